@@ -0,0 +1,148 @@
+#include "stdafx.h"
+#include "AdapterTransfer.h"
+
+namespace
+{
+    UINT GetBytesPerPixel(const DXGI_FORMAT format)
+    {
+        return format == DXGI_FORMAT_R16G16B16A16_FLOAT ? 8 : 4;
+    }
+}
+
+AdapterTransfer::AdapterTransfer()
+    : sourceDevice_(nullptr)
+    , sourceContext_(nullptr)
+    , staging_(nullptr)
+    , bytesPerPixel_(4)
+{
+}
+
+AdapterTransfer::~AdapterTransfer()
+{
+    Destroy();
+}
+
+bool AdapterTransfer::Create(ID3D11Device* sourceDevice)
+{
+    Destroy();
+
+    if (!sourceDevice)
+    {
+        return false;
+    }
+
+    sourceDevice_ = sourceDevice;
+    sourceDevice_->AddRef();
+    sourceDevice_->GetImmediateContext(&sourceContext_);
+
+    return true;
+}
+
+void AdapterTransfer::Destroy()
+{
+    rects_.clear();
+
+    if (staging_) { staging_->Release(); staging_ = nullptr; }
+    if (sourceContext_) { sourceContext_->Release(); sourceContext_ = nullptr; }
+    if (sourceDevice_) { sourceDevice_->Release(); sourceDevice_ = nullptr; }
+}
+
+bool AdapterTransfer::IsActive() const
+{
+    return sourceDevice_ != nullptr;
+}
+
+bool AdapterTransfer::EnsureStaging(ID3D11Texture2D* source)
+{
+    D3D11_TEXTURE2D_DESC sourceDesc;
+    source->GetDesc(&sourceDesc);
+
+    if (staging_)
+    {
+        D3D11_TEXTURE2D_DESC stagingDesc;
+        staging_->GetDesc(&stagingDesc);
+        if (stagingDesc.Width == sourceDesc.Width && stagingDesc.Height == sourceDesc.Height &&
+            stagingDesc.Format == sourceDesc.Format)
+        {
+            return true;
+        }
+
+        staging_->Release();
+        staging_ = nullptr;
+        rects_.clear();
+    }
+
+    D3D11_TEXTURE2D_DESC desc = {};
+    desc.Width = sourceDesc.Width;
+    desc.Height = sourceDesc.Height;
+    desc.MipLevels = 1;
+    desc.ArraySize = 1;
+    desc.Format = sourceDesc.Format;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_STAGING;
+    desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+
+    if (FAILED(sourceDevice_->CreateTexture2D(&desc, nullptr, &staging_)))
+    {
+        staging_ = nullptr;
+        return false;
+    }
+
+    bytesPerPixel_ = GetBytesPerPixel(desc.Format);
+    return true;
+}
+
+bool AdapterTransfer::Queue(ID3D11Texture2D* source, const PixelRect& rect)
+{
+    if (!sourceContext_ || !source || ViewTransform::IsEmpty(rect) || !EnsureStaging(source))
+    {
+        return false;
+    }
+
+    const D3D11_BOX box = {
+        static_cast<UINT>(rect.left), static_cast<UINT>(rect.top), 0,
+        static_cast<UINT>(rect.right), static_cast<UINT>(rect.bottom), 1 };
+
+    sourceContext_->CopySubresourceRegion(
+        staging_, 0, static_cast<UINT>(rect.left), static_cast<UINT>(rect.top), 0, source, 0, &box);
+
+    rects_.push_back(rect);
+    return true;
+}
+
+uint64_t AdapterTransfer::Flush(ID3D11DeviceContext* context, ID3D11Texture2D* destination)
+{
+    if (rects_.empty() || !staging_ || !context || !destination)
+    {
+        rects_.clear();
+        return 0;
+    }
+
+    // Blocks until the source GPU has finished the queued copies
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    if (FAILED(sourceContext_->Map(staging_, 0, D3D11_MAP_READ, 0, &mapped)))
+    {
+        rects_.clear();
+        return 0;
+    }
+
+    uint64_t bytes = 0;
+    for (const PixelRect& rect : rects_)
+    {
+        const D3D11_BOX box = {
+            static_cast<UINT>(rect.left), static_cast<UINT>(rect.top), 0,
+            static_cast<UINT>(rect.right), static_cast<UINT>(rect.bottom), 1 };
+
+        const BYTE* data = static_cast<const BYTE*>(mapped.pData) +
+            static_cast<size_t>(rect.top) * mapped.RowPitch + static_cast<size_t>(rect.left) * bytesPerPixel_;
+
+        context->UpdateSubresource(destination, 0, &box, data, mapped.RowPitch, 0);
+
+        bytes += static_cast<uint64_t>(rect.right - rect.left) * static_cast<uint64_t>(rect.bottom - rect.top) * bytesPerPixel_;
+    }
+
+    sourceContext_->Unmap(staging_, 0);
+    rects_.clear();
+
+    return bytes;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <d3d11.h>
+#include <cstdint>
+#include <vector>
+#include "ViewTransform.h"
+
+// Moves captured pixels from a texture on one adapter to a texture on another, e.g. when
+// the media monitor is driven by a different GPU than the one showing the mirror. D3D11
+// can't open a shared texture on a second adapter, so only the changed rects are copied
+// into a staging texture on the source device, read back and uploaded to the destination.
+class AdapterTransfer  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+public:
+    AdapterTransfer();
+    ~AdapterTransfer();
+
+    bool Create(ID3D11Device* sourceDevice);
+    void Destroy();
+    bool IsActive() const;
+
+    // Queues a copy of rect from source, a texture on the source device.
+    bool Queue(ID3D11Texture2D* source, const PixelRect& rect);
+
+    // Uploads the queued rects into destination, a texture of the same size and format on
+    // the device that owns context. Waits for the source GPU to finish the copies. Returns
+    // the number of bytes moved.
+    uint64_t Flush(ID3D11DeviceContext* context, ID3D11Texture2D* destination);
+
+private:
+    bool EnsureStaging(ID3D11Texture2D* source);
+
+    ID3D11Device* sourceDevice_;
+    ID3D11DeviceContext* sourceContext_;
+    ID3D11Texture2D* staging_;
+    UINT bytesPerPixel_;
+    std::vector<PixelRect> rects_;
+};
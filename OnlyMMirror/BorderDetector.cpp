@@ -0,0 +1,200 @@
+#include "BorderDetector.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+constexpr uint8_t BorderDetector::BorderLuma;
+constexpr double BorderDetector::ShrinkSeconds;
+constexpr double BorderDetector::HoldSeconds;
+constexpr double BorderDetector::MinBorderFraction;
+constexpr double BorderDetector::SymmetryFraction;
+
+namespace
+{
+    bool SameRect(const PixelRect& a, const PixelRect& b)
+    {
+        return a.left == b.left && a.top == b.top && a.right == b.right && a.bottom == b.bottom;
+    }
+
+    PixelRect Union(const PixelRect& a, const PixelRect& b)
+    {
+        return {
+            (std::min)(a.left, b.left), (std::min)(a.top, b.top),
+            (std::max)(a.right, b.right), (std::max)(a.bottom, b.bottom) };
+    }
+
+    // Keeps a pair of opposite borders, before and after the content along one axis, only
+    // if both are wide enough and about the same width; otherwise the content spans the axis
+    void CheckBorders(const int start, const int end, const double tolerance, int& contentStart, int& contentEnd)
+    {
+        const int size = end - start;
+        const int before = contentStart - start;
+        const int after = end - contentEnd;
+        const int minBorder = static_cast<int>(size * BorderDetector::MinBorderFraction);
+
+        if (before < minBorder || after < minBorder || std::abs(before - after) > tolerance)
+        {
+            contentStart = start;
+            contentEnd = end;
+        }
+    }
+}
+
+BorderDetector::BorderDetector()
+    : output_()
+    , content_()
+    , candidate_()
+    , candidateSince_(-1.0)
+    , lastBorderChange_(-1.0)
+    , borderChanged_(false)
+{
+}
+
+void BorderDetector::Reset(const PixelRect& output)
+{
+    output_ = output;
+    content_ = output;
+    candidate_ = PixelRect();
+    candidateSince_ = -1.0;
+    lastBorderChange_ = -1.0;
+    borderChanged_ = false;
+}
+
+bool BorderDetector::AddChange(const PixelRect& rect)
+{
+    if (ViewTransform::IsEmpty(rect))
+    {
+        return false;
+    }
+
+    if (!ViewTransform::Contains(content_, rect))
+    {
+        const bool hadBorders = HasBorders();
+        content_ = output_;
+        candidateSince_ = -1.0;
+        borderChanged_ = true;
+        return hadBorders;
+    }
+
+    if (candidateSince_ >= 0.0 && !ViewTransform::Contains(candidate_, rect))
+    {
+        // The borders waiting to be adopted aren't static after all
+        candidateSince_ = -1.0;
+        borderChanged_ = true;
+    }
+
+    return false;
+}
+
+bool BorderDetector::FindContent(
+    const uint8_t* luma, const int width, const int height, const PixelRect& area, PixelRect& content) const
+{
+    int minX = width;
+    int maxX = -1;
+    int minY = height;
+    int maxY = -1;
+
+    for (int y = 0; y < height; ++y)
+    {
+        const uint8_t* row = luma + static_cast<size_t>(y) * width;
+        for (int x = 0; x < width; ++x)
+        {
+            if (row[x] > BorderLuma)
+            {
+                minX = (std::min)(minX, x);
+                maxX = (std::max)(maxX, x);
+                minY = (std::min)(minY, y);
+                maxY = (std::max)(maxY, y);
+            }
+        }
+    }
+
+    if (maxX < 0)
+    {
+        // A black frame says nothing about where the content is
+        return false;
+    }
+
+    // A sample of margin on each side, as a reduced sample can straddle the content's edge
+    minX = (std::max)(0, minX - 1);
+    minY = (std::max)(0, minY - 1);
+    maxX = (std::min)(width - 1, maxX + 1);
+    maxY = (std::min)(height - 1, maxY + 1);
+
+    // Samples to output pixels, rounded outwards
+    const int64_t areaWidth = area.right - area.left;
+    const int64_t areaHeight = area.bottom - area.top;
+    content.left = area.left + static_cast<int>(minX * areaWidth / width);
+    content.top = area.top + static_cast<int>(minY * areaHeight / height);
+    content.right = area.left + static_cast<int>(((maxX + 1) * areaWidth + width - 1) / width);
+    content.bottom = area.top + static_cast<int>(((maxY + 1) * areaHeight + height - 1) / height);
+
+    const double outputWidth = output_.right - output_.left;
+    const double outputHeight = output_.bottom - output_.top;
+    CheckBorders(output_.left, output_.right,
+        outputWidth * SymmetryFraction + static_cast<double>(areaWidth) / width, content.left, content.right);
+    CheckBorders(output_.top, output_.bottom,
+        outputHeight * SymmetryFraction + static_cast<double>(areaHeight) / height, content.top, content.bottom);
+
+    // Only changes can widen the content: what isn't copied any more can't be measured
+    return ViewTransform::Intersect(content, content_, content);
+}
+
+bool BorderDetector::Update(const uint8_t* luma, const int width, const int height, const PixelRect& area, const double now)
+{
+    if (borderChanged_)
+    {
+        lastBorderChange_ = now;
+        borderChanged_ = false;
+    }
+
+    // Only a measurement of all of the content can tell where it ends, e.g. not while zoomed in
+    PixelRect content;
+    if (!luma || width <= 0 || height <= 0 || !ViewTransform::Contains(area, content_) ||
+        !FindContent(luma, width, height, area, content))
+    {
+        return false;
+    }
+
+    if (SameRect(content, content_))
+    {
+        candidateSince_ = -1.0;
+        return false;
+    }
+
+    // Borders that vary a little while they wait are adopted at their narrowest
+    if (candidateSince_ < 0.0)
+    {
+        candidate_ = content;
+        candidateSince_ = now;
+    }
+    else
+    {
+        candidate_ = Union(candidate_, content);
+    }
+
+    const bool held = lastBorderChange_ < 0.0 || now - lastBorderChange_ >= HoldSeconds;
+    if (now - candidateSince_ < ShrinkSeconds || !held || SameRect(candidate_, content_))
+    {
+        return false;
+    }
+
+    content_ = candidate_;
+    candidateSince_ = -1.0;
+    return true;
+}
+
+const PixelRect& BorderDetector::GetContent() const
+{
+    return content_;
+}
+
+const PixelRect& BorderDetector::GetOutput() const
+{
+    return output_;
+}
+
+bool BorderDetector::HasBorders() const
+{
+    return !SameRect(content_, output_);
+}
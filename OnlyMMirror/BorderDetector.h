@@ -0,0 +1,62 @@
+#pragma once
+
+// Portable detector for letterbox and pillarbox borders: the static black bars around 16:9
+// video or 4:3 slides on an output of another shape. The mirror leaves them out of its
+// copies and feed checks, and can crop them from the view.
+//
+// Borders are found in the feed probe's reduced luma copy, as the dark margins around the
+// content, and only adopted once they have held for ShrinkSeconds. A border has to be
+// symmetrical, as letterboxing is, so a dark scene or a black slide with its text off
+// centre isn't mistaken for one. Once adopted the borders aren't copied any more, so their
+// pixels can't show a change; the duplication's dirty and move rects do, and any change in
+// a border drops the borders straight away. After that the borders have to stay unchanged
+// for HoldSeconds before they're adopted again, so that e.g. subtitles in the letterbox
+// don't make them come and go.
+
+#include <cstdint>
+#include "FrameStatistics.h"
+#include "ViewTransform.h"
+
+class BorderDetector
+{
+public:
+    BorderDetector();
+
+    // The whole output, in the image's coordinates (those of the dirty rects). Drops any borders.
+    void Reset(const PixelRect& output);
+
+    // A dirty rect, or a move rect's destination. Returns true if it hit a border, which
+    // drops the borders.
+    bool AddChange(const PixelRect& rect);
+
+    // A reduced luma copy of area of the output, width * height samples, measured at time
+    // now (in seconds). Returns true if the borders changed.
+    bool Update(const uint8_t* luma, int width, int height, const PixelRect& area, double now);
+
+    // The output without the borders; the whole output if there are none
+    const PixelRect& GetContent() const;
+    const PixelRect& GetOutput() const;
+    bool HasBorders() const;
+
+    // Samples brighter than this are content
+    static constexpr uint8_t BorderLuma = FrameAnalysis::BlackLevel;
+
+    static constexpr double ShrinkSeconds = 2.0;
+    static constexpr double HoldSeconds = 10.0;
+
+    // Borders narrower than this share of the output aren't worth cropping
+    static constexpr double MinBorderFraction = 0.02;
+
+    // Opposite borders may differ by this share of the output, plus a sample
+    static constexpr double SymmetryFraction = 0.01;
+
+private:
+    bool FindContent(const uint8_t* luma, int width, int height, const PixelRect& area, PixelRect& content) const;
+
+    PixelRect output_;
+    PixelRect content_;
+    PixelRect candidate_;           // the borders waiting to be adopted
+    double candidateSince_;         // negative if there are none
+    double lastBorderChange_;       // negative if there's been no change in a border
+    bool borderChanged_;            // since the last Update
+};
@@ -0,0 +1,119 @@
+#include "DirtyRegion.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    bool Overlaps(const PixelRect& a, const PixelRect& b)
+    {
+        return a.left < b.right && b.left < a.right && a.top < b.bottom && b.top < a.bottom;
+    }
+
+    PixelRect Union(const PixelRect& a, const PixelRect& b)
+    {
+        return {
+            (std::min)(a.left, b.left), (std::min)(a.top, b.top),
+            (std::max)(a.right, b.right), (std::max)(a.bottom, b.bottom) };
+    }
+}
+
+constexpr size_t DirtyRegion::MaxRects;
+
+DirtyRegion::DirtyRegion() = default;
+
+void DirtyRegion::Clear()
+{
+    rects_.clear();
+}
+
+void DirtyRegion::Add(const PixelRect& rect)
+{
+    if (ViewTransform::IsEmpty(rect))
+    {
+        return;
+    }
+
+    // Absorb every rect the new one overlaps; the union may then overlap others
+    PixelRect merged = rect;
+    for (size_t n = 0; n < rects_.size();)
+    {
+        if (Overlaps(rects_[n], merged))
+        {
+            merged = Union(rects_[n], merged);
+            rects_.erase(rects_.begin() + static_cast<std::ptrdiff_t>(n));
+            n = 0;
+        }
+        else
+        {
+            ++n;
+        }
+    }
+
+    rects_.push_back(merged);
+
+    if (rects_.size() > MaxRects)
+    {
+        PixelRect bounds = rects_.front();
+        for (const PixelRect& r : rects_)
+        {
+            bounds = Union(bounds, r);
+        }
+
+        rects_.assign(1, bounds);
+    }
+}
+
+bool DirtyRegion::IsEmpty() const
+{
+    return rects_.empty();
+}
+
+const std::vector<PixelRect>& DirtyRegion::GetRects() const
+{
+    return rects_;
+}
+
+void DirtyRegion::Clip(const PixelRect& bounds)
+{
+    std::vector<PixelRect> clipped;
+    for (const PixelRect& rect : rects_)
+    {
+        PixelRect part;
+        if (ViewTransform::Intersect(rect, bounds, part))
+        {
+            clipped.push_back(part);
+        }
+    }
+
+    rects_.swap(clipped);
+}
+
+int64_t DirtyRegion::GetArea() const
+{
+    int64_t area = 0;
+    for (const PixelRect& rect : rects_)
+    {
+        area += static_cast<int64_t>(rect.right - rect.left) * (rect.bottom - rect.top);
+    }
+
+    return area;
+}
+
+PixelRect DirtyRegion::ToPixels(const QuadMapping& mapping, const PixelRect& viewport, const int padding)
+{
+    const double width = viewport.right - viewport.left;
+    const double height = viewport.bottom - viewport.top;
+
+    // Normalised device coordinates have y upwards
+    const double left = viewport.left + (mapping.left + 1.0) * 0.5 * width;
+    const double right = viewport.left + (mapping.right + 1.0) * 0.5 * width;
+    const double top = viewport.top + (1.0 - mapping.top) * 0.5 * height;
+    const double bottom = viewport.top + (1.0 - mapping.bottom) * 0.5 * height;
+
+    return {
+        static_cast<int>(std::floor((std::min)(left, right))) - padding,
+        static_cast<int>(std::floor((std::min)(top, bottom))) - padding,
+        static_cast<int>(std::ceil((std::max)(left, right))) + padding,
+        static_cast<int>(std::ceil((std::max)(top, bottom))) + padding };
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+// Portable bookkeeping for partial presents: the parts of the window to redraw this frame,
+// as a short list of rects. Overlapping rects are merged as they're added, and
+// beyond MaxRects the list collapses to their bounds, which keeps both the number of
+// scissored draws and the present's dirty rect list small.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "ViewTransform.h"
+
+class DirtyRegion
+{
+public:
+    DirtyRegion();
+
+    void Clear();
+    void Add(const PixelRect& rect);
+
+    bool IsEmpty() const;
+    const std::vector<PixelRect>& GetRects() const;
+
+    // Clips the rects to bounds, dropping any that fall outside
+    void Clip(const PixelRect& bounds);
+
+    // Total area of the rects in pixels; they never overlap
+    int64_t GetArea() const;
+
+    // The pixels covered by mapping's quad when drawn into viewport, rounded outwards and
+    // grown by padding on each side
+    static PixelRect ToPixels(const QuadMapping& mapping, const PixelRect& viewport, int padding);
+
+    static constexpr size_t MaxRects = 8;
+
+private:
+    std::vector<PixelRect> rects_;
+};
@@ -0,0 +1,205 @@
+#include "stdafx.h"
+#include "DisplayAdapters.h"
+#include <cstring>
+#include <cwchar>
+#include <dxgi1_6.h>
+#include <vector>
+
+#pragma comment(lib, "dxgi.lib")
+
+namespace DisplayAdapters
+{
+    bool FindOutput(const char* deviceName, IDXGIOutput1** output, IDXGIAdapter1** adapter)
+    {
+        IDXGIFactory1* factory = nullptr;
+        if (FAILED(CreateDXGIFactory1(__uuidof(IDXGIFactory1), reinterpret_cast<void**>(&factory))))  // NOLINT(clang-diagnostic-language-extension-token)
+        {
+            return false;
+        }
+
+        const bool anyOutput = !deviceName || deviceName[0] == '\0';
+        bool found = false;
+
+        IDXGIAdapter1* candidateAdapter = nullptr;
+        for (UINT adapterIndex = 0; !found && factory->EnumAdapters1(adapterIndex, &candidateAdapter) != DXGI_ERROR_NOT_FOUND; ++adapterIndex)
+        {
+            IDXGIOutput* candidate = nullptr;
+            for (UINT outputIndex = 0; !found && candidateAdapter->EnumOutputs(outputIndex, &candidate) != DXGI_ERROR_NOT_FOUND; ++outputIndex)
+            {
+                DXGI_OUTPUT_DESC outputDesc;
+                if (SUCCEEDED(candidate->GetDesc(&outputDesc)))
+                {
+                    // Convert wide string to narrow string for comparison
+                    char name[32];
+                    WideCharToMultiByte(CP_ACP, 0, outputDesc.DeviceName, -1, name, sizeof(name), nullptr, nullptr);
+
+                    if ((anyOutput || strcmp(deviceName, name) == 0) &&
+                        SUCCEEDED(candidate->QueryInterface(__uuidof(IDXGIOutput1), reinterpret_cast<void**>(output))))  // NOLINT(clang-diagnostic-language-extension-token)
+                    {
+                        *adapter = candidateAdapter;
+                        candidateAdapter->AddRef();
+                        found = true;
+                    }
+                }
+
+                candidate->Release();
+            }
+
+            candidateAdapter->Release();
+        }
+
+        factory->Release();
+        return found;
+    }
+
+    IDXGIAdapter1* FindAdapterForMonitor(const HMONITOR monitor)
+    {
+        IDXGIFactory1* factory = nullptr;
+        if (FAILED(CreateDXGIFactory1(__uuidof(IDXGIFactory1), reinterpret_cast<void**>(&factory))))  // NOLINT(clang-diagnostic-language-extension-token)
+        {
+            return nullptr;
+        }
+
+        IDXGIAdapter1* found = nullptr;
+        IDXGIAdapter1* adapter = nullptr;
+        for (UINT adapterIndex = 0; !found && factory->EnumAdapters1(adapterIndex, &adapter) != DXGI_ERROR_NOT_FOUND; ++adapterIndex)
+        {
+            IDXGIOutput* output = nullptr;
+            for (UINT outputIndex = 0; !found && adapter->EnumOutputs(outputIndex, &output) != DXGI_ERROR_NOT_FOUND; ++outputIndex)
+            {
+                DXGI_OUTPUT_DESC outputDesc;
+                if (SUCCEEDED(output->GetDesc(&outputDesc)) && outputDesc.Monitor == monitor)
+                {
+                    found = adapter;
+                    found->AddRef();
+                }
+
+                output->Release();
+            }
+
+            adapter->Release();
+        }
+
+        factory->Release();
+        return found;
+    }
+
+    HRESULT DuplicateOutput(
+        IDXGIOutput1* output, ID3D11Device* device,
+        const DXGI_FORMAT* formats, const UINT formatCount, IDXGIOutputDuplication** duplication)
+    {
+        IDXGIOutput5* output5 = nullptr;
+        if (SUCCEEDED(output->QueryInterface(__uuidof(IDXGIOutput5), reinterpret_cast<void**>(&output5))))  // NOLINT(clang-diagnostic-language-extension-token)
+        {
+            const HRESULT hr = output5->DuplicateOutput1(device, 0, formatCount, formats, duplication);
+            output5->Release();
+            return hr;
+        }
+
+        return output->DuplicateOutput(device, duplication);
+    }
+
+    bool GetOutputColour(IDXGIOutput1* output, bool& hdr10, float& peakNits)
+    {
+        IDXGIOutput6* output6 = nullptr;
+        if (FAILED(output->QueryInterface(__uuidof(IDXGIOutput6), reinterpret_cast<void**>(&output6))))  // NOLINT(clang-diagnostic-language-extension-token)
+        {
+            return false;
+        }
+
+        DXGI_OUTPUT_DESC1 desc;
+        const HRESULT hr = output6->GetDesc1(&desc);
+        output6->Release();
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        hdr10 = desc.ColorSpace == DXGI_COLOR_SPACE_RGB_FULL_G2084_NONE_P2020;
+        peakNits = desc.MaxLuminance;
+        return true;
+    }
+
+    float GetSdrWhiteLevel(const WCHAR* gdiDeviceName)
+    {
+        constexpr float DefaultWhiteLevel = 80.0f;
+
+        UINT32 pathCount = 0;
+        UINT32 modeCount = 0;
+        if (GetDisplayConfigBufferSizes(QDC_ONLY_ACTIVE_PATHS, &pathCount, &modeCount) != ERROR_SUCCESS)
+        {
+            return DefaultWhiteLevel;
+        }
+
+        std::vector<DISPLAYCONFIG_PATH_INFO> paths(pathCount);
+        std::vector<DISPLAYCONFIG_MODE_INFO> modes(modeCount);
+        if (QueryDisplayConfig(QDC_ONLY_ACTIVE_PATHS, &pathCount, paths.data(), &modeCount, modes.data(), nullptr) != ERROR_SUCCESS)
+        {
+            return DefaultWhiteLevel;
+        }
+
+        for (UINT32 n = 0; n < pathCount; ++n)
+        {
+            DISPLAYCONFIG_SOURCE_DEVICE_NAME sourceName = {};
+            sourceName.header.type = DISPLAYCONFIG_DEVICE_INFO_GET_SOURCE_NAME;
+            sourceName.header.size = sizeof(sourceName);
+            sourceName.header.adapterId = paths[n].sourceInfo.adapterId;
+            sourceName.header.id = paths[n].sourceInfo.id;
+
+            if (DisplayConfigGetDeviceInfo(&sourceName.header) != ERROR_SUCCESS ||
+                wcscmp(sourceName.viewGdiDeviceName, gdiDeviceName) != 0)
+            {
+                continue;
+            }
+
+            DISPLAYCONFIG_SDR_WHITE_LEVEL whiteLevel = {};
+            whiteLevel.header.type = DISPLAYCONFIG_DEVICE_INFO_GET_SDR_WHITE_LEVEL;
+            whiteLevel.header.size = sizeof(whiteLevel);
+            whiteLevel.header.adapterId = paths[n].targetInfo.adapterId;
+            whiteLevel.header.id = paths[n].targetInfo.id;
+
+            // Reported in thousandths of 80 nits
+            if (DisplayConfigGetDeviceInfo(&whiteLevel.header) == ERROR_SUCCESS && whiteLevel.SDRWhiteLevel > 0)
+            {
+                return static_cast<float>(whiteLevel.SDRWhiteLevel) * DefaultWhiteLevel / 1000.0f;
+            }
+
+            break;
+        }
+
+        return DefaultWhiteLevel;
+    }
+
+    bool GetDeviceAdapterLuid(ID3D11Device* device, LUID& luid)
+    {
+        IDXGIDevice* dxgiDevice = nullptr;
+        if (FAILED(device->QueryInterface(__uuidof(IDXGIDevice), reinterpret_cast<void**>(&dxgiDevice))))  // NOLINT(clang-diagnostic-language-extension-token)
+        {
+            return false;
+        }
+
+        IDXGIAdapter* adapter = nullptr;
+        HRESULT hr = dxgiDevice->GetAdapter(&adapter);
+        dxgiDevice->Release();
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        DXGI_ADAPTER_DESC desc;
+        hr = adapter->GetDesc(&desc);
+        adapter->Release();
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        luid = desc.AdapterLuid;
+        return true;
+    }
+
+    bool IsSameLuid(const LUID& a, const LUID& b)
+    {
+        return a.LowPart == b.LowPart && a.HighPart == b.HighPart;
+    }
+}
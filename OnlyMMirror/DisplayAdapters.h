@@ -0,0 +1,32 @@
+#pragma once
+#include <windows.h>
+#include <d3d11.h>
+#include <dxgi1_2.h>
+
+// Finding outputs and the adapters that drive them, across every adapter in the system.
+namespace DisplayAdapters
+{
+    // The output whose device name (e.g. "\\.\DISPLAY2") is deviceName, or the first output
+    // if deviceName is null or empty, and its adapter. The caller releases both.
+    bool FindOutput(const char* deviceName, IDXGIOutput1** output, IDXGIAdapter1** adapter);
+
+    // The adapter driving monitor, or null if there isn't one
+    IDXGIAdapter1* FindAdapterForMonitor(HMONITOR monitor);
+
+    // Duplicates output with DuplicateOutput1, which hands frames over in the first of formats
+    // the desktop can supply without conversion (FP16 and 10-bit desktops included), falling
+    // back to DuplicateOutput where IDXGIOutput5 isn't available (before Windows 10 1703)
+    HRESULT DuplicateOutput(IDXGIOutput1* output, ID3D11Device* device,
+        const DXGI_FORMAT* formats, UINT formatCount, IDXGIOutputDuplication** duplication);
+
+    // Whether output is running in HDR10 (ST 2084 with BT.2020 primaries) and its peak
+    // brightness in nits. False if IDXGIOutput6 isn't available.
+    bool GetOutputColour(IDXGIOutput1* output, bool& hdr10, float& peakNits);
+
+    // The brightness, in nits, Windows gives SDR white on the monitor whose GDI device name is
+    // gdiDeviceName ("SDR content brightness"), or 80 if it can't be found
+    float GetSdrWhiteLevel(const WCHAR* gdiDeviceName);
+
+    bool GetDeviceAdapterLuid(ID3D11Device* device, LUID& luid);
+    bool IsSameLuid(const LUID& a, const LUID& b);
+}
@@ -0,0 +1,334 @@
+#include "stdafx.h"
+#include "DuplicationPane.h"
+#include "DisplayAdapters.h"
+#include "Metrics.h"
+
+namespace
+{
+    template<typename T>
+    void SafeRelease(T*& ptr)
+    {
+        if (ptr) { ptr->Release(); ptr = nullptr; }
+    }
+
+    // Panes share the mirror's SDR pixel shader, so HDR desktops are converted to 8-bit by DXGI
+    constexpr DXGI_FORMAT PaneFormat = DXGI_FORMAT_B8G8R8A8_UNORM;
+    constexpr uint64_t BytesPerPixel = 4;
+
+    // How long to wait between attempts to get a lost duplication back
+    constexpr ULONGLONG RetryIntervalMs = 1000;
+}
+
+DuplicationPane::DuplicationPane()
+    : device_(nullptr)
+    , captureDevice_(nullptr)
+    , output_(nullptr)
+    , duplication_(nullptr)
+    , texture_(nullptr)
+    , textureSRV_(nullptr)
+    , monitorRect_()
+    , rotation_(OutputRotation::Identity)
+    , pointerPosition_()
+    , pointerVisible_(false)
+    , needFullCopy_(true)
+    , lastRetry_(0)
+{
+}
+
+DuplicationPane::~DuplicationPane()
+{
+    Destroy();
+}
+
+bool DuplicationPane::Create(ID3D11Device* device, const char* monitorName)
+{
+    Destroy();
+
+    if (!device || !monitorName || monitorName[0] == '\0')
+    {
+        return false;
+    }
+
+    device_ = device;
+    device_->AddRef();
+    monitorName_ = monitorName;
+
+    return InitializeDuplication();
+}
+
+void DuplicationPane::Destroy()
+{
+    CleanupDuplication();
+    transfer_.Destroy();
+    SafeRelease(textureSRV_);
+    SafeRelease(texture_);
+    SafeRelease(captureDevice_);
+    SafeRelease(device_);
+}
+
+bool DuplicationPane::InitializeDuplication()
+{
+    IDXGIAdapter1* adapter = nullptr;
+    if (!DisplayAdapters::FindOutput(monitorName_.c_str(), &output_, &adapter))
+    {
+        return false;
+    }
+
+    DXGI_OUTPUT_DESC outputDesc;
+    if (SUCCEEDED(output_->GetDesc(&outputDesc)))
+    {
+        monitorRect_ = outputDesc.DesktopCoordinates;
+    }
+
+    // As for the main target, the duplication needs a device on the monitor's own adapter
+    if (!captureDevice_)
+    {
+        DXGI_ADAPTER_DESC1 adapterDesc;
+        LUID deviceLuid;
+        if (FAILED(adapter->GetDesc1(&adapterDesc)) || !DisplayAdapters::GetDeviceAdapterLuid(device_, deviceLuid))
+        {
+            adapter->Release();
+            return false;
+        }
+
+        if (DisplayAdapters::IsSameLuid(adapterDesc.AdapterLuid, deviceLuid))
+        {
+            captureDevice_ = device_;
+            captureDevice_->AddRef();
+        }
+        else if (FAILED(D3D11CreateDevice(
+            adapter, D3D_DRIVER_TYPE_UNKNOWN, nullptr, 0, nullptr, 0, D3D11_SDK_VERSION, &captureDevice_, nullptr, nullptr)) ||
+            !transfer_.Create(captureDevice_))
+        {
+            SafeRelease(captureDevice_);
+            adapter->Release();
+            return false;
+        }
+    }
+
+    adapter->Release();
+
+    // A new duplication starts with a complete frame
+    needFullCopy_ = true;
+    if (FAILED(DisplayAdapters::DuplicateOutput(output_, captureDevice_, &PaneFormat, 1, &duplication_)))
+    {
+        return false;
+    }
+
+    DXGI_OUTDUPL_DESC duplicationDesc;
+    duplication_->GetDesc(&duplicationDesc);
+    rotation_ = static_cast<OutputRotation>(duplicationDesc.Rotation);
+    return true;
+}
+
+void DuplicationPane::CleanupDuplication()
+{
+    SafeRelease(duplication_);
+    SafeRelease(output_);
+}
+
+bool DuplicationPane::EnsureTexture(const D3D11_TEXTURE2D_DESC& desktopDesc)
+{
+    if (texture_)
+    {
+        D3D11_TEXTURE2D_DESC existingDesc;
+        texture_->GetDesc(&existingDesc);
+        if (existingDesc.Width == desktopDesc.Width && existingDesc.Height == desktopDesc.Height &&
+            existingDesc.Format == desktopDesc.Format)
+        {
+            return true;
+        }
+
+        SafeRelease(textureSRV_);
+        SafeRelease(texture_);
+    }
+
+    D3D11_TEXTURE2D_DESC desc = {};
+    desc.Width = desktopDesc.Width;
+    desc.Height = desktopDesc.Height;
+    desc.MipLevels = 1;
+    desc.ArraySize = 1;
+    desc.Format = desktopDesc.Format;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+    if (FAILED(device_->CreateTexture2D(&desc, nullptr, &texture_)) ||
+        FAILED(device_->CreateShaderResourceView(texture_, nullptr, &textureSRV_)))
+    {
+        SafeRelease(textureSRV_);
+        SafeRelease(texture_);
+        return false;
+    }
+
+    needFullCopy_ = true;
+    return true;
+}
+
+void DuplicationPane::CopyRect(ID3D11DeviceContext* context, ID3D11Texture2D* source, const RECT& rect)
+{
+    if (transfer_.IsActive())
+    {
+        transfer_.Queue(source, { rect.left, rect.top, rect.right, rect.bottom });
+        return;
+    }
+
+    const D3D11_BOX box = {
+        static_cast<UINT>(rect.left), static_cast<UINT>(rect.top), 0,
+        static_cast<UINT>(rect.right), static_cast<UINT>(rect.bottom), 1 };
+
+    context->CopySubresourceRegion(
+        texture_, 0, static_cast<UINT>(rect.left), static_cast<UINT>(rect.top), 0, source, 0, &box);
+}
+
+uint64_t DuplicationPane::CopyChanges(
+    ID3D11DeviceContext* context, ID3D11Texture2D* desktopTexture, const DXGI_OUTDUPL_FRAME_INFO& frameInfo)
+{
+    D3D11_TEXTURE2D_DESC desc;
+    texture_->GetDesc(&desc);
+    const RECT whole = { 0, 0, static_cast<LONG>(desc.Width), static_cast<LONG>(desc.Height) };
+
+    // Move rects come first in the buffer, dirty rects after them
+    UINT moveBytes = 0;
+    UINT dirtyBytes = 0;
+    bool haveRects = false;
+    if (!needFullCopy_ && frameInfo.TotalMetadataBufferSize > 0)
+    {
+        if (frameMetadata_.size() < frameInfo.TotalMetadataBufferSize)
+        {
+            frameMetadata_.resize(frameInfo.TotalMetadataBufferSize);
+        }
+
+        const auto bufferSize = static_cast<UINT>(frameMetadata_.size());
+        haveRects =
+            SUCCEEDED(duplication_->GetFrameMoveRects(
+                bufferSize, reinterpret_cast<DXGI_OUTDUPL_MOVE_RECT*>(frameMetadata_.data()), &moveBytes)) &&
+            SUCCEEDED(duplication_->GetFrameDirtyRects(
+                bufferSize - moveBytes, reinterpret_cast<RECT*>(frameMetadata_.data() + moveBytes), &dirtyBytes));
+    }
+
+    uint64_t copiedPixels = 0;
+    if (!haveRects)
+    {
+        CopyRect(context, desktopTexture, whole);
+        copiedPixels = static_cast<uint64_t>(desc.Width) * desc.Height;
+    }
+    else
+    {
+        const auto* moveRects = reinterpret_cast<const DXGI_OUTDUPL_MOVE_RECT*>(frameMetadata_.data());
+        const auto* dirtyRects = reinterpret_cast<const RECT*>(frameMetadata_.data() + moveBytes);
+        const UINT moveCount = moveBytes / sizeof(DXGI_OUTDUPL_MOVE_RECT);
+        const UINT dirtyCount = dirtyBytes / sizeof(RECT);
+
+        for (UINT n = 0; n < moveCount + dirtyCount; ++n)
+        {
+            const RECT& changed = n < moveCount ? moveRects[n].DestinationRect : dirtyRects[n - moveCount];
+
+            RECT clipped;
+            if (IntersectRect(&clipped, &changed, &whole))
+            {
+                CopyRect(context, desktopTexture, clipped);
+                copiedPixels += static_cast<uint64_t>(clipped.right - clipped.left) * static_cast<uint64_t>(clipped.bottom - clipped.top);
+            }
+        }
+    }
+
+    if (transfer_.IsActive())
+    {
+        transfer_.Flush(context, texture_);
+    }
+
+    needFullCopy_ = false;
+    return copiedPixels;
+}
+
+bool DuplicationPane::Update(ID3D11DeviceContext* context, MirrorStats& stats)
+{
+    if (!duplication_)
+    {
+        // Lost, e.g. while a secure desktop is shown; try again now and then
+        const ULONGLONG now = GetTickCount64();
+        if (now - lastRetry_ >= RetryIntervalMs)
+        {
+            lastRetry_ = now;
+            CleanupDuplication();
+            InitializeDuplication();
+        }
+
+        return textureSRV_ != nullptr;
+    }
+
+    DXGI_OUTDUPL_FRAME_INFO frameInfo = {};
+    IDXGIResource* desktopResource = nullptr;
+    const HRESULT hr = duplication_->AcquireNextFrame(0, &frameInfo, &desktopResource);
+
+    if (frameInfo.LastMouseUpdateTime.QuadPart != 0)
+    {
+        pointerPosition_ = frameInfo.PointerPosition.Position;
+        pointerVisible_ = frameInfo.PointerPosition.Visible != FALSE;
+    }
+
+    if (hr == S_OK)
+    {
+        ID3D11Texture2D* desktopTexture = nullptr;
+        if (frameInfo.LastPresentTime.QuadPart != 0 &&
+            SUCCEEDED(desktopResource->QueryInterface(__uuidof(ID3D11Texture2D), reinterpret_cast<void**>(&desktopTexture))))  // NOLINT(clang-diagnostic-language-extension-token)
+        {
+            D3D11_TEXTURE2D_DESC desktopDesc;
+            desktopTexture->GetDesc(&desktopDesc);
+
+            if (EnsureTexture(desktopDesc))
+            {
+                stats.copiedBytes += CopyChanges(context, desktopTexture, frameInfo) * BytesPerPixel;
+                stats.fullOutputBytes += static_cast<uint64_t>(desktopDesc.Width) * desktopDesc.Height * BytesPerPixel;
+            }
+
+            desktopTexture->Release();
+        }
+
+        desktopResource->Release();
+        duplication_->ReleaseFrame();
+    }
+    else if (hr != DXGI_ERROR_WAIT_TIMEOUT)
+    {
+        char detail[128];
+        (void)sprintf_s(detail, "%s lost (0x%08lX)", monitorName_.c_str(), static_cast<unsigned long>(hr));
+        Metrics::Event("pane.duplication", detail);
+
+        CleanupDuplication();
+        InitializeDuplication();
+    }
+
+    return textureSRV_ != nullptr;
+}
+
+ID3D11ShaderResourceView* DuplicationPane::GetShaderResourceView() const
+{
+    return textureSRV_;
+}
+
+const std::string& DuplicationPane::GetMonitorName() const
+{
+    return monitorName_;
+}
+
+const RECT& DuplicationPane::GetMonitorRect() const
+{
+    return monitorRect_;
+}
+
+OutputRotation DuplicationPane::GetRotation() const
+{
+    return rotation_;
+}
+
+bool DuplicationPane::GetPointerPosition(POINT& position) const
+{
+    if (!pointerVisible_)
+    {
+        return false;
+    }
+
+    position = pointerPosition_;
+    return true;
+}
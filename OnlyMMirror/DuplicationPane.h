@@ -0,0 +1,61 @@
+#pragma once
+#include <windows.h>
+#include <d3d11.h>
+#include <dxgi1_2.h>
+#include <string>
+#include <vector>
+#include "AdapterTransfer.h"
+#include "MirrorStats.h"
+#include "OutputRotation.h"
+
+// An additional monitor shown in tiled mode. Each pane has its own desktop duplication,
+// acquired independently of the others, and copies what changed into its own texture on
+// the mirror's device; DuplicationWindow draws all the panes in one pass.
+class DuplicationPane  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+public:
+    DuplicationPane();
+    ~DuplicationPane();
+
+    bool Create(ID3D11Device* device, const char* monitorName);
+    void Destroy();
+
+    // Acquires the latest frame, if there is one, and copies what changed. Returns true
+    // if the pane has something to draw.
+    bool Update(ID3D11DeviceContext* context, MirrorStats& stats);
+
+    ID3D11ShaderResourceView* GetShaderResourceView() const;
+    const std::string& GetMonitorName() const;
+
+    // The monitor in desktop coordinates
+    const RECT& GetMonitorRect() const;
+
+    // The texture holds the monitor's image in its unrotated orientation
+    OutputRotation GetRotation() const;
+
+    // Where the pointer is on this monitor, if it's here and visible
+    bool GetPointerPosition(POINT& position) const;
+
+private:
+    bool InitializeDuplication();
+    void CleanupDuplication();
+    bool EnsureTexture(const D3D11_TEXTURE2D_DESC& desktopDesc);
+    void CopyRect(ID3D11DeviceContext* context, ID3D11Texture2D* source, const RECT& rect);
+    uint64_t CopyChanges(ID3D11DeviceContext* context, ID3D11Texture2D* desktopTexture, const DXGI_OUTDUPL_FRAME_INFO& frameInfo);
+
+    ID3D11Device* device_;
+    ID3D11Device* captureDevice_;       // device_, or one on the monitor's own adapter
+    AdapterTransfer transfer_;
+    IDXGIOutput1* output_;
+    IDXGIOutputDuplication* duplication_;
+    ID3D11Texture2D* texture_;
+    ID3D11ShaderResourceView* textureSRV_;
+    std::string monitorName_;
+    RECT monitorRect_;
+    OutputRotation rotation_;
+    std::vector<BYTE> frameMetadata_;
+    POINT pointerPosition_;
+    bool pointerVisible_;
+    bool needFullCopy_;
+    ULONGLONG lastRetry_;
+};
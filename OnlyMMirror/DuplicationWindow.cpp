@@ -1,10 +1,19 @@
 #include "stdafx.h"
 #include "DuplicationWindow.h"
+#include "DisplayAdapters.h"
+#include "FrameJournal.h"
+#include "LatencyPattern.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
 #include <d3dcompiler.h>
+#include <dwmapi.h>
 #include <string>
+#include <utility>
 #include <wingdi.h>
 #include <iostream>
-#include <vector>
 
 #pragma comment(lib, "d3d11.lib")
 #pragma comment(lib, "dxgi.lib")
@@ -47,6 +56,158 @@ float4 main(PS_INPUT input) : SV_TARGET {
 }
 )";
 
+    // Tone mapping of FP16 (scRGB) and HDR10 captures to the SDR swap chain, shared by the
+    // shaders that sample the captured texture. ToneMap.cpp is the CPU reference for it.
+    const char* toneMapShaderSource = R"(
+cbuffer ToneMap : register(b1) {
+    float encoding;     // 0 SDR (unchanged), 1 linear scRGB, 2 PQ with BT.2020 primaries
+    float scale;        // source units to multiples of SDR white
+    float peak;         // source peak in multiples of SDR white
+    float knee;
+};
+
+static const float3x3 Bt2020To709 = {
+     1.6605, -0.5876, -0.0728,
+    -0.1246,  1.1329, -0.0083,
+    -0.0182, -0.1006,  1.1187
+};
+
+float3 PqToNits(float3 value) {
+    float3 p = pow(saturate(value), 1.0 / 78.84375);
+    return 10000.0 * pow(max(p - 0.8359375, 0.0) / (18.8515625 - 18.6875 * p), 1.0 / 0.1593017578125);
+}
+
+float Compress(float x) {
+    if (peak <= 1.0 || x <= knee) {
+        return min(x, 1.0);
+    }
+
+    float range = 1.0 - knee;
+    float a = (min(x, peak) - knee) / range;
+    float limit = (peak - knee) / range;
+    return knee + range * a * (1.0 + a / (limit * limit)) / (1.0 + a);
+}
+
+float3 LinearToSrgb(float3 value) {
+    return value <= 0.0031308 ? value * 12.92 : 1.055 * pow(value, 1.0 / 2.4) - 0.055;
+}
+
+float3 ToneMap(float3 colour) {
+    if (encoding < 0.5) {
+        return colour;
+    }
+
+    float3 linearColour = encoding < 1.5 ? colour * scale : mul(Bt2020To709, PqToNits(colour)) * scale;
+    linearColour = max(linearColour, 0.0);
+
+    // Compress the largest channel and scale the others with it to keep the hue
+    float largest = max(linearColour.r, max(linearColour.g, linearColour.b));
+    if (largest > knee) {
+        linearColour *= Compress(largest) / largest;
+    }
+
+    return LinearToSrgb(saturate(linearColour));
+}
+)";
+
+    // The mirror when the capture is FP16 or HDR10
+    const char* toneMapPixelShaderSource = R"(
+Texture2D shaderTexture : register(t0);
+SamplerState samplerType : register(s0);
+
+struct PS_INPUT {
+    float4 pos : SV_POSITION;
+    float2 tex : TEXCOORD0;
+};
+
+float4 main(PS_INPUT input) : SV_TARGET {
+    return float4(ToneMap(shaderTexture.Sample(samplerType, input.tex).rgb), 1.0);
+}
+)";
+
+    // The mirror when it shows the captured texture at exactly 1/2, 1/3 or 1/4 scale: each
+    // pixel is the average of the factor x factor texels it covers, which bilinear sampling
+    // only achieves at 1/2. Even factors take bilinear taps at the centres of 2x2 blocks,
+    // odd ones taps at texel centres.
+    const char* boxPixelShaderSource = R"(
+Texture2D shaderTexture : register(t0);
+SamplerState samplerType : register(s0);
+
+cbuffer BoxFilter : register(b2) {
+    float2 texelSize;
+    float factor;
+    float padding;
+};
+
+struct PS_INPUT {
+    float4 pos : SV_POSITION;
+    float2 tex : TEXCOORD0;
+};
+
+float4 main(PS_INPUT input) : SV_TARGET {
+    float step = fmod(factor, 2.0) == 0.0 ? 2.0 : 1.0;
+    int taps = (int)(factor / step);
+    float2 origin = input.tex + texelSize * (step - factor) * 0.5;
+
+    float3 sum = 0.0;
+    [unroll] for (int y = 0; y < 3; ++y) {
+        [unroll] for (int x = 0; x < 3; ++x) {
+            if (x < taps && y < taps) {
+                sum += shaderTexture.SampleLevel(samplerType, origin + texelSize * step * float2(x, y), 0).rgb;
+            }
+        }
+    }
+
+    return float4(ToneMap(sum / (taps * taps)), 1.0);
+}
+)";
+
+    // Magnifier lens: samples the captured texture like the mirror, but only inside the
+    // lens's circle or square, with a thin frame around it
+    const char* lensPixelShaderSource = R"(
+Texture2D shaderTexture : register(t0);
+SamplerState samplerType : register(s0);
+
+cbuffer Lens : register(b0) {
+    float2 centre;
+    float2 halfSize;
+    float border;
+    float circle;
+    float2 padding;
+};
+
+struct PS_INPUT {
+    float4 pos : SV_POSITION;
+    float2 tex : TEXCOORD0;
+};
+
+float4 main(PS_INPUT input) : SV_TARGET {
+    float2 d = (input.tex - centre) / halfSize;
+    float r = circle > 0.5 ? length(d) : max(abs(d.x), abs(d.y));
+    clip(1.0 - r);
+
+    if (r > 1.0 - border) {
+        return float4(0.25, 0.25, 0.25, 1.0);
+    }
+
+    // Beyond the edge of the content
+    if (any(input.tex < 0.0) || any(input.tex > 1.0)) {
+        return float4(0.0, 0.0, 0.0, 1.0);
+    }
+
+    return float4(ToneMap(shaderTexture.Sample(samplerType, input.tex).rgb), 1.0);
+}
+)";
+
+    // Formats the duplication may hand frames over in, most precise first; DXGI converts
+    // the desktop to the last one if it can't supply any without conversion
+    constexpr DXGI_FORMAT DuplicationFormats[] =
+    {
+        DXGI_FORMAT_R16G16B16A16_FLOAT,
+        DXGI_FORMAT_R10G10B10A2_UNORM,
+        DXGI_FORMAT_B8G8R8A8_UNORM
+    };
+
     // Vertex structure for rendering
 
     // ReSharper disable CppDeclaratorNeverUsed
@@ -66,6 +227,176 @@ float4 main(PS_INPUT input) : SV_TARGET {
     };
 
     // ReSharper enable CppDeclaratorNeverUsed
+
+    // Quads in the vertex buffer, four vertices each. The mirror, the magnifier lens and the
+    // cursor move with the view and come first, so they can be rewritten without the rest;
+    // the instructions strip and the full quad in each output rotation for tiled panes never
+    // change and are written once.
+    constexpr UINT MirrorFirstVertex = 0;
+    constexpr UINT LensFirstVertex = 4;
+    constexpr UINT CursorFirstVertex = 8;
+    constexpr UINT DynamicVertexCount = 12;
+    constexpr UINT StripFirstVertex = 12;
+    constexpr UINT PaneFirstVertex = 16;
+    constexpr UINT VertexCount = 32;
+
+    constexpr QuadMapping FullQuad = { -1.0f, 1.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f };
+
+    // Writes the four vertices of mapping, turning the texture coordinates from the output's
+    // orientation to the duplicated image's
+    void SetQuad(Vertex* quad, const QuadMapping& mapping, const OutputRotation rotation)
+    {
+        float texCoords[4][2];
+        RotationTransform::GetCornerTexCoords(mapping, rotation, texCoords);
+
+        const float positions[4][2] =
+        {
+            { mapping.left,  mapping.bottom },  // Bottom left
+            { mapping.left,  mapping.top },     // Top left
+            { mapping.right, mapping.bottom },  // Bottom right
+            { mapping.right, mapping.top }      // Top right
+        };
+
+        for (int n = 0; n < 4; ++n)
+        {
+            quad[n] = { positions[n][0], positions[n][1], 0.0f, 1.0f, texCoords[n][0], texCoords[n][1] };
+        }
+    }
+
+    UINT GetPaneFirstVertex(const OutputRotation rotation)
+    {
+        const int index = rotation == OutputRotation::Unspecified ? 0 : static_cast<int>(rotation) - 1;
+        return PaneFirstVertex + static_cast<UINT>(index) * 4;
+    }
+
+    uint64_t GetBytesPerPixel(const DXGI_FORMAT format)
+    {
+        return format == DXGI_FORMAT_R16G16B16A16_FLOAT ? 8 : 4;
+    }
+
+    bool CompileShader(const std::string& source, const char* target, ID3DBlob** blob)
+    {
+        ID3DBlob* errorBlob = nullptr;
+        const HRESULT hr = D3DCompile(
+            source.c_str(), source.size(),
+            nullptr, nullptr, nullptr,
+            "main", target, 0, 0, blob, &errorBlob);
+
+        if (errorBlob)
+        {
+            errorBlob->Release();
+        }
+
+        return SUCCEEDED(hr);
+    }
+
+    bool CreatePixelShader(ID3D11Device* device, ID3DBlob* blob, ID3D11PixelShader** shader)
+    {
+        return SUCCEEDED(device->CreatePixelShader(blob->GetBufferPointer(), blob->GetBufferSize(), nullptr, shader));
+    }
+
+    // Posted by each startup worker when it's done
+    constexpr UINT StartupMessage = WM_APP + 1;
+
+    bool HasFinished(const std::future<bool>& task)
+    {
+        return task.valid() && task.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    double GetElapsedMs(const LARGE_INTEGER& start, const LARGE_INTEGER& frequency)
+    {
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+        return static_cast<double>(now.QuadPart - start.QuadPart) * 1000.0 / static_cast<double>(frequency.QuadPart);
+    }
+
+    // How often the feed is measured for FeedMonitor
+    constexpr LONGLONG ProbeIntervalMs = 250;
+
+    // A decoded latency pattern further from its present than this got past the CRC by chance
+    constexpr double MaxGlassLatencyMs = 1000.0;
+
+    // Beyond this many changed rects in a frame, copy their bounds in one go
+    constexpr UINT MaxCopyRects = 64;
+
+    // How often video memory usage is checked between the OS's budget notifications
+    constexpr LONGLONG BudgetCheckIntervalMs = 1000;
+
+    // The output's size over the captured texture's at QualityLevel::ReducedCapture. Each
+    // texel is then the exact average of the 2x2 pixels the linear sampler reads.
+    constexpr UINT ReducedCaptureScale = 2;
+
+    PixelRect ToPixelRect(const RECT& rect)
+    {
+        return { rect.left, rect.top, rect.right, rect.bottom };
+    }
+
+    bool FillsViewport(const QuadMapping& mapping)
+    {
+        constexpr float Tolerance = 1e-5f;
+        return std::fabs(mapping.left + 1.0f) < Tolerance && std::fabs(mapping.right - 1.0f) < Tolerance &&
+            std::fabs(mapping.top - 1.0f) < Tolerance && std::fabs(mapping.bottom + 1.0f) < Tolerance;
+    }
+
+    D3D11_RECT ToRect(const PixelRect& rect)
+    {
+        return { rect.left, rect.top, rect.right, rect.bottom };
+    }
+
+    // From the image's pixels to those of a texture captured at 1/scale, rounded outwards
+    PixelRect ScaleDown(const PixelRect& rect, const UINT scale)
+    {
+        const int divisor = static_cast<int>(scale);
+        return {
+            rect.left / divisor, rect.top / divisor,
+            (rect.right + divisor - 1) / divisor, (rect.bottom + divisor - 1) / divisor };
+    }
+
+    D3D11_VIEWPORT ToViewport(const PixelRect& rect)
+    {
+        D3D11_VIEWPORT viewport = {};
+        viewport.TopLeftX = static_cast<FLOAT>(rect.left);
+        viewport.TopLeftY = static_cast<FLOAT>(rect.top);
+        viewport.Width = static_cast<FLOAT>(rect.right - rect.left);
+        viewport.Height = static_cast<FLOAT>(rect.bottom - rect.top);
+        viewport.MinDepth = 0.0f;
+        viewport.MaxDepth = 1.0f;
+        return viewport;
+    }
+
+    PixelRect OffsetPixelRect(const PixelRect& rect, const int dx, const int dy)
+    {
+        return { rect.left + dx, rect.top + dy, rect.right + dx, rect.bottom + dy };
+    }
+
+    double GetProcessCpuSeconds()
+    {
+        FILETIME creationTime;
+        FILETIME exitTime;
+        FILETIME kernelTime;
+        FILETIME userTime;
+        if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+        {
+            return 0.0;
+        }
+
+        ULARGE_INTEGER kernel;
+        kernel.LowPart = kernelTime.dwLowDateTime;
+        kernel.HighPart = kernelTime.dwHighDateTime;
+
+        ULARGE_INTEGER user;
+        user.LowPart = userTime.dwLowDateTime;
+        user.HighPart = userTime.dwHighDateTime;
+
+        // 100ns units
+        return static_cast<double>(kernel.QuadPart + user.QuadPart) / 1.0e7;
+    }
+}
+
+template<typename T>
+static void SafeRelease(T*& ptr)  // NOLINT(misc-use-anonymous-namespace)
+{
+    if (ptr) { ptr->Release(); ptr = nullptr; }
 }
 
 bool DuplicationWindow::LoadDefaultCursor()
@@ -95,8 +426,6 @@ bool DuplicationWindow::LoadDefaultCursor()
     cursorShapeInfo_.HotSpot.x = iconInfo.xHotspot;  // NOLINT(cppcoreguidelines-narrowing-conversions, bugprone-narrowing-conversions)
     cursorShapeInfo_.HotSpot.y = iconInfo.yHotspot;  // NOLINT(bugprone-narrowing-conversions, cppcoreguidelines-narrowing-conversions)
 
-    std::vector<BYTE> cursorPixels(width * height * 4);
-
     const HDC hdcScreen = GetDC(nullptr);
     const HDC hdcMem = CreateCompatibleDC(hdcScreen);
 
@@ -125,19 +454,10 @@ bool DuplicationWindow::LoadDefaultCursor()
 
     // Draw the icon into the 32-bpp bitmap. This correctly handles the alpha channel.
     DrawIconEx(hdcMem, 0, 0, cursor, width, height, 0, nullptr, DI_NORMAL);
+    GdiFlush();
 
-    // Copy the pixel data
-    memcpy(cursorPixels.data(), pPixels, cursorPixels.size());
-
-    // Clean up GDI objects
-    SelectObject(hdcMem, hbmOld);
-    DeleteObject(hbm32);
-    DeleteDC(hdcMem);
-    ReleaseDC(nullptr, hdcScreen);
-    DeleteObject(iconInfo.hbmColor);
-    DeleteObject(iconInfo.hbmMask);
-
-    // Create the texture
+    // Create the texture directly from the DIB section's pixels rather than
+    // copying them into an intermediate heap buffer first
     D3D11_TEXTURE2D_DESC desc = {};
     desc.Width = width;
     desc.Height = height;
@@ -148,17 +468,21 @@ bool DuplicationWindow::LoadDefaultCursor()
     desc.Usage = D3D11_USAGE_DEFAULT;
     desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
 
-    D3D11_SUBRESOURCE_DATA subresourceData = {};
-    subresourceData.pSysMem = cursorPixels.data();
-    subresourceData.SysMemPitch = width * 4;
-
-    HRESULT hr = d3dDevice_->CreateTexture2D(&desc, &subresourceData, &cursorTexture_);
-    if (SUCCEEDED(hr))
+    const bool created = texturePool_.Acquire(desc, &cursorTexture_, &cursorSRV_);
+    if (created)
     {
-        hr = d3dDevice_->CreateShaderResourceView(cursorTexture_, nullptr, &cursorSRV_);
+        d3dContext_->UpdateSubresource(cursorTexture_, 0, nullptr, pPixels, width * 4, 0);
     }
 
-    return SUCCEEDED(hr);
+    // Clean up GDI objects
+    SelectObject(hdcMem, hbmOld);
+    DeleteObject(hbm32);
+    DeleteDC(hdcMem);
+    ReleaseDC(nullptr, hdcScreen);
+    DeleteObject(iconInfo.hbmColor);
+    DeleteObject(iconInfo.hbmMask);
+
+    return created;
 }
 
 const TCHAR* DuplicationWindow::GetWindowClassName()
@@ -171,29 +495,82 @@ DuplicationWindow::DuplicationWindow()
     , hInstance_(nullptr)
     , d3dDevice_(nullptr)
     , d3dContext_(nullptr)
+    , captureDevice_(nullptr)
     , swapChain_(nullptr)
     , renderTargetView_(nullptr)
     , capturedTexture_(nullptr)
+    , capturedDesc_()
     , capturedSRV_(nullptr)
+    , capturedRTV_(nullptr)
+    , captureScale_(1)
+    , imageWidth_(0)
+    , imageHeight_(0)
+    , reducedCaptureSupported_(true)
     , samplerState_(nullptr)
+    , scissorState_(nullptr)
     , duplication_(nullptr)
     , output_(nullptr)
+    , rotation_(OutputRotation::Identity)
     , vertexShader_(nullptr)
     , pixelShader_(nullptr)
     , vertexBuffer_(nullptr)
     , inputLayout_(nullptr)
+    , drawnQuads_()
+    , quadsValid_(false)
+    , lensPixelShader_(nullptr)
+    , lensConstantBuffer_(nullptr)
+    , lensParameters_()
+    , toneMapPixelShader_(nullptr)
+    , toneMapConstantBuffer_(nullptr)
+    , toneMap_({ ColourEncoding::Srgb, ToneMap::DefaultSdrWhiteNits, 0.0f })
+    , toneMapDirty_(true)
+    , outputHdr10_(false)
+    , boxPixelShader_(nullptr)
+    , boxConstantBuffer_(nullptr)
+    , boxParameters_()
+    , copiedRegion_()
+    , awaitingFullFrame_(false)
     , zoomFactor_(1.0f)
     , windowWidth_(0)
     , windowHeight_(0)
+    , dpi_(USER_DEFAULT_SCREEN_DPI)
     , cursorTexture_(nullptr)
     , cursorSRV_(nullptr)
     , blendState_(nullptr)
     , cursorShapeInfo_()
     , cursorPosition_()
     , cursorVisible_(false)
+    , thumbnailFramePresented_(false)
+    , presentedFrame_()
+    , fullRedraw_(true)
+    , startupState_(StartupState::Pending)
+    , shaderBytecode_()
+    , firstFramePresented_(false)
+    , lastStatsReport_(0)
+    , pendingDesktopPresentTime_(0)
+    , journalFrame_(0)
+    , journaledGpuFrames_(0)
+    , frameMoveCount_(0)
+    , frameDirtyCount_(0)
+    , frameMetadataValid_(false)
+    , previousFeedWidth_(0)
+    , previousFeedHeight_(0)
+    , feedDirtyPercent_(0.0)
+    , lastProbe_(0)
+    , mediaShowing_(false)
+    , cropBorders_(false)
+    , lastLatencyStamp_(0)
+    , snapshotRequested_(false)
+    , lastBudgetCheck_(0)
+    , lastFrameStart_(0)
 {
     ZeroMemory(&sourceRect_, sizeof(sourceRect_));
+    ZeroMemory(&latencyPatternRect_, sizeof(latencyPatternRect_));
     ZeroMemory(&targetMonitorRect_, sizeof(targetMonitorRect_));
+    ZeroMemory(&captureWindowRect_, sizeof(captureWindowRect_));
+    ZeroMemory(&renderAdapterLuid_, sizeof(renderAdapterLuid_));
+    ZeroMemory(&captureAdapterLuid_, sizeof(captureAdapterLuid_));
+    QueryPerformanceFrequency(&qpcFrequency_);
 }
 
 DuplicationWindow::~DuplicationWindow()
@@ -205,7 +582,8 @@ bool DuplicationWindow::Create(
     const HWND parent, 
     const HINSTANCE instance,
     const int x, const int y, const int width, const int height, 
-    const char* targetMonitorName)
+    const char* targetMonitorName,
+    const std::vector<std::string>& paneMonitorNames)
 {
     Destroy();
 
@@ -243,21 +621,152 @@ bool DuplicationWindow::Create(
         return false;
     }
 
-    if (!InitializeDX()) 
+    // The slow parts of startup run on two worker threads while the window shows a
+    // placeholder: device creation then duplication on one, shader compilation on the
+    // other. Each posts StartupMessage when done and FinishStartup takes over from there.
+    const HMONITOR monitor = MonitorFromWindow(windowHandle_, MONITOR_DEFAULTTOPRIMARY);
+    deviceTask_ = std::async(std::launch::async, [this, monitor, paneMonitorNames]
+    {
+        const bool created = InitializeCapture(monitor, paneMonitorNames);
+        PostMessage(windowHandle_, StartupMessage, 0, 0);
+        return created;
+    });
+
+    shaderTask_ = std::async(std::launch::async, [this]
+    {
+        LARGE_INTEGER start;
+        QueryPerformanceCounter(&start);
+
+        const bool compiled = CompileShaders();
+        Metrics::Write("startup.shaders_ms", GetElapsedMs(start, qpcFrequency_));
+
+        PostMessage(windowHandle_, StartupMessage, 0, 0);
+        return compiled;
+    });
+
+    return true;
+}
+
+bool DuplicationWindow::IsReady() const
+{
+    return startupState_ == StartupState::Ready;
+}
+
+bool DuplicationWindow::InitializeCapture(const HMONITOR monitor, const std::vector<std::string>& paneMonitorNames)
+{
+    LARGE_INTEGER start;
+    QueryPerformanceCounter(&start);
+
+    if (!CreateDevice(monitor))
     {
         return false;
     }
 
-    if (!InitializeDuplication()) 
+    Metrics::Write("startup.device_ms", GetElapsedMs(start, qpcFrequency_));
+
+    // Without a duplication the mirror can still show a thumbnail or a captured window
+    if (!InitializeDuplication())
     {
-        return false;
+        Metrics::Event("capture.duplication", "could not duplicate the target");
+    }
+
+    // Tiled mode: the other media monitors beside the target, adopted by FinishStartup
+    for (const std::string& paneMonitorName : paneMonitorNames)
+    {
+        auto pane = CreatePane(paneMonitorName.c_str());
+        if (pane)
+        {
+            startupPanes_.push_back(std::move(pane));
+        }
     }
 
+    Metrics::Write("startup.device_and_duplication_ms", GetElapsedMs(start, qpcFrequency_));
     return true;
 }
 
+void DuplicationWindow::FinishStartup()
+{
+    if (startupState_ != StartupState::Pending || !HasFinished(deviceTask_) || !HasFinished(shaderTask_))
+    {
+        return;
+    }
+
+    const bool deviceCreated = deviceTask_.get();
+    const bool shadersCompiled = shaderTask_.get();
+    const bool initialized = deviceCreated && shadersCompiled && InitializeDX();
+    ReleaseShaderBytecode();
+
+    if (!initialized)
+    {
+        startupState_ = StartupState::Failed;
+        Metrics::Event("startup.failed",
+            !deviceCreated ? "could not create the device" :
+            !shadersCompiled ? "could not compile the shaders" : "could not create the swap chain");
+        InvalidateRect(windowHandle_, nullptr, FALSE);
+        return;
+    }
+
+    panes_ = std::move(startupPanes_);
+    startupPanes_.clear();
+    startupState_ = StartupState::Ready;
+
+    // The first frame replaces the placeholder from the next paint on
+    InvalidateRect(windowHandle_, nullptr, FALSE);
+}
+
+void DuplicationWindow::WaitForStartup()
+{
+    if (deviceTask_.valid())
+    {
+        deviceTask_.wait();
+    }
+
+    if (shaderTask_.valid())
+    {
+        shaderTask_.wait();
+    }
+}
+
+void DuplicationWindow::PaintPlaceholder(const HDC dc) const
+{
+    // Shown until the device is ready: the mirror's black background and a line of text
+    constexpr int fontPointSize = 12;
+
+    RECT clientRect;
+    GetClientRect(windowHandle_, &clientRect);
+    FillRect(dc, &clientRect, static_cast<HBRUSH>(GetStockObject(BLACK_BRUSH)));
+
+    const HFONT font = CreateFont(
+        -MulDiv(fontPointSize, static_cast<int>(dpi_), 72), 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE,
+        ANSI_CHARSET, OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS,
+        DEFAULT_QUALITY, DEFAULT_PITCH, TEXT("Segoe UI"));
+
+    const HGDIOBJ previousFont = SelectObject(dc, font ? font : GetStockObject(DEFAULT_GUI_FONT));
+    SetBkMode(dc, TRANSPARENT);
+    SetTextColor(dc, RGB(160, 160, 160));
+
+    const TCHAR* text = startupState_ == StartupState::Failed ?
+        TEXT("The mirror could not be started") : TEXT("Starting the mirror...");
+    DrawText(dc, text, -1, &clientRect, DT_CENTER | DT_VCENTER | DT_SINGLELINE);
+
+    SelectObject(dc, previousFont);
+    if (font)
+    {
+        DeleteObject(font);
+    }
+}
+
 void DuplicationWindow::Destroy()
 {
+    // The workers write to this object's members
+    WaitForStartup();
+    deviceTask_ = std::future<bool>();
+    shaderTask_ = std::future<bool>();
+    ReleaseShaderBytecode();
+    startupPanes_.clear();
+    startupState_ = StartupState::Pending;
+
+    panes_.clear();
     CleanupDuplication();
     CleanupDX();
 
@@ -276,9 +785,55 @@ HWND DuplicationWindow::GetWindowHandle() const
 void DuplicationWindow::SetSourceRect(const RECT& rect)
 {
     sourceRect_ = rect;
+    ApplySourceRect();
+}
+
+void DuplicationWindow::ApplySourceRect()
+{
+    // Only the part on the target monitor can be mirrored
+    RECT source = sourceRect_;
+    if (!IsRectEmpty(&targetMonitorRect_) && !IntersectRect(&source, &sourceRect_, &targetMonitorRect_))
+    {
+        source = targetMonitorRect_;
+    }
+
+    // and, when cropping, only the content between the borders
+    PixelRect viewSource = ToPixelRect(source);
+    PixelRect cropped;
+    if (cropBorders_ && stats_.mode != MirrorMode::WindowCapture && borders_.HasBorders() && capturedTexture_ &&
+        ViewTransform::Intersect(
+            viewSource, GetDesktopRect(borders_.GetContent(), imageWidth_, imageHeight_), cropped))
+    {
+        viewSource = cropped;
+    }
+
+    view_.SetSource(viewSource);
+}
 
-    // Store the target monitor rect for mouse coordinate conversion
-    targetMonitorRect_ = rect;    
+void DuplicationWindow::SetTargetMonitorRect(const RECT& rect)
+{
+    targetMonitorRect_ = rect;
+}
+
+ViewTransform& DuplicationWindow::GetView()
+{
+    return view_;
+}
+
+MagnifierLens& DuplicationWindow::GetLens()
+{
+    return lens_;
+}
+
+const MagnifierLens& DuplicationWindow::GetLens() const
+{
+    return lens_;
+}
+
+bool DuplicationWindow::ShowActualSize()
+{
+    // The host window is sized at zoomFactor_ mirror pixels per source pixel
+    return zoomFactor_ > 0.0f && view_.SetZoom(1.0 / zoomFactor_);
 }
 
 bool DuplicationWindow::SetTransform(const float zoomFactor)
@@ -297,29 +852,387 @@ void DuplicationWindow::Resize(const int x, const int y, const int width, const
 
 bool DuplicationWindow::UpdateFrame()
 {
-    // Try to capture a new frame (may reuse existing if no new frame available)
-    const bool hasCapturedContent = CaptureFrame();
+    if (!IsReady())
+    {
+        return false;
+    }
 
-    // Always try to render if we have content, regardless of timing
-    if (hasCapturedContent) 
+    UpdateMemoryBudget();
+
+    const MirrorMode mode = stats_.mode;
+    const bool thumbnailMode = mode == MirrorMode::Thumbnail;
+    if (thumbnailMode && thumbnailFramePresented_)
     {
-        return RenderFrame();
+        // DWM is composing the mirror and the instructions strip is already on screen. The
+        // duplication is still acquired at the probe rate so that the feed is checked.
+        if (IsProbeDue())
+        {
+            CaptureFrame();
+            pendingDesktopPresentTime_ = 0;
+            ProbeFeed();
+        }
+
+        gpuTimer_.Collect(d3dContext_, stats_);
+        UpdateSnapshot();
+        ReportStats();
+        return true;
     }
 
-    return false;
-}
+    // Under the most video memory pressure frames are captured and drawn at a reduced rate;
+    // the duplications accumulate the changes in between
+    LARGE_INTEGER frameStart;
+    QueryPerformanceCounter(&frameStart);
+    if (memoryBudget_.GetLevel() >= QualityLevel::ReducedRate && !thumbnailMode &&
+        static_cast<double>(frameStart.QuadPart - lastFrameStart_) * MemoryBudget::ReducedFrameRate <
+        static_cast<double>(qpcFrequency_.QuadPart))
+    {
+        UpdateSnapshot();
+        ReportStats();
+        return false;
+    }
 
-// ReSharper disable once CppInconsistentNaming
-bool DuplicationWindow::InitializeDX()
-{
-    // Create D3D11 device and context
-    D3D_FEATURE_LEVEL featureLevel;
+    lastFrameStart_ = frameStart.QuadPart;
+    gpuTimer_.BeginFrame(d3dContext_);
 
-    HRESULT hr = D3D11CreateDevice(
-        nullptr,
-        D3D_DRIVER_TYPE_HARDWARE,
+    // Try to capture a new frame (may reuse existing if no new frame available). In
+    // thumbnail mode nothing is captured; we just present the instructions strip once.
+    bool hasCapturedContent =
+        thumbnailMode || (mode == MirrorMode::WindowCapture ? CaptureWindowFrame() : CaptureFrame());
+
+    // Each pane acquires from its own duplication, whether or not the others have a frame
+    for (const auto& pane : panes_)
+    {
+        hasCapturedContent = pane->Update(d3dContext_, stats_) || hasCapturedContent;
+    }
+
+    if (IsProbeDue())
+    {
+        ProbeFeed();
+    }
+
+    // Always try to render if we have content, regardless of timing
+    bool rendered = false;
+    if (hasCapturedContent) 
+    {
+        LARGE_INTEGER renderStart, renderEnd;
+        QueryPerformanceCounter(&renderStart);
+        rendered = RenderFrame();
+        QueryPerformanceCounter(&renderEnd);
+        thumbnailFramePresented_ = thumbnailMode && rendered;
+
+        const UINT calls = renderState_.TakeCallCount();
+        const double cpuUs =
+            static_cast<double>(renderEnd.QuadPart - renderStart.QuadPart) * 1.0e6 /
+            static_cast<double>(qpcFrequency_.QuadPart);
+
+        stats_.renderCalls.Add(static_cast<double>(calls));
+        stats_.renderCpuUs.Add(cpuUs);
+        FrameJournal::Record(JournalEvent::Render, journalFrame_, 0, calls, static_cast<float>(cpuUs));
+    }
+
+    gpuTimer_.EndFrame(d3dContext_);
+    gpuTimer_.Collect(d3dContext_, stats_);
+
+    if (stats_.gpuFramesTimed != journaledGpuFrames_)
+    {
+        journaledGpuFrames_ = stats_.gpuFramesTimed;
+        FrameJournal::Record(
+            JournalEvent::GpuFrame, journalFrame_, 0, 0,
+            static_cast<float>(stats_.gpuStageMs[static_cast<int>(GpuStage::Copy)].Last()),
+            static_cast<float>(stats_.gpuStageMs[static_cast<int>(GpuStage::Draw)].Last()));
+    }
+
+    ReadLatencyPattern();
+    UpdateSnapshot();
+    ReportStats();
+
+    return rendered;
+}
+
+const MirrorStats& DuplicationWindow::GetStats() const
+{
+    return stats_;
+}
+
+void DuplicationWindow::SetMode(const MirrorMode mode)
+{
+    if (mode == stats_.mode)
+    {
+        return;
+    }
+
+    const MirrorMode previousMode = stats_.mode;
+    stats_.mode = mode;
+    thumbnailFramePresented_ = false;
+
+    // The captured texture holds either the output or the window, never both
+    if (previousMode == MirrorMode::WindowCapture)
+    {
+        windowCapture_.Stop();
+        ReleaseCapturedTexture();
+    }
+    else if (mode == MirrorMode::WindowCapture)
+    {
+        ReleaseCapturedTexture();
+    }
+
+    // Duplication only reports changes since its last acquire, so if there's no texture
+    // to carry on from, start it afresh to get a complete first frame
+    if (mode == MirrorMode::Duplication && !capturedTexture_ && duplication_)
+    {
+        CleanupDuplication();
+        InitializeDuplication();
+    }
+
+    FrameJournal::Record(JournalEvent::Mode, journalFrame_, 0, static_cast<uint32_t>(mode), 0.0f);
+    Metrics::Event("mirror.mode", MirrorStats::GetModeName(mode));
+}
+
+bool DuplicationWindow::SetCaptureWindow(const HWND window)
+{
+    if (!IsReady())
+    {
+        return false;
+    }
+
+    if (windowCapture_.GetWindow() == window)
+    {
+        return true;
+    }
+
+    return windowCapture_.Start(d3dDevice_, window);
+}
+
+MirrorMode DuplicationWindow::GetMode() const
+{
+    return stats_.mode;
+}
+
+int DuplicationWindow::GetInstructionsHeight() const
+{
+    return instructions_.GetHeight();
+}
+
+void DuplicationWindow::ToggleHud()
+{
+    hud_.ToggleVisible();
+}
+
+void DuplicationWindow::ToggleBorderCrop()
+{
+    cropBorders_ = !cropBorders_;
+    ApplySourceRect();
+
+    Metrics::Event("borders.crop", cropBorders_ ? "on" : "off");
+}
+
+void DuplicationWindow::SetInstructionsHotKey(const TCHAR hotKey)
+{
+    instructions_.SetHotKey(hotKey);
+    fullRedraw_ = true;
+}
+
+void DuplicationWindow::SetDpi(const UINT dpi)
+{
+    dpi_ = dpi;
+
+    // Overlays are sized in physical pixels so scale them to stay the same apparent size
+    const int margin = MulDiv(8, static_cast<int>(dpi_), USER_DEFAULT_SCREEN_DPI);
+    const int hudScale = MulDiv(2, static_cast<int>(dpi_), USER_DEFAULT_SCREEN_DPI);
+    hud_.SetPosition(margin, margin, hudScale);
+
+    if (IsReady())
+    {
+        instructions_.SetDpi(dpi_);
+    }
+
+    thumbnailFramePresented_ = false;
+    fullRedraw_ = true;
+}
+
+void DuplicationWindow::SetMediaShowing(const bool showing)
+{
+    mediaShowing_ = showing;
+}
+
+FeedAlert DuplicationWindow::GetFeedAlert() const
+{
+    return feedMonitor_.GetAlert();
+}
+
+void DuplicationWindow::SetLatencyPattern(const RECT& rect)
+{
+    // Each calibration run starts its own distribution
+    latencyPatternRect_ = rect;
+    lastLatencyStamp_ = 0;
+    stats_.glassLatencyMs.Clear();
+    stats_.glassLatencyMisreads = 0;
+
+    Metrics::Event("latency.calibration", IsRectEmpty(&rect) ? "off" : "on");
+}
+
+void DuplicationWindow::TakeSnapshot()
+{
+    snapshotRequested_ = true;
+}
+
+bool DuplicationWindow::Rebind(
+    const char* targetMonitorName, const RECT& targetMonitorRect, const std::vector<std::string>& paneMonitorNames)
+{
+    // The device, swap chain and shaders are kept; only what depends on the outputs is
+    // rebuilt. The captured texture is kept too, so the last frame stays up until the new
+    // duplication delivers its first (complete) frame.
+    WaitForStartup();
+    FinishStartup();
+    if (!IsReady())
+    {
+        return false;
+    }
+
+    panes_.clear();
+    CleanupDuplication();
+    copiedRegion_ = PixelRect();
+    awaitingFullFrame_ = false;
+    cursorVisible_ = false;
+    fullRedraw_ = true;
+
+    targetMonitorName_ = targetMonitorName ? targetMonitorName : "";
+    SetTargetMonitorRect(targetMonitorRect);
+    SetSourceRect(targetMonitorRect);
+
+    for (const std::string& paneMonitorName : paneMonitorNames)
+    {
+        AddPane(paneMonitorName.c_str());
+    }
+
+    return InitializeDuplication();
+}
+
+bool DuplicationWindow::AddPane(const char* monitorName)
+{
+    if (!IsReady())
+    {
+        return false;
+    }
+
+    auto pane = CreatePane(monitorName);
+    if (!pane)
+    {
+        return false;
+    }
+
+    panes_.push_back(std::move(pane));
+    return true;
+}
+
+std::unique_ptr<DuplicationPane> DuplicationWindow::CreatePane(const char* monitorName) const
+{
+    auto pane = std::make_unique<DuplicationPane>();
+    if (!pane->Create(d3dDevice_, monitorName))
+    {
+        Metrics::Event("mirror.pane", "could not duplicate a tiled monitor");
+        return nullptr;
+    }
+
+    Metrics::Event("mirror.pane", monitorName);
+    return pane;
+}
+
+bool DuplicationWindow::IsTiled() const
+{
+    return !panes_.empty();
+}
+
+PixelRect DuplicationWindow::GetPrimaryTile() const
+{
+    std::vector<PixelRect> sources;
+    std::vector<PixelRect> tiles;
+    ArrangeTiles(sources, tiles);
+    return tiles.front();
+}
+
+void DuplicationWindow::ArrangeTiles(std::vector<PixelRect>& sources, std::vector<PixelRect>& tiles) const
+{
+    const PixelRect area = { 0, 0, windowWidth_, windowHeight_ - instructions_.GetHeight() };
+    if (panes_.empty())
+    {
+        // A single target, letterboxed or pillarboxed if the window's shape doesn't match it
+        const PixelRect& source = view_.GetSource();
+        const PixelRect tile = MirrorLayout::Fit(source.right - source.left, source.bottom - source.top, area);
+        tiles.assign(1, ViewTransform::IsEmpty(tile) ? area : tile);
+        return;
+    }
+
+    sources.clear();
+    sources.push_back(ToPixelRect(targetMonitorRect_));
+    for (const auto& pane : panes_)
+    {
+        sources.push_back(ToPixelRect(pane->GetMonitorRect()));
+    }
+
+    if (!TileLayout::Arrange(sources, area, tiles))
+    {
+        tiles.assign(sources.size(), PixelRect());
+    }
+}
+
+void DuplicationWindow::ReportStats()
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+
+    const LONGLONG elapsed = now.QuadPart - lastStatsReport_;
+    if (elapsed < qpcFrequency_.QuadPart)
+    {
+        return;
+    }
+
+    if (lastStatsReport_ != 0)
+    {
+        stats_.UpdateRates(
+            static_cast<double>(elapsed) / static_cast<double>(qpcFrequency_.QuadPart),
+            GetProcessCpuSeconds());
+    }
+
+    lastStatsReport_ = now.QuadPart;
+
+    const TexturePoolStats poolStats = texturePool_.GetStats();
+    stats_.poolBytesInUse = poolStats.bytesInUse;
+    stats_.poolBytesIdle = poolStats.bytesIdle;
+    stats_.poolCreated = poolStats.created;
+    stats_.poolReused = poolStats.reused;
+    stats_.poolEvicted = poolStats.evicted;
+
+    char hudText[256];
+    if (stats_.FormatHud(hudText, sizeof(hudText)) > 0)
+    {
+        hud_.SetText(hudText);
+    }
+
+    char line[1024];
+    if (stats_.Format(line, sizeof(line)) > 0)
+    {
+        OutputDebugStringA("OnlyMMirror stats ");
+        OutputDebugStringA(line);
+        OutputDebugStringA("\n");
+    }
+
+    Metrics::Export(stats_);
+}
+
+bool DuplicationWindow::CreateDevice(const HMONITOR monitor)
+{
+    // Render on the adapter driving the monitor the mirror is shown on, so that presenting
+    // doesn't cross adapters. The duplication gets its own device if the target is elsewhere.
+    IDXGIAdapter1* renderAdapter = DisplayAdapters::FindAdapterForMonitor(monitor);
+
+    // BGRA support is needed by Windows.Graphics.Capture
+    D3D_FEATURE_LEVEL featureLevel;
+    const HRESULT hr = D3D11CreateDevice(
+        renderAdapter,
+        renderAdapter ? D3D_DRIVER_TYPE_UNKNOWN : D3D_DRIVER_TYPE_HARDWARE,
         nullptr,
-        0,
+        D3D11_CREATE_DEVICE_BGRA_SUPPORT,
         nullptr,
         0,
         D3D11_SDK_VERSION,
@@ -327,27 +1240,50 @@ bool DuplicationWindow::InitializeDX()
         &featureLevel,
         &d3dContext_);
 
-    if (FAILED(hr))
-    {
-        return false;
-    }
+    SafeRelease(renderAdapter);
 
-    // Create swap chain
-    DXGI_SWAP_CHAIN_DESC swapChainDesc = {};
-    swapChainDesc.BufferCount = 1;
-    swapChainDesc.BufferDesc.Width = windowWidth_;
-    swapChainDesc.BufferDesc.Height = windowHeight_;
-    swapChainDesc.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-    swapChainDesc.BufferDesc.RefreshRate.Numerator = 60;
-    swapChainDesc.BufferDesc.RefreshRate.Denominator = 1;
-    swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-    swapChainDesc.OutputWindow = windowHandle_;
+    return SUCCEEDED(hr) && DisplayAdapters::GetDeviceAdapterLuid(d3dDevice_, renderAdapterLuid_);
+}
+
+bool DuplicationWindow::CompileShaders()
+{
+    // The tone-mapping, box filter and lens pixel shaders all include the tone-mapping functions
+    return CompileShader(vertexShaderSource, "vs_4_0", &shaderBytecode_.vertex) &&
+        CompileShader(pixelShaderSource, "ps_4_0", &shaderBytecode_.mirror) &&
+        CompileShader(std::string(toneMapShaderSource) + toneMapPixelShaderSource, "ps_4_0", &shaderBytecode_.toneMap) &&
+        CompileShader(std::string(toneMapShaderSource) + boxPixelShaderSource, "ps_4_0", &shaderBytecode_.box) &&
+        CompileShader(std::string(toneMapShaderSource) + lensPixelShaderSource, "ps_4_0", &shaderBytecode_.lens);
+}
+
+void DuplicationWindow::ReleaseShaderBytecode()
+{
+    SafeRelease(shaderBytecode_.vertex);
+    SafeRelease(shaderBytecode_.mirror);
+    SafeRelease(shaderBytecode_.toneMap);
+    SafeRelease(shaderBytecode_.box);
+    SafeRelease(shaderBytecode_.lens);
+}
+
+// ReSharper disable once CppInconsistentNaming
+bool DuplicationWindow::InitializeDX()
+{
+    // The device and shader bytecode come from the startup workers; the rest is created
+    // here, on the window's thread
+
+    // Create swap chain. The sequential effect keeps the back buffer's contents after a
+    // present, so a frame only has to redraw, and present, the parts that changed.
+    DXGI_SWAP_CHAIN_DESC1 swapChainDesc = {};
+    swapChainDesc.Width = static_cast<UINT>(windowWidth_);
+    swapChainDesc.Height = static_cast<UINT>(windowHeight_);
+    swapChainDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
     swapChainDesc.SampleDesc.Count = 1;
     swapChainDesc.SampleDesc.Quality = 0;
-    swapChainDesc.Windowed = TRUE;
+    swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+    swapChainDesc.BufferCount = 1;
+    swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_SEQUENTIAL;
 
     IDXGIDevice* dxgiDevice = nullptr;
-    hr = d3dDevice_->QueryInterface(__uuidof(IDXGIDevice), reinterpret_cast<void**>(&dxgiDevice));  // NOLINT(clang-diagnostic-language-extension-token)
+    HRESULT hr = d3dDevice_->QueryInterface(__uuidof(IDXGIDevice), reinterpret_cast<void**>(&dxgiDevice));  // NOLINT(clang-diagnostic-language-extension-token)
     if (FAILED(hr))
     {
         return false;
@@ -361,21 +1297,23 @@ bool DuplicationWindow::InitializeDX()
         return false;
     }
 
-    IDXGIFactory* dxgiFactory = nullptr;
-    hr = dxgiAdapter->GetParent(__uuidof(IDXGIFactory), reinterpret_cast<void**>(&dxgiFactory));  // NOLINT(clang-diagnostic-language-extension-token)
+    IDXGIFactory2* dxgiFactory = nullptr;
+    hr = dxgiAdapter->GetParent(__uuidof(IDXGIFactory2), reinterpret_cast<void**>(&dxgiFactory));  // NOLINT(clang-diagnostic-language-extension-token)
     dxgiAdapter->Release();
     if (FAILED(hr))
     {
         return false;
     }
 
-    hr = dxgiFactory->CreateSwapChain(d3dDevice_, &swapChainDesc, &swapChain_);
+    hr = dxgiFactory->CreateSwapChainForHwnd(d3dDevice_, windowHandle_, &swapChainDesc, nullptr, nullptr, &swapChain_);
     dxgiFactory->Release();
     if (FAILED(hr))
     {
         return false;
     }
 
+    fullRedraw_ = true;
+
     // Create render target view
     ID3D11Texture2D* backBuffer = nullptr;
     hr = swapChain_->GetBuffer(0, __uuidof(ID3D11Texture2D), reinterpret_cast<void**>(&backBuffer));  // NOLINT(clang-diagnostic-language-extension-token)
@@ -391,31 +1329,12 @@ bool DuplicationWindow::InitializeDX()
         return false;
     }
 
-    // Compile and create shaders
-    ID3DBlob* vsBlob = nullptr;
-    ID3DBlob* errorBlob = nullptr;
-    hr = D3DCompile(
-        vertexShaderSource,
-        strlen(vertexShaderSource),
-        nullptr, nullptr, nullptr,
-        "main", "vs_4_0", 0, 0, &vsBlob, &errorBlob);
-
-    if (FAILED(hr))
-    {
-        if (errorBlob)
-        {
-            errorBlob->Release();
-        }
-
-        return false;
-    }
-
+    // Create shaders from the bytecode compiled at startup
     hr = d3dDevice_->CreateVertexShader(
-        vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), nullptr, &vertexShader_);
+        shaderBytecode_.vertex->GetBufferPointer(), shaderBytecode_.vertex->GetBufferSize(), nullptr, &vertexShader_);
 
     if (FAILED(hr))
     {
-        vsBlob->Release();
         return false;
     }
 
@@ -427,56 +1346,73 @@ bool DuplicationWindow::InitializeDX()
     };
 
     hr = d3dDevice_->CreateInputLayout(
-        layout, 2, vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), &inputLayout_);
-
-    vsBlob->Release();
+        layout, 2, shaderBytecode_.vertex->GetBufferPointer(), shaderBytecode_.vertex->GetBufferSize(), &inputLayout_);
 
     if (FAILED(hr))
     {
         return false;
     }
 
-    // Compile pixel shader
-    ID3DBlob* psBlob = nullptr;
-    hr = D3DCompile(
-        pixelShaderSource, strlen(pixelShaderSource),
-        nullptr, nullptr, nullptr,
-        "main", "ps_4_0", 0, 0, &psBlob, &errorBlob);
+    if (!CreatePixelShader(d3dDevice_, shaderBytecode_.mirror, &pixelShader_) ||
+        !CreatePixelShader(d3dDevice_, shaderBytecode_.toneMap, &toneMapPixelShader_) ||
+        !CreatePixelShader(d3dDevice_, shaderBytecode_.box, &boxPixelShader_) ||
+        !CreatePixelShader(d3dDevice_, shaderBytecode_.lens, &lensPixelShader_))
+    {
+        return false;
+    }
+
+    D3D11_BUFFER_DESC boxBufferDesc = {};
+    boxBufferDesc.ByteWidth = sizeof(BoxFilterParameters);
+    boxBufferDesc.Usage = D3D11_USAGE_DEFAULT;
+    boxBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
 
+    hr = d3dDevice_->CreateBuffer(&boxBufferDesc, nullptr, &boxConstantBuffer_);
     if (FAILED(hr))
     {
-        if (errorBlob)
-        {
-            errorBlob->Release();
-        }
+        return false;
+    }
+
+    boxParameters_ = BoxFilterParameters();
 
+    D3D11_BUFFER_DESC toneMapBufferDesc = {};
+    toneMapBufferDesc.ByteWidth = sizeof(ToneMapConstants);
+    toneMapBufferDesc.Usage = D3D11_USAGE_DEFAULT;
+    toneMapBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+
+    hr = d3dDevice_->CreateBuffer(&toneMapBufferDesc, nullptr, &toneMapConstantBuffer_);
+    if (FAILED(hr))
+    {
         return false;
     }
 
-    hr = d3dDevice_->CreatePixelShader(
-        psBlob->GetBufferPointer(), psBlob->GetBufferSize(), nullptr, &pixelShader_);
+    toneMapDirty_ = true;
+    lensParameters_ = LensParameters();
 
-    psBlob->Release();
+    D3D11_BUFFER_DESC lensBufferDesc = {};
+    lensBufferDesc.ByteWidth = sizeof(LensParameters);
+    lensBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+    lensBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+    lensBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
 
+    hr = d3dDevice_->CreateBuffer(&lensBufferDesc, nullptr, &lensConstantBuffer_);
     if (FAILED(hr))
     {
         return false;
     }
 
-    // Create vertex buffer
-    constexpr Vertex vertices[] =
+    // Create vertex buffer for the quads with the fixed ones in place; RenderFrame updates
+    // the others when they move
+    Vertex vertices[VertexCount] = {};
+    SetQuad(vertices + StripFirstVertex, FullQuad, OutputRotation::Identity);
+    for (int n = 0; n < 4; ++n)
     {
-        { -1.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f },  // Bottom left
-        { -1.0f,  1.0f, 0.0f, 1.0f, 0.0f, 0.0f },  // Top left
-        {  1.0f, -1.0f, 0.0f, 1.0f, 1.0f, 1.0f },  // Bottom right
-        {  1.0f,  1.0f, 0.0f, 1.0f, 1.0f, 0.0f }   // Top right
-    };
+        SetQuad(vertices + PaneFirstVertex + n * 4, FullQuad, static_cast<OutputRotation>(n + 1));
+    }
 
     D3D11_BUFFER_DESC bufferDesc = {};
     bufferDesc.ByteWidth = sizeof(vertices);
-    bufferDesc.Usage = D3D11_USAGE_DYNAMIC;  // Changed to DYNAMIC for updates
+    bufferDesc.Usage = D3D11_USAGE_DEFAULT;
     bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-    bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;  // Allow CPU write access
 
     D3D11_SUBRESOURCE_DATA initData = {};
     initData.pSysMem = vertices;
@@ -487,6 +1423,8 @@ bool DuplicationWindow::InitializeDX()
         return false;
     }
 
+    quadsValid_ = false;
+
     // Create high-quality sampler state
     D3D11_SAMPLER_DESC samplerDesc = {};
     samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;  // High-quality linear filtering
@@ -505,6 +1443,19 @@ bool DuplicationWindow::InitializeDX()
         return false;
     }
 
+    // The default rasterizer state, but scissored to the part of the frame being redrawn
+    D3D11_RASTERIZER_DESC rasterizerDesc = {};
+    rasterizerDesc.FillMode = D3D11_FILL_SOLID;
+    rasterizerDesc.CullMode = D3D11_CULL_BACK;
+    rasterizerDesc.DepthClipEnable = TRUE;
+    rasterizerDesc.ScissorEnable = TRUE;
+
+    hr = d3dDevice_->CreateRasterizerState(&rasterizerDesc, &scissorState_);
+    if (FAILED(hr))
+    {
+        return false;
+    }
+
     // Create blend state for cursor
     D3D11_BLEND_DESC blendDesc = {};
     blendDesc.RenderTarget[0].BlendEnable = TRUE;
@@ -522,34 +1473,73 @@ bool DuplicationWindow::InitializeDX()
         return false;
     }
 
+    if (!texturePool_.Create(d3dDevice_))
+    {
+        return false;
+    }
+
     // Load the default cursor texture
     if (!LoadDefaultCursor())
     {
         return false;
     }
 
-    return true;
-}
+    if (!instructions_.Create(d3dDevice_, dpi_))
+    {
+        return false;
+    }
 
-template<typename T>
-static void SafeRelease(T*& ptr)  // NOLINT(misc-use-anonymous-namespace)
-{
-    if (ptr) { ptr->Release(); ptr = nullptr; }
+    // GPU timing, the HUD and the feed checks are diagnostic only, so failure isn't fatal
+    gpuTimer_.Create(d3dDevice_);
+    hud_.Create(d3dDevice_);
+    probe_.Create(&texturePool_);
+    alert_.Create(d3dDevice_);
+    latencyReader_.Create(&texturePool_);
+    snapshot_.Create(&texturePool_);
+
+    // Without a budget to go by the quality stays full
+    videoMemory_.Create(d3dDevice_);
+    memoryBudget_.Reset();
+
+    constexpr float alertForeground[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    constexpr float alertBackground[4] = { 0.75f, 0.0f, 0.0f, 0.85f };
+    alert_.SetColors(alertForeground, alertBackground);
+    SetDpi(dpi_);
+
+    renderState_.Attach(d3dContext_);
+    return true;
 }
 
 // ReSharper disable once CppInconsistentNaming
 void DuplicationWindow::CleanupDX()
 {
+    windowCapture_.Stop();
+    ReleaseCaptureDevice();
+    renderState_.Detach();
+    hud_.Destroy();
+    alert_.Destroy();
+    probe_.Destroy();
+    latencyReader_.Destroy();
+    snapshot_.Destroy();
+    videoMemory_.Destroy();
+    instructions_.Destroy();
+    gpuTimer_.Destroy();
     SafeRelease(blendState_);
-    SafeRelease(cursorSRV_);
-    SafeRelease(cursorTexture_);
+    texturePool_.Recycle(cursorTexture_, cursorSRV_);
     SafeRelease(samplerState_);
+    SafeRelease(scissorState_);
     SafeRelease(vertexBuffer_);
     SafeRelease(inputLayout_);
+    SafeRelease(boxConstantBuffer_);
+    SafeRelease(boxPixelShader_);
+    SafeRelease(toneMapConstantBuffer_);
+    SafeRelease(toneMapPixelShader_);
+    SafeRelease(lensConstantBuffer_);
+    SafeRelease(lensPixelShader_);
     SafeRelease(pixelShader_);
     SafeRelease(vertexShader_);
-    SafeRelease(capturedSRV_);
-    SafeRelease(capturedTexture_);
+    ReleaseCapturedTexture();
+    texturePool_.Destroy();
     SafeRelease(renderTargetView_);
     SafeRelease(swapChain_);
     SafeRelease(d3dContext_);
@@ -558,99 +1548,117 @@ void DuplicationWindow::CleanupDX()
 
 bool DuplicationWindow::InitializeDuplication()
 {
-    // Get DXGI adapter
-    IDXGIDevice* dxgiDevice = nullptr;
-    HRESULT hr = d3dDevice_->QueryInterface(__uuidof(IDXGIDevice), reinterpret_cast<void**>(&dxgiDevice));  // NOLINT(clang-diagnostic-language-extension-token)
-    if (FAILED(hr)) 
+    // Find the target output, on whichever adapter drives it
+    IDXGIAdapter1* adapter = nullptr;
+    if (!FindTargetOutput(&adapter)) 
     {
         return false;
     }
 
-    IDXGIAdapter* adapter = nullptr;
-    hr = dxgiDevice->GetAdapter(&adapter);
-    dxgiDevice->Release();
-    if (FAILED(hr)) 
+    // Duplication has to use a device on the output's own adapter
+    const bool haveDevice = EnsureCaptureDevice(adapter);
+    adapter->Release();
+    if (!haveDevice)
     {
         return false;
     }
 
-    // Find the target output instead of always using the primary
-    if (!FindTargetOutput()) 
+    // Create desktop duplication, taking HDR and FP16 desktops as they are rather than
+    // having DXGI convert them to 8-bit
+    const HRESULT hr = DisplayAdapters::DuplicateOutput(
+        output_, captureDevice_, DuplicationFormats, ARRAYSIZE(DuplicationFormats), &duplication_);
+    if (FAILED(hr)) 
     {
-        adapter->Release();
         return false;
     }
 
-    adapter->Release();
+    // Frames come in the output's unrotated orientation
+    DXGI_OUTDUPL_DESC duplicationDesc;
+    duplication_->GetDesc(&duplicationDesc);
+    rotation_ = static_cast<OutputRotation>(duplicationDesc.Rotation);
 
-    // Create desktop duplication
-    hr = output_->DuplicateOutput(d3dDevice_, &duplication_);
-    if (FAILED(hr)) 
+    // What the tone mapping needs to know about the target; an SDR desktop needs none
+    DXGI_OUTPUT_DESC outputDesc;
+    float peakNits = 0.0f;
+    if (!DisplayAdapters::GetOutputColour(output_, outputHdr10_, peakNits))
     {
-        return false;
+        outputHdr10_ = false;
     }
 
+    toneMap_.peakNits = peakNits;
+    toneMap_.sdrWhiteNits = SUCCEEDED(output_->GetDesc(&outputDesc)) ?
+        DisplayAdapters::GetSdrWhiteLevel(outputDesc.DeviceName) : ToneMap::DefaultSdrWhiteNits;
+    toneMapDirty_ = true;
+
     return true;
 }
 
-bool DuplicationWindow::FindTargetOutput()
+bool DuplicationWindow::FindTargetOutput(IDXGIAdapter1** targetAdapter)
 {   
-    // Get DXGI adapter
-    IDXGIDevice* dxgiDevice = nullptr;
-    HRESULT hr = d3dDevice_->QueryInterface(__uuidof(IDXGIDevice), reinterpret_cast<void**>(&dxgiDevice));  // NOLINT(clang-diagnostic-language-extension-token)
-    if (FAILED(hr)) 
+    // On hybrid and multi-GPU systems the target needn't be on the adapter we render with
+    if (DisplayAdapters::FindOutput(targetMonitorName_.c_str(), &output_, targetAdapter))
     {
-        return false;
+        return true;
     }
-
-    IDXGIAdapter* adapter = nullptr;
-    hr = dxgiDevice->GetAdapter(&adapter);
-    dxgiDevice->Release();
-    if (FAILED(hr)) 
+    
+    // If we didn't find the target monitor, try to fall back to primary
+    if (!targetMonitorName_.empty()) 
     {
-        return false;
+        // Reset and try again without target monitor name (fallback to primary)
+        targetMonitorName_.clear();
+        return FindTargetOutput(targetAdapter);
     }
-
-    // Enumerate all outputs to find the target monitor
-    UINT outputIndex = 0;
-    IDXGIOutput* output = nullptr;
     
-    while (adapter->EnumOutputs(outputIndex, &output) != DXGI_ERROR_NOT_FOUND) 
-    {
-        DXGI_OUTPUT_DESC outputDesc;
-        hr = output->GetDesc(&outputDesc);
-        
-        if (SUCCEEDED(hr)) 
-        {
-            // Convert wide string to narrow string for comparison
-            char deviceName[32];
-            WideCharToMultiByte(CP_ACP, 0, outputDesc.DeviceName, -1, deviceName, sizeof(deviceName), nullptr, nullptr);
-            
-            // Check if this output matches our target monitor
-            if (targetMonitorName_.empty() || targetMonitorName_ == deviceName) {
-                // Found the target output
-                hr = output->QueryInterface(__uuidof(IDXGIOutput1), reinterpret_cast<void**>(&output_));  // NOLINT(clang-diagnostic-language-extension-token)
-                output->Release();
-                adapter->Release();
-                return SUCCEEDED(hr);
-            }
-        }
-        
-        output->Release();
-        outputIndex++;
+    return false;
+}
+
+bool DuplicationWindow::EnsureCaptureDevice(IDXGIAdapter1* adapter)
+{
+    DXGI_ADAPTER_DESC1 adapterDesc;
+    if (FAILED(adapter->GetDesc1(&adapterDesc)))
+    {
+        return false;
     }
-    
-    adapter->Release();
-    
-    // If we didn't find the target monitor, try to fall back to primary
-    if (!targetMonitorName_.empty()) 
+
+    if (captureDevice_ && DisplayAdapters::IsSameLuid(adapterDesc.AdapterLuid, captureAdapterLuid_))
     {
-        // Reset and try again without target monitor name (fallback to primary)
-        targetMonitorName_.clear();
-        return FindTargetOutput();
+        return true;
     }
-    
-    return false;
+
+    ReleaseCaptureDevice();
+
+    if (DisplayAdapters::IsSameLuid(adapterDesc.AdapterLuid, renderAdapterLuid_))
+    {
+        // The usual case: capture and render share a device and frames are copied on the GPU
+        captureDevice_ = d3dDevice_;
+        captureDevice_->AddRef();
+    }
+    else
+    {
+        const HRESULT hr = D3D11CreateDevice(
+            adapter, D3D_DRIVER_TYPE_UNKNOWN, nullptr, 0, nullptr, 0, D3D11_SDK_VERSION,
+            &captureDevice_, nullptr, nullptr);
+
+        if (FAILED(hr) || !transfer_.Create(captureDevice_))
+        {
+            ReleaseCaptureDevice();
+            return false;
+        }
+
+        char detail[256];
+        (void)snprintf(detail, sizeof(detail), "target on another adapter (%ls), frames move through staging", adapterDesc.Description);
+        Metrics::Event("capture.adapter", detail);
+    }
+
+    captureAdapterLuid_ = adapterDesc.AdapterLuid;
+    return true;
+}
+
+void DuplicationWindow::ReleaseCaptureDevice()
+{
+    transfer_.Destroy();
+    SafeRelease(captureDevice_);
+    ZeroMemory(&captureAdapterLuid_, sizeof(captureAdapterLuid_));
 }
 
 void DuplicationWindow::CleanupDuplication()
@@ -659,6 +1667,363 @@ void DuplicationWindow::CleanupDuplication()
     if (output_) { output_->Release(); output_ = nullptr; }
 }
 
+void DuplicationWindow::UpdateToneMap(const DXGI_FORMAT format)
+{
+    ColourEncoding encoding = ColourEncoding::Srgb;
+    if (format == DXGI_FORMAT_R16G16B16A16_FLOAT)
+    {
+        encoding = ColourEncoding::LinearScRgb;
+    }
+    else if (format == DXGI_FORMAT_R10G10B10A2_UNORM && outputHdr10_)
+    {
+        encoding = ColourEncoding::Pq2020;
+    }
+
+    if (encoding == toneMap_.encoding)
+    {
+        return;
+    }
+
+    toneMap_.encoding = encoding;
+    toneMapDirty_ = true;
+
+    char detail[128];
+    (void)snprintf(detail, sizeof(detail), "format %d, %s, SDR white %.0f nits, peak %.0f nits",
+        static_cast<int>(format),
+        encoding == ColourEncoding::Srgb ? "SDR" : encoding == ColourEncoding::LinearScRgb ? "scRGB tone mapped" : "HDR10 tone mapped",
+        toneMap_.sdrWhiteNits, toneMap_.peakNits);
+    Metrics::Event("capture.format", detail);
+}
+
+UINT DuplicationWindow::GetCaptureScale(const D3D11_TEXTURE2D_DESC& desktopDesc) const
+{
+    // A reduced copy is drawn from the acquired image, so that has to be on our device and
+    // readable by a shader
+    const bool reduce = memoryBudget_.GetLevel() >= QualityLevel::ReducedCapture && reducedCaptureSupported_ &&
+        !transfer_.IsActive() && (desktopDesc.BindFlags & D3D11_BIND_SHADER_RESOURCE) != 0;
+    return reduce ? ReducedCaptureScale : 1;
+}
+
+bool DuplicationWindow::EnsureCapturedTexture(const UINT width, const UINT height, const DXGI_FORMAT format, const UINT scale)
+{
+    UpdateToneMap(format);
+
+    if (capturedTexture_ && imageWidth_ == width && imageHeight_ == height && capturedDesc_.Format == format &&
+        captureScale_ == scale)
+    {
+        return true;
+    }
+
+    // The full-size texture isn't kept idle when reducing is meant to free its memory
+    if (scale > captureScale_)
+    {
+        texturePool_.Discard(capturedTexture_, capturedSRV_);
+    }
+
+    ReleaseCapturedTexture();
+
+    // A texture this size and format may be left from before, e.g. an HDR toggle
+    D3D11_TEXTURE2D_DESC desc = {};
+    desc.Width = (width + scale - 1) / scale;
+    desc.Height = (height + scale - 1) / scale;
+    desc.MipLevels = 1;
+    desc.ArraySize = 1;
+    desc.Format = format;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = scale > 1 ? D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET : D3D11_BIND_SHADER_RESOURCE;
+
+    if (!texturePool_.Acquire(desc, &capturedTexture_, &capturedSRV_))
+    {
+        return false;
+    }
+
+    if (scale > 1 && FAILED(d3dDevice_->CreateRenderTargetView(capturedTexture_, nullptr, &capturedRTV_)))
+    {
+        ReleaseCapturedTexture();
+        return false;
+    }
+
+    capturedDesc_ = desc;
+    captureScale_ = scale;
+    imageWidth_ = width;
+    imageHeight_ = height;
+    borders_.Reset({ 0, 0, static_cast<int>(width), static_cast<int>(height) });
+    return true;
+}
+
+void DuplicationWindow::ReleaseCapturedTexture()
+{
+    SafeRelease(capturedRTV_);
+    texturePool_.Recycle(capturedTexture_, capturedSRV_);
+    capturedDesc_ = D3D11_TEXTURE2D_DESC();
+    captureScale_ = 1;
+    imageWidth_ = 0;
+    imageHeight_ = 0;
+    copiedRegion_ = PixelRect();
+    capturedChanges_.Clear();
+    borders_.Reset(PixelRect());
+    fullRedraw_ = true;
+}
+
+PixelRect DuplicationWindow::GetOutputRegion(const UINT width, const UINT height) const
+{
+    // The region in view, relative to the output, in the image's coordinates (which are
+    // those of the dirty and move rects) when the output is rotated
+    const bool swapAxes = RotationTransform::SwapsAxes(rotation_);
+    const int outputWidth = static_cast<int>(swapAxes ? height : width);
+    const int outputHeight = static_cast<int>(swapAxes ? width : height);
+
+    const PixelRect region = OffsetPixelRect(view_.GetRegion(), -targetMonitorRect_.left, -targetMonitorRect_.top);
+    const PixelRect output = { 0, 0, outputWidth, outputHeight };
+
+    PixelRect clipped;
+    const PixelRect imageRegion = RotationTransform::DesktopToImage(
+        ViewTransform::Intersect(region, output, clipped) ? clipped : output, outputWidth, outputHeight, rotation_);
+
+    // Static black borders aren't copied
+    PixelRect content;
+    return ViewTransform::Intersect(imageRegion, borders_.GetContent(), content) ? content : imageRegion;
+}
+
+PixelRect DuplicationWindow::GetDesktopRect(const PixelRect& imageRect, const UINT width, const UINT height) const
+{
+    // The inverse of GetOutputRegion: from the image's coordinates to the desktop's
+    const bool swapAxes = RotationTransform::SwapsAxes(rotation_);
+    const int outputWidth = static_cast<int>(swapAxes ? height : width);
+    const int outputHeight = static_cast<int>(swapAxes ? width : height);
+
+    return OffsetPixelRect(
+        RotationTransform::ImageToDesktop(imageRect, outputWidth, outputHeight, rotation_),
+        targetMonitorRect_.left, targetMonitorRect_.top);
+}
+
+uint64_t DuplicationWindow::CopyBox(ID3D11Texture2D* source, const PixelRect& rect)
+{
+    if (transfer_.IsActive())
+    {
+        // source is on the capture adapter; the copy completes in the transfer's Flush
+        transfer_.Queue(source, rect);
+    }
+    else if (captureScale_ > 1)
+    {
+        // BeginReducedCopy has bound the acquired image; the scissor keeps the draw to rect
+        const PixelRect reduced = ScaleDown(rect, captureScale_);
+        renderState_.SetScissorRect(ToRect(reduced));
+        renderState_.Draw(4, StripFirstVertex);
+        return static_cast<uint64_t>(reduced.right - reduced.left) * static_cast<uint64_t>(reduced.bottom - reduced.top);
+    }
+    else
+    {
+        const D3D11_BOX box = {
+            static_cast<UINT>(rect.left), static_cast<UINT>(rect.top), 0,
+            static_cast<UINT>(rect.right), static_cast<UINT>(rect.bottom), 1 };
+
+        d3dContext_->CopySubresourceRegion(
+            capturedTexture_, 0, static_cast<UINT>(rect.left), static_cast<UINT>(rect.top), 0, source, 0, &box);
+    }
+
+    return static_cast<uint64_t>(rect.right - rect.left) * static_cast<uint64_t>(rect.bottom - rect.top);
+}
+
+void DuplicationWindow::BeginReducedCopy(ID3D11ShaderResourceView* source)
+{
+    // The acquired image replaces capturedSRV_ before capturedTexture_ becomes the target.
+    // The strip's quad covers the whole target, so sampling at each texel's centre reads
+    // the middle of the pixels it stands for.
+    renderState_.SetShaderResource(source);
+    renderState_.SetRenderTarget(capturedRTV_);
+    renderState_.SetRasterizerState(scissorState_);
+    renderState_.SetBlendState(nullptr);
+    renderState_.SetVertexShader(vertexShader_);
+    renderState_.SetInputLayout(inputLayout_);
+    renderState_.SetVertexBuffer(vertexBuffer_, sizeof(Vertex));
+    renderState_.SetPixelShader(pixelShader_);
+    renderState_.SetSampler(samplerState_);
+    renderState_.SetViewport(ToViewport({ 0, 0, static_cast<int>(capturedDesc_.Width), static_cast<int>(capturedDesc_.Height) }));
+}
+
+void DuplicationWindow::EndReducedCopy()
+{
+    // The acquired image is released with the frame, so it mustn't stay bound
+    renderState_.SetShaderResource(nullptr);
+    renderState_.SetRenderTarget(renderTargetView_);
+}
+
+void DuplicationWindow::CopyCapturedRegion(
+    ID3D11Texture2D* desktopTexture, const DXGI_OUTDUPL_FRAME_INFO& frameInfo, const D3D11_TEXTURE2D_DESC& desktopDesc)
+{
+    const bool desktopChanged = frameInfo.LastPresentTime.QuadPart != 0;
+    const auto* moveRects = reinterpret_cast<const DXGI_OUTDUPL_MOVE_RECT*>(frameMetadata_.data());
+    const auto* dirtyRects = reinterpret_cast<const RECT*>(frameMetadata_.data() + frameMoveCount_ * sizeof(DXGI_OUTDUPL_MOVE_RECT));
+
+    // The borders aren't copied, so only the frame's changes can show them changing. That
+    // has to be known before the copy, which then takes in the borders again.
+    if (desktopChanged)
+    {
+        bool bordersChanged = !frameMetadataValid_ && borders_.AddChange(borders_.GetOutput());
+        for (UINT n = 0; frameMetadataValid_ && n < frameMoveCount_ + frameDirtyCount_; ++n)
+        {
+            const RECT& changedRect = n < frameMoveCount_ ? moveRects[n].DestinationRect : dirtyRects[n - frameMoveCount_];
+            bordersChanged = borders_.AddChange(ToPixelRect(changedRect)) || bordersChanged;
+        }
+
+        if (bordersChanged)
+        {
+            OnBordersChanged();
+        }
+    }
+
+    // A reduced capture is drawn from the acquired image rather than copied
+    ID3D11ShaderResourceView* desktopSRV = nullptr;
+    if (captureScale_ > 1)
+    {
+        if (FAILED(d3dDevice_->CreateShaderResourceView(desktopTexture, nullptr, &desktopSRV)))
+        {
+            // The next frame is copied at full size instead, whole as the texture is new
+            reducedCaptureSupported_ = false;
+            Metrics::Event("vram.reduced_capture", "unsupported");
+            ReleaseCapturedTexture();
+            return;
+        }
+
+        BeginReducedCopy(desktopSRV);
+    }
+
+    // Only the region in view is copied; the rest of capturedTexture_ goes stale
+    const PixelRect region = GetOutputRegion(desktopDesc.Width, desktopDesc.Height);
+
+    LARGE_INTEGER transferStart = {};
+    if (transfer_.IsActive())
+    {
+        QueryPerformanceCounter(&transferStart);
+    }
+
+    uint64_t copiedPixels = 0;
+    if (!ViewTransform::Contains(copiedRegion_, region) || (desktopChanged && !frameMetadataValid_))
+    {
+        // Newly exposed by a pan or zoom, or no dirty rects to go on
+        copiedPixels = CopyBox(desktopTexture, region);
+        capturedChanges_.Add(GetDesktopRect(region, desktopDesc.Width, desktopDesc.Height));
+    }
+    else if (desktopChanged)
+    {
+        // The acquired image is complete, so copying the destinations of move rects and the
+        // dirty rects, where they are in view, brings the region up to date
+        PixelRect bounds = {};
+        const bool copyBounds = frameMoveCount_ + frameDirtyCount_ > MaxCopyRects;
+
+        for (UINT n = 0; n < frameMoveCount_ + frameDirtyCount_; ++n)
+        {
+            const RECT& changedRect = n < frameMoveCount_ ? moveRects[n].DestinationRect : dirtyRects[n - frameMoveCount_];
+
+            PixelRect changed;
+            if (!ViewTransform::Intersect(ToPixelRect(changedRect), region, changed))
+            {
+                continue;
+            }
+
+            capturedChanges_.Add(GetDesktopRect(changed, desktopDesc.Width, desktopDesc.Height));
+
+            if (copyBounds)
+            {
+                bounds = ViewTransform::IsEmpty(bounds) ? changed : PixelRect{
+                    (std::min)(bounds.left, changed.left), (std::min)(bounds.top, changed.top),
+                    (std::max)(bounds.right, changed.right), (std::max)(bounds.bottom, changed.bottom) };
+            }
+            else
+            {
+                copiedPixels += CopyBox(desktopTexture, changed);
+            }
+        }
+
+        if (copyBounds && !ViewTransform::IsEmpty(bounds))
+        {
+            copiedPixels += CopyBox(desktopTexture, bounds);
+        }
+    }
+
+    if (desktopSRV)
+    {
+        EndReducedCopy();
+        desktopSRV->Release();
+    }
+
+    if (transfer_.IsActive())
+    {
+        // Read back from the capture adapter and upload to ours
+        const uint64_t transferredBytes = transfer_.Flush(d3dContext_, capturedTexture_);
+        if (transferredBytes > 0)
+        {
+            LARGE_INTEGER transferEnd;
+            QueryPerformanceCounter(&transferEnd);
+            stats_.transferMs.Add(
+                static_cast<double>(transferEnd.QuadPart - transferStart.QuadPart) * 1000.0 /
+                static_cast<double>(qpcFrequency_.QuadPart));
+            stats_.transferredBytes += transferredBytes;
+        }
+    }
+
+    copiedRegion_ = region;
+
+    if (copiedPixels > 0)
+    {
+        gpuTimer_.EndStage(d3dContext_, GpuStage::Copy);
+    }
+
+    const uint64_t bytesPerPixel = GetBytesPerPixel(desktopDesc.Format);
+    stats_.copiedBytes += copiedPixels * bytesPerPixel;
+    if (desktopChanged)
+    {
+        stats_.fullOutputBytes += static_cast<uint64_t>(desktopDesc.Width) * desktopDesc.Height * bytesPerPixel;
+    }
+}
+
+bool DuplicationWindow::CaptureWindowFrame()
+{
+    const HWND window = windowCapture_.GetWindow();
+    if (!window)
+    {
+        return false;
+    }
+
+    WindowCaptureFrame frame;
+    if (windowCapture_.AcquireFrame(&frame))
+    {
+        const UINT width = static_cast<UINT>(frame.contentSize.cx);
+        const UINT height = static_cast<UINT>(frame.contentSize.cy);
+
+        if (width > 0 && height > 0 && EnsureCapturedTexture(width, height, DXGI_FORMAT_B8G8R8A8_UNORM, 1))
+        {
+            // The pool's buffers can be larger than the window after a resize
+            const D3D11_BOX box = { 0, 0, 0, width, height, 1 };
+            d3dContext_->CopySubresourceRegion(capturedTexture_, 0, 0, 0, 0, frame.texture, 0, &box);
+            gpuTimer_.EndStage(d3dContext_, GpuStage::Copy);
+
+            ++stats_.capturedFrames;
+            stats_.skippedFrames += frame.skippedFrames;
+            pendingDesktopPresentTime_ = frame.presentTime;
+            FrameJournal::Record(JournalEvent::Acquire, ++journalFrame_, S_OK, frame.skippedFrames + 1, -1.0f);
+
+            const uint64_t bytesPerPixel = GetBytesPerPixel(DXGI_FORMAT_B8G8R8A8_UNORM);
+            stats_.copiedBytes += static_cast<uint64_t>(width) * height * bytesPerPixel;
+            stats_.fullOutputBytes +=
+                static_cast<uint64_t>(targetMonitorRect_.right - targetMonitorRect_.left) *
+                static_cast<uint64_t>(targetMonitorRect_.bottom - targetMonitorRect_.top) * bytesPerPixel;
+
+            // Where the window's content sits on the monitor (excluding the invisible resize borders)
+            if (FAILED(DwmGetWindowAttribute(window, DWMWA_EXTENDED_FRAME_BOUNDS, &captureWindowRect_, sizeof(captureWindowRect_))))
+            {
+                GetWindowRect(window, &captureWindowRect_);
+            }
+        }
+
+        windowCapture_.ReleaseFrame();
+    }
+
+    return capturedTexture_ != nullptr;
+}
+
 bool DuplicationWindow::CaptureFrame()
 {
     if (!duplication_)
@@ -688,44 +2053,14 @@ bool DuplicationWindow::CaptureFrame()
             D3D11_TEXTURE2D_DESC newDesc;
             desktopTexture->GetDesc(&newDesc);
 
-            bool needRecreate = false;
-            if (capturedTexture_)
-            {
-                D3D11_TEXTURE2D_DESC existingDesc;
-                capturedTexture_->GetDesc(&existingDesc);
-                needRecreate = (existingDesc.Width != newDesc.Width ||
-                    existingDesc.Height != newDesc.Height ||
-                    existingDesc.Format != newDesc.Format);
-            }
-            else
-            {
-                needRecreate = true;
-            }
+            UpdateCaptureStats(frameInfo, newDesc);
+            FrameJournal::Record(
+                JournalEvent::Acquire, ++journalFrame_, hr, frameInfo.AccumulatedFrames,
+                frameMetadataValid_ ? static_cast<float>(stats_.dirtyAreaPercent.Last()) : -1.0f);
 
-            if (needRecreate)
+            if (EnsureCapturedTexture(newDesc.Width, newDesc.Height, newDesc.Format, GetCaptureScale(newDesc)))
             {
-                if (capturedTexture_) { capturedTexture_->Release(); capturedTexture_ = nullptr; }
-                if (capturedSRV_) { capturedSRV_->Release(); capturedSRV_ = nullptr; }
-
-                D3D11_TEXTURE2D_DESC desc = newDesc;
-                desc.Usage = D3D11_USAGE_DEFAULT;
-                desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-                desc.CPUAccessFlags = 0;
-                desc.MiscFlags = 0;
-
-                if (SUCCEEDED(d3dDevice_->CreateTexture2D(&desc, nullptr, &capturedTexture_)))
-                {
-                    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-                    srvDesc.Format = desc.Format;
-                    srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-                    srvDesc.Texture2D.MipLevels = 1;
-                    d3dDevice_->CreateShaderResourceView(capturedTexture_, &srvDesc, &capturedSRV_);
-                }
-            }
-
-            if (capturedTexture_)
-            {
-                d3dContext_->CopySubresourceRegion(capturedTexture_, 0, 0, 0, 0, desktopTexture, 0, nullptr);
+                CopyCapturedRegion(desktopTexture, frameInfo, newDesc);
             }
 
             desktopTexture->Release();
@@ -733,10 +2068,27 @@ bool DuplicationWindow::CaptureFrame()
 
         desktopResource->Release();
         duplication_->ReleaseFrame();
+        awaitingFullFrame_ = false;
+    }
+    else if (hr == DXGI_ERROR_WAIT_TIMEOUT)
+    {
+        if (capturedTexture_ && !awaitingFullFrame_)
+        {
+            if (!ViewTransform::Contains(copiedRegion_, GetOutputRegion(imageWidth_, imageHeight_)))
+            {
+                // A pan or zoom exposed part of the output we haven't copied, but nothing is changing
+                // on screen so no frame is coming. A new duplication always starts with a full frame.
+                FrameJournal::Record(JournalEvent::Restart, journalFrame_, S_OK, 0, 0.0f);
+                CleanupDuplication();
+                InitializeDuplication();
+                awaitingFullFrame_ = true;
+            }
+        }
     }
-    else if (hr != DXGI_ERROR_WAIT_TIMEOUT)
+    else
     {
         // A real error occurred (not a timeout). Re-initialize the duplication.
+        FrameJournal::Record(JournalEvent::Restart, journalFrame_, hr, 0, 0.0f);
         CleanupDuplication();
         InitializeDuplication();
     }
@@ -745,108 +2097,753 @@ bool DuplicationWindow::CaptureFrame()
     return capturedTexture_ != nullptr;
 }
 
-bool DuplicationWindow::RenderFrame() const
+void DuplicationWindow::UpdateCaptureStats(
+    const DXGI_OUTDUPL_FRAME_INFO& frameInfo, const D3D11_TEXTURE2D_DESC& desktopDesc)
+{
+    frameMoveCount_ = 0;
+    frameDirtyCount_ = 0;
+    frameMetadataValid_ = false;
+
+    // A zero present time means only the pointer changed
+    if (frameInfo.LastPresentTime.QuadPart == 0)
+    {
+        return;
+    }
+
+    ++stats_.capturedFrames;
+    if (frameInfo.AccumulatedFrames > 1)
+    {
+        stats_.skippedFrames += frameInfo.AccumulatedFrames - 1;
+    }
+
+    pendingDesktopPresentTime_ = frameInfo.LastPresentTime.QuadPart;
+
+    if (frameInfo.TotalMetadataBufferSize == 0)
+    {
+        stats_.dirtyAreaPercent.Add(0.0);
+        return;
+    }
+
+    if (frameMetadata_.size() < frameInfo.TotalMetadataBufferSize)
+    {
+        frameMetadata_.resize(frameInfo.TotalMetadataBufferSize);
+    }
+
+    // Move rects come first in the buffer, dirty rects after them
+    UINT moveBytes = 0;
+    auto* moveRects = reinterpret_cast<DXGI_OUTDUPL_MOVE_RECT*>(frameMetadata_.data());
+    if (FAILED(duplication_->GetFrameMoveRects(static_cast<UINT>(frameMetadata_.size()), moveRects, &moveBytes)))
+    {
+        return;
+    }
+
+    UINT dirtyBytes = 0;
+    auto* dirtyRects = reinterpret_cast<RECT*>(frameMetadata_.data() + moveBytes);
+    if (FAILED(duplication_->GetFrameDirtyRects(
+        static_cast<UINT>(frameMetadata_.size()) - moveBytes, dirtyRects, &dirtyBytes)))
+    {
+        return;
+    }
+
+    double changedArea = 0.0;
+
+    const UINT moveCount = moveBytes / sizeof(DXGI_OUTDUPL_MOVE_RECT);
+    const UINT dirtyCount = dirtyBytes / sizeof(RECT);
+
+    // Kept for CopyCapturedRegion
+    frameMoveCount_ = moveCount;
+    frameDirtyCount_ = dirtyCount;
+    frameMetadataValid_ = true;
+
+    for (UINT n = 0; n < moveCount; ++n)
+    {
+        const RECT& r = moveRects[n].DestinationRect;
+        changedArea += static_cast<double>(r.right - r.left) * (r.bottom - r.top);
+    }
+
+    for (UINT n = 0; n < dirtyCount; ++n)
+    {
+        const RECT& r = dirtyRects[n];
+        changedArea += static_cast<double>(r.right - r.left) * (r.bottom - r.top);
+    }
+
+    const double totalArea = static_cast<double>(desktopDesc.Width) * desktopDesc.Height;
+    const double percent = totalArea > 0.0 ? changedArea * 100.0 / totalArea : 0.0;
+    stats_.dirtyAreaPercent.Add(percent > 100.0 ? 100.0 : percent);
+    feedDirtyPercent_ = (std::max)(feedDirtyPercent_, 0.0) + percent;
+}
+
+bool DuplicationWindow::GetLensMapping(
+    const QuadMapping& content, const float aspect, QuadMapping& lens, LensParameters& parameters) const
 {
-    if (!capturedSRV_ || !capturedTexture_)
+    if (!lens_.IsEnabled())
     {
         return false;
     }
 
-    // Set up rendering pipeline
-    d3dContext_->OMSetRenderTargets(1, &renderTargetView_, nullptr);
+    // The lens follows the pointer while it's in view, otherwise it sits in the middle
+    POINT cursorPos;
+    float x = 0.0f;
+    float y = 0.0f;
+    if (GetCursorPos(&cursorPos) && !view_.MapPoint(cursorPos.x, cursorPos.y, x, y))
+    {
+        x = 0.0f;
+        y = 0.0f;
+    }
+
+    return lens_.Map(content, x, y, aspect, lens, parameters);
+}
+
+int DuplicationWindow::GetBoxFilterFactor(const RECT& contentRect, const D3D11_VIEWPORT& viewport) const
+{
+    // Only the whole of the content maps texels to pixels exactly
+    if (view_.GetZoom() != 1.0)
+    {
+        return 1;
+    }
+
+    // A reduced capture has fewer texels to average
+    const int scale = static_cast<int>(captureScale_);
+    return MirrorLayout::GetBoxFilterFactor(
+        (contentRect.right - contentRect.left + scale - 1) / scale, (contentRect.bottom - contentRect.top + scale - 1) / scale,
+        static_cast<int>(viewport.Width), static_cast<int>(viewport.Height));
+}
+
+PixelRect DuplicationWindow::GetCursorRect(const RECT& monitorRect, const POINT& position) const
+{
+    const int left = monitorRect.left + position.x - cursorShapeInfo_.HotSpot.x;
+    const int top = monitorRect.top + position.y - cursorShapeInfo_.HotSpot.y;
+    return { left, top, left + static_cast<int>(cursorShapeInfo_.Width), top + static_cast<int>(cursorShapeInfo_.Height) };
+}
+
+bool DuplicationWindow::IsProbeDue() const
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return now.QuadPart - lastProbe_ >= qpcFrequency_.QuadPart * ProbeIntervalMs / 1000;
+}
+
+void DuplicationWindow::ProbeFeed()
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    lastProbe_ = now.QuadPart;
+
+    const bool windowCapture = stats_.mode == MirrorMode::WindowCapture;
+
+    FeedSample sample = {};
+    sample.time = static_cast<double>(now.QuadPart) / static_cast<double>(qpcFrequency_.QuadPart);
+    sample.hasSignal = windowCapture ? windowCapture_.GetWindow() != nullptr : duplication_ != nullptr;
+    sample.mediaShowing = mediaShowing_;
+    sample.dirtyPercent = feedDirtyPercent_;
+
+    // Window capture has no dirty rects; a duplication that delivered no frames changed nothing
+    feedDirtyPercent_ = windowCapture ? -1.0 : 0.0;
+
+    // Measure the oldest reduced copy the GPU has finished, then queue the next one
+    int width = 0;
+    int height = 0;
+    PixelRect area;
+    if (probe_.Read(d3dContext_, ToneMap::GetConstants(toneMap_), feedLuma_, width, height, area))
+    {
+        // The probe's area is in the captured texture's pixels, which a reduced capture has fewer of
+        const int scale = static_cast<int>(captureScale_);
+        area = {
+            area.left * scale, area.top * scale,
+            (std::min)(area.right * scale, static_cast<int>(imageWidth_)),
+            (std::min)(area.bottom * scale, static_cast<int>(imageHeight_)) };
+
+        const bool comparable = width == previousFeedWidth_ && height == previousFeedHeight_;
+        FrameAnalysis::Measure(
+            feedLuma_.data(), comparable ? previousFeedLuma_.data() : nullptr, feedLuma_.size(), sample.statistics);
+        sample.measured = true;
+
+        // Window capture has no dirty rects to tell when a border stops being one
+        if (!windowCapture && borders_.Update(feedLuma_.data(), width, height, area, sample.time))
+        {
+            OnBordersChanged();
+        }
+
+        std::swap(feedLuma_, previousFeedLuma_);
+        previousFeedWidth_ = width;
+        previousFeedHeight_ = height;
+
+        stats_.feedMeanLuma.Add(sample.statistics.meanLuma);
+        stats_.feedDarkPercent.Add(sample.statistics.darkFraction * 100.0);
+        stats_.feedChangedPercent.Add(sample.statistics.changedFraction * 100.0);
+
+        LARGE_INTEGER measured;
+        QueryPerformanceCounter(&measured);
+        stats_.feedAnalysisUs.Add(
+            static_cast<double>(measured.QuadPart - now.QuadPart) * 1.0e6 / static_cast<double>(qpcFrequency_.QuadPart));
+    }
+
+    if (sample.hasSignal && capturedTexture_)
+    {
+        // Only the part of the output that's kept up to date is measured
+        const PixelRect whole = { 0, 0, static_cast<int>(capturedDesc_.Width), static_cast<int>(capturedDesc_.Height) };
+        probe_.Queue(d3dContext_, capturedTexture_, windowCapture ? whole : ScaleDown(copiedRegion_, captureScale_));
+    }
+
+    if (feedMonitor_.Update(sample))
+    {
+        Metrics::Event("feed.alert", FeedMonitor::GetAlertName(feedMonitor_.GetAlert()));
+
+        // The banner is drawn into the swap chain, so the strip alone isn't enough any more
+        thumbnailFramePresented_ = false;
+    }
+
+    UpdateAlert(sample.time);
+}
+
+void DuplicationWindow::OnBordersChanged()
+{
+    const PixelRect& output = borders_.GetOutput();
+    const PixelRect& content = borders_.GetContent();
+    const double outputArea = static_cast<double>(output.right - output.left) * (output.bottom - output.top);
+    const double contentArea = static_cast<double>(content.right - content.left) * (content.bottom - content.top);
+
+    char detail[64];
+    (void)snprintf(detail, sizeof(detail), "%d,%d %dx%d", content.left, content.top,
+        content.right - content.left, content.bottom - content.top);
+    Metrics::Event("borders.content", borders_.HasBorders() ? detail : "none");
+    Metrics::Write("borders.excluded_percent", outputArea > 0.0 ? 100.0 * (1.0 - contentArea / outputArea) : 0.0);
+
+    ApplySourceRect();
+}
+
+void DuplicationWindow::UpdateAlert(const double now)
+{
+    const FeedAlert alert = feedMonitor_.GetAlert();
+    alert_.SetVisible(alert != FeedAlert::None);
+    if (alert == FeedAlert::None)
+    {
+        return;
+    }
+
+    const char* problem =
+        alert == FeedAlert::NoSignal ? "No signal" :
+        alert == FeedAlert::Black ? "Output black" : "Video frozen";
+
+    char text[64];
+    (void)snprintf(text, sizeof(text), "%s for %.0f s", problem, feedMonitor_.GetAlertDuration(now));
+    alert_.SetText(text);
+
+    // Centred at the top of the mirror
+    const int scale = MulDiv(4, static_cast<int>(dpi_), USER_DEFAULT_SCREEN_DPI);
+    const int margin = MulDiv(8, static_cast<int>(dpi_), USER_DEFAULT_SCREEN_DPI);
+
+    int width;
+    int height;
+    GlyphAtlas::Measure(text, scale, width, height);
+    alert_.SetPosition((std::max)(margin, (windowWidth_ - width) / 2), margin, scale);
+}
+
+void DuplicationWindow::QueueLatencyPattern(const LONGLONG presentTime)
+{
+    // The pattern is read as a horizontal strip, so rotated outputs aren't supported, and
+    // its cells need every pixel, so neither are reduced captures
+    const bool unrotated = rotation_ == OutputRotation::Identity || rotation_ == OutputRotation::Unspecified;
+    if (IsRectEmpty(&latencyPatternRect_) || stats_.mode != MirrorMode::Duplication || !capturedTexture_ || !unrotated ||
+        captureScale_ > 1)
+    {
+        return;
+    }
+
+    // Only the part of the output in copiedRegion_ is up to date in the captured texture
+    const PixelRect region = OffsetPixelRect(
+        ToPixelRect(latencyPatternRect_), -targetMonitorRect_.left, -targetMonitorRect_.top);
+    if (ViewTransform::Contains(copiedRegion_, region))
+    {
+        latencyReader_.Queue(d3dContext_, capturedTexture_, region, presentTime);
+    }
+}
+
+void DuplicationWindow::ReadLatencyPattern()
+{
+    bool decoded;
+    uint32_t stamp;
+    LONGLONG presentTime;
+    while (latencyReader_.Read(d3dContext_, ToneMap::GetConstants(toneMap_), decoded, stamp, presentTime))
+    {
+        if (!decoded)
+        {
+            ++stats_.glassLatencyMisreads;
+            continue;
+        }
+
+        // The same stamp again is a frame that changed elsewhere, not a new measurement
+        if (stamp == lastLatencyStamp_)
+        {
+            continue;
+        }
+
+        lastLatencyStamp_ = stamp;
+
+        const double latencyMs = LatencyPattern::GetElapsedMs(
+            stamp, LatencyPattern::ToStamp(presentTime, qpcFrequency_.QuadPart));
+        if (latencyMs >= 0.0 && latencyMs < MaxGlassLatencyMs)
+        {
+            stats_.glassLatencyMs.Add(latencyMs);
+        }
+        else
+        {
+            ++stats_.glassLatencyMisreads;
+        }
+    }
+}
+
+void DuplicationWindow::UpdateSnapshot()
+{
+    if (snapshotRequested_ && capturedTexture_)
+    {
+        snapshotRequested_ = false;
+
+        // Only the part of the output that's kept up to date is saved, the right way up and
+        // at the size it's captured
+        const bool windowCapture = stats_.mode == MirrorMode::WindowCapture;
+        const PixelRect whole = { 0, 0, static_cast<int>(capturedDesc_.Width), static_cast<int>(capturedDesc_.Height) };
+        if (!snapshot_.Queue(
+            d3dContext_, capturedTexture_, windowCapture ? whole : ScaleDown(copiedRegion_, captureScale_),
+            windowCapture ? OutputRotation::Identity : rotation_, ToneMap::GetConstants(toneMap_)))
+        {
+            Metrics::Event("snapshot.skipped", snapshot_.IsBusy() ? "busy" : "unsupported");
+        }
+    }
+
+    SnapshotResult result;
+    if (!snapshot_.Update(d3dContext_, result))
+    {
+        return;
+    }
+
+    if (!result.saved)
+    {
+        Metrics::Event("snapshot.failed", result.path.empty() ? "encode" : result.path.c_str());
+        return;
+    }
+
+    Metrics::Event("snapshot.saved", result.path.c_str());
+    Metrics::Write("snapshot.convert_ms", result.convertMs);
+    Metrics::Write("snapshot.encode_ms", result.encodeMs);
+    Metrics::Write("snapshot.size_mb", static_cast<double>(result.bytes) / (1024.0 * 1024.0));
+}
+
+void DuplicationWindow::UpdateMemoryBudget()
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+
+    const bool budgetChanged = videoMemory_.TakeBudgetChange();
+    if (!budgetChanged && now.QuadPart - lastBudgetCheck_ < qpcFrequency_.QuadPart * BudgetCheckIntervalMs / 1000)
+    {
+        return;
+    }
+
+    lastBudgetCheck_ = now.QuadPart;
+
+    uint64_t usage;
+    uint64_t budget;
+    if (!videoMemory_.Query(usage, budget))
+    {
+        return;
+    }
+
+    stats_.videoMemoryUsage = usage;
+    stats_.videoMemoryBudget = budget;
+
+    const bool wasReduced = memoryBudget_.GetLevel() >= QualityLevel::ReducedCapture;
+    if (!memoryBudget_.Update(usage, budget, static_cast<double>(now.QuadPart) / static_cast<double>(qpcFrequency_.QuadPart)))
+    {
+        return;
+    }
+
+    const QualityLevel level = memoryBudget_.GetLevel();
+    texturePool_.SetMaxIdleBytes(level >= QualityLevel::ReducedPool ? 0 : TexturePool::DefaultMaxIdleBytes);
+
+    // The capture scale changes with the next frame; a new duplication starts with a whole
+    // one, so a still desktop isn't left at the old scale
+    const bool reduced = level >= QualityLevel::ReducedCapture;
+    if (reduced != wasReduced && stats_.mode == MirrorMode::Duplication && duplication_ && !transfer_.IsActive())
+    {
+        FrameJournal::Record(JournalEvent::Restart, journalFrame_, S_OK, 0, 0.0f);
+        CleanupDuplication();
+        InitializeDuplication();
+        awaitingFullFrame_ = true;
+    }
+
+    char detail[96];
+    (void)snprintf(detail, sizeof(detail), "%s, %.0f of %.0f MB", MemoryBudget::GetLevelName(level),
+        static_cast<double>(usage) / (1024.0 * 1024.0), static_cast<double>(budget) / (1024.0 * 1024.0));
+    Metrics::Event("vram.level", detail);
+    Metrics::Write("vram.level", static_cast<double>(level));
+}
+
+bool DuplicationWindow::GetRedrawRegion(const PresentedFrame& frame, const bool partialPossible, DirtyRegion& region) const
+{
+    region.Clear();
+
+    const PresentedFrame& last = presentedFrame_;
+    const bool sameLayout = partialPossible && !fullRedraw_ && !frame.overlays && !last.overlays &&
+        frame.mode == last.mode && frame.boxFactor == last.boxFactor &&
+        memcmp(&frame.mapping, &last.mapping, sizeof(frame.mapping)) == 0 &&
+        memcmp(&frame.tile, &last.tile, sizeof(frame.tile)) == 0;
+
+    if (!sameLayout)
+    {
+        region.Add({ 0, 0, windowWidth_, windowHeight_ });
+        return false;
+    }
+
+    // The output's changes, mapped into the view. Filtering reaches one texel (or one box)
+    // beyond each changed one.
+    for (const PixelRect& rect : capturedChanges_.GetRects())
+    {
+        const int reach = frame.boxFactor;
+        const PixelRect grown = { rect.left - reach, rect.top - reach, rect.right + reach, rect.bottom + reach };
+
+        QuadMapping mapping;
+        if (view_.Map(grown, mapping))
+        {
+            region.Add(DirtyRegion::ToPixels(mapping, frame.tile, 1));
+        }
+    }
+
+    // The pointer where it was and where it is now
+    if (memcmp(&frame.cursor, &last.cursor, sizeof(frame.cursor)) != 0)
+    {
+        region.Add(last.cursor);
+        region.Add(frame.cursor);
+    }
+
+    region.Clip(frame.tile);
+    return true;
+}
+
+bool DuplicationWindow::RenderFrame()
+{
+    // In thumbnail mode the mirror area is covered by DWM's thumbnail so only the strip is drawn
+    const bool drawMirror = stats_.mode != MirrorMode::Thumbnail && capturedSRV_ && capturedTexture_;
+
+    // Set up rendering pipeline; renderState_ only passes on what isn't bound already
+    renderState_.SetRenderTarget(renderTargetView_);
+
+    // The mirror occupies the window above the instructions strip
+    const int instructionsHeight = instructions_.GetHeight();
+    const int mirrorHeight = windowHeight_ - instructionsHeight;
 
     // ReSharper disable once CppInitializedValueIsAlwaysRewritten
-    D3D11_VIEWPORT viewport{}; // no need to initialise really, but good practice
+    D3D11_VIEWPORT mirrorViewport{}; // no need to initialise really, but good practice
 
-    viewport.TopLeftX = 0;
-    viewport.TopLeftY = 0;
-    viewport.Width = static_cast<FLOAT>(windowWidth_);
-    viewport.Height = static_cast<FLOAT>(windowHeight_);
-    viewport.MinDepth = 0.0f;
-    viewport.MaxDepth = 1.0f;
-    d3dContext_->RSSetViewports(1, &viewport);
+    mirrorViewport.TopLeftX = 0;
+    mirrorViewport.TopLeftY = 0;
+    mirrorViewport.Width = static_cast<FLOAT>(windowWidth_);
+    mirrorViewport.Height = static_cast<FLOAT>(mirrorHeight);
+    mirrorViewport.MinDepth = 0.0f;
+    mirrorViewport.MaxDepth = 1.0f;
 
-    // Clear the render target
-    constexpr float clearColor[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
-    d3dContext_->ClearRenderTargetView(renderTargetView_, clearColor);
+    // The target's tile: all of the mirror unless tiled
+    ArrangeTiles(tileSources_, tiles_);
+    const D3D11_VIEWPORT viewport = ToViewport(tiles_.front());
 
     // Draw the captured desktop texture
-    D3D11_TEXTURE2D_DESC textureDesc;
-    capturedTexture_->GetDesc(&textureDesc);
+    // The captured content (the output, or the window where it sits on the monitor) clipped
+    // to the part of the source in view; UVs select the matching part of the texture
+    const RECT& contentRect = stats_.mode == MirrorMode::WindowCapture ? captureWindowRect_ : targetMonitorRect_;
+    QuadMapping mapping = {};
+    const bool contentVisible = drawMirror && view_.Map(ToPixelRect(contentRect), mapping);
+
+    QuadMapping lensMapping = {};
+    LensParameters lensParameters = {};
+    const bool drawLens = contentVisible && viewport.Height > 0.0f &&
+        GetLensMapping(mapping, viewport.Width / viewport.Height, lensMapping, lensParameters);
+
+    // A rotated output's image is drawn upright by rotating the texture coordinates at the
+    // quad's corners rather than the pixels. The lens's shape is tested in the same space.
+    const OutputRotation rotation = stats_.mode == MirrorMode::Duplication ? rotation_ : OutputRotation::Identity;
+    if (drawLens)
+    {
+        RotationTransform::DesktopToImage(
+            lensParameters.centreU, lensParameters.centreV, rotation, lensParameters.centreU, lensParameters.centreV);
+
+        if (RotationTransform::SwapsAxes(rotation))
+        {
+            std::swap(lensParameters.halfWidthU, lensParameters.halfHeightV);
+        }
+    }
+
+    // Showing the whole capture at exactly 1/n scale: average the texels each pixel covers
+    const int boxFactor = contentVisible && FillsViewport(mapping) ? GetBoxFilterFactor(contentRect, viewport) : 1;
+
+    // The cursor (window capture draws it into the frame itself), mapped into the view like
+    // the desktop and clipped where it is partly out of view
+    QuadMapping cursorMapping = {};
+    PixelRect cursorTile = tiles_.front();
+    bool drawCursor = drawMirror && stats_.mode == MirrorMode::Duplication && cursorVisible_ &&
+        view_.Map(GetCursorRect(targetMonitorRect_, cursorPosition_), cursorMapping);
 
-    constexpr Vertex vertices[] =
+    // Otherwise it may be on one of the tiled monitors, which are always shown whole
+    for (size_t n = 0; !drawCursor && n < panes_.size(); ++n)
     {
-        { -1.0f, -1.0f, 0.0f, 1.0f, 0.0f, 1.0f },   // Bottom left
-        { -1.0f,  1.0f, 0.0f, 1.0f, 0.0f, 0.0f },   // Top left
-        {  1.0f, -1.0f, 0.0f, 1.0f, 1.0f, 1.0f },   // Bottom right
-        {  1.0f,  1.0f, 0.0f, 1.0f, 1.0f, 0.0f }    // Top right
-    };
+        POINT position;
+        if (panes_[n]->GetPointerPosition(position))
+        {
+            ViewTransform paneView;
+            paneView.SetSource(ToPixelRect(panes_[n]->GetMonitorRect()));
+            drawCursor = paneView.Map(GetCursorRect(panes_[n]->GetMonitorRect(), position), cursorMapping);
+            cursorTile = tiles_[n + 1];
+        }
+    }
 
-    D3D11_MAPPED_SUBRESOURCE mappedResource;
-    HRESULT hr = d3dContext_->Map(vertexBuffer_, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-    if (SUCCEEDED(hr))
+    drawCursor = drawCursor && cursorSRV_;
+
+    // Partial presents: unless the layout or anything drawn over the mirror changed, only the
+    // output's changes and the pointer's old and new places are redrawn and presented
+    PresentedFrame frame = {};
+    frame.mode = stats_.mode;
+    frame.mapping = mapping;
+    frame.tile = tiles_.front();
+    frame.cursor = drawCursor ? DirtyRegion::ToPixels(cursorMapping, cursorTile, 1) : PixelRect();
+    frame.boxFactor = boxFactor;
+    frame.overlays = hud_.IsVisible() || alert_.IsVisible();
+
+    const bool partialPossible = contentVisible && !drawLens && panes_.empty() &&
+        stats_.mode == MirrorMode::Duplication && !toneMapDirty_;
+
+    DirtyRegion redraw;
+    const bool partial = GetRedrawRegion(frame, partialPossible, redraw);
+    if (redraw.IsEmpty())
     {
-        memcpy(mappedResource.pData, vertices, sizeof(vertices));
-        d3dContext_->Unmap(vertexBuffer_, 0);
+        // Nothing in view has changed since the last present
+        FrameJournal::Record(JournalEvent::Present, journalFrame_, S_OK, 0, 0.0f, 0.0f, JournalUnchanged);
+        capturedChanges_.Clear();
+        pendingDesktopPresentTime_ = 0;
+        return true;
     }
 
-    d3dContext_->VSSetShader(vertexShader_, nullptr, 0);
-    d3dContext_->PSSetShader(pixelShader_, nullptr, 0);
-    d3dContext_->IASetInputLayout(inputLayout_);
-    constexpr UINT stride = sizeof(Vertex);
-    constexpr UINT offset = 0;
-    d3dContext_->IASetVertexBuffers(0, 1, &vertexBuffer_, &stride, &offset);
-    d3dContext_->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
-    d3dContext_->PSSetShaderResources(0, 1, &capturedSRV_);
-    d3dContext_->PSSetSamplers(0, 1, &samplerState_);
-    d3dContext_->Draw(4, 0);
+    const std::vector<PixelRect>& redrawRects = redraw.GetRects();
+    renderState_.SetRasterizerState(scissorState_);
 
-    // Draw the cursor
-    if (cursorVisible_ && cursorSRV_)
+    // Clear the render target. A partial redraw lies within the mirror's quad, which covers it.
+    if (!partial)
     {
-        // Set up blend state for transparency
-        d3dContext_->OMSetBlendState(blendState_, nullptr, 0xffffffff);
+        constexpr float clearColor[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        d3dContext_->ClearRenderTargetView(renderTargetView_, clearColor);
+        renderState_.CountCalls(1);
+    }
 
-        // Calculate cursor position in normalized device coordinates, accounting for the hotspot
-        const float cursorX =
-            (static_cast<float>(
-                cursorPosition_.x - cursorShapeInfo_.HotSpot.x) / textureDesc.Width) * 2.0f - 1.0f;  // NOLINT(bugprone-narrowing-conversions, cppcoreguidelines-narrowing-conversions, clang-diagnostic-implicit-int-float-conversion)
+    // The quads that follow the view are only rewritten when one of them has moved
+    DrawnQuads quads = {};
+    quads.mirror = contentVisible ? mapping : QuadMapping();
+    quads.lens = drawLens ? lensMapping : QuadMapping();
+    quads.cursor = drawCursor ? cursorMapping : QuadMapping();
+    quads.rotation = rotation;
 
-        const float cursorY =
-            1.0f - (static_cast<float>(
-                cursorPosition_.y - cursorShapeInfo_.HotSpot.y) / textureDesc.Height) * 2.0f;  // NOLINT(bugprone-narrowing-conversions, clang-diagnostic-implicit-int-float-conversion, cppcoreguidelines-narrowing-conversions)
+    if (!quadsValid_ || memcmp(&quads, &drawnQuads_, sizeof(quads)) != 0)
+    {
+        Vertex vertices[DynamicVertexCount];
+        SetQuad(vertices + MirrorFirstVertex, quads.mirror, rotation);
+        SetQuad(vertices + LensFirstVertex, quads.lens, rotation);
+
+        const QuadMapping& cursor = quads.cursor;
+        Vertex* cursorVertices = vertices + CursorFirstVertex;
+        cursorVertices[0] = { cursor.left,  cursor.bottom, 0.0f, 1.0f, cursor.u0, cursor.v1 }; // Bottom-left
+        cursorVertices[1] = { cursor.left,  cursor.top,    0.0f, 1.0f, cursor.u0, cursor.v0 }; // Top-left
+        cursorVertices[2] = { cursor.right, cursor.bottom, 0.0f, 1.0f, cursor.u1, cursor.v1 }; // Bottom-right
+        cursorVertices[3] = { cursor.right, cursor.top,    0.0f, 1.0f, cursor.u1, cursor.v0 }; // Top-right
+
+        const D3D11_BOX box = { 0, 0, 0, sizeof(vertices), 1, 1 };
+        d3dContext_->UpdateSubresource(vertexBuffer_, 0, &box, vertices, 0, 0);
+        renderState_.CountCalls(1);
+
+        drawnQuads_ = quads;
+        quadsValid_ = true;
+    }
 
-        const float cursorWidth =
-            (static_cast<float>(cursorShapeInfo_.Width) / textureDesc.Width) * 2.0f;  // NOLINT(bugprone-narrowing-conversions, clang-diagnostic-implicit-int-float-conversion, cppcoreguidelines-narrowing-conversions)
+    renderState_.SetVertexShader(vertexShader_);
+    renderState_.SetInputLayout(inputLayout_);
+    renderState_.SetVertexBuffer(vertexBuffer_, sizeof(Vertex));
+    renderState_.SetSampler(samplerState_);
 
-        const float cursorHeight =
-            (static_cast<float>(cursorShapeInfo_.Height) / textureDesc.Height) * 2.0f; // NOLINT(bugprone-narrowing-conversions, clang-diagnostic-implicit-int-float-conversion, cppcoreguidelines-narrowing-conversions)
+    // FP16 and HDR10 captures are tone mapped to the SDR swap chain as they are drawn
+    if (toneMapDirty_)
+    {
+        const ToneMapConstants toneMapConstants = ToneMap::GetConstants(toneMap_);
+        d3dContext_->UpdateSubresource(toneMapConstantBuffer_, 0, nullptr, &toneMapConstants, 0, 0);
+        renderState_.CountCalls(1);
+        toneMapDirty_ = false;
+    }
 
-        const Vertex cursorVertices[] =
+    renderState_.SetPixelConstantBuffer(1, toneMapConstantBuffer_);
+
+    if (contentVisible)
+    {
+        ID3D11PixelShader* mirrorShader = toneMap_.encoding == ColourEncoding::Srgb ? pixelShader_ : toneMapPixelShader_;
+
+        if (boxFactor > 1)
         {
-            { cursorX,               cursorY - cursorHeight, 0.0f, 1.0f, 0.0f, 1.0f }, // Bottom-left
-            { cursorX,               cursorY,                0.0f, 1.0f, 0.0f, 0.0f }, // Top-left
-            { cursorX + cursorWidth, cursorY - cursorHeight, 0.0f, 1.0f, 1.0f, 1.0f }, // Bottom-right
-            { cursorX + cursorWidth, cursorY,                0.0f, 1.0f, 1.0f, 0.0f }  // Top-right
-        };
+            BoxFilterParameters parameters = {};
+            parameters.texelWidth = 1.0f / static_cast<float>(capturedDesc_.Width);
+            parameters.texelHeight = 1.0f / static_cast<float>(capturedDesc_.Height);
+            parameters.factor = static_cast<float>(boxFactor);
+
+            if (memcmp(&parameters, &boxParameters_, sizeof(parameters)) != 0)
+            {
+                d3dContext_->UpdateSubresource(boxConstantBuffer_, 0, nullptr, &parameters, 0, 0);
+                renderState_.CountCalls(1);
+                boxParameters_ = parameters;
+            }
+
+            renderState_.SetPixelConstantBuffer(2, boxConstantBuffer_);
+            mirrorShader = boxPixelShader_;
+        }
 
-        hr = d3dContext_->Map(vertexBuffer_, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-        if (SUCCEEDED(hr))
+        renderState_.SetViewport(viewport);
+        renderState_.SetPixelShader(mirrorShader);
+        renderState_.SetShaderResource(capturedSRV_);
+        for (const PixelRect& rect : redrawRects)
         {
-            memcpy(mappedResource.pData, cursorVertices, sizeof(cursorVertices));
-            d3dContext_->Unmap(vertexBuffer_, 0);
+            renderState_.SetScissorRect(ToRect(rect));
+            renderState_.Draw(4, MirrorFirstVertex);
         }
+    }
+
+    // The lens, panes and strip only take part in full redraws, whose one rectangle is the
+    // whole window
+    renderState_.SetScissorRect(ToRect(redrawRects.front()));
+
+    // Magnifier lens: one more draw from the same texture; nothing extra is captured
+    bool lensReady = drawLens && memcmp(&lensParameters, &lensParameters_, sizeof(lensParameters)) == 0;
+    D3D11_MAPPED_SUBRESOURCE mappedResource;
+    if (drawLens && !lensReady &&
+        SUCCEEDED(d3dContext_->Map(lensConstantBuffer_, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource)))
+    {
+        memcpy(mappedResource.pData, &lensParameters, sizeof(lensParameters));
+        d3dContext_->Unmap(lensConstantBuffer_, 0);
+        renderState_.CountCalls(2);
+        lensParameters_ = lensParameters;
+        lensReady = true;
+    }
+
+    if (lensReady)
+    {
+        renderState_.SetViewport(viewport);
+        renderState_.SetPixelShader(lensPixelShader_);
+        renderState_.SetPixelConstantBuffer(0, lensConstantBuffer_);
+        renderState_.Draw(4, LensFirstVertex);
+    }
+
+    // Tiled mode: the other monitors, each drawn from the full quad for its rotation into its
+    // own tile with the same pipeline state
+    for (size_t n = 0; n < panes_.size(); ++n)
+    {
+        ID3D11ShaderResourceView* paneSRV = panes_[n]->GetShaderResourceView();
+        if (paneSRV && !ViewTransform::IsEmpty(tiles_[n + 1]))
+        {
+            renderState_.SetViewport(ToViewport(tiles_[n + 1]));
+            renderState_.SetPixelShader(pixelShader_);
+            renderState_.SetShaderResource(paneSRV);
+            renderState_.Draw(4, GetPaneFirstVertex(panes_[n]->GetRotation()));
+        }
+    }
+
+    // Instructions strip: drawn into the strip's viewport from its cached texture. A partial
+    // redraw never reaches it.
+    ID3D11ShaderResourceView* instructionsSRV = partial ? nullptr : instructions_.GetShaderResourceView(d3dContext_, windowWidth_);
+    if (instructionsSRV)
+    {
+        D3D11_VIEWPORT stripViewport = mirrorViewport;
+        stripViewport.TopLeftY = static_cast<FLOAT>(mirrorHeight);
+        stripViewport.Height = static_cast<FLOAT>(instructionsHeight);
+        renderState_.SetViewport(stripViewport);
+        renderState_.SetPixelShader(pixelShader_);
+        renderState_.SetShaderResource(instructionsSRV);
+        renderState_.Draw(4, StripFirstVertex);
+    }
+
+    gpuTimer_.EndStage(d3dContext_, GpuStage::Draw);
+
+    // Draw the cursor, blended over the mirror from its own quad
+    if (drawCursor)
+    {
+        renderState_.SetBlendState(blendState_);
+        renderState_.SetViewport(ToViewport(cursorTile));
+        renderState_.SetPixelShader(pixelShader_);
+        renderState_.SetShaderResource(cursorSRV_);
+        for (const PixelRect& rect : redrawRects)
+        {
+            renderState_.SetScissorRect(ToRect(rect));
+            renderState_.Draw(4, CursorFirstVertex);
+        }
+
+        renderState_.SetBlendState(nullptr);
+        gpuTimer_.EndStage(d3dContext_, GpuStage::Cursor);
+    }
 
-        d3dContext_->PSSetShaderResources(0, 1, &cursorSRV_);
-        d3dContext_->Draw(4, 0);
+    // Performance HUD (ALT+SHIFT+hotkey), over the whole mirror. The overlays bind their own
+    // pipeline state, so nothing bound before can be assumed afterwards.
+    if (hud_.IsVisible() || alert_.IsVisible())
+    {
+        renderState_.SetViewport(mirrorViewport);
+        renderState_.SetScissorRect(ToRect(redrawRects.front()));
+        hud_.Render(d3dContext_, windowWidth_, mirrorHeight);
+        alert_.Render(d3dContext_, windowWidth_, mirrorHeight);
+        renderState_.Invalidate();
+    }
 
-        // Reset blend state
-        d3dContext_->OMSetBlendState(nullptr, nullptr, 0xffffffff);
+    // Present the DirectX content; no dirty rects presents the whole window
+    RECT dirtyRects[DirtyRegion::MaxRects];
+    DXGI_PRESENT_PARAMETERS presentParameters = {};
+    if (partial)
+    {
+        for (const PixelRect& rect : redrawRects)
+        {
+            dirtyRects[presentParameters.DirtyRectsCount++] = ToRect(rect);
+        }
+
+        presentParameters.pDirtyRects = dirtyRects;
     }
 
+    const HRESULT hr = swapChain_->Present1(0, 0, &presentParameters);
+    renderState_.CountCalls(1);
+    gpuTimer_.EndStage(d3dContext_, GpuStage::Present);
+
+    const double areaPercent = windowWidth_ > 0 && windowHeight_ > 0 ?
+        static_cast<double>(redraw.GetArea()) * 100.0 / (static_cast<double>(windowWidth_) * windowHeight_) : 0.0;
+    FrameJournal::Record(
+        JournalEvent::Present, journalFrame_, hr, 0, static_cast<float>(areaPercent), 0.0f,
+        static_cast<uint16_t>(partial ? JournalPartial : 0));
 
-    // Present the DirectX content
-    hr = swapChain_->Present(0, 0);
+    fullRedraw_ = FAILED(hr);
+    if (SUCCEEDED(hr))
+    {
+        ++stats_.presentedFrames;
+        presentedFrame_ = frame;
+        capturedChanges_.Clear();
+
+        if (windowWidth_ > 0 && windowHeight_ > 0)
+        {
+            stats_.presentAreaPercent.Add(areaPercent);
+        }
+
+        // Startup is over once the mirror shows something captured
+        if (!firstFramePresented_ && (contentVisible || stats_.mode == MirrorMode::Thumbnail))
+        {
+            firstFramePresented_ = true;
+            Metrics::Write("startup.time_to_first_frame_ms", Metrics::GetUptimeMs());
+        }
+
+        if (pendingDesktopPresentTime_ != 0)
+        {
+            LARGE_INTEGER now;
+            QueryPerformanceCounter(&now);
+            QueueLatencyPattern(now.QuadPart);
+            stats_.latencyMs.Add(
+                static_cast<double>(now.QuadPart - pendingDesktopPresentTime_) * 1000.0 /
+                static_cast<double>(qpcFrequency_.QuadPart));
+            pendingDesktopPresentTime_ = 0;
+        }
+    }
     if (hr == DXGI_ERROR_DEVICE_REMOVED || hr == DXGI_ERROR_DEVICE_RESET)
     {
         // Device lost - we should reinitialize DirectX resources
@@ -879,11 +2876,15 @@ LRESULT CALLBACK DuplicationWindow::WindowProc(const HWND windowHandle, const UI
     switch (msg)
     {
         case WM_SIZE:
+            // The size is kept even while starting up, for the swap chain to be created at
+            self->windowWidth_ = LOWORD(lParam);
+            self->windowHeight_ = HIWORD(lParam);
             if (self->swapChain_) 
             {
-                self->windowWidth_ = LOWORD(lParam);
-                self->windowHeight_ = HIWORD(lParam);
+                self->thumbnailFramePresented_ = false;
+                self->fullRedraw_ = true;
                 self->d3dContext_->OMSetRenderTargets(0, nullptr, nullptr);
+                self->renderState_.Invalidate();
                 if (self->renderTargetView_) 
                 {
                     self->renderTargetView_->Release();
@@ -912,27 +2913,26 @@ LRESULT CALLBACK DuplicationWindow::WindowProc(const HWND windowHandle, const UI
         case WM_PAINT:
             {
                 PAINTSTRUCT ps;
-                BeginPaint(windowHandle, &ps);
-                if (self) 
+                const HDC dc = BeginPaint(windowHandle, &ps);
+                if (self->IsReady()) 
                 {
                     self->UpdateFrame();
                 }
+                else
+                {
+                    self->PaintPlaceholder(dc);
+                }
                 EndPaint(windowHandle, &ps);
                 return 0;
             }
 
+        case StartupMessage:
+            self->FinishStartup();
+            return 0;
+
         case WM_ERASEBKGND:
             return 1;
 
-        case WM_DISPLAYCHANGE:
-            if (self) 
-            {
-                self->CleanupDuplication();
-                self->InitializeDuplication();
-                InvalidateRect(windowHandle, nullptr, FALSE);
-            }
-            break;
-
         default:
             break;
     }
@@ -2,8 +2,33 @@
 #include <windows.h>
 #include <d3d11.h>
 #include <dxgi1_2.h>
+#include <future>
 #include <memory>
 #include <string>
+#include <vector>
+#include "AdapterTransfer.h"
+#include "BorderDetector.h"
+#include "DirtyRegion.h"
+#include "DuplicationPane.h"
+#include "FeedMonitor.h"
+#include "FrameProbe.h"
+#include "GpuTimer.h"
+#include "InstructionsOverlay.h"
+#include "LatencyReader.h"
+#include "MagnifierLens.h"
+#include "MemoryBudget.h"
+#include "MirrorLayout.h"
+#include "MirrorStats.h"
+#include "OutputRotation.h"
+#include "RenderStateCache.h"
+#include "SnapshotWriter.h"
+#include "TextOverlay.h"
+#include "TexturePool.h"
+#include "TileLayout.h"
+#include "ToneMap.h"
+#include "VideoMemoryMonitor.h"
+#include "ViewTransform.h"
+#include "WindowCapture.h"
 
 class DuplicationWindow  // NOLINT(cppcoreguidelines-special-member-functions)
 {
@@ -11,15 +36,105 @@ public:
     DuplicationWindow();
     ~DuplicationWindow();
 
-    bool Create(HWND parent, HINSTANCE instance, int x, int y, int width, int height, const char* targetMonitorName = nullptr);
+    // Returns once the window exists; the device, shaders and duplication are set up on
+    // worker threads and a placeholder is painted until they're ready
+    bool Create(HWND parent, HINSTANCE instance, int x, int y, int width, int height,
+        const char* targetMonitorName, const std::vector<std::string>& paneMonitorNames);
     void Destroy();
+    bool IsReady() const;
     HWND GetWindowHandle() const;
     void SetSourceRect(const RECT& rect);
+    void SetTargetMonitorRect(const RECT& rect);
     bool SetTransform(float zoomFactor);
+    ViewTransform& GetView();
+    MagnifierLens& GetLens();
+    const MagnifierLens& GetLens() const;
+    bool ShowActualSize();
     void Resize(int x, int y, int width, int height) const;
     bool UpdateFrame();
+    const MirrorStats& GetStats() const;
+    void SetMode(MirrorMode mode);
+    bool SetCaptureWindow(HWND window);
+    MirrorMode GetMode() const;
+    int GetInstructionsHeight() const;
+    void ToggleHud();
+
+    // Whether letterbox and pillarbox borders are cropped from the view, so that the
+    // content is shown larger. They're left out of the copies either way.
+    void ToggleBorderCrop();
+    void SetInstructionsHotKey(TCHAR hotKey);
+    void SetDpi(UINT dpi);
+
+    // Whether OnlyM's media window is showing on the target; black and frozen feeds are
+    // only unexpected while it is
+    void SetMediaShowing(bool showing);
+    FeedAlert GetFeedAlert() const;
+
+    // Glass-to-glass calibration: where the latency pattern is drawn on the desktop, or an
+    // empty rect to stop reading it
+    void SetLatencyPattern(const RECT& rect);
+
+    // Saves the next captured frame, as shown, to the Pictures folder. The readback and
+    // encoding happen over the following frames without holding up the mirror.
+    void TakeSnapshot();
+
+    // After a display topology change: duplicates the target (and tiled monitors) under
+    // their current names and positions, keeping the device and swap chain
+    bool Rebind(const char* targetMonitorName, const RECT& targetMonitorRect, const std::vector<std::string>& paneMonitorNames);
+
+    // Tiled mode: mirrors another monitor beside the target, in the same pass and present
+    bool AddPane(const char* monitorName);
+    bool IsTiled() const;
+
+    // Where the target is drawn, in client coordinates; the whole mirror unless tiled
+    PixelRect GetPrimaryTile() const;
 
 private:
+    // Shader bytecode, compiled on a startup worker while the device is being created
+    struct ShaderBytecode
+    {
+        ID3DBlob* vertex;
+        ID3DBlob* mirror;
+        ID3DBlob* toneMap;
+        ID3DBlob* box;
+        ID3DBlob* lens;
+    };
+
+    // The quads RenderFrame last wrote to the vertex buffer, to skip rewriting them unchanged
+    struct DrawnQuads
+    {
+        QuadMapping mirror;
+        QuadMapping lens;
+        QuadMapping cursor;
+        OutputRotation rotation;
+    };
+
+    // What the last present drew, to tell which parts of the next frame need redrawing
+    struct PresentedFrame
+    {
+        MirrorMode mode;
+        QuadMapping mapping;
+        PixelRect tile;
+        PixelRect cursor;               // in client pixels; empty if not drawn
+        int boxFactor;
+        bool overlays;                  // the HUD or the alert banner
+    };
+
+    enum class StartupState
+    {
+        Pending,
+        Ready,
+        Failed
+    };
+
+    bool CreateDevice(HMONITOR monitor);
+    bool InitializeCapture(HMONITOR monitor, const std::vector<std::string>& paneMonitorNames);
+    bool CompileShaders();
+    void ReleaseShaderBytecode();
+    void FinishStartup();
+    void WaitForStartup();
+    void PaintPlaceholder(HDC dc) const;
+    std::unique_ptr<DuplicationPane> CreatePane(const char* monitorName) const;
     // ReSharper disable once CppInconsistentNaming
     bool InitializeDX();
     // ReSharper disable once CppInconsistentNaming
@@ -27,8 +142,37 @@ private:
     bool InitializeDuplication();
     void CleanupDuplication();
     bool CaptureFrame();
-    bool RenderFrame() const;
-    bool FindTargetOutput();
+    bool CaptureWindowFrame();
+    void UpdateToneMap(DXGI_FORMAT format);
+    UINT GetCaptureScale(const D3D11_TEXTURE2D_DESC& desktopDesc) const;
+    bool EnsureCapturedTexture(UINT width, UINT height, DXGI_FORMAT format, UINT scale);
+    void ReleaseCapturedTexture();
+    PixelRect GetOutputRegion(UINT width, UINT height) const;
+    PixelRect GetDesktopRect(const PixelRect& imageRect, UINT width, UINT height) const;
+    void ApplySourceRect();
+    void OnBordersChanged();
+    uint64_t CopyBox(ID3D11Texture2D* source, const PixelRect& rect);
+    void BeginReducedCopy(ID3D11ShaderResourceView* source);
+    void EndReducedCopy();
+    void CopyCapturedRegion(ID3D11Texture2D* desktopTexture, const DXGI_OUTDUPL_FRAME_INFO& frameInfo, const D3D11_TEXTURE2D_DESC& desktopDesc);
+    void UpdateCaptureStats(const DXGI_OUTDUPL_FRAME_INFO& frameInfo, const D3D11_TEXTURE2D_DESC& desktopDesc);
+    bool GetRedrawRegion(const PresentedFrame& frame, bool partialPossible, DirtyRegion& region) const;
+    bool GetLensMapping(const QuadMapping& content, float aspect, QuadMapping& lens, LensParameters& parameters) const;
+    void ArrangeTiles(std::vector<PixelRect>& sources, std::vector<PixelRect>& tiles) const;
+    int GetBoxFilterFactor(const RECT& contentRect, const D3D11_VIEWPORT& viewport) const;
+    PixelRect GetCursorRect(const RECT& monitorRect, const POINT& position) const;
+    bool IsProbeDue() const;
+    void ProbeFeed();
+    void UpdateAlert(double now);
+    void QueueLatencyPattern(LONGLONG presentTime);
+    void ReadLatencyPattern();
+    void UpdateSnapshot();
+    void UpdateMemoryBudget();
+    bool RenderFrame();
+    void ReportStats();
+    bool FindTargetOutput(IDXGIAdapter1** targetAdapter);
+    bool EnsureCaptureDevice(IDXGIAdapter1* adapter);
+    void ReleaseCaptureDevice();
     bool LoadDefaultCursor();     
     static LRESULT CALLBACK WindowProc(HWND windowHandle, UINT msg, WPARAM wParam, LPARAM lParam);
     static const TCHAR* GetWindowClassName();
@@ -40,27 +184,80 @@ private:
     // DirectX resources
     ID3D11Device* d3dDevice_;
     ID3D11DeviceContext* d3dContext_;
-    IDXGISwapChain* swapChain_;
+    LUID renderAdapterLuid_;
+
+    // Device the duplication is created on: the render device itself, or one on the
+    // target's adapter with frames moved across by transfer_
+    ID3D11Device* captureDevice_;
+    LUID captureAdapterLuid_;
+    AdapterTransfer transfer_;
+
+    IDXGISwapChain1* swapChain_;
     ID3D11RenderTargetView* renderTargetView_;
+
+    // The captured texture, the cursor and the readback copies come from here, so that
+    // size and format changes reuse textures rather than reallocating them
+    TexturePool texturePool_;
     ID3D11Texture2D* capturedTexture_;
+    D3D11_TEXTURE2D_DESC capturedDesc_;
     ID3D11ShaderResourceView* capturedSRV_;
+
+    // Under video memory pressure the output is captured at 1/captureScale_ of its size,
+    // drawn into capturedTexture_ through capturedRTV_. The image's own size stays in
+    // imageWidth_ and imageHeight_, which the dirty rects, borders and view go by.
+    ID3D11RenderTargetView* capturedRTV_;
+    UINT captureScale_;
+    UINT imageWidth_;
+    UINT imageHeight_;
+    bool reducedCaptureSupported_;
     ID3D11SamplerState* samplerState_;
+    ID3D11RasterizerState* scissorState_;
     
     // Desktop Duplication resources
     IDXGIOutputDuplication* duplication_;
     IDXGIOutput1* output_;
+    OutputRotation rotation_;           // of output_; capturedTexture_ is in its unrotated orientation
+
+    // Windows.Graphics.Capture of a single window
+    WindowCapture windowCapture_;
+    RECT captureWindowRect_;
     
     // Shader resources
     ID3D11VertexShader* vertexShader_;
     ID3D11PixelShader* pixelShader_;
     ID3D11Buffer* vertexBuffer_;
     ID3D11InputLayout* inputLayout_;
+    DrawnQuads drawnQuads_;
+    bool quadsValid_;
+    RenderStateCache renderState_;
+
+    // Magnifier lens, drawn over the mirror from the same captured texture
+    MagnifierLens lens_;
+    ID3D11PixelShader* lensPixelShader_;
+    ID3D11Buffer* lensConstantBuffer_;
+    LensParameters lensParameters_;
+
+    // Tone mapping of FP16 and HDR10 captures to the 8-bit swap chain
+    ID3D11PixelShader* toneMapPixelShader_;
+    ID3D11Buffer* toneMapConstantBuffer_;
+    ToneMapSettings toneMap_;
+    bool toneMapDirty_;
+    bool outputHdr10_;
+
+    // Exact downscale of the whole capture by 2, 3 or 4
+    ID3D11PixelShader* boxPixelShader_;
+    ID3D11Buffer* boxConstantBuffer_;
+    BoxFilterParameters boxParameters_;
     
     // Rendering parameters
     RECT sourceRect_;
+    ViewTransform view_;
+    PixelRect copiedRegion_;            // the part of the output kept up to date in capturedTexture_
+    bool awaitingFullFrame_;
     float zoomFactor_;
     int windowWidth_;
     int windowHeight_;
+    UINT dpi_;
     RECT targetMonitorRect_;
     
     // Monitor selection
@@ -74,4 +271,73 @@ private:
     mutable DXGI_OUTDUPL_POINTER_SHAPE_INFO cursorShapeInfo_;
     POINT cursorPosition_;    
     bool cursorVisible_;
+
+    // Other monitors in tiled mode, and where each target is drawn (the main target first)
+    std::vector<std::unique_ptr<DuplicationPane>> panes_;
+    std::vector<PixelRect> tileSources_;
+    std::vector<PixelRect> tiles_;
+
+    // Set once the instructions strip has been presented in thumbnail mode
+    bool thumbnailFramePresented_;
+
+    // Partial presents: the output's changes since the last present, in desktop
+    // coordinates, and whether the next frame has to be redrawn whole regardless
+    DirtyRegion capturedChanges_;
+    PresentedFrame presentedFrame_;
+    bool fullRedraw_;
+
+    // Startup workers. Until FinishStartup marks the window ready only they touch the
+    // device, duplication and panes; the window thread just paints the placeholder.
+    StartupState startupState_;
+    std::future<bool> deviceTask_;
+    std::future<bool> shaderTask_;
+    ShaderBytecode shaderBytecode_;
+    std::vector<std::unique_ptr<DuplicationPane>> startupPanes_;
+    bool firstFramePresented_;
+
+    // Instrumentation
+    GpuTimer gpuTimer_;
+    MirrorStats stats_;
+    LARGE_INTEGER qpcFrequency_;
+    LONGLONG lastStatsReport_;
+    LONGLONG pendingDesktopPresentTime_;
+    uint32_t journalFrame_;             // captured frames, numbering the frame journal's records
+    uint64_t journaledGpuFrames_;
+    std::vector<BYTE> frameMetadata_;
+    UINT frameMoveCount_;               // move rects then dirty rects of the last frame in frameMetadata_
+    UINT frameDirtyCount_;
+    bool frameMetadataValid_;
+    TextOverlay hud_;
+
+    // Black, frozen and no-signal detection on a reduced copy of the captured texture
+    FrameProbe probe_;
+    FeedMonitor feedMonitor_;
+    TextOverlay alert_;
+    std::vector<uint8_t> feedLuma_;
+    std::vector<uint8_t> previousFeedLuma_;
+    int previousFeedWidth_;
+    int previousFeedHeight_;
+    double feedDirtyPercent_;           // of the output changed since the last probe; negative if unknown
+    LONGLONG lastProbe_;
+    bool mediaShowing_;
+
+    // Static black borders around the content, found in the probe's copies
+    BorderDetector borders_;
+    bool cropBorders_;
+
+    // The latency pattern's part of each new frame, read back after it's presented
+    LatencyReader latencyReader_;
+    RECT latencyPatternRect_;
+    uint32_t lastLatencyStamp_;
+
+    SnapshotWriter snapshot_;
+    bool snapshotRequested_;
+
+    // Video memory usage against the OS's budget, and the quality level it calls for
+    VideoMemoryMonitor videoMemory_;
+    MemoryBudget memoryBudget_;
+    LONGLONG lastBudgetCheck_;
+    LONGLONG lastFrameStart_;           // for QualityLevel::ReducedRate
+
+    InstructionsOverlay instructions_;
 };
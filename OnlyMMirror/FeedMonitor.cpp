@@ -0,0 +1,138 @@
+#include "FeedMonitor.h"
+
+constexpr double FeedMonitor::NoSignalSeconds;
+constexpr double FeedMonitor::BlackSeconds;
+constexpr double FeedMonitor::FrozenSeconds;
+constexpr double FeedMonitor::PlayingSeconds;
+constexpr double FeedMonitor::BlackMeanLuma;
+constexpr double FeedMonitor::BlackDarkFraction;
+constexpr double FeedMonitor::MotionChangedFraction;
+constexpr double FeedMonitor::MotionDirtyPercent;
+
+FeedMonitor::FeedMonitor()
+    : alert_(FeedAlert::None)
+    , alertSince_(0.0)
+    , signalLostAt_(-1.0)
+    , blackSince_(-1.0)
+    , playingSince_(-1.0)
+    , lastMotion_(-1.0)
+{
+}
+
+void FeedMonitor::Reset()
+{
+    alert_ = FeedAlert::None;
+    alertSince_ = 0.0;
+    signalLostAt_ = -1.0;
+    blackSince_ = -1.0;
+    playingSince_ = -1.0;
+    lastMotion_ = -1.0;
+}
+
+bool FeedMonitor::Update(const FeedSample& sample)
+{
+    const double now = sample.time;
+
+    if (!sample.hasSignal)
+    {
+        if (signalLostAt_ < 0.0)
+        {
+            signalLostAt_ = now;
+        }
+    }
+    else
+    {
+        signalLostAt_ = -1.0;
+    }
+
+    if (!sample.mediaShowing)
+    {
+        // Black or still is what the screen is meant to show without media
+        blackSince_ = -1.0;
+        playingSince_ = -1.0;
+        lastMotion_ = -1.0;
+    }
+    else if (sample.hasSignal && sample.measured)
+    {
+        const FrameStatistics& statistics = sample.statistics;
+
+        const bool black = statistics.meanLuma <= BlackMeanLuma && statistics.darkFraction >= BlackDarkFraction;
+        if (!black)
+        {
+            blackSince_ = -1.0;
+        }
+        else if (blackSince_ < 0.0)
+        {
+            blackSince_ = now;
+        }
+
+        const bool moving = statistics.changedFraction >= MotionChangedFraction || sample.dirtyPercent >= MotionDirtyPercent;
+        if (moving)
+        {
+            // A pause long enough to have raised the alert starts a new run
+            if (playingSince_ < 0.0 || now - lastMotion_ >= FrozenSeconds)
+            {
+                playingSince_ = now;
+            }
+
+            lastMotion_ = now;
+        }
+    }
+
+    FeedAlert alert = FeedAlert::None;
+    double since = now;
+
+    if (signalLostAt_ >= 0.0 && now - signalLostAt_ >= NoSignalSeconds)
+    {
+        alert = FeedAlert::NoSignal;
+        since = signalLostAt_;
+    }
+    else if (blackSince_ >= 0.0 && now - blackSince_ >= BlackSeconds)
+    {
+        alert = FeedAlert::Black;
+        since = blackSince_;
+    }
+    else if (playingSince_ >= 0.0 && lastMotion_ - playingSince_ >= PlayingSeconds && now - lastMotion_ >= FrozenSeconds)
+    {
+        alert = FeedAlert::Frozen;
+        since = lastMotion_;
+    }
+
+    if (alert == alert_)
+    {
+        return false;
+    }
+
+    alert_ = alert;
+    alertSince_ = since;
+    return true;
+}
+
+FeedAlert FeedMonitor::GetAlert() const
+{
+    return alert_;
+}
+
+double FeedMonitor::GetAlertDuration(const double now) const
+{
+    return alert_ == FeedAlert::None || now < alertSince_ ? 0.0 : now - alertSince_;
+}
+
+const char* FeedMonitor::GetAlertName(const FeedAlert alert)
+{
+    switch (alert)
+    {
+        case FeedAlert::NoSignal:
+            return "no_signal";
+
+        case FeedAlert::Black:
+            return "black";
+
+        case FeedAlert::Frozen:
+            return "frozen";
+
+        case FeedAlert::None:
+        default:
+            return "none";
+    }
+}
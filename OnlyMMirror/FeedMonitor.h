@@ -0,0 +1,63 @@
+#pragma once
+
+// Portable detector for a media screen that has gone wrong without anyone noticing: no
+// signal, a black output, or a video that has stopped moving. It's fed the statistics of
+// the mirrored feed a few times a second and raises an alert once a condition has held
+// for long enough to rule out a fade or a still scene.
+
+#include "FrameStatistics.h"
+
+enum class FeedAlert
+{
+    None,
+    NoSignal,   // the capture isn't running, e.g. the output was lost
+    Black,      // media is showing but the output is black
+    Frozen      // media that was moving has stopped
+};
+
+struct FeedSample
+{
+    double time;                    // seconds, from any fixed origin
+    bool hasSignal;                 // the capture is running
+    bool mediaShowing;              // OnlyM's media window is showing on the target
+    bool measured;                  // statistics and dirtyPercent are from a new frame
+    FrameStatistics statistics;
+    double dirtyPercent;            // of the output changed since the last sample; negative if unknown
+};
+
+class FeedMonitor
+{
+public:
+    FeedMonitor();
+
+    // Returns true if the alert changed
+    bool Update(const FeedSample& sample);
+    void Reset();
+
+    FeedAlert GetAlert() const;
+
+    // How long the alert's condition has held at time now, in seconds
+    double GetAlertDuration(double now) const;
+
+    static const char* GetAlertName(FeedAlert alert);
+
+    static constexpr double NoSignalSeconds = 2.0;
+    static constexpr double BlackSeconds = 3.0;
+    static constexpr double FrozenSeconds = 5.0;
+
+    // Media has to have been moving for this long to count as video rather than a still
+    static constexpr double PlayingSeconds = 3.0;
+
+    static constexpr double BlackMeanLuma = 0.04;
+    static constexpr double BlackDarkFraction = 0.98;
+    static constexpr double MotionChangedFraction = 0.002;
+    static constexpr double MotionDirtyPercent = 0.5;
+
+private:
+    FeedAlert alert_;
+    double alertSince_;
+    double signalLostAt_;       // negative while there's a signal
+    double blackSince_;         // negative unless the output is black
+    double playingSince_;       // start of the current run of motion; negative if none
+    double lastMotion_;
+};
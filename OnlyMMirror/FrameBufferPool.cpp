@@ -0,0 +1,282 @@
+#include "FrameBufferPool.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace
+{
+    constexpr size_t MinGranule = 64u * 1024u;
+
+#ifdef _WIN32
+    size_t EnableLargePages()
+    {
+        // Large pages require SeLockMemoryPrivilege, which must be granted by policy
+        // and then enabled in our token.
+        HANDLE token = nullptr;
+        if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token))
+        {
+            return 0;
+        }
+
+        TOKEN_PRIVILEGES privileges = {};
+        privileges.PrivilegeCount = 1;
+        privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+
+        bool enabled = false;
+        if (LookupPrivilegeValue(nullptr, SE_LOCK_MEMORY_NAME, &privileges.Privileges[0].Luid))
+        {
+            enabled = AdjustTokenPrivileges(token, FALSE, &privileges, 0, nullptr, nullptr) &&
+                GetLastError() == ERROR_SUCCESS;
+        }
+
+        CloseHandle(token);
+        return enabled ? GetLargePageMinimum() : 0;
+    }
+#else
+    size_t EnableLargePages()
+    {
+        // Transparent huge pages; madvise is only a hint so there is nothing to enable.
+        return 2u * 1024u * 1024u;
+    }
+#endif
+
+    size_t RoundUp(const size_t value, const size_t multiple)
+    {
+        return ((value + multiple - 1) / multiple) * multiple;
+    }
+}
+
+FrameBuffer::FrameBuffer() noexcept
+    : pool_(nullptr)
+    , data_(nullptr)
+    , size_(0)
+    , capacity_(0)
+{
+}
+
+FrameBuffer::FrameBuffer(FrameBufferPool* pool, uint8_t* data, const size_t size, const size_t capacity) noexcept
+    : pool_(pool)
+    , data_(data)
+    , size_(size)
+    , capacity_(capacity)
+{
+}
+
+FrameBuffer::FrameBuffer(FrameBuffer&& other) noexcept
+    : pool_(other.pool_)
+    , data_(other.data_)
+    , size_(other.size_)
+    , capacity_(other.capacity_)
+{
+    other.pool_ = nullptr;
+    other.data_ = nullptr;
+    other.size_ = 0;
+    other.capacity_ = 0;
+}
+
+FrameBuffer& FrameBuffer::operator=(FrameBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        Reset();
+        pool_ = other.pool_;
+        data_ = other.data_;
+        size_ = other.size_;
+        capacity_ = other.capacity_;
+        other.pool_ = nullptr;
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.capacity_ = 0;
+    }
+
+    return *this;
+}
+
+FrameBuffer::~FrameBuffer()
+{
+    Reset();
+}
+
+void FrameBuffer::Reset()
+{
+    if (pool_ && data_)
+    {
+        pool_->Release(data_, capacity_);
+    }
+
+    pool_ = nullptr;
+    data_ = nullptr;
+    size_ = 0;
+    capacity_ = 0;
+}
+
+FrameBufferPool::FrameBufferPool(const bool useLargePages, const size_t maxIdleBytes)
+    : maxIdleBytes_(maxIdleBytes)
+    , idleBytes_(0)
+    , largePageSize_(useLargePages ? EnableLargePages() : 0)
+    , useLargePages_(largePageSize_ != 0)
+    , stats_()
+{
+    stats_.largePages = useLargePages_;
+}
+
+FrameBufferPool::~FrameBufferPool()
+{
+    // Any FrameBuffer handles must have been released by now.
+    const std::lock_guard<std::mutex> lock(mutex_);
+    TrimLocked(0);
+}
+
+size_t FrameBufferPool::SizeClassFor(const size_t size)
+{
+    // Eight classes per power of two, so a buffer wastes at most 12.5% of its size
+    // while frames of similar dimensions still share a class.
+    size_t powerOfTwo = MinGranule;
+    while (powerOfTwo < size)
+    {
+        powerOfTwo <<= 1;
+    }
+
+    const size_t granule = (std::max)(MinGranule, powerOfTwo / 8);
+    return RoundUp((std::max)(size, static_cast<size_t>(1)), granule);
+}
+
+FrameBuffer FrameBufferPool::Acquire(const size_t size)
+{
+    size_t capacity = SizeClassFor(size);
+    if (useLargePages_)
+    {
+        capacity = RoundUp(capacity, largePageSize_);
+    }
+
+    uint8_t* data = nullptr;
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+
+        const auto it = freeLists_.find(capacity);
+        if (it != freeLists_.end() && !it->second.empty())
+        {
+            data = it->second.back();
+            it->second.pop_back();
+            idleBytes_ -= capacity;
+            ++stats_.reusedAllocations;
+        }
+    }
+
+    if (!data)
+    {
+        data = AllocateBlock(capacity);
+        if (!data)
+        {
+            return {};
+        }
+
+        const std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.freshAllocations;
+        stats_.bytesReserved += capacity;
+        stats_.highWaterBytesReserved = (std::max)(stats_.highWaterBytesReserved, stats_.bytesReserved);
+    }
+
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        stats_.bytesInUse += capacity;
+        ++stats_.buffersInUse;
+        stats_.highWaterBytesInUse = (std::max)(stats_.highWaterBytesInUse, stats_.bytesInUse);
+        stats_.highWaterBuffersInUse = (std::max)(stats_.highWaterBuffersInUse, stats_.buffersInUse);
+    }
+
+    return { this, data, size, capacity };
+}
+
+void FrameBufferPool::Release(uint8_t* data, const size_t capacity)
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+
+    stats_.bytesInUse -= capacity;
+    --stats_.buffersInUse;
+
+    freeLists_[capacity].push_back(data);
+    idleBytes_ += capacity;
+
+    if (idleBytes_ > maxIdleBytes_)
+    {
+        TrimLocked(maxIdleBytes_);
+    }
+}
+
+void FrameBufferPool::Trim(const size_t maxIdleBytes)
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    TrimLocked(maxIdleBytes);
+}
+
+void FrameBufferPool::TrimLocked(const size_t maxIdleBytes)
+{
+    // Free the largest idle buffers first; they are the most expensive to keep.
+    for (auto it = freeLists_.rbegin(); it != freeLists_.rend() && idleBytes_ > maxIdleBytes; ++it)
+    {
+        auto& buffers = it->second;
+        while (!buffers.empty() && idleBytes_ > maxIdleBytes)
+        {
+            FreeBlock(buffers.back(), it->first);
+            buffers.pop_back();
+            idleBytes_ -= it->first;
+            stats_.bytesReserved -= it->first;
+        }
+    }
+}
+
+FrameBufferPoolStats FrameBufferPool::GetStats() const
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+uint8_t* FrameBufferPool::AllocateBlock(const size_t capacity)
+{
+#ifdef _WIN32
+    if (useLargePages_)
+    {
+        void* block = VirtualAlloc(nullptr, capacity, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+        if (block)
+        {
+            return static_cast<uint8_t*>(block);
+        }
+    }
+
+    // VirtualAlloc is page-aligned so satisfies our alignment, and keeps big
+    // buffers out of the CRT heap altogether.
+    return static_cast<uint8_t*>(VirtualAlloc(nullptr, capacity, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+#else
+    void* block = nullptr;
+    const size_t alignment = useLargePages_ ? largePageSize_ : Alignment;
+    if (posix_memalign(&block, alignment, capacity) != 0)
+    {
+        return nullptr;
+    }
+
+    if (useLargePages_)
+    {
+        (void)madvise(block, capacity, MADV_HUGEPAGE);
+    }
+
+    return static_cast<uint8_t*>(block);
+#endif
+}
+
+void FrameBufferPool::FreeBlock(uint8_t* data, const size_t /*capacity*/) const
+{
+#ifdef _WIN32
+    VirtualFree(data, 0, MEM_RELEASE);
+#else
+    free(data);  // NOLINT(cppcoreguidelines-no-malloc)
+#endif
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+// Portable pool of 64-byte aligned CPU frame buffers, for whole frames such as the
+// snapshots' converted and encoded images. Buffers are grouped into size classes and
+// recycled rather than returned to the heap, so that repeatedly handling 8-33 MB frames
+// doesn't thrash the allocator. The per-frame probe and latency copies are a few KB and
+// keep their own buffers from frame to frame, so they don't need it.
+// Tools/FrameBufferPoolBenchmark.cpp compares it with fresh allocations.
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+class FrameBufferPool;
+
+// RAII handle to a pooled buffer. The buffer is returned to its pool on destruction.
+class FrameBuffer
+{
+public:
+    FrameBuffer() noexcept;
+    FrameBuffer(FrameBuffer&& other) noexcept;
+    FrameBuffer& operator=(FrameBuffer&& other) noexcept;
+    FrameBuffer(const FrameBuffer&) = delete;
+    FrameBuffer& operator=(const FrameBuffer&) = delete;
+    ~FrameBuffer();
+
+    uint8_t* Data() const { return data_; }
+    size_t Size() const { return size_; }
+    size_t Capacity() const { return capacity_; }
+    explicit operator bool() const { return data_ != nullptr; }
+
+    void Reset();
+
+private:
+    friend class FrameBufferPool;
+    FrameBuffer(FrameBufferPool* pool, uint8_t* data, size_t size, size_t capacity) noexcept;
+
+    FrameBufferPool* pool_;
+    uint8_t* data_;
+    size_t size_;
+    size_t capacity_;
+};
+
+struct FrameBufferPoolStats
+{
+    size_t bytesInUse;
+    size_t bytesReserved;           // in use + idle
+    size_t highWaterBytesInUse;
+    size_t highWaterBytesReserved;
+    size_t buffersInUse;
+    size_t highWaterBuffersInUse;
+    uint64_t freshAllocations;
+    uint64_t reusedAllocations;
+    bool largePages;
+};
+
+class FrameBufferPool  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+public:
+    static constexpr size_t Alignment = 64;
+
+    // useLargePages is a request only; if the OS refuses (e.g. no SeLockMemoryPrivilege)
+    // the pool silently falls back to normal pages. Idle buffers beyond maxIdleBytes are freed.
+    explicit FrameBufferPool(bool useLargePages = false, size_t maxIdleBytes = 128u * 1024u * 1024u);
+    ~FrameBufferPool();
+
+    FrameBufferPool(const FrameBufferPool&) = delete;
+    FrameBufferPool& operator=(const FrameBufferPool&) = delete;
+
+    FrameBuffer Acquire(size_t size);
+    void Trim(size_t maxIdleBytes);
+    FrameBufferPoolStats GetStats() const;
+
+    static size_t SizeClassFor(size_t size);
+
+private:
+    friend class FrameBuffer;
+    void Release(uint8_t* data, size_t capacity);
+    uint8_t* AllocateBlock(size_t capacity);
+    void FreeBlock(uint8_t* data, size_t capacity) const;
+    void TrimLocked(size_t maxIdleBytes);
+
+    mutable std::mutex mutex_;
+    std::map<size_t, std::vector<uint8_t*>> freeLists_;
+    size_t maxIdleBytes_;
+    size_t idleBytes_;
+    size_t largePageSize_;
+    bool useLargePages_;
+    FrameBufferPoolStats stats_;
+};
@@ -0,0 +1,172 @@
+#include "FrameJournal.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+
+namespace
+{
+    constexpr char Magic[4] = { 'O', 'M', 'J', '1' };
+
+    // A seqlock per slot: sequence is cleared while the record is written and set to the
+    // record's position after it, so a reader can tell a complete record from a torn one
+    struct Slot
+    {
+        std::atomic<uint64_t> sequence;
+        JournalRecord record;
+    };
+
+    Slot slots[FrameJournal::Capacity];
+    std::atomic<uint64_t> written(0);
+
+    static_assert((FrameJournal::Capacity & (FrameJournal::Capacity - 1)) == 0, "Capacity must be a power of two");
+}
+
+namespace FrameJournal
+{
+    void Record(
+        const JournalEvent event, const uint32_t frame, const int32_t result, const uint32_t count,
+        const float value, const float value2, const uint16_t flags)
+    {
+        const uint64_t sequence = written.fetch_add(1, std::memory_order_relaxed) + 1;
+        Slot& slot = slots[(sequence - 1) & (Capacity - 1)];
+
+        slot.sequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        JournalRecord& record = slot.record;
+        record.sequence = sequence;
+        record.time = Now();
+        record.frame = frame;
+        record.event = static_cast<uint16_t>(event);
+        record.flags = flags;
+        record.result = result;
+        record.count = count;
+        record.value = value;
+        record.value2 = value2;
+
+        slot.sequence.store(sequence, std::memory_order_release);
+    }
+
+    int64_t Now()
+    {
+        // QueryPerformanceCounter underneath on Windows
+        return std::chrono::steady_clock::now().time_since_epoch().count();
+    }
+
+    int64_t GetTicksPerSecond()
+    {
+        using Period = std::chrono::steady_clock::period;
+        return static_cast<int64_t>(Period::den / Period::num);
+    }
+
+    size_t GetDumpSize()
+    {
+        return sizeof(JournalHeader) + Capacity * sizeof(JournalRecord);
+    }
+
+    size_t Serialize(uint8_t* buffer, const size_t size)
+    {
+        if (!buffer || size < sizeof(JournalHeader))
+        {
+            return 0;
+        }
+
+        const uint64_t total = written.load(std::memory_order_acquire);
+        const uint64_t first = total > Capacity ? total - Capacity + 1 : 1;
+        const size_t room = (size - sizeof(JournalHeader)) / sizeof(JournalRecord);
+
+        uint32_t recordCount = 0;
+        uint8_t* out = buffer + sizeof(JournalHeader);
+        for (uint64_t sequence = first; sequence <= total && recordCount < room; ++sequence)
+        {
+            const Slot& slot = slots[(sequence - 1) & (Capacity - 1)];
+            if (slot.sequence.load(std::memory_order_acquire) != sequence)
+            {
+                continue;
+            }
+
+            JournalRecord record;
+            memcpy(&record, &slot.record, sizeof(record));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) != sequence)
+            {
+                continue;
+            }
+
+            memcpy(out, &record, sizeof(record));
+            out += sizeof(record);
+            ++recordCount;
+        }
+
+        JournalHeader header = {};
+        memcpy(header.magic, Magic, sizeof(Magic));
+        header.recordSize = sizeof(JournalRecord);
+        header.capacity = static_cast<uint32_t>(Capacity);
+        header.recordCount = recordCount;
+        header.written = total;
+        header.ticksPerSecond = GetTicksPerSecond();
+        memcpy(buffer, &header, sizeof(header));
+
+        return sizeof(JournalHeader) + recordCount * sizeof(JournalRecord);
+    }
+
+    bool Parse(const uint8_t* data, const size_t size, JournalHeader& header, std::vector<JournalRecord>& records)
+    {
+        records.clear();
+        if (!data || size < sizeof(JournalHeader))
+        {
+            return false;
+        }
+
+        memcpy(&header, data, sizeof(header));
+        if (memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.recordSize < sizeof(JournalRecord) ||
+            header.ticksPerSecond <= 0)
+        {
+            return false;
+        }
+
+        // Later versions may add fields at the end of a record
+        const size_t available = (size - sizeof(JournalHeader)) / header.recordSize;
+        const size_t count = header.recordCount < available ? header.recordCount : available;
+
+        records.resize(count);
+        for (size_t n = 0; n < count; ++n)
+        {
+            memcpy(&records[n], data + sizeof(JournalHeader) + n * header.recordSize, sizeof(JournalRecord));
+        }
+
+        return true;
+    }
+
+    const char* GetEventName(const JournalEvent event)
+    {
+        switch (event)
+        {
+            case JournalEvent::Acquire:
+                return "acquire";
+
+            case JournalEvent::Render:
+                return "render";
+
+            case JournalEvent::Present:
+                return "present";
+
+            case JournalEvent::GpuFrame:
+                return "gpu";
+
+            case JournalEvent::Restart:
+                return "restart";
+
+            case JournalEvent::Mode:
+                return "mode";
+
+            case JournalEvent::Dump:
+                return "dump";
+
+            case JournalEvent::Count:
+            default:
+                return "unknown";
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+// Portable always-on journal of the render loop: a fixed ring of small records, one per
+// event (an acquire, a present, a duplication restart...), kept so that a stutter can be
+// looked at after the fact. Recording is a clock read, a fetch_add and a 40-byte store, so
+// it stays on in every build. The ring is dumped to a file on exit, on a crash or on a
+// hotkey, and read back with Tools/JournalDecode.cpp.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class JournalEvent : uint16_t
+{
+    Acquire,        // result: HRESULT; count: accumulated frames; value: dirty area %, negative if unknown
+    Render,         // count: driver calls; value: CPU microseconds
+    Present,        // result: HRESULT; value: area presented %; flags: JournalFlags
+    GpuFrame,       // value: copy ms; value2: draw ms; from the timestamp queries, a few frames late
+    Restart,        // result: the error that restarted the duplication, or S_OK if it wasn't one
+    Mode,           // count: the MirrorMode switched to
+    Dump,           // count: the dump's reason, a JournalDumpReason
+    Count
+};
+
+enum JournalFlags : uint16_t
+{
+    JournalPartial = 1,         // a present with dirty rects
+    JournalUnchanged = 2        // nothing in view changed, so nothing was presented
+};
+
+enum class JournalDumpReason : uint32_t
+{
+    Exit,
+    Crash,
+    HotKey
+};
+
+struct JournalRecord
+{
+    uint64_t sequence;      // position in the journal, from 1
+    int64_t time;           // FrameJournal::Now ticks
+    uint32_t frame;         // the captured frame the event belongs to
+    uint16_t event;         // JournalEvent
+    uint16_t flags;
+    int32_t result;
+    uint32_t count;
+    float value;
+    float value2;
+};
+
+struct JournalHeader
+{
+    char magic[4];          // "OMJ1"
+    uint32_t recordSize;
+    uint32_t capacity;
+    uint32_t recordCount;   // records following the header, oldest first
+    uint64_t written;       // records ever written; more than recordCount once the ring wraps
+    int64_t ticksPerSecond;
+};
+
+namespace FrameJournal
+{
+    constexpr size_t Capacity = 8192;    // a power of two
+
+    // Safe from any thread, and from the crash handler
+    void Record(JournalEvent event, uint32_t frame, int32_t result, uint32_t count,
+        float value, float value2 = 0.0f, uint16_t flags = 0);
+
+    int64_t Now();
+    int64_t GetTicksPerSecond();
+
+    // Bytes needed by Serialize for a full ring
+    size_t GetDumpSize();
+
+    // Writes the header and the ring's records, oldest first, into buffer without
+    // allocating. Records being written at the time are left out. Returns the bytes used.
+    size_t Serialize(uint8_t* buffer, size_t size);
+
+    // Reads a dump back. Returns false if it isn't one.
+    bool Parse(const uint8_t* data, size_t size, JournalHeader& header, std::vector<JournalRecord>& records);
+
+    const char* GetEventName(JournalEvent event);
+}
@@ -0,0 +1,223 @@
+#include "stdafx.h"
+#include "FrameProbe.h"
+#include "FrameStatistics.h"
+#include <algorithm>
+
+FrameProbe::FrameProbe()
+    : pool_(nullptr)
+    , mipTexture_(nullptr)
+    , mipSRV_(nullptr)
+    , slots_()
+    , sourceDesc_()
+    , level_(0)
+    , levelWidth_(0)
+    , levelHeight_(0)
+    , writeIndex_(0)
+    , readIndex_(0)
+{
+}
+
+FrameProbe::~FrameProbe()
+{
+    Destroy();
+}
+
+bool FrameProbe::Create(TexturePool* pool)
+{
+    Destroy();
+
+    pool_ = pool;
+    return pool_ != nullptr;
+}
+
+void FrameProbe::Destroy()
+{
+    ReleaseTextures();
+    pool_ = nullptr;
+}
+
+void FrameProbe::ReleaseTextures()
+{
+    // Textures only exist while there's a pool
+    for (Slot& slot : slots_)
+    {
+        if (pool_)
+        {
+            pool_->Recycle(slot.staging);
+        }
+
+        slot.pending = false;
+    }
+
+    if (pool_)
+    {
+        pool_->Recycle(mipTexture_, mipSRV_);
+    }
+
+    sourceDesc_ = D3D11_TEXTURE2D_DESC();
+    writeIndex_ = 0;
+    readIndex_ = 0;
+}
+
+bool FrameProbe::EnsureTextures(const D3D11_TEXTURE2D_DESC& sourceDesc)
+{
+    if (mipTexture_ && sourceDesc.Width == sourceDesc_.Width && sourceDesc.Height == sourceDesc_.Height &&
+        sourceDesc.Format == sourceDesc_.Format)
+    {
+        return true;
+    }
+
+    ReleaseTextures();
+
+    // The smallest level that's still at least ProbeWidth wide
+    level_ = 0;
+    while ((sourceDesc.Width >> (level_ + 1)) >= ProbeWidth && (sourceDesc.Height >> (level_ + 1)) > 0)
+    {
+        ++level_;
+    }
+
+    levelWidth_ = sourceDesc.Width >> level_;
+    levelHeight_ = sourceDesc.Height >> level_;
+
+    D3D11_TEXTURE2D_DESC desc = {};
+    desc.Width = sourceDesc.Width;
+    desc.Height = sourceDesc.Height;
+    desc.MipLevels = level_ + 1;
+    desc.ArraySize = 1;
+    desc.Format = sourceDesc.Format;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+    desc.MiscFlags = D3D11_RESOURCE_MISC_GENERATE_MIPS;
+
+    if (!pool_->Acquire(desc, &mipTexture_, &mipSRV_))
+    {
+        ReleaseTextures();
+        return false;
+    }
+
+    D3D11_TEXTURE2D_DESC stagingDesc = {};
+    stagingDesc.Width = levelWidth_;
+    stagingDesc.Height = levelHeight_;
+    stagingDesc.MipLevels = 1;
+    stagingDesc.ArraySize = 1;
+    stagingDesc.Format = sourceDesc.Format;
+    stagingDesc.SampleDesc.Count = 1;
+    stagingDesc.Usage = D3D11_USAGE_STAGING;
+    stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+
+    for (Slot& slot : slots_)
+    {
+        if (!pool_->Acquire(stagingDesc, &slot.staging, nullptr))
+        {
+            ReleaseTextures();
+            return false;
+        }
+    }
+
+    sourceDesc_ = sourceDesc;
+    return true;
+}
+
+bool FrameProbe::Queue(ID3D11DeviceContext* context, ID3D11Texture2D* source, const PixelRect& region)
+{
+    if (!pool_ || !context || !source)
+    {
+        return false;
+    }
+
+    D3D11_TEXTURE2D_DESC sourceDesc;
+    source->GetDesc(&sourceDesc);
+    if (!EnsureTextures(sourceDesc))
+    {
+        return false;
+    }
+
+    Slot& slot = slots_[writeIndex_];
+    if (slot.pending)
+    {
+        return false;
+    }
+
+    // The region in the reduced level's pixels, rounded outwards
+    const int scale = 1 << level_;
+    const PixelRect reduced = {
+        region.left / scale, region.top / scale,
+        (region.right + scale - 1) / scale, (region.bottom + scale - 1) / scale };
+
+    const PixelRect level = { 0, 0, static_cast<int>(levelWidth_), static_cast<int>(levelHeight_) };
+    if (!ViewTransform::Intersect(reduced, level, slot.region))
+    {
+        return false;
+    }
+
+    context->CopySubresourceRegion(mipTexture_, 0, 0, 0, 0, source, 0, nullptr);
+    context->GenerateMips(mipSRV_);
+    context->CopySubresourceRegion(slot.staging, 0, 0, 0, 0, mipTexture_, level_, nullptr);
+
+    slot.pending = true;
+    writeIndex_ = (writeIndex_ + 1) % RingSize;
+    return true;
+}
+
+bool FrameProbe::Read(
+    ID3D11DeviceContext* context, const ToneMapConstants& toneMap,
+    std::vector<uint8_t>& luma, int& width, int& height, PixelRect& area)
+{
+    Slot& slot = slots_[readIndex_];
+    if (!context || !slot.pending)
+    {
+        return false;
+    }
+
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    if (FAILED(context->Map(slot.staging, 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped)))
+    {
+        // DXGI_ERROR_WAS_STILL_DRAWING: try again next time
+        return false;
+    }
+
+    width = slot.region.right - slot.region.left;
+    height = slot.region.bottom - slot.region.top;
+    luma.resize(static_cast<size_t>(width) * height);
+
+    // The level's last pixels also cover any source pixels left over by the halvings
+    const int scale = 1 << level_;
+    const int sourceWidth = static_cast<int>(sourceDesc_.Width);
+    const int sourceHeight = static_cast<int>(sourceDesc_.Height);
+    area.left = slot.region.left * scale;
+    area.top = slot.region.top * scale;
+    area.right = slot.region.right == static_cast<int>(levelWidth_) ?
+        sourceWidth : (std::min)(sourceWidth, slot.region.right * scale);
+    area.bottom = slot.region.bottom == static_cast<int>(levelHeight_) ?
+        sourceHeight : (std::min)(sourceHeight, slot.region.bottom * scale);
+
+    for (int y = 0; y < height; ++y)
+    {
+        const BYTE* row = static_cast<const BYTE*>(mapped.pData) + static_cast<size_t>(slot.region.top + y) * mapped.RowPitch;
+        uint8_t* lumaRow = luma.data() + static_cast<size_t>(y) * width;
+
+        switch (sourceDesc_.Format)
+        {
+            case DXGI_FORMAT_R16G16B16A16_FLOAT:
+                FrameAnalysis::LumaFromRgba16f(
+                    reinterpret_cast<const uint16_t*>(row) + static_cast<size_t>(slot.region.left) * 4, width, toneMap, lumaRow);
+                break;
+
+            case DXGI_FORMAT_R10G10B10A2_UNORM:
+                FrameAnalysis::LumaFromRgb10a2(
+                    reinterpret_cast<const uint32_t*>(row) + slot.region.left, width, toneMap, lumaRow);
+                break;
+
+            default:
+                FrameAnalysis::LumaFromBgra8(row + static_cast<size_t>(slot.region.left) * 4, width, lumaRow);
+                break;
+        }
+    }
+
+    context->Unmap(slot.staging, 0);
+
+    slot.pending = false;
+    readIndex_ = (readIndex_ + 1) % RingSize;
+    return true;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <d3d11.h>
+#include <cstdint>
+#include <vector>
+#include "TexturePool.h"
+#include "ToneMap.h"
+#include "ViewTransform.h"
+
+// Reads back a small copy of the captured texture for FrameAnalysis. The GPU does the
+// reduction: the texture is copied into one with a mip chain, GenerateMips box-filters it
+// down, and the level about ProbeWidth wide is copied to a staging texture. Copies go into
+// a small ring and are mapped a few frames later with DO_NOT_WAIT, so the CPU never waits
+// on the GPU; if the ring is full the probe is simply skipped.
+class FrameProbe  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+public:
+    FrameProbe();
+    ~FrameProbe();
+
+    // Textures come from pool, which has to outlive this
+    bool Create(TexturePool* pool);
+    void Destroy();
+
+    // Queues a reduced copy of source. Only region, in source pixels, is measured.
+    bool Queue(ID3D11DeviceContext* context, ID3D11Texture2D* source, const PixelRect& region);
+
+    // Converts the oldest finished copy to luma, width * height samples covering area of
+    // the source. Returns false if none has finished yet.
+    bool Read(ID3D11DeviceContext* context, const ToneMapConstants& toneMap,
+        std::vector<uint8_t>& luma, int& width, int& height, PixelRect& area);
+
+    static constexpr UINT ProbeWidth = 64;
+
+private:
+    bool EnsureTextures(const D3D11_TEXTURE2D_DESC& sourceDesc);
+    void ReleaseTextures();
+
+    static constexpr int RingSize = 3;
+
+    struct Slot
+    {
+        ID3D11Texture2D* staging;
+        PixelRect region;       // in the reduced level's pixels
+        bool pending;
+    };
+
+    TexturePool* pool_;
+    ID3D11Texture2D* mipTexture_;
+    ID3D11ShaderResourceView* mipSRV_;
+    Slot slots_[RingSize];
+    D3D11_TEXTURE2D_DESC sourceDesc_;
+    UINT level_;
+    UINT levelWidth_;
+    UINT levelHeight_;
+    int writeIndex_;
+    int readIndex_;
+};
@@ -0,0 +1,137 @@
+#include "FrameStatistics.h"
+
+#include <cstring>
+
+namespace
+{
+    // BT.709 luma weights in 8.8 fixed point; they sum to 256
+    constexpr uint32_t RedWeight = 54;
+    constexpr uint32_t GreenWeight = 183;
+    constexpr uint32_t BlueWeight = 19;
+
+    uint8_t ToLuma(const float rgb[3])
+    {
+        const float luma = 0.2126f * rgb[0] + 0.7152f * rgb[1] + 0.0722f * rgb[2];
+        return static_cast<uint8_t>(luma <= 0.0f ? 0.0f : luma >= 1.0f ? 255.0f : luma * 255.0f + 0.5f);
+    }
+}
+
+constexpr int FrameStatistics::HistogramBins;
+
+namespace FrameAnalysis
+{
+    void LumaFromBgra8(const uint8_t* pixels, const size_t count, uint8_t* luma)
+    {
+        for (size_t n = 0; n < count; ++n)
+        {
+            const uint8_t* pixel = pixels + n * 4;
+            luma[n] = static_cast<uint8_t>(
+                (BlueWeight * pixel[0] + GreenWeight * pixel[1] + RedWeight * pixel[2] + 128) >> 8);
+        }
+    }
+
+    void LumaFromRgba16f(const uint16_t* pixels, const size_t count, const ToneMapConstants& toneMap, uint8_t* luma)
+    {
+        for (size_t n = 0; n < count; ++n)
+        {
+            const uint16_t* pixel = pixels + n * 4;
+            const float source[3] = { HalfToFloat(pixel[0]), HalfToFloat(pixel[1]), HalfToFloat(pixel[2]) };
+
+            float displayed[3];
+            ToneMap::Apply(toneMap, source, displayed);
+            luma[n] = ToLuma(displayed);
+        }
+    }
+
+    void LumaFromRgb10a2(const uint32_t* pixels, const size_t count, const ToneMapConstants& toneMap, uint8_t* luma)
+    {
+        for (size_t n = 0; n < count; ++n)
+        {
+            const uint32_t pixel = pixels[n];
+            const float source[3] = {
+                static_cast<float>(pixel & 0x3ff) / 1023.0f,
+                static_cast<float>((pixel >> 10) & 0x3ff) / 1023.0f,
+                static_cast<float>((pixel >> 20) & 0x3ff) / 1023.0f };
+
+            float displayed[3];
+            ToneMap::Apply(toneMap, source, displayed);
+            luma[n] = ToLuma(displayed);
+        }
+    }
+
+    void Measure(const uint8_t* luma, const uint8_t* previous, const size_t count, FrameStatistics& statistics)
+    {
+        memset(&statistics, 0, sizeof(statistics));
+        statistics.sampleCount = static_cast<uint32_t>(count);
+        if (count == 0)
+        {
+            return;
+        }
+
+        uint64_t sum = 0;
+        uint32_t dark = 0;
+        for (size_t n = 0; n < count; ++n)
+        {
+            sum += luma[n];
+            dark += luma[n] <= BlackLevel ? 1u : 0u;
+        }
+
+        for (size_t n = 0; n < count; ++n)
+        {
+            ++statistics.histogram[luma[n] >> 4];
+        }
+
+        if (previous)
+        {
+            uint32_t changed = 0;
+            for (size_t n = 0; n < count; ++n)
+            {
+                const int difference = static_cast<int>(luma[n]) - static_cast<int>(previous[n]);
+                changed += (difference > ChangeThreshold || difference < -ChangeThreshold) ? 1u : 0u;
+            }
+
+            statistics.changedFraction = static_cast<double>(changed) / static_cast<double>(count);
+        }
+
+        statistics.meanLuma = static_cast<double>(sum) / (255.0 * static_cast<double>(count));
+        statistics.darkFraction = static_cast<double>(dark) / static_cast<double>(count);
+    }
+
+    float HalfToFloat(const uint16_t value)
+    {
+        const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+        const uint32_t exponent = (value >> 10) & 0x1f;
+        uint32_t mantissa = value & 0x3ff;
+
+        uint32_t bits;
+        if (exponent == 0x1f)
+        {
+            // Infinity or NaN
+            bits = sign | 0x7f800000 | (mantissa << 13);
+        }
+        else if (exponent != 0)
+        {
+            bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+        }
+        else if (mantissa == 0)
+        {
+            bits = sign;
+        }
+        else
+        {
+            // Subnormal: normalise it
+            uint32_t shift = 0;
+            while ((mantissa & 0x400) == 0)
+            {
+                mantissa <<= 1;
+                ++shift;
+            }
+
+            bits = sign | ((113 - shift) << 23) | ((mantissa & 0x3ff) << 13);
+        }
+
+        float result;
+        memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+// Portable per-frame statistics of the mirrored feed, computed on a small downscaled copy
+// of the captured texture (see FrameProbe). Pixels are first reduced to 8-bit luma of the
+// displayed, sRGB-encoded image; the kernels are plain integer loops over contiguous
+// arrays, without branches in the inner loops, so that the compiler can vectorise them.
+
+#include <cstddef>
+#include <cstdint>
+#include "ToneMap.h"
+
+struct FrameStatistics
+{
+    static constexpr int HistogramBins = 16;
+
+    double meanLuma;            // 0..1
+    double darkFraction;        // share of samples at or below FrameAnalysis::BlackLevel
+    double changedFraction;     // share of samples that changed since the previous frame; 0 if there's none
+    uint32_t histogram[HistogramBins];
+    uint32_t sampleCount;
+};
+
+namespace FrameAnalysis
+{
+    // Luma at or below this counts as black; it's video black, allowing for encoder noise
+    constexpr uint8_t BlackLevel = 20;
+
+    // A sample has changed if its luma moved by more than this, which is above compression noise
+    constexpr uint8_t ChangeThreshold = 6;
+
+    // Convert count pixels to luma (BT.709 weights on the encoded values, as displayed).
+    // The wide formats are tone mapped first, the same way as the mirror draws them.
+    void LumaFromBgra8(const uint8_t* pixels, size_t count, uint8_t* luma);
+    void LumaFromRgba16f(const uint16_t* pixels, size_t count, const ToneMapConstants& toneMap, uint8_t* luma);
+    void LumaFromRgb10a2(const uint32_t* pixels, size_t count, const ToneMapConstants& toneMap, uint8_t* luma);
+
+    // Measures count luma samples. previous is the same area of the last frame measured,
+    // or null.
+    void Measure(const uint8_t* luma, const uint8_t* previous, size_t count, FrameStatistics& statistics);
+
+    float HalfToFloat(uint16_t value);
+}
@@ -0,0 +1,209 @@
+#include "GlyphAtlas.h"
+
+#include <cstring>
+
+namespace
+{
+    constexpr int FirstChar = 32;
+    constexpr int CharCount = 64;
+    constexpr int SolidCell = CharCount;  // first cell of the last row
+
+    // Rows top to bottom, bit 4 is the leftmost pixel
+    constexpr uint8_t Font[CharCount][GlyphAtlas::GlyphHeight] =
+    {
+        { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // space
+        { 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04 },  // !
+        { 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00 },  // "
+        { 0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A },  // #
+        { 0x04, 0x0F, 0x14, 0x0E, 0x05, 0x1E, 0x04 },  // $
+        { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 },  // %
+        { 0x0C, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0D },  // &
+        { 0x04, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00 },  // '
+        { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 },  // (
+        { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 },  // )
+        { 0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00 },  // *
+        { 0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00 },  // +
+        { 0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08 },  // ,
+        { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 },  // -
+        { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C },  // .
+        { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 },  // /
+        { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E },  // 0
+        { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E },  // 1
+        { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F },  // 2
+        { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E },  // 3
+        { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 },  // 4
+        { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E },  // 5
+        { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E },  // 6
+        { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 },  // 7
+        { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E },  // 8
+        { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C },  // 9
+        { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 },  // :
+        { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x04, 0x08 },  // ;
+        { 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02 },  // <
+        { 0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00 },  // =
+        { 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08 },  // >
+        { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04 },  // ?
+        { 0x0E, 0x11, 0x01, 0x0D, 0x15, 0x15, 0x0E },  // @
+        { 0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11 },  // A
+        { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E },  // B
+        { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E },  // C
+        { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C },  // D
+        { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F },  // E
+        { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 },  // F
+        { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F },  // G
+        { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 },  // H
+        { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E },  // I
+        { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C },  // J
+        { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 },  // K
+        { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F },  // L
+        { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 },  // M
+        { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 },  // N
+        { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E },  // O
+        { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 },  // P
+        { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D },  // Q
+        { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 },  // R
+        { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E },  // S
+        { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 },  // T
+        { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E },  // U
+        { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 },  // V
+        { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A },  // W
+        { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 },  // X
+        { 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 },  // Y
+        { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F },  // Z
+        { 0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E },  // [
+        { 0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00 },  // backslash
+        { 0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E },  // ]
+        { 0x04, 0x0A, 0x11, 0x00, 0x00, 0x00, 0x00 },  // ^
+        { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F },  // _
+    };
+
+    int CellForChar(char c)
+    {
+        if (c >= 'a' && c <= 'z')
+        {
+            c = static_cast<char>(c - 'a' + 'A');
+        }
+
+        const int index = static_cast<unsigned char>(c) - FirstChar;
+        return (index >= 0 && index < CharCount) ? index : '?' - FirstChar;
+    }
+
+    void CellUv(const int cell, const int width, const int height, GlyphQuad& quad)
+    {
+        const int cellX = (cell % GlyphAtlas::Columns) * GlyphAtlas::CellWidth;
+        const int cellY = (cell / GlyphAtlas::Columns) * GlyphAtlas::CellHeight;
+
+        quad.u0 = static_cast<float>(cellX) / GlyphAtlas::Width;
+        quad.v0 = static_cast<float>(cellY) / GlyphAtlas::Height;
+        quad.u1 = static_cast<float>(cellX + width) / GlyphAtlas::Width;
+        quad.v1 = static_cast<float>(cellY + height) / GlyphAtlas::Height;
+    }
+}
+
+void GlyphAtlas::Build(uint8_t* pixels)
+{
+    memset(pixels, 0, static_cast<size_t>(Width) * Height);
+
+    for (int cell = 0; cell < CharCount; ++cell)
+    {
+        const int cellX = (cell % Columns) * CellWidth;
+        const int cellY = (cell / Columns) * CellHeight;
+
+        for (int row = 0; row < GlyphHeight; ++row)
+        {
+            for (int col = 0; col < GlyphWidth; ++col)
+            {
+                if (Font[cell][row] & (0x10 >> col))
+                {
+                    pixels[(cellY + row) * Width + cellX + col] = 255;
+                }
+            }
+        }
+    }
+
+    const int solidX = (SolidCell % Columns) * CellWidth;
+    const int solidY = (SolidCell / Columns) * CellHeight;
+    for (int row = 0; row < CellHeight; ++row)
+    {
+        memset(pixels + (solidY + row) * Width + solidX, 255, CellWidth);
+    }
+}
+
+void GlyphAtlas::Layout(const char* text, const float x, const float y, const int scale, std::vector<GlyphQuad>& quads)
+{
+    const auto advanceX = static_cast<float>(CellWidth * scale);
+    const auto advanceY = static_cast<float>((CellHeight + 2) * scale);
+
+    float penX = x;
+    float penY = y;
+
+    for (const char* p = text; p && *p; ++p)
+    {
+        if (*p == '\n')
+        {
+            penX = x;
+            penY += advanceY;
+            continue;
+        }
+
+        if (*p != ' ')
+        {
+            GlyphQuad quad = {};
+            quad.x0 = penX;
+            quad.y0 = penY;
+            quad.x1 = penX + static_cast<float>(GlyphWidth * scale);
+            quad.y1 = penY + static_cast<float>(GlyphHeight * scale);
+            CellUv(CellForChar(*p), GlyphWidth, GlyphHeight, quad);
+            quads.push_back(quad);
+        }
+
+        penX += advanceX;
+    }
+}
+
+void GlyphAtlas::Measure(const char* text, const int scale, int& width, int& height)
+{
+    int columns = 0;
+    int maxColumns = 0;
+    int lines = text && *text ? 1 : 0;
+
+    for (const char* p = text; p && *p; ++p)
+    {
+        if (*p == '\n')
+        {
+            ++lines;
+            columns = 0;
+            continue;
+        }
+
+        ++columns;
+        if (columns > maxColumns)
+        {
+            maxColumns = columns;
+        }
+    }
+
+    width = maxColumns * CellWidth * scale;
+    height = lines > 0 ? ((lines - 1) * (CellHeight + 2) + GlyphHeight) * scale : 0;
+}
+
+GlyphQuad GlyphAtlas::SolidQuad(const float x0, const float y0, const float x1, const float y1)
+{
+    GlyphQuad quad = {};
+    quad.x0 = x0;
+    quad.y0 = y0;
+    quad.x1 = x1;
+    quad.y1 = y1;
+
+    // sample well inside the solid cell so filtering never picks up a neighbour
+    CellUv(SolidCell, CellWidth, CellHeight, quad);
+    const float insetU = 2.0f / Width;
+    const float insetV = 2.0f / Height;
+    quad.u0 += insetU;
+    quad.u1 -= insetU;
+    quad.v0 += insetV;
+    quad.v1 -= insetV;
+    quad.solid = true;
+
+    return quad;
+}
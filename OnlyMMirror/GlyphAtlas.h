@@ -0,0 +1,49 @@
+#pragma once
+
+// Portable, pre-baked 5x7 bitmap font used for text drawn inside the swap chain.
+// Covers ASCII 32-95 (upper case, digits and punctuation); lower case is folded to upper.
+
+#include <cstdint>
+#include <vector>
+
+struct GlyphQuad
+{
+    // Position in pixels
+    float x0;
+    float y0;
+    float x1;
+    float y1;
+
+    // Texture coordinates in the atlas
+    float u0;
+    float v0;
+    float u1;
+    float v1;
+
+    bool solid;     // background panel rather than a glyph
+};
+
+class GlyphAtlas
+{
+public:
+    static constexpr int GlyphWidth = 5;
+    static constexpr int GlyphHeight = 7;
+    static constexpr int CellWidth = 6;
+    static constexpr int CellHeight = 8;
+    static constexpr int Columns = 16;
+    static constexpr int Rows = 5;
+    static constexpr int Width = Columns * CellWidth;
+    static constexpr int Height = Rows * CellHeight;
+
+    // Writes Width * Height 8-bit coverage values (0 or 255).
+    static void Build(uint8_t* pixels);
+
+    // Appends one quad per visible character; '\n' starts a new line. Scale is an integer
+    // pixel multiplier so glyphs stay crisp with point sampling.
+    static void Layout(const char* text, float x, float y, int scale, std::vector<GlyphQuad>& quads);
+
+    static void Measure(const char* text, int scale, int& width, int& height);
+
+    // Quad covering the given pixel rect that samples a fully-covered texel.
+    static GlyphQuad SolidQuad(float x0, float y0, float x1, float y1);
+};
@@ -0,0 +1,194 @@
+#include "stdafx.h"
+#include "GpuTimer.h"
+
+namespace
+{
+    void SafeReleaseQuery(ID3D11Query*& query)
+    {
+        if (query) { query->Release(); query = nullptr; }
+    }
+}
+
+GpuTimer::GpuTimer()
+    : frames_()
+    , writeIndex_(0)
+    , readIndex_(0)
+    , frameOpen_(false)
+    , frameSkipped_(false)
+{
+}
+
+GpuTimer::~GpuTimer()
+{
+    Destroy();
+}
+
+bool GpuTimer::Create(ID3D11Device* device)
+{
+    Destroy();
+
+    D3D11_QUERY_DESC disjointDesc = {};
+    disjointDesc.Query = D3D11_QUERY_TIMESTAMP_DISJOINT;
+
+    D3D11_QUERY_DESC timestampDesc = {};
+    timestampDesc.Query = D3D11_QUERY_TIMESTAMP;
+
+    for (FrameQueries& frame : frames_)
+    {
+        if (FAILED(device->CreateQuery(&disjointDesc, &frame.disjoint)) ||
+            FAILED(device->CreateQuery(&timestampDesc, &frame.start)))
+        {
+            Destroy();
+            return false;
+        }
+
+        for (ID3D11Query*& query : frame.stageEnd)
+        {
+            if (FAILED(device->CreateQuery(&timestampDesc, &query)))
+            {
+                Destroy();
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void GpuTimer::Destroy()
+{
+    for (FrameQueries& frame : frames_)
+    {
+        SafeReleaseQuery(frame.disjoint);
+        SafeReleaseQuery(frame.start);
+        for (ID3D11Query*& query : frame.stageEnd)
+        {
+            SafeReleaseQuery(query);
+        }
+
+        frame.pending = false;
+    }
+
+    writeIndex_ = 0;
+    readIndex_ = 0;
+    frameOpen_ = false;
+    frameSkipped_ = false;
+}
+
+void GpuTimer::BeginFrame(ID3D11DeviceContext* context)
+{
+    FrameQueries& frame = frames_[writeIndex_];
+    if (!frame.disjoint || frame.pending)
+    {
+        // Not created, or the GPU is more than FrameLatency frames behind
+        frameSkipped_ = frame.disjoint != nullptr;
+        frameOpen_ = false;
+        return;
+    }
+
+    for (bool& used : frame.stageUsed)
+    {
+        used = false;
+    }
+
+    context->Begin(frame.disjoint);
+    context->End(frame.start);
+    frameOpen_ = true;
+    frameSkipped_ = false;
+}
+
+void GpuTimer::EndStage(ID3D11DeviceContext* context, const GpuStage stage)
+{
+    if (!frameOpen_)
+    {
+        return;
+    }
+
+    FrameQueries& frame = frames_[writeIndex_];
+    const int index = static_cast<int>(stage);
+    context->End(frame.stageEnd[index]);
+    frame.stageUsed[index] = true;
+}
+
+void GpuTimer::EndFrame(ID3D11DeviceContext* context)
+{
+    if (!frameOpen_)
+    {
+        return;
+    }
+
+    FrameQueries& frame = frames_[writeIndex_];
+    context->End(frame.disjoint);
+    frame.pending = true;
+    frameOpen_ = false;
+    writeIndex_ = (writeIndex_ + 1) % FrameLatency;
+}
+
+void GpuTimer::Collect(ID3D11DeviceContext* context, MirrorStats& stats)
+{
+    if (frameSkipped_)
+    {
+        ++stats.gpuFramesDropped;
+        frameSkipped_ = false;
+    }
+
+    while (frames_[readIndex_].pending)
+    {
+        FrameQueries& frame = frames_[readIndex_];
+
+        D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint;
+        if (context->GetData(frame.disjoint, &disjoint, sizeof(disjoint), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+        {
+            // oldest frame still in flight, so later ones will be too
+            return;
+        }
+
+        UINT64 start = 0;
+        bool valid = !disjoint.Disjoint && disjoint.Frequency != 0 &&
+            context->GetData(frame.start, &start, sizeof(start), D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK;
+
+        // Stages are issued in order, so each stage runs from the previous mark to its own.
+        UINT64 previous = start;
+        double stageMs[StageCount] = {};
+        bool anyStage = false;
+        for (int n = 0; n < StageCount && valid; ++n)
+        {
+            if (!frame.stageUsed[n])
+            {
+                continue;
+            }
+
+            UINT64 end = 0;
+            valid = context->GetData(frame.stageEnd[n], &end, sizeof(end), D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK;
+            if (valid)
+            {
+                stageMs[n] = static_cast<double>(end - previous) * 1000.0 / static_cast<double>(disjoint.Frequency);
+                previous = end;
+                anyStage = true;
+            }
+        }
+
+        if (valid && anyStage)
+        {
+            for (int n = 0; n < StageCount; ++n)
+            {
+                if (frame.stageUsed[n])
+                {
+                    stats.gpuStageMs[n].Add(stageMs[n]);
+                }
+            }
+
+            const double frameMs = static_cast<double>(previous - start) * 1000.0 / static_cast<double>(disjoint.Frequency);
+            stats.gpuFrameMs.Add(frameMs);
+            stats.gpuBusyMs += frameMs;
+            ++stats.gpuFramesTimed;
+        }
+        else if (!valid)
+        {
+            ++stats.gpuFramesDropped;
+        }
+
+        frame.pending = false;
+        readIndex_ = (readIndex_ + 1) % FrameLatency;
+    }
+}
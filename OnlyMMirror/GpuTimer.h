@@ -0,0 +1,42 @@
+#pragma once
+#include <d3d11.h>
+#include "MirrorStats.h"
+
+// Timestamp-query instrumentation of the render loop's GPU stages. Queries are issued
+// into a small ring and read back several frames later with DONOTFLUSH, so the CPU
+// never waits on the GPU; if the ring is full the frame simply isn't timed.
+class GpuTimer  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+public:
+    GpuTimer();
+    ~GpuTimer();
+
+    bool Create(ID3D11Device* device);
+    void Destroy();
+
+    void BeginFrame(ID3D11DeviceContext* context);
+    void EndStage(ID3D11DeviceContext* context, GpuStage stage);
+    void EndFrame(ID3D11DeviceContext* context);
+
+    // Reads back any completed frames into stats.
+    void Collect(ID3D11DeviceContext* context, MirrorStats& stats);
+
+private:
+    static constexpr int FrameLatency = 4;
+    static constexpr int StageCount = static_cast<int>(GpuStage::Count);
+
+    struct FrameQueries
+    {
+        ID3D11Query* disjoint;
+        ID3D11Query* start;
+        ID3D11Query* stageEnd[StageCount];
+        bool stageUsed[StageCount];
+        bool pending;
+    };
+
+    FrameQueries frames_[FrameLatency];
+    int writeIndex_;
+    int readIndex_;
+    bool frameOpen_;
+    bool frameSkipped_;
+};
@@ -1,11 +1,26 @@
 #include "stdafx.h"
 #include "HostWindow.h"
+#include <cmath>
 #include <strsafe.h>
+#include <windowsx.h>
+
+namespace
+{
+    // How often to re-check whether the thumbnail can be used (and how long to
+    // wait for messages between checks while it is)
+    constexpr DWORD ModeCheckIntervalMs = 100;
+
+    bool IsCloaked(const HWND window)
+    {
+        DWORD cloaked = 0;
+        return SUCCEEDED(DwmGetWindowAttribute(window, DWMWA_CLOAKED, &cloaked, sizeof(cloaked))) && cloaked != 0;
+    }
+}
 
 const TCHAR* HostWindow::GetWindowClassName() { return TEXT("OnlyMMirrorWindow"); }
 
 HostWindow::HostWindow()
-    : windowHandle_(nullptr), instructionsWindowHeight_(0), zoomFactor_(1.0f), hInstance_(nullptr)
+    : windowHandle_(nullptr), lastModeCheck_(0), windowCaptureSupported_(false), zoomFactor_(1.0f), hInstance_(nullptr), displayChanged_(false)
 {
     ZeroMemory(&targetMonitorRect_, sizeof(targetMonitorRect_));
 }
@@ -34,23 +49,24 @@ bool HostWindow::Create(
     const float zoomFactor, 
     const RECT& targetMonitorRect,
     const TCHAR hotKey,
-    const char* targetMonitorName)
+    const char* targetMonitorName,
+    const std::vector<std::string>& paneMonitorNames)
 {
     Destroy();
 
     hInstance_ = instance;
     zoomFactor_ = zoomFactor;
     targetMonitorRect_ = targetMonitorRect;
-    instructionsWindowHeight_ = InstructionsWindow::CalculateInstructionsWindowHeight();
+    windowCaptureSupported_ = WindowCapture::IsSupported();
 
     RegisterWindowClass();
 
-    // create host window...
+    // create host window; it never takes the focus from OnlyM...
     windowHandle_ = CreateWindowEx(
-        WS_EX_TOPMOST | WS_EX_TOOLWINDOW,
+        WS_EX_TOPMOST | WS_EX_TOOLWINDOW | WS_EX_NOACTIVATE,
         GetWindowClassName(),
         TEXT("OnlyM Mirror"),
-        WS_CLIPCHILDREN | WS_CAPTION | WS_DISABLED,
+        WS_CLIPCHILDREN | WS_CAPTION,
         x, y, width, height,
         nullptr,
         nullptr,
@@ -65,22 +81,24 @@ bool HostWindow::Create(
     RECT clientRect;
     GetClientRect(windowHandle_, &clientRect);
 
+    // the duplication window's swap chain covers the whole client area, including the instructions strip
+    duplicationWindow_.SetTargetMonitorRect(targetMonitorRect_);
+    duplicationWindow_.SetSourceRect(targetMonitorRect_);
+    duplicationWindow_.SetInstructionsHotKey(hotKey);
+    duplicationWindow_.SetDpi(GetDpiForWindow(windowHandle_));
+    // Returns straight away; in tiled mode the other media monitors are duplicated beside the target
     duplicationWindow_.Create(
         windowHandle_, hInstance_, 
-        0, 0, clientRect.right, clientRect.bottom - instructionsWindowHeight_,
-        targetMonitorName);
-
-    instructionsWindow_.Create(
-        windowHandle_, hInstance_, 
-        clientRect.bottom - instructionsWindowHeight_, clientRect.right, instructionsWindowHeight_,
-        hotKey);
+        0, 0, clientRect.right, clientRect.bottom,
+        targetMonitorName, paneMonitorNames);
 
     return duplicationWindow_.SetTransform(zoomFactor_);    
 }
 
 void HostWindow::Destroy()
 {
-    instructionsWindow_.Destroy();
+    thumbnail_.Unregister();
+    latencyPattern_.Destroy();
     duplicationWindow_.Destroy();
     if (windowHandle_)
     {
@@ -103,7 +121,8 @@ void HostWindow::Update() const
 {
     if (windowHandle_)
     {
-        UpdateWindow(windowHandle_);
+        // Paints the children too, so the placeholder is up before the window counts as shown
+        RedrawWindow(windowHandle_, nullptr, nullptr, RDW_UPDATENOW | RDW_ALLCHILDREN);
     }
 }
 
@@ -127,11 +146,325 @@ void HostWindow::UpdateMirror(const RECT& sourceRect)
 {
     duplicationWindow_.SetSourceRect(sourceRect);
     SetTopMost();
+
+    if (!duplicationWindow_.IsReady())
+    {
+        // Still starting up; the worker threads post a message when they're done
+        MsgWaitForMultipleObjects(0, nullptr, FALSE, ModeCheckIntervalMs, QS_ALLINPUT);
+        return;
+    }
+
+    SelectMode();
+
+    if (latencyPattern_.IsCreated())
+    {
+        latencyPattern_.Draw();
+    }
     
     // Trigger a frame update
     duplicationWindow_.UpdateFrame();
-    
-    InvalidateRect(duplicationWindow_.GetWindowHandle(), nullptr, TRUE);
+
+    if (thumbnail_.IsRegistered())
+    {
+        // DWM composes the thumbnail so there's nothing to do per frame; don't spin the message loop
+        MsgWaitForMultipleObjects(0, nullptr, FALSE, ModeCheckIntervalMs, QS_ALLINPUT);
+    }
+    else
+    {
+        InvalidateRect(duplicationWindow_.GetWindowHandle(), nullptr, TRUE);
+    }
+}
+
+bool HostWindow::Rebind(
+    const RECT& targetMonitorRect, const char* targetMonitorName, const std::vector<std::string>& paneMonitorNames)
+{
+    targetMonitorRect_ = targetMonitorRect;
+
+    // The thumbnail's geometry belongs to the old layout; the next mode check re-registers it
+    thumbnail_.Unregister();
+    lastModeCheck_ = 0;
+
+    const bool rebound = duplicationWindow_.Rebind(targetMonitorName, targetMonitorRect, paneMonitorNames);
+    if (latencyPattern_.IsCreated())
+    {
+        latencyPattern_.Move(targetMonitorRect_);
+        duplicationWindow_.SetLatencyPattern(latencyPattern_.GetRect());
+    }
+
+    return rebound;
+}
+
+void HostWindow::Reposition(const int x, const int y, const int width, const int height, const float zoomFactor)
+{
+    zoomFactor_ = zoomFactor;
+    duplicationWindow_.SetTransform(zoomFactor_);
+
+    // The resulting WM_SIZE resizes the swap chain buffers; nothing is recreated
+    SetWindowPos(windowHandle_, nullptr, x, y, width, height, SWP_NOZORDER | SWP_NOACTIVATE);
+}
+
+bool HostWindow::TakeDisplayChange()
+{
+    const bool changed = displayChanged_;
+    displayChanged_ = false;
+    return changed;
+}
+
+void HostWindow::SelectMode()
+{
+    const ULONGLONG now = GetTickCount64();
+    if (now - lastModeCheck_ < ModeCheckIntervalMs)
+    {
+        return;
+    }
+
+    lastModeCheck_ = now;
+
+    HWND mediaWindow = nullptr;
+    const MirrorMode mode = ChooseMode(mediaWindow);
+
+    RECT coveredRect;
+    duplicationWindow_.SetMediaShowing(GetMediaRect(mediaWindow, coveredRect));
+
+    if (mode == MirrorMode::Thumbnail)
+    {
+        const bool registered = thumbnail_.GetSource() == mediaWindow || thumbnail_.Register(windowHandle_, mediaWindow);
+        if (registered && UpdateThumbnail())
+        {
+            duplicationWindow_.SetMode(MirrorMode::Thumbnail);
+            return;
+        }
+    }
+
+    thumbnail_.Unregister();
+
+    if (mode == MirrorMode::WindowCapture)
+    {
+        duplicationWindow_.SetMode(MirrorMode::WindowCapture);
+        if (duplicationWindow_.SetCaptureWindow(mediaWindow))
+        {
+            return;
+        }
+
+        // e.g. capture blocked by policy; don't keep retrying
+        windowCaptureSupported_ = false;
+    }
+
+    duplicationWindow_.SetMode(MirrorMode::Duplication);
+}
+
+bool HostWindow::UpdateThumbnail()
+{
+    RECT mediaRect;
+    if (!thumbnail_.IsRegistered() || !GetWindowRect(thumbnail_.GetSource(), &mediaRect))
+    {
+        return false;
+    }
+
+    // The part of the target monitor in view, relative to the media window
+    const PixelRect region = duplicationWindow_.GetView().GetRegion();
+    RECT sourceRect = { region.left, region.top, region.right, region.bottom };
+    OffsetRect(&sourceRect, -mediaRect.left, -mediaRect.top);
+
+    // Scaled into the target's tile, letterboxed like the other modes
+    const PixelRect tile = duplicationWindow_.GetPrimaryTile();
+    const RECT destinationRect = { tile.left, tile.top, tile.right, tile.bottom };
+
+    return thumbnail_.Update(sourceRect, destinationRect);
+}
+
+bool HostWindow::GetMediaRect(const HWND mediaWindow, RECT& coveredRect) const
+{
+    if (!mediaWindow || !IsWindowVisible(mediaWindow) || IsIconic(mediaWindow) || IsCloaked(mediaWindow))
+    {
+        return false;
+    }
+
+    RECT mediaRect;
+    return GetWindowRect(mediaWindow, &mediaRect) && IntersectRect(&coveredRect, &mediaRect, &targetMonitorRect_);
+}
+
+MirrorMode HostWindow::ChooseMode(HWND& mediaWindow) const
+{
+    // this is a little fragile because it depends on the OnlyM media window title
+    mediaWindow = ::FindWindow(nullptr, "OnlyM Media Window");
+
+    RECT coveredRect;
+    if (!GetMediaRect(mediaWindow, coveredRect))
+    {
+        return MirrorMode::Duplication;
+    }
+
+    // The latency pattern is only in the desktop image
+    if (latencyPattern_.IsCreated())
+    {
+        return MirrorMode::Duplication;
+    }
+
+    // Anything visible above the media window on the target monitor would be missing from
+    // both the thumbnail and a capture of the window alone
+    for (HWND window = GetTopWindow(nullptr); window && window != mediaWindow; window = GetWindow(window, GW_HWNDNEXT))
+    {
+        if (window == windowHandle_ || !IsWindowVisible(window) || IsCloaked(window))
+        {
+            continue;
+        }
+
+        RECT windowRect;
+        RECT overlapRect;
+        if (GetWindowRect(window, &windowRect) && IntersectRect(&overlapRect, &windowRect, &targetMonitorRect_))
+        {
+            return MirrorMode::Duplication;
+        }
+    }
+
+    if (EqualRect(&coveredRect, &targetMonitorRect_))
+    {
+        // The mouse pointer isn't part of the thumbnail, so use duplication while it's on the
+        // target. Likewise while the lens is on, since it's drawn from the captured frame, when
+        // tiled, since the other panes keep the render loop running anyway, and while a feed
+        // alert's banner has to be drawn over the mirror.
+        POINT cursorPos;
+        const bool pointerOnTarget = GetCursorPos(&cursorPos) && PtInRect(&targetMonitorRect_, cursorPos);
+        return pointerOnTarget || duplicationWindow_.GetLens().IsEnabled() || duplicationWindow_.IsTiled() ||
+            duplicationWindow_.GetFeedAlert() != FeedAlert::None
+            ? MirrorMode::Duplication
+            : MirrorMode::Thumbnail;
+    }
+
+    // The media window only fills part of the monitor; copy just that part
+    return windowCaptureSupported_ ? MirrorMode::WindowCapture : MirrorMode::Duplication;
+}
+
+void HostWindow::ToggleHud()
+{
+    duplicationWindow_.ToggleHud();
+}
+
+void HostWindow::ZoomView(const double factor)
+{
+    if (duplicationWindow_.GetView().Zoom(factor))
+    {
+        OnViewChanged();
+    }
+}
+
+void HostWindow::PanView(const double dx, const double dy)
+{
+    if (duplicationWindow_.GetView().Pan(dx, dy))
+    {
+        OnViewChanged();
+    }
+}
+
+void HostWindow::ResetView()
+{
+    duplicationWindow_.GetView().Reset();
+    OnViewChanged();
+}
+
+void HostWindow::ShowActualSize()
+{
+    if (duplicationWindow_.ShowActualSize())
+    {
+        OnViewChanged();
+    }
+}
+
+void HostWindow::ToggleLens()
+{
+    duplicationWindow_.GetLens().Toggle();
+
+    // The lens needs a captured frame, so re-check the mode now rather than leave the thumbnail up
+    lastModeCheck_ = 0;
+}
+
+void HostWindow::ToggleLensShape()
+{
+    duplicationWindow_.GetLens().ToggleShape();
+}
+
+void HostWindow::ReduceLens()
+{
+    duplicationWindow_.GetLens().Reduce();
+}
+
+void HostWindow::EnlargeLens()
+{
+    duplicationWindow_.GetLens().Enlarge();
+}
+
+void HostWindow::ToggleLatencyCalibration()
+{
+    if (latencyPattern_.IsCreated())
+    {
+        latencyPattern_.Destroy();
+    }
+    else
+    {
+        latencyPattern_.Create(hInstance_, targetMonitorRect_);
+    }
+
+    // An empty rect when it's off
+    duplicationWindow_.SetLatencyPattern(latencyPattern_.GetRect());
+
+    // The pattern has to be captured, so leave the thumbnail and window capture now
+    lastModeCheck_ = 0;
+}
+
+void HostWindow::TakeSnapshot()
+{
+    duplicationWindow_.TakeSnapshot();
+}
+
+void HostWindow::ToggleBorderCrop()
+{
+    duplicationWindow_.ToggleBorderCrop();
+    OnViewChanged();
+}
+
+void HostWindow::OnViewChanged()
+{
+    // Duplication and window capture pick up the new view on their next frame
+    if (thumbnail_.IsRegistered())
+    {
+        UpdateThumbnail();
+    }
+}
+
+bool HostWindow::GetMirrorScreenRect(RECT& rect) const
+{
+    if (!windowHandle_)
+    {
+        return false;
+    }
+
+    // The target's part of the mirror (the duplication window fills the client area)
+    const PixelRect tile = duplicationWindow_.GetPrimaryTile();
+    rect = { tile.left, tile.top, tile.right, tile.bottom };
+    MapWindowPoints(windowHandle_, nullptr, reinterpret_cast<POINT*>(&rect), 2);
+    return rect.bottom > rect.top;
+}
+
+bool HostWindow::OnMouseWheel(const POINT& point, const int delta)
+{
+    RECT mirrorRect;
+    if (!GetMirrorScreenRect(mirrorRect) || !PtInRect(&mirrorRect, point))
+    {
+        return false;
+    }
+
+    // Zoom about the point under the pointer
+    const double fx = static_cast<double>(point.x - mirrorRect.left) / (mirrorRect.right - mirrorRect.left);
+    const double fy = static_cast<double>(point.y - mirrorRect.top) / (mirrorRect.bottom - mirrorRect.top);
+    const double factor = pow(ZoomStep, static_cast<double>(delta) / WHEEL_DELTA);
+
+    if (duplicationWindow_.GetView().Zoom(factor, fx, fy))
+    {
+        OnViewChanged();
+    }
+
+    return true;
 }
 
 void HostWindow::PositionCursor() const
@@ -160,22 +493,37 @@ void HostWindow::RepositionCursor()
 
 DuplicationWindow& HostWindow::GetDuplicationWindow() { return duplicationWindow_; }
 
-InstructionsWindow& HostWindow::GetInstructionsWindow() { return instructionsWindow_; }
-
-void HostWindow::OnSize() const
+void HostWindow::OnSize()
 {
-    if (duplicationWindow_.GetWindowHandle() && instructionsWindow_.GetWindowHandle())
+    if (duplicationWindow_.GetWindowHandle())
     {
         RECT clientRect;
         GetClientRect(windowHandle_, &clientRect);
-        duplicationWindow_.Resize(0, 0, clientRect.right, clientRect.bottom - instructionsWindowHeight_);
-        instructionsWindow_.Resize(0, clientRect.bottom - instructionsWindowHeight_, clientRect.right, instructionsWindowHeight_);
+        duplicationWindow_.Resize(0, 0, clientRect.right, clientRect.bottom);
+    }
+
+    if (thumbnail_.IsRegistered())
+    {
+        UpdateThumbnail();
     }
 }
 
+void HostWindow::OnDpiChanged(const UINT dpi, const RECT& suggestedRect)
+{
+    duplicationWindow_.SetDpi(dpi);
+
+    // The resulting WM_SIZE resizes the swap chain buffers to the new physical size
+    SetWindowPos(
+        windowHandle_, nullptr,
+        suggestedRect.left, suggestedRect.top,
+        suggestedRect.right - suggestedRect.left, suggestedRect.bottom - suggestedRect.top,
+        SWP_NOZORDER | SWP_NOACTIVATE);
+}
+
 void HostWindow::OnDestroy()
 {
-    instructionsWindow_.Destroy();
+    thumbnail_.Unregister();
+    latencyPattern_.Destroy();
     duplicationWindow_.Destroy();
     PostQuitMessage(0);
 }
@@ -206,6 +554,26 @@ LRESULT CALLBACK HostWindow::WindowProc(HWND windowHandle, UINT message, WPARAM
             SetCursor(nullptr);
             return TRUE;
 
+        case WM_NCHITTEST:
+        {
+            // The caption can't be dragged, so the window stays where it was put
+            const LRESULT hit = DefWindowProc(windowHandle, message, wParam, lParam);
+            return hit == HTCAPTION ? HTCLIENT : hit;
+        }
+
+        case WM_MOUSEACTIVATE:
+            // Clicking the mirror leaves the focus with OnlyM
+            return MA_NOACTIVATE;
+
+        case WM_MOUSEWHEEL:
+        {
+            // The window never has the focus, so this is the wheel over it (Windows scrolls
+            // the window under the pointer); the mirror's child passes it up
+            const POINT point = { GET_X_LPARAM(lParam), GET_Y_LPARAM(lParam) };
+            self->OnMouseWheel(point, GET_WHEEL_DELTA_WPARAM(wParam));
+            break;
+        }
+
         case WM_DESTROY:
             self->OnDestroy();
             break;
@@ -214,6 +582,15 @@ LRESULT CALLBACK HostWindow::WindowProc(HWND windowHandle, UINT message, WPARAM
             self->OnSize();
             break;
 
+        case WM_DISPLAYCHANGE:
+            // Acted on from the message loop once the topology has settled
+            self->displayChanged_ = true;
+            break;
+
+        case WM_DPICHANGED:
+            self->OnDpiChanged(HIWORD(wParam), *reinterpret_cast<const RECT*>(lParam));  // NOLINT(performance-no-int-to-ptr)
+            break;
+
         default:
             return DefWindowProc(windowHandle, message, wParam, lParam);
     }
@@ -1,7 +1,10 @@
 #pragma once
 #include <windows.h>
+#include <string>
+#include <vector>
 #include "DuplicationWindow.h"
-#include "InstructionsWindow.h"
+#include "LatencyPatternWindow.h"
+#include "ThumbnailMirror.h"
 
 class HostWindow  // NOLINT(cppcoreguidelines-special-member-functions)
 {
@@ -15,7 +18,8 @@ public:
         float zoomFactor, 
         const RECT& targetMonitorRect, 
         TCHAR hotKey,
-        const char* targetMonitorName = nullptr);
+        const char* targetMonitorName = nullptr,
+        const std::vector<std::string>& paneMonitorNames = std::vector<std::string>());
 
     void Destroy();
     HWND GetWindowHandle() const;
@@ -24,10 +28,40 @@ public:
     void SetCaption(const TCHAR* caption) const;
     void SetTopMost() const;
     void UpdateMirror(const RECT& sourceRect);
+
+    // After a display topology change: mirrors the target (and tiled monitors) where they
+    // are now, and moves the window. The mirror's device and swap chain are kept.
+    bool Rebind(
+        const RECT& targetMonitorRect, const char* targetMonitorName, const std::vector<std::string>& paneMonitorNames);
+    void Reposition(int x, int y, int width, int height, float zoomFactor);
+
+    // True once after each WM_DISPLAYCHANGE
+    bool TakeDisplayChange();
+
+    void ToggleHud();
+    void ZoomView(double factor);
+    void PanView(double dx, double dy);
+    void ResetView();
+    void ShowActualSize();
+    void ToggleLens();
+    void ToggleLensShape();
+    void ReduceLens();
+    void EnlargeLens();
+
+    // Shows or hides the glass-to-glass latency pattern on the target
+    void ToggleLatencyCalibration();
+
+    // Saves what the mirror is showing to the Pictures folder, in the background
+    void TakeSnapshot();
+
+    // Crops letterbox and pillarbox borders from the view, or stops cropping them
+    void ToggleBorderCrop();
     void PositionCursor() const;
     static void RepositionCursor();
     DuplicationWindow& GetDuplicationWindow();
-    InstructionsWindow& GetInstructionsWindow();
+
+    // Each wheel notch or zoom key press zooms the view by this much
+    static constexpr double ZoomStep = 1.25;
 
     static LRESULT CALLBACK WindowProc(HWND windowHandle, UINT message, WPARAM wParam, LPARAM lParam);
     static const TCHAR* GetWindowClassName();
@@ -35,12 +69,25 @@ public:
 private:
     HWND windowHandle_;
     DuplicationWindow duplicationWindow_;
-    InstructionsWindow instructionsWindow_;
-    int instructionsWindowHeight_;
+    ThumbnailMirror thumbnail_;
+    LatencyPatternWindow latencyPattern_;
+    ULONGLONG lastModeCheck_;
+    bool windowCaptureSupported_;
     float zoomFactor_;
     RECT targetMonitorRect_;
     HINSTANCE hInstance_;
-    void OnSize() const;
+    bool displayChanged_;
+    void SelectMode();
+    bool UpdateThumbnail();
+    MirrorMode ChooseMode(HWND& mediaWindow) const;
+
+    // The part of the target monitor the media window covers; false if it isn't showing there
+    bool GetMediaRect(HWND mediaWindow, RECT& coveredRect) const;
+    bool GetMirrorScreenRect(RECT& rect) const;
+    bool OnMouseWheel(const POINT& point, int delta);
+    void OnViewChanged();
+    void OnSize();
+    void OnDpiChanged(UINT dpi, const RECT& suggestedRect);
     void OnDestroy();
     void RegisterWindowClass() const;
 };
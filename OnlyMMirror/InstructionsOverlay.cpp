@@ -0,0 +1,260 @@
+#include "stdafx.h"
+#include "InstructionsOverlay.h"
+
+#include <cstdio>
+#include <tchar.h>
+
+namespace
+{
+    constexpr COLORREF backgroundColour = RGB(255, 255, 192);
+    constexpr COLORREF textColour = RGB(0, 0, 0);
+
+    HFONT CreateInstructionsFont(const int weight, const UINT dpi)
+    {
+        // NB - LOGPIXELSY is the system DPI, not the DPI of the monitor we're on
+        constexpr int fontPointSize = 12;
+        const int fontHeight = -MulDiv(fontPointSize, static_cast<int>(dpi), 72);
+
+        return CreateFont(
+            fontHeight, 0, 0, 0, weight, FALSE, FALSE, FALSE,
+            ANSI_CHARSET, OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS,
+            DEFAULT_QUALITY, DEFAULT_PITCH, TEXT("Segoe UI"));
+    }
+}
+
+InstructionsOverlay::InstructionsOverlay()
+    : device_(nullptr)
+    , texture_(nullptr)
+    , textureSRV_(nullptr)
+    , fontHandle_(nullptr)
+    , boldFontHandle_(nullptr)
+    , text_()
+    , height_(0)
+    , textureWidth_(0)
+    , textureHeight_(0)
+    , dirty_(true)
+{
+}
+
+InstructionsOverlay::~InstructionsOverlay()
+{
+    Destroy();
+}
+
+int InstructionsOverlay::CalculateHeight(const UINT dpi)
+{
+    const int lineHeight = GetSystemMetricsForDpi(SM_CYMENU, dpi); // Standard menu text height
+    return 4 * lineHeight; // For 4 lines of text
+}
+
+bool InstructionsOverlay::Create(ID3D11Device* device, const UINT dpi)
+{
+    Destroy();
+
+    device_ = device;
+    return SetDpi(dpi);
+}
+
+bool InstructionsOverlay::SetDpi(const UINT dpi)
+{
+    DeleteFonts();
+
+    height_ = CalculateHeight(dpi);
+    fontHandle_ = CreateInstructionsFont(FW_NORMAL, dpi);
+    boldFontHandle_ = CreateInstructionsFont(FW_BOLD, dpi);
+    dirty_ = true;
+
+    return fontHandle_ != nullptr && boldFontHandle_ != nullptr;
+}
+
+void InstructionsOverlay::SetHotKey(const TCHAR hotKey)
+{
+    TCHAR altZ[128];
+    _stprintf_s(altZ, TEXT("Press ALT+%c to close Mirror Window (ALT+SHIFT+%c - performance overlay)"), hotKey, hotKey);
+
+    TCHAR magnifierText[128];
+    _stprintf_s(magnifierText, TEXT("Magnifier: F1 - on/off, F2 - square/circle, F3 - reduce, F4 - enlarge (mirror lens: ALT+SHIFT+F1 to F4)"));
+
+    TCHAR pageZoomText[128];
+    _stprintf_s(pageZoomText, TEXT("Page: Ctrl+Plus - zoom in, Ctrl+Minus - zoom out, Ctrl+0 - reset zoom"));
+
+    TCHAR viewText[128];
+    _stprintf_s(viewText, TEXT("Mirror: wheel - zoom; ALT+SHIFT+M, then ALT+SHIFT with Plus/Minus - zoom, arrows - pan, 1 - actual size, 0 - reset"));
+
+    _stprintf_s(text_, TEXT("%s\r\n%s\r\n%s\r\n%s"), altZ, magnifierText, pageZoomText, viewText);
+    dirty_ = true;
+}
+
+int InstructionsOverlay::GetHeight() const
+{
+    return height_;
+}
+
+ID3D11ShaderResourceView* InstructionsOverlay::GetShaderResourceView(ID3D11DeviceContext* context, const int width)
+{
+    if ((dirty_ || width != textureWidth_) && !Rasterise(context, width))
+    {
+        return nullptr;
+    }
+
+    return textureSRV_;
+}
+
+bool InstructionsOverlay::Rasterise(ID3D11DeviceContext* context, const int width)
+{
+    if (!device_ || width <= 0 || height_ <= 0)
+    {
+        return false;
+    }
+
+    const HDC hdcScreen = GetDC(nullptr);
+    const HDC hdc = CreateCompatibleDC(hdcScreen);
+
+    BITMAPINFO bmi = {};
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = width;
+    bmi.bmiHeader.biHeight = -height_; // Top-down DIB
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+
+    void* pixels = nullptr;
+    const HBITMAP bitmap = CreateDIBSection(hdcScreen, &bmi, DIB_RGB_COLORS, &pixels, nullptr, 0);
+    if (!bitmap)
+    {
+        DeleteDC(hdc);
+        ReleaseDC(nullptr, hdcScreen);
+        return false;
+    }
+
+    const HBITMAP oldBitmap = static_cast<HBITMAP>(SelectObject(hdc, bitmap));
+
+    RECT rc = { 0, 0, width, height_ };
+
+    // Fill the background with yellow
+    const HBRUSH brush = CreateSolidBrush(backgroundColour);
+    FillRect(hdc, &rc, brush);
+    DeleteObject(brush);
+
+    constexpr int padding = 8;
+    rc.left += padding;
+    rc.top += padding;
+    rc.right -= padding;
+    rc.bottom -= padding;
+
+    SetBkColor(hdc, backgroundColour);
+    SetTextColor(hdc, textColour);
+
+    TCHAR buffer[512];
+    _tcscpy_s(buffer, text_);
+
+    // Split into lines; the first is bold
+    TCHAR* tokenContext = nullptr;
+    const TCHAR* line = _tcstok_s(buffer, TEXT("\r\n"), &tokenContext);
+    RECT lineRect = rc;
+    bool firstLine = true;
+
+    while (line)
+    {
+        const HFONT font = firstLine ? boldFontHandle_ : fontHandle_;
+        const HFONT oldFont = static_cast<HFONT>(SelectObject(hdc, font));
+
+        SIZE sz;
+        GetTextExtentPoint32(hdc, line, static_cast<int>(_tcslen(line)), &sz);
+
+        DrawText(hdc, line, -1, &lineRect, DT_LEFT | DT_TOP | DT_NOPREFIX | DT_SINGLELINE);  // NOLINT(misc-redundant-expression)
+
+        SelectObject(hdc, oldFont);
+
+        lineRect.top += sz.cy;
+        firstLine = false;
+        line = _tcstok_s(nullptr, TEXT("\r\n"), &tokenContext);
+    }
+
+    GdiFlush();
+
+    // GDI leaves alpha at zero; make the strip opaque
+    auto* pixel = static_cast<BYTE*>(pixels);
+    for (int n = 0; n < width * height_; ++n)
+    {
+        pixel[n * 4 + 3] = 0xFF;
+    }
+
+    bool ok = true;
+    if (texture_ && width == textureWidth_ && height_ == textureHeight_)
+    {
+        context->UpdateSubresource(texture_, 0, nullptr, pixels, width * 4, 0);
+    }
+    else
+    {
+        if (textureSRV_) { textureSRV_->Release(); textureSRV_ = nullptr; }
+        if (texture_) { texture_->Release(); texture_ = nullptr; }
+
+        D3D11_TEXTURE2D_DESC desc = {};
+        desc.Width = width;
+        desc.Height = height_;
+        desc.MipLevels = 1;
+        desc.ArraySize = 1;
+        desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
+        desc.SampleDesc.Count = 1;
+        desc.Usage = D3D11_USAGE_DEFAULT;
+        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+        D3D11_SUBRESOURCE_DATA data = {};
+        data.pSysMem = pixels;
+        data.SysMemPitch = width * 4;
+
+        ok = SUCCEEDED(device_->CreateTexture2D(&desc, &data, &texture_)) &&
+            SUCCEEDED(device_->CreateShaderResourceView(texture_, nullptr, &textureSRV_));
+    }
+
+    SelectObject(hdc, oldBitmap);
+    DeleteObject(bitmap);
+    DeleteDC(hdc);
+    ReleaseDC(nullptr, hdcScreen);
+
+    if (ok)
+    {
+        textureWidth_ = width;
+        textureHeight_ = height_;
+        dirty_ = false;
+    }
+
+    return ok;
+}
+
+void InstructionsOverlay::Destroy()
+{
+    if (textureSRV_)
+    {
+        textureSRV_->Release();
+        textureSRV_ = nullptr;
+    }
+
+    if (texture_)
+    {
+        texture_->Release();
+        texture_ = nullptr;
+    }
+
+    DeleteFonts();
+
+    device_ = nullptr;
+    textureWidth_ = 0;
+    textureHeight_ = 0;
+}
+
+void InstructionsOverlay::DeleteFonts()
+{
+    if (fontHandle_)
+    {
+        DeleteObject(fontHandle_);
+        fontHandle_ = nullptr;
+    }
+
+    if (boldFontHandle_)
+    {
+        DeleteObject(boldFontHandle_);
+        boldFontHandle_ = nullptr;
+    }
+}
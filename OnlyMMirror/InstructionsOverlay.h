@@ -0,0 +1,40 @@
+#pragma once
+
+#include <windows.h>
+#include <d3d11.h>
+
+// Key help shown in a strip along the bottom of the mirror's swap chain. The text is
+// rasterised with GDI into a texture only when it (or the strip width) changes; each
+// frame just draws that texture, so there is no child window for DWM to composite.
+class InstructionsOverlay  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+public:
+    InstructionsOverlay();
+    ~InstructionsOverlay();
+
+    bool Create(ID3D11Device* device, UINT dpi);
+    void Destroy();
+    void SetHotKey(TCHAR hotKey);
+    bool SetDpi(UINT dpi);
+    int GetHeight() const;
+
+    // Returns the texture for a strip of the given width, re-rasterising if necessary.
+    ID3D11ShaderResourceView* GetShaderResourceView(ID3D11DeviceContext* context, int width);
+
+    static int CalculateHeight(UINT dpi);
+
+private:
+    bool Rasterise(ID3D11DeviceContext* context, int width);
+    void DeleteFonts();
+
+    ID3D11Device* device_;
+    ID3D11Texture2D* texture_;
+    ID3D11ShaderResourceView* textureSRV_;
+    HFONT fontHandle_;
+    HFONT boldFontHandle_;
+    TCHAR text_[512];
+    int height_;
+    int textureWidth_;
+    int textureHeight_;
+    bool dirty_;
+};
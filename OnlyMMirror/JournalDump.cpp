@@ -0,0 +1,81 @@
+#include "stdafx.h"
+#include "JournalDump.h"
+#include "Metrics.h"
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    std::vector<uint8_t> dumpBuffer;
+    LPTOP_LEVEL_EXCEPTION_FILTER previousFilter = nullptr;
+
+    const char* GetReasonName(const JournalDumpReason reason)
+    {
+        switch (reason)
+        {
+            case JournalDumpReason::Crash:
+                return "crash";
+
+            case JournalDumpReason::HotKey:
+                return "hotkey";
+
+            case JournalDumpReason::Exit:
+            default:
+                return "exit";
+        }
+    }
+
+    LONG WINAPI OnUnhandledException(EXCEPTION_POINTERS* exception)
+    {
+        JournalDump::Write(JournalDumpReason::Crash);
+        return previousFilter ? previousFilter(exception) : EXCEPTION_CONTINUE_SEARCH;
+    }
+}
+
+namespace JournalDump
+{
+    void Install()
+    {
+        dumpBuffer.resize(FrameJournal::GetDumpSize());
+        previousFilter = SetUnhandledExceptionFilter(OnUnhandledException);
+    }
+
+    bool Write(const JournalDumpReason reason)
+    {
+        if (dumpBuffer.empty())
+        {
+            return false;
+        }
+
+        FrameJournal::Record(JournalEvent::Dump, 0, 0, static_cast<uint32_t>(reason), 0.0f);
+
+        char path[MAX_PATH];
+        const DWORD length = GetTempPathA(MAX_PATH, path);
+        if (length == 0 || length >= MAX_PATH ||
+            sprintf_s(path + length, MAX_PATH - length, "OnlyMMirror-%s.journal", GetReasonName(reason)) < 0)
+        {
+            return false;
+        }
+
+        const size_t size = FrameJournal::Serialize(dumpBuffer.data(), dumpBuffer.size());
+
+        const HANDLE file = CreateFileA(path, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)  // NOLINT(performance-no-int-to-ptr)
+        {
+            return false;
+        }
+
+        DWORD bytesWritten = 0;
+        const bool written = WriteFile(file, dumpBuffer.data(), static_cast<DWORD>(size), &bytesWritten, nullptr) &&
+            bytesWritten == size;
+        CloseHandle(file);
+
+        // Not from the crash handler, where the process is in an unknown state
+        if (reason != JournalDumpReason::Crash)
+        {
+            Metrics::Event("journal.dump", path);
+        }
+
+        return written;
+    }
+}
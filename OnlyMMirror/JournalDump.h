@@ -0,0 +1,13 @@
+#pragma once
+
+#include "FrameJournal.h"
+
+// Writes the frame journal to %TEMP%\OnlyMMirror-<reason>.journal. The buffer is set aside
+// by Install so that a dump from the crash handler doesn't have to allocate.
+namespace JournalDump
+{
+    // Also installs the unhandled-exception filter that dumps on a crash
+    void Install();
+
+    bool Write(JournalDumpReason reason);
+}
@@ -0,0 +1,123 @@
+#include "LatencyPattern.h"
+
+#include <algorithm>
+
+namespace
+{
+    // Mean luma of the middle half of a cell, away from the edges blurred into its neighbours
+    int SampleCell(const uint8_t* luma, const size_t pitch, const PixelRect& rect, const int cell)
+    {
+        const double cellWidth = static_cast<double>(rect.right - rect.left) / LatencyPattern::CellCount;
+        const double cellHeight = static_cast<double>(rect.bottom - rect.top);
+
+        const int left = rect.left + static_cast<int>(cellWidth * (cell + 0.25));
+        const int right = (std::max)(left + 1, rect.left + static_cast<int>(cellWidth * (cell + 0.75)));
+        const int top = rect.top + static_cast<int>(cellHeight * 0.25);
+        const int bottom = (std::max)(top + 1, rect.top + static_cast<int>(cellHeight * 0.75));
+
+        uint32_t sum = 0;
+        for (int y = top; y < bottom; ++y)
+        {
+            const uint8_t* row = luma + static_cast<size_t>(y) * pitch;
+            for (int x = left; x < right; ++x)
+            {
+                sum += row[x];
+            }
+        }
+
+        return static_cast<int>(sum / static_cast<uint32_t>((right - left) * (bottom - top)));
+    }
+}
+
+namespace LatencyPattern
+{
+    uint32_t ToStamp(const int64_t counter, const int64_t frequency)
+    {
+        if (frequency <= 0)
+        {
+            return 0;
+        }
+
+        // Split to keep counter * 10000 from overflowing
+        const int64_t whole = counter / frequency;
+        const int64_t part = counter % frequency;
+        return static_cast<uint32_t>(whole * 10000 + part * 10000 / frequency);
+    }
+
+    double GetElapsedMs(const uint32_t stamp, const uint32_t now)
+    {
+        return static_cast<double>(static_cast<int32_t>(now - stamp)) * StampMs;
+    }
+
+    uint8_t Crc8(const uint32_t value)
+    {
+        // CRC-8/SMBUS (polynomial x^8 + x^2 + x + 1), most significant byte first
+        uint8_t crc = 0;
+        for (int shift = 24; shift >= 0; shift -= 8)
+        {
+            crc ^= static_cast<uint8_t>(value >> shift);
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                crc = static_cast<uint8_t>((crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1);
+            }
+        }
+
+        return crc;
+    }
+
+    void Encode(const uint32_t stamp, bool* cells)
+    {
+        const uint64_t word = (static_cast<uint64_t>(stamp) << CrcBits) | Crc8(stamp);
+
+        cells[0] = true;
+        cells[1] = false;
+
+        for (int bit = 0; bit < StampBits + CrcBits; ++bit)
+        {
+            const bool one = ((word >> (StampBits + CrcBits - 1 - bit)) & 1) != 0;
+            cells[2 + bit * 2] = one;
+            cells[3 + bit * 2] = !one;
+        }
+    }
+
+    bool Decode(
+        const uint8_t* luma, const int width, const int height, const size_t pitch,
+        const PixelRect& rect, uint32_t& stamp)
+    {
+        // At least two pixels a cell, and the whole strip in the image
+        if (!luma || rect.left < 0 || rect.top < 0 || rect.right > width || rect.bottom > height ||
+            rect.right - rect.left < CellCount * 2 || rect.bottom - rect.top < 2)
+        {
+            return false;
+        }
+
+        const int contrast = SampleCell(luma, pitch, rect, 0) - SampleCell(luma, pitch, rect, 1);
+        if (contrast < MinContrast)
+        {
+            return false;
+        }
+
+        uint64_t word = 0;
+        for (int bit = 0; bit < StampBits + CrcBits; ++bit)
+        {
+            const int difference = SampleCell(luma, pitch, rect, 2 + bit * 2) - SampleCell(luma, pitch, rect, 3 + bit * 2);
+
+            // A pair that's neither clearly light-dark nor dark-light was caught mid-update
+            if (difference < contrast / 2 && difference > -contrast / 2)
+            {
+                return false;
+            }
+
+            word = (word << 1) | (difference > 0 ? 1u : 0u);
+        }
+
+        const uint32_t value = static_cast<uint32_t>(word >> CrcBits);
+        if (Crc8(value) != static_cast<uint8_t>(word))
+        {
+            return false;
+        }
+
+        stamp = value;
+        return true;
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+// Portable encoder and decoder for the glass-to-glass latency pattern: a strip of square
+// cells drawn on the target monitor that encodes a timestamp, and read back from the
+// captured frame. Each bit is Manchester coded as a light-dark or dark-light pair, so it is
+// read by comparing neighbouring cells rather than against a fixed threshold; that holds up
+// through scaling, blurring and tone mapping between the drawn and the captured pattern. A
+// CRC-8 rejects patterns captured half way through being redrawn.
+
+#include <cstddef>
+#include <cstdint>
+#include "ViewTransform.h"
+
+namespace LatencyPattern
+{
+    constexpr int StampBits = 32;
+    constexpr int CrcBits = 8;
+
+    // A light and a dark reference cell, then two cells for each bit
+    constexpr int CellCount = 2 + 2 * (StampBits + CrcBits);
+
+    // Stamps count in units of 0.1 ms, so they wrap after about five days
+    constexpr double StampMs = 0.1;
+
+    // The reference cells must differ by at least this much luma to decode
+    constexpr int MinContrast = 64;
+
+    // The stamp for a QueryPerformanceCounter value
+    uint32_t ToStamp(int64_t counter, int64_t frequency);
+
+    // Time from stamp to now, allowing for wrap
+    double GetElapsedMs(uint32_t stamp, uint32_t now);
+
+    uint8_t Crc8(uint32_t value);
+
+    // Colours of the CellCount cells, left to right; true is light
+    void Encode(uint32_t stamp, bool* cells);
+
+    // Reads a pattern covering rect of a luma image, at whatever scale it was captured.
+    // Returns false if the pattern can't be read or fails its CRC.
+    bool Decode(const uint8_t* luma, int width, int height, size_t pitch, const PixelRect& rect, uint32_t& stamp);
+}
@@ -0,0 +1,182 @@
+#include "stdafx.h"
+#include "LatencyPatternWindow.h"
+
+const TCHAR* LatencyPatternWindow::GetWindowClassName() { return TEXT("OnlyMMirrorLatencyPattern"); }
+
+LatencyPatternWindow::LatencyPatternWindow()
+    : windowHandle_(nullptr)
+    , hInstance_(nullptr)
+    , rect_()
+    , qpcFrequency_()
+    , pixels_()
+{
+    QueryPerformanceFrequency(&qpcFrequency_);
+}
+
+LatencyPatternWindow::~LatencyPatternWindow()
+{
+    Destroy();
+}
+
+void LatencyPatternWindow::RegisterWindowClass() const
+{
+    WNDCLASSEX windowClassEx = {};
+    windowClassEx.cbSize = sizeof(WNDCLASSEX);
+    windowClassEx.lpfnWndProc = WindowProc;
+    windowClassEx.hInstance = hInstance_;
+    windowClassEx.lpszClassName = GetWindowClassName();
+    RegisterClassEx(&windowClassEx);
+}
+
+bool LatencyPatternWindow::Create(const HINSTANCE instance, const RECT& monitorRect)
+{
+    Destroy();
+
+    hInstance_ = instance;
+    RegisterWindowClass();
+
+    // Never activated and transparent to the mouse, so it doesn't get in the way on the target
+    windowHandle_ = CreateWindowEx(
+        WS_EX_TOPMOST | WS_EX_TOOLWINDOW | WS_EX_NOACTIVATE | WS_EX_TRANSPARENT,
+        GetWindowClassName(),
+        TEXT("OnlyM Mirror Latency Pattern"),
+        WS_POPUP,
+        0, 0, 0, 0,
+        nullptr,
+        nullptr,
+        hInstance_,
+        this);
+
+    if (!windowHandle_)
+    {
+        return false;
+    }
+
+    Move(monitorRect);
+    ShowWindow(windowHandle_, SW_SHOWNOACTIVATE);
+    Draw();
+    return true;
+}
+
+void LatencyPatternWindow::Destroy()
+{
+    if (windowHandle_)
+    {
+        DestroyWindow(windowHandle_);
+        windowHandle_ = nullptr;
+    }
+
+    SetRectEmpty(&rect_);
+}
+
+bool LatencyPatternWindow::IsCreated() const
+{
+    return windowHandle_ != nullptr;
+}
+
+void LatencyPatternWindow::Move(const RECT& monitorRect)
+{
+    rect_ = {
+        monitorRect.left, monitorRect.top,
+        monitorRect.left + LatencyPattern::CellCount * CellWidth, monitorRect.top + CellHeight };
+
+    if (windowHandle_)
+    {
+        SetWindowPos(
+            windowHandle_, HWND_TOPMOST, rect_.left, rect_.top, rect_.right - rect_.left, rect_.bottom - rect_.top,
+            SWP_NOACTIVATE);
+    }
+}
+
+RECT LatencyPatternWindow::GetRect() const
+{
+    return rect_;
+}
+
+void LatencyPatternWindow::Draw()
+{
+    if (!windowHandle_)
+    {
+        return;
+    }
+
+    // OnlyM's media window is topmost too; stay above it
+    SetWindowPos(windowHandle_, HWND_TOPMOST, 0, 0, 0, 0, SWP_NOACTIVATE | SWP_NOMOVE | SWP_NOSIZE);
+
+    const HDC dc = GetDC(windowHandle_);
+    if (dc)
+    {
+        Paint(dc);
+        ReleaseDC(windowHandle_, dc);
+    }
+}
+
+void LatencyPatternWindow::Paint(const HDC dc)
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+
+    bool cells[LatencyPattern::CellCount];
+    LatencyPattern::Encode(LatencyPattern::ToStamp(now.QuadPart, qpcFrequency_.QuadPart), cells);
+
+    for (int n = 0; n < LatencyPattern::CellCount; ++n)
+    {
+        pixels_[n] = cells[n] ? 0x00ffffff : 0;
+    }
+
+    // One pixel a cell, stretched over the window in a single call
+    BITMAPINFO info = {};
+    info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    info.bmiHeader.biWidth = LatencyPattern::CellCount;
+    info.bmiHeader.biHeight = -1;
+    info.bmiHeader.biPlanes = 1;
+    info.bmiHeader.biBitCount = 32;
+    info.bmiHeader.biCompression = BI_RGB;
+
+    SetStretchBltMode(dc, COLORONCOLOR);
+    StretchDIBits(
+        dc,
+        0, 0, rect_.right - rect_.left, rect_.bottom - rect_.top,
+        0, 0, LatencyPattern::CellCount, 1,
+        pixels_, &info, DIB_RGB_COLORS, SRCCOPY);
+}
+
+LRESULT CALLBACK LatencyPatternWindow::WindowProc(HWND windowHandle, UINT message, WPARAM wParam, LPARAM lParam)
+{
+    LatencyPatternWindow* self;
+    if (message == WM_NCCREATE)
+    {
+        const CREATESTRUCT* cs = reinterpret_cast<CREATESTRUCT*>(lParam);  // NOLINT(performance-no-int-to-ptr)
+        self = static_cast<LatencyPatternWindow*>(cs->lpCreateParams);
+        SetWindowLongPtr(windowHandle, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(self));
+    }
+    else
+    {
+        self = reinterpret_cast<LatencyPatternWindow*>(GetWindowLongPtr(windowHandle, GWLP_USERDATA));  // NOLINT(performance-no-int-to-ptr)
+    }
+
+    switch (message)
+    {
+        case WM_PAINT:
+        {
+            PAINTSTRUCT ps;
+            const HDC dc = BeginPaint(windowHandle, &ps);
+            if (self)
+            {
+                self->Paint(dc);
+            }
+
+            EndPaint(windowHandle, &ps);
+            return 0;
+        }
+
+        case WM_NCHITTEST:
+            return HTTRANSPARENT;
+
+        case WM_MOUSEACTIVATE:
+            return MA_NOACTIVATE;
+
+        default:
+            return DefWindowProc(windowHandle, message, wParam, lParam);
+    }
+}
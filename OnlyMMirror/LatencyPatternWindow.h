@@ -0,0 +1,46 @@
+#pragma once
+#include <windows.h>
+#include <cstdint>
+#include "LatencyPattern.h"
+
+// Glass-to-glass calibration: a small click-through strip in the top left corner of the
+// target monitor showing the LatencyPattern for the current time. The mirror reads it back
+// out of the captured frames (see LatencyReader), so the difference between the decoded
+// time and the present time covers DWM, the capture and the mirror's own render loop.
+class LatencyPatternWindow  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+public:
+    LatencyPatternWindow();
+    ~LatencyPatternWindow();
+
+    bool Create(HINSTANCE instance, const RECT& monitorRect);
+    void Destroy();
+    bool IsCreated() const;
+
+    // Moves the strip to the corner of a monitor's new position
+    void Move(const RECT& monitorRect);
+
+    // Where the strip is, in desktop coordinates
+    RECT GetRect() const;
+
+    // Redraws the pattern with the current time; call once per mirror frame
+    void Draw();
+
+    // Screen pixels per pattern cell. The capture is at the target's full resolution, so
+    // small cells are still several pixels wide by the time they're decoded.
+    static constexpr int CellWidth = 8;
+    static constexpr int CellHeight = 16;
+
+    static LRESULT CALLBACK WindowProc(HWND windowHandle, UINT message, WPARAM wParam, LPARAM lParam);
+    static const TCHAR* GetWindowClassName();
+
+private:
+    void RegisterWindowClass() const;
+    void Paint(HDC dc);
+
+    HWND windowHandle_;
+    HINSTANCE hInstance_;
+    RECT rect_;
+    LARGE_INTEGER qpcFrequency_;
+    uint32_t pixels_[LatencyPattern::CellCount];
+};
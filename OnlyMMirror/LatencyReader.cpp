@@ -0,0 +1,173 @@
+#include "stdafx.h"
+#include "LatencyReader.h"
+#include "FrameStatistics.h"
+#include "LatencyPattern.h"
+
+LatencyReader::LatencyReader()
+    : pool_(nullptr)
+    , slots_()
+    , stagingDesc_()
+    , writeIndex_(0)
+    , readIndex_(0)
+{
+}
+
+LatencyReader::~LatencyReader()
+{
+    Destroy();
+}
+
+bool LatencyReader::Create(TexturePool* pool)
+{
+    Destroy();
+
+    pool_ = pool;
+    return pool_ != nullptr;
+}
+
+void LatencyReader::Destroy()
+{
+    ReleaseTextures();
+    pool_ = nullptr;
+}
+
+void LatencyReader::ReleaseTextures()
+{
+    // Textures only exist while there's a pool
+    for (Slot& slot : slots_)
+    {
+        if (pool_)
+        {
+            pool_->Recycle(slot.staging);
+        }
+
+        slot.pending = false;
+    }
+
+    stagingDesc_ = D3D11_TEXTURE2D_DESC();
+    writeIndex_ = 0;
+    readIndex_ = 0;
+}
+
+bool LatencyReader::EnsureTextures(const UINT width, const UINT height, const DXGI_FORMAT format)
+{
+    if (slots_[0].staging && width == stagingDesc_.Width && height == stagingDesc_.Height && format == stagingDesc_.Format)
+    {
+        return true;
+    }
+
+    ReleaseTextures();
+
+    D3D11_TEXTURE2D_DESC desc = {};
+    desc.Width = width;
+    desc.Height = height;
+    desc.MipLevels = 1;
+    desc.ArraySize = 1;
+    desc.Format = format;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_STAGING;
+    desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+
+    for (Slot& slot : slots_)
+    {
+        if (!pool_->Acquire(desc, &slot.staging, nullptr))
+        {
+            ReleaseTextures();
+            return false;
+        }
+    }
+
+    stagingDesc_ = desc;
+    return true;
+}
+
+bool LatencyReader::Queue(
+    ID3D11DeviceContext* context, ID3D11Texture2D* source, const PixelRect& region, const LONGLONG presentTime)
+{
+    if (!pool_ || !context || !source || region.right <= region.left || region.bottom <= region.top)
+    {
+        return false;
+    }
+
+    D3D11_TEXTURE2D_DESC sourceDesc;
+    source->GetDesc(&sourceDesc);
+    if (region.left < 0 || region.top < 0 ||
+        region.right > static_cast<int>(sourceDesc.Width) || region.bottom > static_cast<int>(sourceDesc.Height))
+    {
+        return false;
+    }
+
+    if (!EnsureTextures(region.right - region.left, region.bottom - region.top, sourceDesc.Format))
+    {
+        return false;
+    }
+
+    Slot& slot = slots_[writeIndex_];
+    if (slot.pending)
+    {
+        return false;
+    }
+
+    const D3D11_BOX box = {
+        static_cast<UINT>(region.left), static_cast<UINT>(region.top), 0,
+        static_cast<UINT>(region.right), static_cast<UINT>(region.bottom), 1 };
+    context->CopySubresourceRegion(slot.staging, 0, 0, 0, 0, source, 0, &box);
+
+    slot.presentTime = presentTime;
+    slot.pending = true;
+    writeIndex_ = (writeIndex_ + 1) % RingSize;
+    return true;
+}
+
+bool LatencyReader::Read(
+    ID3D11DeviceContext* context, const ToneMapConstants& toneMap,
+    bool& decoded, uint32_t& stamp, LONGLONG& presentTime)
+{
+    Slot& slot = slots_[readIndex_];
+    if (!context || !slot.pending)
+    {
+        return false;
+    }
+
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    if (FAILED(context->Map(slot.staging, 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped)))
+    {
+        // DXGI_ERROR_WAS_STILL_DRAWING: try again next time
+        return false;
+    }
+
+    const int width = static_cast<int>(stagingDesc_.Width);
+    const int height = static_cast<int>(stagingDesc_.Height);
+    luma_.resize(static_cast<size_t>(width) * height);
+
+    for (int y = 0; y < height; ++y)
+    {
+        const BYTE* row = static_cast<const BYTE*>(mapped.pData) + static_cast<size_t>(y) * mapped.RowPitch;
+        uint8_t* lumaRow = luma_.data() + static_cast<size_t>(y) * width;
+
+        switch (stagingDesc_.Format)
+        {
+            case DXGI_FORMAT_R16G16B16A16_FLOAT:
+                FrameAnalysis::LumaFromRgba16f(reinterpret_cast<const uint16_t*>(row), width, toneMap, lumaRow);
+                break;
+
+            case DXGI_FORMAT_R10G10B10A2_UNORM:
+                FrameAnalysis::LumaFromRgb10a2(reinterpret_cast<const uint32_t*>(row), width, toneMap, lumaRow);
+                break;
+
+            default:
+                FrameAnalysis::LumaFromBgra8(row, width, lumaRow);
+                break;
+        }
+    }
+
+    context->Unmap(slot.staging, 0);
+
+    const PixelRect whole = { 0, 0, width, height };
+    decoded = LatencyPattern::Decode(luma_.data(), width, height, static_cast<size_t>(width), whole, stamp);
+    presentTime = slot.presentTime;
+
+    slot.pending = false;
+    readIndex_ = (readIndex_ + 1) % RingSize;
+    return true;
+}
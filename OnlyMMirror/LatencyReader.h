@@ -0,0 +1,50 @@
+#pragma once
+#include <d3d11.h>
+#include <cstdint>
+#include <vector>
+#include "TexturePool.h"
+#include "ToneMap.h"
+#include "ViewTransform.h"
+
+// Reads the latency pattern back out of presented frames. The pattern's part of the
+// captured texture is copied to a staging ring as each frame is presented, tagged with the
+// present time, and mapped a few frames later with DO_NOT_WAIT; if the ring is full the
+// frame is simply skipped.
+class LatencyReader  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+public:
+    LatencyReader();
+    ~LatencyReader();
+
+    // Textures come from pool, which has to outlive this
+    bool Create(TexturePool* pool);
+    void Destroy();
+
+    // Queues a copy of region of source, a frame presented at presentTime (a QPC value)
+    bool Queue(ID3D11DeviceContext* context, ID3D11Texture2D* source, const PixelRect& region, LONGLONG presentTime);
+
+    // Decodes the oldest finished copy. Returns false if none has finished yet; decoded
+    // is false if it had one but the pattern couldn't be read.
+    bool Read(ID3D11DeviceContext* context, const ToneMapConstants& toneMap,
+        bool& decoded, uint32_t& stamp, LONGLONG& presentTime);
+
+private:
+    bool EnsureTextures(UINT width, UINT height, DXGI_FORMAT format);
+    void ReleaseTextures();
+
+    static constexpr int RingSize = 3;
+
+    struct Slot
+    {
+        ID3D11Texture2D* staging;
+        LONGLONG presentTime;
+        bool pending;
+    };
+
+    TexturePool* pool_;
+    Slot slots_[RingSize];
+    D3D11_TEXTURE2D_DESC stagingDesc_;
+    std::vector<uint8_t> luma_;
+    int writeIndex_;
+    int readIndex_;
+};
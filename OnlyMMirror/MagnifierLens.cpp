@@ -0,0 +1,128 @@
+#include "MagnifierLens.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Lens heights as fractions of the mirror's height, smallest first
+    constexpr double LensSizes[MagnifierLens::SizeCount] = { 0.1, 0.15, 0.2, 0.25, 0.3, 0.4, 0.5 };
+
+    constexpr float BorderFraction = 0.03f;
+}
+
+constexpr int MagnifierLens::SizeCount;
+constexpr int MagnifierLens::DefaultSizeIndex;
+constexpr double MagnifierLens::DefaultZoom;
+constexpr double MagnifierLens::MinZoom;
+constexpr double MagnifierLens::MaxZoom;
+
+MagnifierLens::MagnifierLens()
+    : enabled_(false)
+    , shape_(LensShape::Circle)
+    , sizeIndex_(DefaultSizeIndex)
+    , zoom_(DefaultZoom)
+{
+}
+
+void MagnifierLens::Toggle()
+{
+    enabled_ = !enabled_;
+}
+
+bool MagnifierLens::IsEnabled() const
+{
+    return enabled_;
+}
+
+void MagnifierLens::ToggleShape()
+{
+    shape_ = shape_ == LensShape::Circle ? LensShape::Square : LensShape::Circle;
+}
+
+LensShape MagnifierLens::GetShape() const
+{
+    return shape_;
+}
+
+bool MagnifierLens::Reduce()
+{
+    if (sizeIndex_ == 0)
+    {
+        return false;
+    }
+
+    --sizeIndex_;
+    return true;
+}
+
+bool MagnifierLens::Enlarge()
+{
+    if (sizeIndex_ == SizeCount - 1)
+    {
+        return false;
+    }
+
+    ++sizeIndex_;
+    return true;
+}
+
+double MagnifierLens::GetSize() const
+{
+    return LensSizes[sizeIndex_];
+}
+
+void MagnifierLens::SetZoom(const double zoom)
+{
+    zoom_ = (std::min)(MaxZoom, (std::max)(MinZoom, zoom));
+}
+
+double MagnifierLens::GetZoom() const
+{
+    return zoom_;
+}
+
+bool MagnifierLens::Map(
+    const QuadMapping& content, const float x, const float y, const float aspect,
+    QuadMapping& lens, LensParameters& parameters) const
+{
+    if (!enabled_ || aspect <= 0.0f || content.right <= content.left || content.top <= content.bottom)
+    {
+        return false;
+    }
+
+    // Half the lens's size in NDC; the viewport is 2 units high whatever its aspect
+    const auto halfHeight = static_cast<float>(GetSize());
+    const float halfWidth = halfHeight / aspect;
+
+    // Rate of change of the texture coordinates across the mirror (v runs downwards)
+    const float uPerX = (content.u1 - content.u0) / (content.right - content.left);
+    const float vPerY = (content.v1 - content.v0) / (content.bottom - content.top);
+
+    // The texture coordinates under the lens's centre stay where they are
+    const float centreU = content.u0 + (x - content.left) * uPerX;
+    const float centreV = content.v0 + (y - content.top) * vPerY;
+
+    const auto zoom = static_cast<float>(zoom_);
+    const float halfU = halfWidth * uPerX / zoom;
+    const float halfV = halfHeight * vPerY / zoom;
+
+    lens.left = x - halfWidth;
+    lens.right = x + halfWidth;
+    lens.top = y + halfHeight;
+    lens.bottom = y - halfHeight;
+    lens.u0 = centreU - halfU;
+    lens.u1 = centreU + halfU;
+    lens.v0 = centreV + halfV;
+    lens.v1 = centreV - halfV;
+
+    parameters = LensParameters();
+    parameters.centreU = centreU;
+    parameters.centreV = centreV;
+    parameters.halfWidthU = std::fabs(halfU);
+    parameters.halfHeightV = std::fabs(halfV);
+    parameters.border = BorderFraction;
+    parameters.circle = shape_ == LensShape::Circle ? 1.0f : 0.0f;
+
+    return parameters.halfWidthU > 0.0f && parameters.halfHeightV > 0.0f;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+// Portable state and geometry of the mirror's magnifier lens. The lens is drawn as one
+// extra quad over the mirror, sampling the texture that's already been captured.
+
+#include "ViewTransform.h"
+
+enum class LensShape
+{
+    Square,
+    Circle
+};
+
+// What the lens pixel shader needs, in the lens quad's texture coordinates
+struct LensParameters
+{
+    float centreU;
+    float centreV;
+    float halfWidthU;
+    float halfHeightV;
+    float border;       // width of the frame as a fraction of the lens radius
+    float circle;       // 1 for a circle, 0 for a square
+    float padding[2];   // constant buffers are a multiple of 16 bytes
+};
+
+class MagnifierLens
+{
+public:
+    MagnifierLens();
+
+    void Toggle();
+    bool IsEnabled() const;
+
+    void ToggleShape();
+    LensShape GetShape() const;
+
+    // Steps through the sizes. Returns false if already at the smallest or largest.
+    bool Reduce();
+    bool Enlarge();
+
+    // The lens's height as a fraction of the mirror's height
+    double GetSize() const;
+
+    // Magnification relative to the mirror, clamped to MinZoom..MaxZoom
+    void SetZoom(double zoom);
+    double GetZoom() const;
+
+    // Places the lens centred on (x, y), in normalised device coordinates of the mirror,
+    // over content already mapped with ViewTransform::Map. aspect is the mirror's width
+    // divided by its height. Returns false if the lens is off or can't be placed.
+    bool Map(const QuadMapping& content, float x, float y, float aspect,
+        QuadMapping& lens, LensParameters& parameters) const;
+
+    static constexpr int SizeCount = 7;
+    static constexpr int DefaultSizeIndex = 3;
+    static constexpr double DefaultZoom = 2.0;
+    static constexpr double MinZoom = 1.0;
+    static constexpr double MaxZoom = 8.0;
+
+private:
+    bool enabled_;
+    LensShape shape_;
+    int sizeIndex_;
+    double zoom_;
+};
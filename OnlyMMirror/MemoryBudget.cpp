@@ -0,0 +1,103 @@
+#include "MemoryBudget.h"
+
+constexpr double MemoryBudget::StepDownFraction;
+constexpr double MemoryBudget::StepUpFraction;
+constexpr double MemoryBudget::StepDownSeconds;
+constexpr double MemoryBudget::StepUpSeconds;
+constexpr double MemoryBudget::ReducedFrameRate;
+
+MemoryBudget::MemoryBudget()
+    : level_(QualityLevel::Full)
+    , usageFraction_(0.0)
+    , lastStep_(-1.0)
+    , lowSince_(-1.0)
+{
+}
+
+void MemoryBudget::Reset()
+{
+    level_ = QualityLevel::Full;
+    usageFraction_ = 0.0;
+    lastStep_ = -1.0;
+    lowSince_ = -1.0;
+}
+
+bool MemoryBudget::Update(const uint64_t usage, const uint64_t budget, const double now)
+{
+    if (budget == 0)
+    {
+        usageFraction_ = 0.0;
+        lowSince_ = -1.0;
+        return false;
+    }
+
+    usageFraction_ = static_cast<double>(usage) / static_cast<double>(budget);
+
+    if (usageFraction_ >= StepUpFraction)
+    {
+        lowSince_ = -1.0;
+    }
+    else if (lowSince_ < 0.0)
+    {
+        lowSince_ = now;
+    }
+
+    const QualityLevel previous = level_;
+    const int lowest = static_cast<int>(QualityLevel::Count) - 1;
+
+    if (usageFraction_ >= StepDownFraction)
+    {
+        // The last step's textures may not have been released yet
+        if (static_cast<int>(level_) < lowest && (lastStep_ < 0.0 || now - lastStep_ >= StepDownSeconds))
+        {
+            level_ = static_cast<QualityLevel>(static_cast<int>(level_) + 1);
+        }
+    }
+    else if (level_ != QualityLevel::Full && lowSince_ >= 0.0 && now - lowSince_ >= StepUpSeconds &&
+        now - lastStep_ >= StepUpSeconds)
+    {
+        // One level at a time, each after its own quiet spell, in case stepping up is
+        // what brings the pressure back
+        level_ = static_cast<QualityLevel>(static_cast<int>(level_) - 1);
+        lowSince_ = now;
+    }
+
+    if (level_ == previous)
+    {
+        return false;
+    }
+
+    lastStep_ = now;
+    return true;
+}
+
+QualityLevel MemoryBudget::GetLevel() const
+{
+    return level_;
+}
+
+double MemoryBudget::GetUsageFraction() const
+{
+    return usageFraction_;
+}
+
+const char* MemoryBudget::GetLevelName(const QualityLevel level)
+{
+    switch (level)
+    {
+        case QualityLevel::Full:
+            return "full";
+
+        case QualityLevel::ReducedCapture:
+            return "reduced capture";
+
+        case QualityLevel::ReducedPool:
+            return "reduced pool";
+
+        case QualityLevel::ReducedRate:
+            return "reduced rate";
+
+        default:
+            return "unknown";
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+// Portable policy for video memory pressure. It's fed the adapter's usage and the budget
+// the OS gives the process, and steps the mirror's quality down one level at a time while
+// usage is near the budget, then back up once it has stayed well below it for a while.
+// Stepping down is spaced out so that each step's savings show in the usage before the
+// next is taken.
+
+#include <cstdint>
+
+enum class QualityLevel
+{
+    Full,
+    ReducedCapture,     // the output is captured at half resolution
+    ReducedPool,        // and the texture pool keeps no idle textures
+    ReducedRate,        // and frames are captured and drawn at ReducedFrameRate at most
+    Count
+};
+
+class MemoryBudget
+{
+public:
+    MemoryBudget();
+
+    // usage and budget in bytes, at time now in seconds from any fixed origin. A budget of
+    // zero means it isn't known and is ignored. Returns true if the level changed.
+    bool Update(uint64_t usage, uint64_t budget, double now);
+    void Reset();
+
+    QualityLevel GetLevel() const;
+
+    // Of the budget, at the last update; zero if it isn't known
+    double GetUsageFraction() const;
+
+    static const char* GetLevelName(QualityLevel level);
+
+    static constexpr double StepDownFraction = 0.9;
+    static constexpr double StepUpFraction = 0.7;
+    static constexpr double StepDownSeconds = 2.0;
+    static constexpr double StepUpSeconds = 10.0;
+    static constexpr double ReducedFrameRate = 30.0;
+
+private:
+    QualityLevel level_;
+    double usageFraction_;
+    double lastStep_;           // negative if the level hasn't changed yet
+    double lowSince_;           // start of the current run below StepUpFraction; negative if none
+};
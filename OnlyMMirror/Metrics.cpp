@@ -0,0 +1,133 @@
+#include "stdafx.h"
+#include "Metrics.h"
+#include <cstdio>
+
+namespace Metrics
+{
+    void Write(const char* name, const double value)
+    {
+        char line[128];
+        (void)sprintf_s(line, "OnlyMMirror metric %s=%.4f\n", name, value);
+        OutputDebugStringA(line);
+    }
+
+    void Event(const char* name, const char* detail)
+    {
+        char line[256];
+        (void)sprintf_s(line, "OnlyMMirror event %s: %s\n", name, detail ? detail : "");
+        OutputDebugStringA(line);
+    }
+
+    double GetUptimeMs()
+    {
+        FILETIME creationTime, exitTime, kernelTime, userTime;
+        if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+        {
+            return 0.0;
+        }
+
+        FILETIME nowTime;
+        GetSystemTimePreciseAsFileTime(&nowTime);
+
+        ULARGE_INTEGER created, now;
+        created.LowPart = creationTime.dwLowDateTime;
+        created.HighPart = creationTime.dwHighDateTime;
+        now.LowPart = nowTime.dwLowDateTime;
+        now.HighPart = nowTime.dwHighDateTime;
+
+        // 100ns units
+        return now.QuadPart > created.QuadPart ? static_cast<double>(now.QuadPart - created.QuadPart) / 1.0e4 : 0.0;
+    }
+
+    void Export(const MirrorStats& stats)
+    {
+        Write("capture.fps", stats.captureFps);
+        Write("present.fps", stats.presentFps);
+        Write("present.area_pct", stats.presentAreaPercent.Mean());
+        Write("pool.in_use_mb", static_cast<double>(stats.poolBytesInUse) / (1024.0 * 1024.0));
+        Write("pool.idle_mb", static_cast<double>(stats.poolBytesIdle) / (1024.0 * 1024.0));
+        Write("pool.created", static_cast<double>(stats.poolCreated));
+        Write("pool.reused", static_cast<double>(stats.poolReused));
+        Write("pool.evicted", static_cast<double>(stats.poolEvicted));
+
+        if (stats.videoMemoryBudget > 0)
+        {
+            Write("vram.usage_mb", static_cast<double>(stats.videoMemoryUsage) / (1024.0 * 1024.0));
+            Write("vram.budget_mb", static_cast<double>(stats.videoMemoryBudget) / (1024.0 * 1024.0));
+        }
+
+        if (stats.renderCalls.Count() > 0)
+        {
+            Write("render.calls_per_frame", stats.renderCalls.Mean());
+            Write("render.cpu.mean_us", stats.renderCpuUs.Mean());
+            Write("render.cpu.p99_us", stats.renderCpuUs.Percentile(99.0));
+        }
+
+        Write("capture.skipped_frames", static_cast<double>(stats.skippedFrames));
+        Write("capture.dirty_area_pct", stats.dirtyAreaPercent.Mean());
+        Write("capture.copy_mb_per_s", stats.copyMBPerSecond);
+        Write("capture.full_output_mb_per_s", stats.fullOutputMBPerSecond);
+
+        if (stats.transferMs.Count() > 0)
+        {
+            Write("capture.transfer.mean_ms", stats.transferMs.Mean());
+            Write("capture.transfer.p99_ms", stats.transferMs.Percentile(99.0));
+            Write("capture.transfer_mb_per_s", stats.transferMBPerSecond);
+        }
+
+        if (stats.feedAnalysisUs.Count() > 0)
+        {
+            Write("feed.mean_luma", stats.feedMeanLuma.Last());
+            Write("feed.dark_pct", stats.feedDarkPercent.Last());
+            Write("feed.changed_pct", stats.feedChangedPercent.Last());
+            Write("feed.analysis.mean_us", stats.feedAnalysisUs.Mean());
+            Write("feed.analysis.p99_us", stats.feedAnalysisUs.Percentile(99.0));
+        }
+
+        Write("latency.mean_ms", stats.latencyMs.Mean());
+        Write("latency.p99_ms", stats.latencyMs.Percentile(99.0));
+
+        if (stats.glassLatencyMs.Count() > 0)
+        {
+            Write("latency.glass.mean_ms", stats.glassLatencyMs.Mean());
+            Write("latency.glass.p50_ms", stats.glassLatencyMs.Percentile(50.0));
+            Write("latency.glass.p99_ms", stats.glassLatencyMs.Percentile(99.0));
+            Write("latency.glass.misreads", static_cast<double>(stats.glassLatencyMisreads));
+        }
+
+        char name[64];
+        for (int n = 0; n < static_cast<int>(GpuStage::Count); ++n)
+        {
+            const char* stageName = MirrorStats::GetStageName(static_cast<GpuStage>(n));
+
+            (void)sprintf_s(name, "gpu.%s.mean_ms", stageName);
+            Write(name, stats.gpuStageMs[n].Mean());
+
+            (void)sprintf_s(name, "gpu.%s.p99_ms", stageName);
+            Write(name, stats.gpuStageMs[n].Percentile(99.0));
+        }
+
+        Write("gpu.total.mean_ms", stats.gpuFrameMs.Mean());
+        Write("gpu.total.p99_ms", stats.gpuFrameMs.Percentile(99.0));
+        Write("gpu.frames_dropped", static_cast<double>(stats.gpuFramesDropped));
+
+        for (int n = 0; n < static_cast<int>(MirrorMode::Count); ++n)
+        {
+            if (stats.modeCpuPercent[n].Count() == 0)
+            {
+                continue;
+            }
+
+            const char* modeName = MirrorStats::GetModeName(static_cast<MirrorMode>(n));
+
+            (void)sprintf_s(name, "mode.%s.cpu_pct", modeName);
+            Write(name, stats.modeCpuPercent[n].Mean());
+
+            (void)sprintf_s(name, "mode.%s.gpu_ms_per_s", modeName);
+            Write(name, stats.modeGpuMsPerSecond[n].Mean());
+
+            (void)sprintf_s(name, "mode.%s.copy_mb_per_s", modeName);
+            Write(name, stats.modeCopyMBPerSecond[n].Mean());
+        }
+    }
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "MirrorStats.h"
+
+// Metrics channel. Values are written to the debug output as "OnlyMMirror metric <name>=<value>"
+// lines so they can be collected with DebugView or an attached debugger alongside OnlyM's own logs.
+namespace Metrics
+{
+    void Write(const char* name, double value);
+    void Event(const char* name, const char* detail);
+
+    // Milliseconds since the process was created, for the startup timings
+    double GetUptimeMs();
+
+    // Exports every rolling statistic in stats (mean and p99 of each).
+    void Export(const MirrorStats& stats);
+}
@@ -0,0 +1,94 @@
+#include "MirrorLayout.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+namespace MirrorLayout
+{
+    void GetDisplayedSize(
+        const int width, const int height, const OutputRotation rotation, int& displayedWidth, int& displayedHeight)
+    {
+        const bool swapAxes = RotationTransform::SwapsAxes(rotation);
+        displayedWidth = swapAxes ? height : width;
+        displayedHeight = swapAxes ? width : height;
+    }
+
+    double GetFitScale(const int width, const int height, const int areaWidth, const int areaHeight)
+    {
+        if (width <= 0 || height <= 0 || areaWidth <= 0 || areaHeight <= 0)
+        {
+            return 0.0;
+        }
+
+        return (std::min)(static_cast<double>(areaWidth) / width, static_cast<double>(areaHeight) / height);
+    }
+
+    PixelRect Fit(const int width, const int height, const PixelRect& area)
+    {
+        const int areaWidth = area.right - area.left;
+        const int areaHeight = area.bottom - area.top;
+        if (width <= 0 || height <= 0 || areaWidth <= 0 || areaHeight <= 0)
+        {
+            return PixelRect();
+        }
+
+        // Integer arithmetic so that the result doesn't depend on rounding of the scale
+        int fittedWidth;
+        int fittedHeight;
+        if (static_cast<int64_t>(areaWidth) * height <= static_cast<int64_t>(areaHeight) * width)
+        {
+            // Limited by the width: bars above and below
+            fittedWidth = areaWidth;
+            fittedHeight = static_cast<int>((static_cast<int64_t>(areaWidth) * height * 2 + width) / (static_cast<int64_t>(width) * 2));
+        }
+        else
+        {
+            // Limited by the height: bars at the sides
+            fittedHeight = areaHeight;
+            fittedWidth = static_cast<int>((static_cast<int64_t>(areaHeight) * width * 2 + height) / (static_cast<int64_t>(height) * 2));
+        }
+
+        fittedWidth = (std::max)(1, fittedWidth);
+        fittedHeight = (std::max)(1, fittedHeight);
+
+        for (int factor = 2; factor <= MaxBoxFilterFactor; ++factor)
+        {
+            const int exactWidth = width / factor;
+            const int exactHeight = height / factor;
+            if (width % factor == 0 && height % factor == 0 &&
+                exactWidth <= areaWidth && exactHeight <= areaHeight &&
+                std::abs(exactWidth - fittedWidth) <= 1 && std::abs(exactHeight - fittedHeight) <= 1)
+            {
+                fittedWidth = exactWidth;
+                fittedHeight = exactHeight;
+                break;
+            }
+        }
+
+        PixelRect fitted;
+        fitted.left = area.left + (areaWidth - fittedWidth) / 2;
+        fitted.top = area.top + (areaHeight - fittedHeight) / 2;
+        fitted.right = fitted.left + fittedWidth;
+        fitted.bottom = fitted.top + fittedHeight;
+        return fitted;
+    }
+
+    int GetBoxFilterFactor(const int sourceWidth, const int sourceHeight, const int destinationWidth, const int destinationHeight)
+    {
+        if (destinationWidth <= 0 || destinationHeight <= 0)
+        {
+            return 1;
+        }
+
+        for (int factor = 2; factor <= MaxBoxFilterFactor; ++factor)
+        {
+            if (sourceWidth == destinationWidth * factor && sourceHeight == destinationHeight * factor)
+            {
+                return factor;
+            }
+        }
+
+        return 1;
+    }
+}
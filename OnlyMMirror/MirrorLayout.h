@@ -0,0 +1,38 @@
+#pragma once
+
+// Portable aspect-preserving layout for the mirror: where a source goes in the window,
+// letterboxed or pillarboxed, and whether it lands at an exact integer downscale that can
+// be box filtered rather than sampled bilinearly.
+
+#include "OutputRotation.h"
+#include "ViewTransform.h"
+
+// What the box filter pixel shader needs
+struct BoxFilterParameters
+{
+    float texelWidth;   // 1 / texture width
+    float texelHeight;  // 1 / texture height
+    float factor;       // texels per pixel in each direction, 2 to MirrorLayout::MaxBoxFilterFactor
+    float padding;      // constant buffers are a multiple of 16 bytes
+};
+
+namespace MirrorLayout
+{
+    constexpr int MaxBoxFilterFactor = 4;
+
+    // The size of a width x height image as shown: swapped for 90 and 270 degree rotations
+    void GetDisplayedSize(int width, int height, OutputRotation rotation, int& displayedWidth, int& displayedHeight);
+
+    // The largest scale at which a width x height source fits in areaWidth x areaHeight, or
+    // 0 if either is empty
+    double GetFitScale(int width, int height, int areaWidth, int areaHeight);
+
+    // The largest rect with the aspect ratio of a width x height source that fits in area,
+    // centred. If that is within a pixel of exactly 1/2, 1/3 or 1/4 of the source it is
+    // snapped to it, so that the integer downscale applies. Empty if nothing fits.
+    PixelRect Fit(int width, int height, const PixelRect& area);
+
+    // n if the destination is exactly 1/n of the source in both directions, for n from 2 to
+    // MaxBoxFilterFactor, otherwise 1
+    int GetBoxFilterFactor(int sourceWidth, int sourceHeight, int destinationWidth, int destinationHeight);
+}
@@ -0,0 +1,322 @@
+#include "MirrorStats.h"
+
+#include <algorithm>
+#include <cstdio>
+
+RollingStats::RollingStats(const size_t window)
+    : samples_(window == 0 ? 1 : window)
+    , next_(0)
+    , count_(0)
+    , last_(0.0)
+{
+}
+
+void RollingStats::Add(const double value)
+{
+    samples_[next_] = value;
+    next_ = (next_ + 1) % samples_.size();
+    if (count_ < samples_.size())
+    {
+        ++count_;
+    }
+
+    last_ = value;
+}
+
+void RollingStats::Clear()
+{
+    next_ = 0;
+    count_ = 0;
+    last_ = 0.0;
+}
+
+double RollingStats::Mean() const
+{
+    if (count_ == 0)
+    {
+        return 0.0;
+    }
+
+    double sum = 0.0;
+    for (size_t n = 0; n < count_; ++n)
+    {
+        sum += samples_[n];
+    }
+
+    return sum / static_cast<double>(count_);
+}
+
+double RollingStats::Max() const
+{
+    if (count_ == 0)
+    {
+        return 0.0;
+    }
+
+    return *std::max_element(samples_.begin(), samples_.begin() + static_cast<std::ptrdiff_t>(count_));
+}
+
+double RollingStats::Percentile(const double percentile) const
+{
+    if (count_ == 0)
+    {
+        return 0.0;
+    }
+
+    // Only called when reporting (about once a second), so a copy is fine
+    std::vector<double> sorted(samples_.begin(), samples_.begin() + static_cast<std::ptrdiff_t>(count_));
+
+    const double clamped = (std::min)(100.0, (std::max)(0.0, percentile));
+    const auto rank = static_cast<size_t>(clamped / 100.0 * static_cast<double>(count_ - 1) + 0.5);
+    std::nth_element(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(rank), sorted.end());
+    return sorted[rank];
+}
+
+MirrorStats::MirrorStats()
+    : capturedFrames(0)
+    , presentedFrames(0)
+    , skippedFrames(0)
+    , captureFps(0.0)
+    , presentFps(0.0)
+    , glassLatencyMisreads(0)
+    , copiedBytes(0)
+    , fullOutputBytes(0)
+    , copyMBPerSecond(0.0)
+    , fullOutputMBPerSecond(0.0)
+    , transferredBytes(0)
+    , transferMBPerSecond(0.0)
+    , poolBytesInUse(0)
+    , poolBytesIdle(0)
+    , poolCreated(0)
+    , poolReused(0)
+    , poolEvicted(0)
+    , videoMemoryUsage(0)
+    , videoMemoryBudget(0)
+    , gpuFramesTimed(0)
+    , gpuFramesDropped(0)
+    , gpuBusyMs(0.0)
+    , mode(MirrorMode::Duplication)
+    , capturedAtLastUpdate_(0)
+    , presentedAtLastUpdate_(0)
+    , copiedAtLastUpdate_(0)
+    , fullOutputAtLastUpdate_(0)
+    , transferredAtLastUpdate_(0)
+    , gpuBusyAtLastUpdate_(0.0)
+    , cpuSecondsAtLastUpdate_(-1.0)
+{
+}
+
+void MirrorStats::UpdateRates(const double elapsedSeconds, const double processCpuSeconds)
+{
+    if (elapsedSeconds <= 0.0)
+    {
+        return;
+    }
+
+    captureFps = static_cast<double>(capturedFrames - capturedAtLastUpdate_) / elapsedSeconds;
+    presentFps = static_cast<double>(presentedFrames - presentedAtLastUpdate_) / elapsedSeconds;
+
+    constexpr double bytesPerMB = 1024.0 * 1024.0;
+    copyMBPerSecond = static_cast<double>(copiedBytes - copiedAtLastUpdate_) / bytesPerMB / elapsedSeconds;
+    fullOutputMBPerSecond = static_cast<double>(fullOutputBytes - fullOutputAtLastUpdate_) / bytesPerMB / elapsedSeconds;
+    transferMBPerSecond = static_cast<double>(transferredBytes - transferredAtLastUpdate_) / bytesPerMB / elapsedSeconds;
+
+    const int modeIndex = static_cast<int>(mode);
+    if (cpuSecondsAtLastUpdate_ >= 0.0)
+    {
+        modeCpuPercent[modeIndex].Add((processCpuSeconds - cpuSecondsAtLastUpdate_) * 100.0 / elapsedSeconds);
+
+        // GPU timings arrive a few frames late, so a sample taken just after a mode switch
+        // can include a little of the previous mode's work
+        modeGpuMsPerSecond[modeIndex].Add((gpuBusyMs - gpuBusyAtLastUpdate_) / elapsedSeconds);
+        modeCopyMBPerSecond[modeIndex].Add(copyMBPerSecond);
+    }
+
+    capturedAtLastUpdate_ = capturedFrames;
+    presentedAtLastUpdate_ = presentedFrames;
+    copiedAtLastUpdate_ = copiedBytes;
+    fullOutputAtLastUpdate_ = fullOutputBytes;
+    transferredAtLastUpdate_ = transferredBytes;
+    gpuBusyAtLastUpdate_ = gpuBusyMs;
+    cpuSecondsAtLastUpdate_ = processCpuSeconds;
+}
+
+const char* MirrorStats::GetStageName(const GpuStage stage)
+{
+    switch (stage)
+    {
+        case GpuStage::Copy:
+            return "copy";
+
+        case GpuStage::Draw:
+            return "draw";
+
+        case GpuStage::Cursor:
+            return "cursor";
+
+        case GpuStage::Present:
+            return "present";
+
+        default:
+            return "unknown";
+    }
+}
+
+const char* MirrorStats::GetModeName(const MirrorMode mode)
+{
+    switch (mode)
+    {
+        case MirrorMode::Duplication:
+            return "duplication";
+
+        case MirrorMode::WindowCapture:
+            return "window";
+
+        case MirrorMode::Thumbnail:
+            return "thumbnail";
+
+        default:
+            return "unknown";
+    }
+}
+
+int MirrorStats::FormatModeCosts(char* buffer, const size_t size) const
+{
+    if (!buffer || size == 0)
+    {
+        return 0;
+    }
+
+    buffer[0] = '\0';
+
+    int written = 0;
+    for (int n = 0; n < static_cast<int>(MirrorMode::Count) && written >= 0 && static_cast<size_t>(written) < size; ++n)
+    {
+        if (modeCpuPercent[n].Count() == 0)
+        {
+            written += snprintf(
+                buffer + written, size - written, "%s%s not sampled",
+                n == 0 ? "" : " | ", GetModeName(static_cast<MirrorMode>(n)));
+        }
+        else
+        {
+            written += snprintf(
+                buffer + written, size - written, "%s%s cpu %.1f%% gpu %.1f ms/s copy %.1f MB/s",
+                n == 0 ? "" : " | ", GetModeName(static_cast<MirrorMode>(n)),
+                modeCpuPercent[n].Mean(), modeGpuMsPerSecond[n].Mean(), modeCopyMBPerSecond[n].Mean());
+        }
+    }
+
+    return written < 0 ? 0 : (std::min)(written, static_cast<int>(size) - 1);
+}
+
+int MirrorStats::Format(char* buffer, const size_t size) const
+{
+    if (!buffer || size == 0)
+    {
+        return 0;
+    }
+
+    int written = snprintf(
+        buffer, size, "mode %s, capture %.1f fps, present %.1f fps, skipped %llu, dirty %.1f%%, copy %.1f MB/s (full output %.1f MB/s), latency p99 %.1f ms",
+        GetModeName(mode), captureFps, presentFps, static_cast<unsigned long long>(skippedFrames),
+        dirtyAreaPercent.Mean(), copyMBPerSecond, fullOutputMBPerSecond, latencyMs.Percentile(99.0));
+
+    if (transferMs.Count() > 0 && written >= 0 && static_cast<size_t>(written) < size)
+    {
+        written += snprintf(
+            buffer + written, size - written, ", adapter transfer %.2f/%.2f ms (mean/p99) %.1f MB/s",
+            transferMs.Mean(), transferMs.Percentile(99.0), transferMBPerSecond);
+    }
+
+    if (written >= 0 && static_cast<size_t>(written) < size)
+    {
+        written += snprintf(
+            buffer + written, size - written, ", textures %.1f MB (%.1f idle, %llu reused)",
+            static_cast<double>(poolBytesInUse + poolBytesIdle) / (1024.0 * 1024.0),
+            static_cast<double>(poolBytesIdle) / (1024.0 * 1024.0),
+            static_cast<unsigned long long>(poolReused));
+    }
+
+    if (videoMemoryBudget > 0 && written >= 0 && static_cast<size_t>(written) < size)
+    {
+        written += snprintf(
+            buffer + written, size - written, ", video memory %.0f of %.0f MB",
+            static_cast<double>(videoMemoryUsage) / (1024.0 * 1024.0),
+            static_cast<double>(videoMemoryBudget) / (1024.0 * 1024.0));
+    }
+
+    if (renderCalls.Count() > 0 && written >= 0 && static_cast<size_t>(written) < size)
+    {
+        written += snprintf(
+            buffer + written, size - written, ", render %.1f calls %.1f/%.1f us (mean/p99)",
+            renderCalls.Mean(), renderCpuUs.Mean(), renderCpuUs.Percentile(99.0));
+    }
+
+    if (glassLatencyMs.Count() > 0 && written >= 0 && static_cast<size_t>(written) < size)
+    {
+        written += snprintf(
+            buffer + written, size - written, ", glass-to-glass %.1f/%.1f ms (p50/p99, %llu misread)",
+            glassLatencyMs.Percentile(50.0), glassLatencyMs.Percentile(99.0),
+            static_cast<unsigned long long>(glassLatencyMisreads));
+    }
+
+    if (written >= 0 && static_cast<size_t>(written) < size)
+    {
+        written += snprintf(buffer + written, size - written, "; gpu ms (mean/p99):");
+    }
+
+    for (int n = 0; n < static_cast<int>(GpuStage::Count) && written >= 0 && static_cast<size_t>(written) < size; ++n)
+    {
+        const RollingStats& stage = gpuStageMs[n];
+        written += snprintf(
+            buffer + written, size - written, " %s %.3f/%.3f",
+            GetStageName(static_cast<GpuStage>(n)), stage.Mean(), stage.Percentile(99.0));
+    }
+
+    if (written >= 0 && static_cast<size_t>(written) < size)
+    {
+        written += snprintf(
+            buffer + written, size - written, " total %.3f/%.3f (timed %llu, dropped %llu)",
+            gpuFrameMs.Mean(), gpuFrameMs.Percentile(99.0),
+            static_cast<unsigned long long>(gpuFramesTimed),
+            static_cast<unsigned long long>(gpuFramesDropped));
+    }
+
+    if (written >= 0 && static_cast<size_t>(written) + 2 < size)
+    {
+        buffer[written++] = ';';
+        buffer[written++] = ' ';
+        written += FormatModeCosts(buffer + written, size - written);
+    }
+
+    return (std::min)(written, static_cast<int>(size) - 1);
+}
+
+int MirrorStats::FormatHud(char* buffer, const size_t size) const
+{
+    if (!buffer || size == 0)
+    {
+        return 0;
+    }
+
+    int written = snprintf(
+        buffer, size,
+        "CAPTURE %5.1f FPS  PRESENT %5.1f FPS\n"
+        "SKIPPED %llu  DIRTY %4.1f%%\n"
+        "GPU %.2f MS  LATENCY P99 %.1f MS",
+        captureFps, presentFps,
+        static_cast<unsigned long long>(skippedFrames), dirtyAreaPercent.Mean(),
+        gpuFrameMs.Mean(), latencyMs.Percentile(99.0));
+
+    // Only while calibrating
+    if (glassLatencyMs.Count() > 0 && written >= 0 && static_cast<size_t>(written) < size)
+    {
+        written += snprintf(
+            buffer + written, size - written,
+            "\nGLASS P50 %.1f P99 %.1f MS",
+            glassLatencyMs.Percentile(50.0), glassLatencyMs.Percentile(99.0));
+    }
+
+    return (std::min)(written, static_cast<int>(size) - 1);
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+// Portable rolling statistics for the mirror's render loop.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Fixed window of the most recent samples
+class RollingStats
+{
+public:
+    explicit RollingStats(size_t window = 120);
+
+    void Add(double value);
+    void Clear();
+
+    size_t Count() const { return count_; }
+    double Last() const { return last_; }
+    double Mean() const;
+    double Max() const;
+    double Percentile(double percentile) const;
+
+private:
+    std::vector<double> samples_;
+    size_t next_;
+    size_t count_;
+    double last_;
+};
+
+enum class GpuStage
+{
+    Copy,       // CopySubresourceRegion of the desktop image
+    Draw,       // textured quad
+    Cursor,     // cursor pass
+    Present,    // swap chain blit
+    Count
+};
+
+// How the mirror image reaches the host window
+enum class MirrorMode
+{
+    Duplication,    // desktop duplication, copied and drawn by us
+    WindowCapture,  // Windows.Graphics.Capture of the OnlyM media window only, copied and drawn by us
+    Thumbnail,      // DWM thumbnail of the OnlyM media window, composed by DWM
+    Count
+};
+
+struct MirrorStats
+{
+    MirrorStats();
+
+    // Capture and present
+    uint64_t capturedFrames;
+    uint64_t presentedFrames;
+    uint64_t skippedFrames;     // desktop frames accumulated by DXGI between our acquires
+    double captureFps;
+    double presentFps;
+    RollingStats dirtyAreaPercent;
+    RollingStats latencyMs;     // desktop present to mirror present
+    RollingStats presentAreaPercent;    // of the window redrawn and presented, per present
+
+    // CPU cost of building a frame: driver calls made and time spent in RenderFrame
+    RollingStats renderCalls;
+    RollingStats renderCpuUs;
+
+    // Glass-to-glass calibration: the latency pattern's time to the present that showed it
+    RollingStats glassLatencyMs;
+    uint64_t glassLatencyMisreads;  // presented patterns that couldn't be decoded
+
+    // Capture bandwidth
+    uint64_t copiedBytes;       // running total copied from captured frames into our texture
+    uint64_t fullOutputBytes;   // what copying the whole output for the same frames would have cost
+    double copyMBPerSecond;
+    double fullOutputMBPerSecond;
+
+    // Moving frames from the target's adapter to ours, when they differ
+    uint64_t transferredBytes;  // running total read back and uploaded
+    double transferMBPerSecond;
+    RollingStats transferMs;    // CPU time per frame, including the wait for the readback
+
+    // Video memory held by the texture pool, and how often a change reused a texture
+    uint64_t poolBytesInUse;
+    uint64_t poolBytesIdle;
+    uint64_t poolCreated;
+    uint64_t poolReused;
+    uint64_t poolEvicted;
+
+    // The render adapter's local video memory: our usage and the OS's budget for it, zero
+    // if the adapter doesn't report them
+    uint64_t videoMemoryUsage;
+    uint64_t videoMemoryBudget;
+
+    // The mirrored feed, measured on FrameProbe's reduced copies a few times a second
+    RollingStats feedMeanLuma;          // 0..1
+    RollingStats feedDarkPercent;       // of samples at or below black
+    RollingStats feedChangedPercent;    // of samples changed since the previous probe
+    RollingStats feedAnalysisUs;        // CPU time to convert and measure one probe
+
+    // GPU
+    RollingStats gpuStageMs[static_cast<int>(GpuStage::Count)];
+    RollingStats gpuFrameMs;
+    uint64_t gpuFramesTimed;
+    uint64_t gpuFramesDropped;  // query ring full or timestamps disjoint
+    double gpuBusyMs;           // running total of gpuFrameMs samples
+
+    // Cost of each mirror mode, sampled once per UpdateRates while that mode is active
+    MirrorMode mode;
+    RollingStats modeCpuPercent[static_cast<int>(MirrorMode::Count)];     // process CPU, % of one core
+    RollingStats modeGpuMsPerSecond[static_cast<int>(MirrorMode::Count)]; // our GPU work only
+    RollingStats modeCopyMBPerSecond[static_cast<int>(MirrorMode::Count)];
+
+    // Recalculates the frame rates from the counters and samples the cost of the current
+    // mode; call at a regular interval. processCpuSeconds is the process's total CPU time.
+    void UpdateRates(double elapsedSeconds, double processCpuSeconds);
+
+    static const char* GetStageName(GpuStage stage);
+    static const char* GetModeName(MirrorMode mode);
+
+    // Side-by-side cost of the mirror modes, e.g. "duplication cpu 3.1% gpu 42.0 ms/s | thumbnail ..."
+    int FormatModeCosts(char* buffer, size_t size) const;
+
+    // Single-line summary, e.g. for debug output. Returns the number of characters written.
+    int Format(char* buffer, size_t size) const;
+
+    // Compact multi-line summary for the on-screen HUD.
+    int FormatHud(char* buffer, size_t size) const;
+
+private:
+    uint64_t capturedAtLastUpdate_;
+    uint64_t presentedAtLastUpdate_;
+    uint64_t copiedAtLastUpdate_;
+    uint64_t fullOutputAtLastUpdate_;
+    uint64_t transferredAtLastUpdate_;
+    double gpuBusyAtLastUpdate_;
+    double cpuSecondsAtLastUpdate_;
+};
@@ -3,16 +3,58 @@
 #include <windows.h>
 #include <wincodec.h>
 #include <strsafe.h>
-#include "InstructionsWindow.h"
+#include <shellscalingapi.h>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "InstructionsOverlay.h"
 #include "HostWindow.h"
+#include "JournalDump.h"
+#include "Metrics.h"
+#include "MirrorLayout.h"
+#include "TileLayout.h"
+#include "TopologyWatcher.h"
 
-// WS_DISABLED prevents window being moved
-#define HOST_WINDOW_STYLES (WS_CLIPCHILDREN | WS_CAPTION | WS_DISABLED)
-#define HOST_WINDOW_STYLES_EX (WS_EX_TOPMOST | WS_EX_TOOLWINDOW)
+#pragma comment(lib, "Shcore.lib")
+
+// The window never takes the focus, and its caption can't be dragged (see HostWindow)
+#define HOST_WINDOW_STYLES (WS_CLIPCHILDREN | WS_CAPTION)
+#define HOST_WINDOW_STYLES_EX (WS_EX_TOPMOST | WS_EX_TOOLWINDOW | WS_EX_NOACTIVATE)
 
 // Global variables and strings.
 constexpr TCHAR WindowTitle[] = TEXT("OnlyM Mirror");
 constexpr int MaxMonitorNameLength = 32;
+constexpr size_t MaxPanes = 3;          // monitors tiled beside the target
+
+// Hotkey ids
+constexpr int CloseHotKeyId = 1;        // ALT+hotkey
+constexpr int HudHotKeyId = 2;          // ALT+SHIFT+hotkey
+constexpr int ZoomInHotKeyId = 3;       // ALT+SHIFT+Plus (main keyboard or keypad)
+constexpr int ZoomInPadHotKeyId = 4;
+constexpr int ZoomOutHotKeyId = 5;      // ALT+SHIFT+Minus
+constexpr int ZoomOutPadHotKeyId = 6;
+constexpr int PanLeftHotKeyId = 7;      // ALT+SHIFT+arrows
+constexpr int PanRightHotKeyId = 8;
+constexpr int PanUpHotKeyId = 9;
+constexpr int PanDownHotKeyId = 10;
+constexpr int ResetViewHotKeyId = 11;   // ALT+SHIFT+0
+constexpr int ActualSizeHotKeyId = 12;  // ALT+SHIFT+1
+constexpr int LensHotKeyId = 13;        // ALT+SHIFT+F1
+constexpr int LensShapeHotKeyId = 14;   // ALT+SHIFT+F2
+constexpr int LensReduceHotKeyId = 15;  // ALT+SHIFT+F3
+constexpr int LensEnlargeHotKeyId = 16; // ALT+SHIFT+F4
+constexpr int LatencyHotKeyId = 17;     // ALT+SHIFT+F5
+constexpr int JournalHotKeyId = 18;     // ALT+SHIFT+F6
+constexpr int SnapshotHotKeyId = 19;    // ALT+SHIFT+F7
+constexpr int BorderCropHotKeyId = 20;  // ALT+SHIFT+F8
+constexpr int MirrorKeysHotKeyId = 21;  // ALT+SHIFT+M, turns the keys from 3 to 20 on and off
+
+// The mirror keys turn off again after this long without one being pressed
+constexpr ULONGLONG MirrorKeysTimeoutMs = 10000;
+
+// Mirror view pan step for the keyboard, as a fraction of the view
+constexpr double PanStep = 0.1;
 
 namespace
 {
@@ -22,17 +64,70 @@ namespace
     RECT targetMonitorRect;
     TCHAR mainMonitorName[MaxMonitorNameLength + 1];
     TCHAR targetMonitorName[MaxMonitorNameLength + 1];
+    std::vector<std::string> paneMonitorNames;
+    std::vector<RECT> paneMonitorRects;
+
+    // Monitors are followed by these, as GDI device names are reassigned when the display
+    // topology changes
+    TopologyWatcher topologyWatcher;
+    std::string mainMonitorId;
+    std::string targetMonitorId;
+    std::vector<std::string> paneMonitorIds;
+
     float zoomFactor = 1.0F;
     TCHAR hotKey = 'Z';
+    double lensZoom = MagnifierLens::DefaultZoom;
+
+    struct MirrorKey
+    {
+        int id;
+        UINT modifiers;
+        UINT vkCode;
+        const char* name;
+    };
+
+    // Only registered while the mirror keys are on, so that these combinations aren't held
+    // system-wide for as long as the mirror runs. No MOD_NOREPEAT on zoom, pan and lens
+    // size so that holding a key keeps going; plain F1-F4 belong to OnlyM's own magnifier.
+    const MirrorKey MirrorKeys[] = {
+        { ZoomInHotKeyId, MOD_ALT | MOD_SHIFT, VK_OEM_PLUS, "ALT+SHIFT+Plus" },
+        { ZoomInPadHotKeyId, MOD_ALT | MOD_SHIFT, VK_ADD, "ALT+SHIFT+keypad Plus" },
+        { ZoomOutHotKeyId, MOD_ALT | MOD_SHIFT, VK_OEM_MINUS, "ALT+SHIFT+Minus" },
+        { ZoomOutPadHotKeyId, MOD_ALT | MOD_SHIFT, VK_SUBTRACT, "ALT+SHIFT+keypad Minus" },
+        { PanLeftHotKeyId, MOD_ALT | MOD_SHIFT, VK_LEFT, "ALT+SHIFT+Left" },
+        { PanRightHotKeyId, MOD_ALT | MOD_SHIFT, VK_RIGHT, "ALT+SHIFT+Right" },
+        { PanUpHotKeyId, MOD_ALT | MOD_SHIFT, VK_UP, "ALT+SHIFT+Up" },
+        { PanDownHotKeyId, MOD_ALT | MOD_SHIFT, VK_DOWN, "ALT+SHIFT+Down" },
+        { ResetViewHotKeyId, MOD_ALT | MOD_SHIFT | MOD_NOREPEAT, '0', "ALT+SHIFT+0" },
+        { ActualSizeHotKeyId, MOD_ALT | MOD_SHIFT | MOD_NOREPEAT, '1', "ALT+SHIFT+1" },
+        { LensHotKeyId, MOD_ALT | MOD_SHIFT | MOD_NOREPEAT, VK_F1, "ALT+SHIFT+F1" },
+        { LensShapeHotKeyId, MOD_ALT | MOD_SHIFT | MOD_NOREPEAT, VK_F2, "ALT+SHIFT+F2" },
+        { LensReduceHotKeyId, MOD_ALT | MOD_SHIFT, VK_F3, "ALT+SHIFT+F3" },
+        { LensEnlargeHotKeyId, MOD_ALT | MOD_SHIFT, VK_F4, "ALT+SHIFT+F4" },
+        { LatencyHotKeyId, MOD_ALT | MOD_SHIFT | MOD_NOREPEAT, VK_F5, "ALT+SHIFT+F5" },
+        { JournalHotKeyId, MOD_ALT | MOD_SHIFT | MOD_NOREPEAT, VK_F6, "ALT+SHIFT+F6" },
+        { SnapshotHotKeyId, MOD_ALT | MOD_SHIFT | MOD_NOREPEAT, VK_F7, "ALT+SHIFT+F7" },
+        { BorderCropHotKeyId, MOD_ALT | MOD_SHIFT | MOD_NOREPEAT, VK_F8, "ALT+SHIFT+F8" } };
+
+    bool mirrorKeysOn = false;
+    ULONGLONG lastMirrorKeyTime = 0;
 }
 
 // Forward declarations.
 namespace
 {
+    void InitDpiAwareness();
+    UINT GetMonitorDpi(const RECT& monitorRect);
+    void CalculateLayout(RECT& windowRect, float& zoom);
     bool SetupMirror(HINSTANCE instance);    
-    BOOL CALLBACK OnlyMMonitorEnumProc(HMONITOR monitor, HDC monitorDeviceContext, LPRECT monitorRect, LPARAM data);
     bool InitMonitors();
+    bool ResolveMonitors();
+    void OnTopologyChanged(const TopologyChanges& changes);
     bool InitHotKey();
+    bool TryRegisterHotKey(int id, UINT modifiers, UINT vkCode, const char* name);
+    void SetMirrorKeys(bool on);
+    void UpdateCaption();
+    void OnHotKey(int id);
     bool InitFromCommandLine();
 }
 
@@ -51,6 +146,9 @@ int APIENTRY WinMain(
 {
     applicationInstance = hInstance;
 
+    JournalDump::Install();
+    InitDpiAwareness();
+
 	if (!InitFromCommandLine())
 	{
 		return 1;
@@ -61,6 +159,18 @@ int APIENTRY WinMain(
 		return 4;
 	}
 
+	// Before SetupMirror, which starts the device and shader threads
+	const HANDLE applicationMutex = ::CreateMutex(nullptr, TRUE, "OnlyMMirrorMutex");
+	if (!applicationMutex || ::GetLastError() == ERROR_ALREADY_EXISTS)
+	{
+		if (applicationMutex)
+		{
+			CloseHandle(applicationMutex);
+		}
+
+		return 10;
+	}
+
 	if (!SetupMirror(hInstance))
 	{
 		return 3;
@@ -72,57 +182,91 @@ int APIENTRY WinMain(
         return 5;
     }
 
-	int rv;
-
-	const HANDLE applicationMutex = ::CreateMutex(nullptr, TRUE, "OnlyMMirrorMutex");
-	if (applicationMutex && ::GetLastError() != ERROR_ALREADY_EXISTS)
-	{
-		hostWindow.Show(nCmdShow);
-		hostWindow.Update();
-		hostWindow.PositionCursor();
-
-		TCHAR caption[64];
-		(void)sprintf_s(caption, "%s (ALT+%c to close)", WindowTitle, hotKey);
+	hostWindow.Show(nCmdShow);
+	hostWindow.Update();
+	Metrics::Write("startup.time_to_window_ms", Metrics::GetUptimeMs());
+	hostWindow.PositionCursor();
+	UpdateCaption();
 
-		hostWindow.SetCaption(caption);
-		
-        MSG msg = {};
-        while (msg.message != WM_QUIT)
+    MSG msg = {};
+    while (msg.message != WM_QUIT)
+    {
+        if (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE))
         {
-            if (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE))
+            if (msg.message == WM_HOTKEY)
             {
-                if (msg.message == WM_HOTKEY)
+                if (msg.wParam == CloseHotKeyId)
                 {
-                    // we only register one hotkey so its value doesn't matter
                     break;
                 }
-                TranslateMessage(&msg);
-                DispatchMessage(&msg);
+
+                OnHotKey(static_cast<int>(msg.wParam));
+                continue;
             }
-            else
+            TranslateMessage(&msg);
+            DispatchMessage(&msg);
+        }
+        else
+        {
+            if (mirrorKeysOn && GetTickCount64() - lastMirrorKeyTime > MirrorKeysTimeoutMs)
             {
-                // When no messages are pending, update and render a frame.
-                hostWindow.UpdateMirror(targetMonitorRect);
+                SetMirrorKeys(false);
             }
-        }
 
-        // find OnlyM window and reposition cursor over it...
-        HostWindow::RepositionCursor();
+            // Monitors connected, disconnected, renumbered or rearranged: once it settles,
+            // follow the main and target monitors to where they are now
+            if (hostWindow.TakeDisplayChange())
+            {
+                topologyWatcher.OnDisplayChange();
+            }
 
-        rv = static_cast<int>(msg.wParam);
+            TopologyChanges changes;
+            if (topologyWatcher.Poll(changes))
+            {
+                OnTopologyChanged(changes);
+            }
 
-        CloseHandle(applicationMutex);
+            // When no messages are pending, update and render a frame.
+            hostWindow.UpdateMirror(targetMonitorRect);
+        }
     }
-	else
-	{
-		rv = 10;
-	}
 
-	return rv;
+    JournalDump::Write(JournalDumpReason::Exit);
+
+    // find OnlyM window and reposition cursor over it...
+    HostWindow::RepositionCursor();
+
+    CloseHandle(applicationMutex);
+
+    return static_cast<int>(msg.wParam);
 }
 
 namespace
 {
+    void InitDpiAwareness()
+    {
+        // Per-monitor v2 so that monitor rects, our client area and the swap chain are all in
+        // physical pixels. Otherwise Windows bitmap-stretches the mirror on a scaled monitor.
+        if (!SetProcessDpiAwarenessContext(DPI_AWARENESS_CONTEXT_PER_MONITOR_AWARE_V2))
+        {
+            SetProcessDPIAware();
+        }
+    }
+
+    UINT GetMonitorDpi(const RECT& monitorRect)
+    {
+        UINT dpiX = USER_DEFAULT_SCREEN_DPI;
+        UINT dpiY = USER_DEFAULT_SCREEN_DPI;
+
+        const HMONITOR monitor = MonitorFromRect(&monitorRect, MONITOR_DEFAULTTONEAREST);
+        if (FAILED(GetDpiForMonitor(monitor, MDT_EFFECTIVE_DPI, &dpiX, &dpiY)))
+        {
+            return USER_DEFAULT_SCREEN_DPI;
+        }
+
+        return dpiY;
+    }
+
     bool InitFromCommandLine()
     {
         bool rv = FALSE;
@@ -131,8 +275,25 @@ namespace
         {
 #pragma warning(suppress: 6031)
             lstrcpyn(mainMonitorName, __argv[1], MaxMonitorNameLength);
+            // The target may be a comma-separated list; the first is the main target and
+            // the rest are tiled beside it
+            const std::string targets = __argv[2];
+            const size_t comma = targets.find(',');
 #pragma warning(suppress: 6031)
-            lstrcpyn(targetMonitorName, __argv[2], MaxMonitorNameLength);
+            lstrcpyn(targetMonitorName, targets.substr(0, comma).c_str(), MaxMonitorNameLength);
+
+            for (size_t start = comma; start != std::string::npos && paneMonitorNames.size() < MaxPanes;)
+            {
+                const size_t end = targets.find(',', start + 1);
+                const std::string name = targets.substr(start + 1, end == std::string::npos ? std::string::npos : end - start - 1);
+                if (!name.empty() && name.length() <= MaxMonitorNameLength)
+                {
+                    paneMonitorNames.push_back(name);
+                }
+
+                start = end;
+            }
+
             rv = TRUE;
         }
 
@@ -150,76 +311,309 @@ namespace
             hotKey = __argv[4][0];
         }
 
+        if (__argc >= 6)
+        {
+            lensZoom = atof(__argv[5]);  // NOLINT(cert-err34-c)
+            if (lensZoom <= 0.0)
+            {
+                lensZoom = MagnifierLens::DefaultZoom;
+            }
+        }
+
         return rv;
     }
 
     bool InitMonitors()
     {
-        EnumDisplayMonitors(nullptr, nullptr, OnlyMMonitorEnumProc, 0);
+        if (!topologyWatcher.Start())
+        {
+            return false;
+        }
+
+        // The command line names monitors by GDI device name; from here on they're followed by id
+        const std::vector<DisplayMonitor>& monitors = topologyWatcher.GetMonitors();
+        const DisplayMonitor* mainMonitor = TopologyDiff::FindByDeviceName(monitors, mainMonitorName);
+        const DisplayMonitor* targetMonitor = TopologyDiff::FindByDeviceName(monitors, targetMonitorName);
+        if (!mainMonitor || !targetMonitor)
+        {
+            return false;
+        }
+
+        mainMonitorId = mainMonitor->id;
+        targetMonitorId = targetMonitor->id;
+
+        // Tiled monitors that aren't connected are left out
+        for (const std::string& name : paneMonitorNames)
+        {
+            const DisplayMonitor* paneMonitor = TopologyDiff::FindByDeviceName(monitors, name);
+            if (paneMonitor)
+            {
+                paneMonitorIds.push_back(paneMonitor->id);
+            }
+        }
+
+        return ResolveMonitors();
+    }
+
+    bool ResolveMonitors()
+    {
+        const std::vector<DisplayMonitor>& monitors = topologyWatcher.GetMonitors();
+        const DisplayMonitor* mainMonitor = TopologyDiff::FindById(monitors, mainMonitorId);
+        const DisplayMonitor* targetMonitor = TopologyDiff::FindById(monitors, targetMonitorId);
+        if (!mainMonitor || !targetMonitor)
+        {
+            return false;
+        }
+
+#pragma warning(suppress: 6031)
+        lstrcpyn(mainMonitorName, mainMonitor->deviceName.c_str(), MaxMonitorNameLength);
+        mainMonitorRect = { mainMonitor->workArea.left, mainMonitor->workArea.top, mainMonitor->workArea.right, mainMonitor->workArea.bottom };
 
-        return
-            mainMonitorRect.left != mainMonitorRect.right &&
-            targetMonitorRect.left != targetMonitorRect.right;
+#pragma warning(suppress: 6031)
+        lstrcpyn(targetMonitorName, targetMonitor->deviceName.c_str(), MaxMonitorNameLength);
+        targetMonitorRect = { targetMonitor->bounds.left, targetMonitor->bounds.top, targetMonitor->bounds.right, targetMonitor->bounds.bottom };
+
+        // Tiled monitors that are disconnected are left out until they come back
+        paneMonitorNames.clear();
+        paneMonitorRects.clear();
+        for (const std::string& id : paneMonitorIds)
+        {
+            const DisplayMonitor* paneMonitor = TopologyDiff::FindById(monitors, id);
+            if (paneMonitor)
+            {
+                paneMonitorNames.push_back(paneMonitor->deviceName);
+                paneMonitorRects.push_back({ paneMonitor->bounds.left, paneMonitor->bounds.top, paneMonitor->bounds.right, paneMonitor->bounds.bottom });
+            }
+        }
+
+        return true;
+    }
+
+    void OnTopologyChanged(const TopologyChanges& changes)
+    {
+        bool affected = changes.Affects(mainMonitorId) || changes.Affects(targetMonitorId);
+        for (const std::string& id : paneMonitorIds)
+        {
+            affected = affected || changes.Affects(id);
+        }
+
+        if (!affected)
+        {
+            return;
+        }
+
+        if (!ResolveMonitors())
+        {
+            // Keep showing the last frame; the next change may bring the monitor back
+            Metrics::Event("topology.change", "main or target monitor disconnected");
+            return;
+        }
+
+        RECT windowRect;
+        float zoom;
+        CalculateLayout(windowRect, zoom);
+
+        // Duplication is rebound; the device and swap chain are kept so there's no blackout
+        hostWindow.Rebind(targetMonitorRect, targetMonitorName, paneMonitorNames);
+        hostWindow.Reposition(
+            windowRect.left, windowRect.top, windowRect.right - windowRect.left, windowRect.bottom - windowRect.top, zoom);
+
+        char detail[128];
+        (void)snprintf(detail, sizeof(detail), "target %s, main %s, %zu tiled", targetMonitorName, mainMonitorName, paneMonitorNames.size());
+        Metrics::Event("topology.rebind", detail);
     }
 
     bool InitHotKey()
     {
         const UINT vkCode = 0x41 + hotKey - 'A';
-        return ::RegisterHotKey(nullptr, 1, MOD_ALT, vkCode);  //0x5A is 'Z'
+        char name[16];
+        (void)snprintf(name, sizeof(name), "ALT+%c", hotKey);
+        if (!TryRegisterHotKey(CloseHotKeyId, MOD_ALT, vkCode, name))  //0x5A is 'Z'
+        {
+            return false;
+        }
+
+        // the HUD and mirror keys are optional so don't fail if they're taken
+        (void)snprintf(name, sizeof(name), "ALT+SHIFT+%c", hotKey);
+        TryRegisterHotKey(HudHotKeyId, MOD_ALT | MOD_SHIFT | MOD_NOREPEAT, vkCode, name);
+        TryRegisterHotKey(MirrorKeysHotKeyId, MOD_ALT | MOD_SHIFT | MOD_NOREPEAT, 'M', "ALT+SHIFT+M");
+
+        return true;
     }
 
-    BOOL CALLBACK OnlyMMonitorEnumProc(
-        HMONITOR monitor, HDC /*monitorDeviceContext*/, LPRECT /*monitorRect*/, LPARAM /*data*/)
+    bool TryRegisterHotKey(const int id, const UINT modifiers, const UINT vkCode, const char* name)
     {
-        if (monitor)
+        if (::RegisterHotKey(nullptr, id, modifiers, vkCode))
         {
-            MONITORINFOEX info{};
-            info.cbSize = sizeof(MONITORINFOEX);
-            ::GetMonitorInfo(monitor, &info);
+            return true;
+        }
+
+        // Most likely another application has it
+        char detail[64];
+        (void)snprintf(detail, sizeof(detail), "%s, error %lu", name, ::GetLastError());
+        Metrics::Event("hotkey.unavailable", detail);
+        return false;
+    }
+
+    void SetMirrorKeys(const bool on)
+    {
+        if (on == mirrorKeysOn)
+        {
+            return;
+        }
 
-            if (strcmp(info.szDevice, mainMonitorName) == 0)
+        for (const MirrorKey& key : MirrorKeys)
+        {
+            if (on)
             {
-                mainMonitorRect = info.rcWork;
+                TryRegisterHotKey(key.id, key.modifiers, key.vkCode, key.name);
             }
-
-            if (strcmp(info.szDevice, targetMonitorName) == 0)
+            else
             {
-                targetMonitorRect = info.rcMonitor;
+                ::UnregisterHotKey(nullptr, key.id);
             }
         }
 
-        return true;
+        mirrorKeysOn = on;
+        lastMirrorKeyTime = GetTickCount64();
+        UpdateCaption();
     }
 
-    bool SetupMirror(const HINSTANCE instance)
+    void UpdateCaption()
     {
-        // 1. Calculate height of instructionsWindow
-        const int instructionsHeight = InstructionsWindow::CalculateInstructionsWindowHeight();
+        TCHAR caption[96];
+        (void)sprintf_s(caption, "%s (ALT+%c to close)%s", WindowTitle, hotKey, mirrorKeysOn ? " - mirror keys on" : "");
+        hostWindow.SetCaption(caption);
+    }
 
-        // 2. Set bounds of host window according to size of media monitor...
-        const int mediaMonitorHeight = targetMonitorRect.bottom - targetMonitorRect.top;
-        const int mediaMonitorWidth = targetMonitorRect.right - targetMonitorRect.left;
+    void OnHotKey(const int id)
+    {
+        if (mirrorKeysOn)
+        {
+            lastMirrorKeyTime = GetTickCount64();
+        }
+
+        switch (id)
+        {
+            case HudHotKeyId:
+                hostWindow.ToggleHud();
+                break;
+
+            case MirrorKeysHotKeyId:
+                SetMirrorKeys(!mirrorKeysOn);
+                break;
+
+            case ZoomInHotKeyId:
+            case ZoomInPadHotKeyId:
+                hostWindow.ZoomView(HostWindow::ZoomStep);
+                break;
+
+            case ZoomOutHotKeyId:
+            case ZoomOutPadHotKeyId:
+                hostWindow.ZoomView(1.0 / HostWindow::ZoomStep);
+                break;
+
+            case PanLeftHotKeyId:
+                hostWindow.PanView(-PanStep, 0.0);
+                break;
+
+            case PanRightHotKeyId:
+                hostWindow.PanView(PanStep, 0.0);
+                break;
+
+            case PanUpHotKeyId:
+                hostWindow.PanView(0.0, -PanStep);
+                break;
+
+            case PanDownHotKeyId:
+                hostWindow.PanView(0.0, PanStep);
+                break;
+
+            case ResetViewHotKeyId:
+                hostWindow.ResetView();
+                break;
+
+            case ActualSizeHotKeyId:
+                hostWindow.ShowActualSize();
+                break;
+
+            case LensHotKeyId:
+                hostWindow.ToggleLens();
+                break;
+
+            case LensShapeHotKeyId:
+                hostWindow.ToggleLensShape();
+                break;
+
+            case LensReduceHotKeyId:
+                hostWindow.ReduceLens();
+                break;
+
+            case LensEnlargeHotKeyId:
+                hostWindow.EnlargeLens();
+                break;
+
+            case LatencyHotKeyId:
+                hostWindow.ToggleLatencyCalibration();
+                break;
+
+            case JournalHotKeyId:
+                JournalDump::Write(JournalDumpReason::HotKey);
+                break;
+
+            case SnapshotHotKeyId:
+                hostWindow.TakeSnapshot();
+                break;
+
+            case BorderCropHotKeyId:
+                hostWindow.ToggleBorderCrop();
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    void CalculateLayout(RECT& windowRect, float& zoom)
+    {
+        // 1. Calculate height of the instructions strip (at the DPI of the monitor hosting the mirror)
+        const UINT hostDpi = GetMonitorDpi(mainMonitorRect);
+        const int instructionsHeight = InstructionsOverlay::CalculateHeight(hostDpi);
+
+        // 2. Set bounds of host window according to size of media monitor (or the row of
+        // media monitors when tiled)...
+        std::vector<PixelRect> mediaMonitors;
+        mediaMonitors.push_back({ targetMonitorRect.left, targetMonitorRect.top, targetMonitorRect.right, targetMonitorRect.bottom });
+        for (const RECT& rect : paneMonitorRects)
+        {
+            mediaMonitors.push_back({ rect.left, rect.top, rect.right, rect.bottom });
+        }
+
+        int mediaMonitorWidth;
+        int mediaMonitorHeight;
+        TileLayout::GetRowSize(mediaMonitors, mediaMonitorWidth, mediaMonitorHeight);
 
         const int hostMonitorHeight = mainMonitorRect.bottom - mainMonitorRect.top;
         const int hostMonitorWidth = mainMonitorRect.right - mainMonitorRect.left;
 
-        // 3. Calculate the maximum zoom factor that fits in the main monitor
-        const float maxZoomWidth = static_cast<float>(hostMonitorWidth) / static_cast<float>(mediaMonitorWidth);
-        const float maxZoomHeight = static_cast<float>(hostMonitorHeight - instructionsHeight) / static_cast<float>(mediaMonitorHeight);
-        const float maxZoom = (maxZoomWidth < maxZoomHeight) ? maxZoomWidth : maxZoomHeight;
+        // 3. Limit the zoom factor to what fits in the main monitor
+        const auto maxZoom = static_cast<float>(MirrorLayout::GetFitScale(
+            mediaMonitorWidth, mediaMonitorHeight, hostMonitorWidth, hostMonitorHeight - instructionsHeight));
 
-        if (zoomFactor > maxZoom)  // NOLINT(readability-use-std-min-max)
+        zoom = zoomFactor;
+        if (zoom > maxZoom)  // NOLINT(readability-use-std-min-max)
         {
-            zoomFactor = maxZoom;
+            zoom = maxZoom;
         }
 
-        // 4. Calculate the intended client area size (scaled by ZoomFactor)
-        const int clientHeight = static_cast<int>(mediaMonitorHeight * zoomFactor);  // NOLINT(clang-diagnostic-implicit-int-float-conversion, bugprone-narrowing-conversions, cppcoreguidelines-narrowing-conversions)
-        const int clientWidth = static_cast<int>(mediaMonitorWidth * zoomFactor); // NOLINT(clang-diagnostic-implicit-int-float-conversion, bugprone-narrowing-conversions, cppcoreguidelines-narrowing-conversions)
+        // 4. Calculate the intended client area size (scaled by ZoomFactor). Rounding rather
+        // than truncating keeps e.g. 1/3 scale an exact third, for the box filter.
+        const int clientHeight = static_cast<int>(std::lround(mediaMonitorHeight * static_cast<double>(zoom)));
+        const int clientWidth = static_cast<int>(std::lround(mediaMonitorWidth * static_cast<double>(zoom)));
 
         // 5. Add space for instructions
-        RECT windowRect = { 0, 0, clientWidth, clientHeight + instructionsHeight };
-        AdjustWindowRectEx(&windowRect, HOST_WINDOW_STYLES, FALSE, HOST_WINDOW_STYLES_EX);
+        windowRect = { 0, 0, clientWidth, clientHeight + instructionsHeight };
+        AdjustWindowRectExForDpi(&windowRect, HOST_WINDOW_STYLES, FALSE, HOST_WINDOW_STYLES_EX, hostDpi);
 
         const int winWidth = windowRect.right - windowRect.left;
         const int winHeight = windowRect.bottom - windowRect.top;
@@ -238,7 +632,19 @@ namespace
             winTop = mainMonitorRect.top;
         }
 
+        windowRect = { winLeft, winTop, winLeft + winWidth, winTop + winHeight };
+    }
+
+    bool SetupMirror(const HINSTANCE instance)
+    {
+        RECT windowRect;
+        float zoom;
+        CalculateLayout(windowRect, zoom);
+
+        hostWindow.GetDuplicationWindow().GetLens().SetZoom(lensZoom);
+
         return hostWindow.Create(
-            instance, winLeft, winTop, winWidth, winHeight, zoomFactor, targetMonitorRect, hotKey, targetMonitorName);
+            instance, windowRect.left, windowRect.top, windowRect.right - windowRect.left, windowRect.bottom - windowRect.top,
+            zoom, targetMonitorRect, hotKey, targetMonitorName, paneMonitorNames);
     }
 }
\ No newline at end of file
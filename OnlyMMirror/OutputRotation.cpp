@@ -0,0 +1,90 @@
+#include "OutputRotation.h"
+
+namespace RotationTransform
+{
+    bool SwapsAxes(const OutputRotation rotation)
+    {
+        return rotation == OutputRotation::Rotate90 || rotation == OutputRotation::Rotate270;
+    }
+
+    PixelRect DesktopToImage(const PixelRect& rect, const int width, const int height, const OutputRotation rotation)
+    {
+        switch (rotation)
+        {
+        case OutputRotation::Rotate90:
+            // Image (x, y) is shown at desktop (width - y, x)
+            return { rect.top, width - rect.right, rect.bottom, width - rect.left };
+
+        case OutputRotation::Rotate180:
+            return { width - rect.right, height - rect.bottom, width - rect.left, height - rect.top };
+
+        case OutputRotation::Rotate270:
+            // Image (x, y) is shown at desktop (y, height - x)
+            return { height - rect.bottom, rect.left, height - rect.top, rect.right };
+
+        default:
+            return rect;
+        }
+    }
+
+    PixelRect ImageToDesktop(const PixelRect& rect, const int width, const int height, const OutputRotation rotation)
+    {
+        switch (rotation)
+        {
+        case OutputRotation::Rotate90:
+            return { width - rect.bottom, rect.left, width - rect.top, rect.right };
+
+        case OutputRotation::Rotate180:
+            return { width - rect.right, height - rect.bottom, width - rect.left, height - rect.top };
+
+        case OutputRotation::Rotate270:
+            return { rect.top, height - rect.right, rect.bottom, height - rect.left };
+
+        default:
+            return rect;
+        }
+    }
+
+    void DesktopToImage(const float u, const float v, const OutputRotation rotation, float& imageU, float& imageV)
+    {
+        switch (rotation)
+        {
+        case OutputRotation::Rotate90:
+            imageU = v;
+            imageV = 1.0f - u;
+            break;
+
+        case OutputRotation::Rotate180:
+            imageU = 1.0f - u;
+            imageV = 1.0f - v;
+            break;
+
+        case OutputRotation::Rotate270:
+            imageU = 1.0f - v;
+            imageV = u;
+            break;
+
+        default:
+            imageU = u;
+            imageV = v;
+            break;
+        }
+    }
+
+    void GetCornerTexCoords(const QuadMapping& mapping, const OutputRotation rotation, float texCoords[4][2])
+    {
+        // v0 is at the top and v1 at the bottom, as in the unrotated quad
+        const float corners[4][2] =
+        {
+            { mapping.u0, mapping.v1 },
+            { mapping.u0, mapping.v0 },
+            { mapping.u1, mapping.v1 },
+            { mapping.u1, mapping.v0 }
+        };
+
+        for (int n = 0; n < 4; ++n)
+        {
+            DesktopToImage(corners[n][0], corners[n][1], rotation, texCoords[n][0], texCoords[n][1]);
+        }
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+// Portable coordinate maths for rotated (e.g. portrait) outputs. Desktop duplication hands
+// over the image in the output's unrotated scan-out orientation, and its dirty and move rects
+// are in the image's coordinates. Desktop coordinates, the pointer position and the view are
+// in the rotated orientation the user sees. Rather than rotate-copying each frame, the mirror
+// copies in image coordinates and rotates the texture coordinates at the quad's corners.
+
+#include "ViewTransform.h"
+
+// Same values as DXGI_MODE_ROTATION
+enum class OutputRotation
+{
+    Unspecified = 0,
+    Identity = 1,
+    Rotate90 = 2,
+    Rotate180 = 3,
+    Rotate270 = 4
+};
+
+namespace RotationTransform
+{
+    // True for 90 and 270 degrees, where the image's width is the desktop's height
+    bool SwapsAxes(OutputRotation rotation);
+
+    // Convert rects between desktop coordinates, relative to the output's top left, and the
+    // image's coordinates. width and height are the output's size in desktop coordinates.
+    PixelRect DesktopToImage(const PixelRect& rect, int width, int height, OutputRotation rotation);
+    PixelRect ImageToDesktop(const PixelRect& rect, int width, int height, OutputRotation rotation);
+
+    // Converts normalised coordinates across the output from desktop to image orientation
+    void DesktopToImage(float u, float v, OutputRotation rotation, float& imageU, float& imageV);
+
+    // The image's texture coordinates at the corners of mapping, whose u and v are in desktop
+    // orientation, in the vertex order bottom left, top left, bottom right, top right
+    void GetCornerTexCoords(const QuadMapping& mapping, OutputRotation rotation, float texCoords[4][2]);
+}
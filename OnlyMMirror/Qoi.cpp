@@ -0,0 +1,355 @@
+#include "Qoi.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+namespace
+{
+    constexpr uint8_t OpIndex = 0x00;
+    constexpr uint8_t OpDiff = 0x40;
+    constexpr uint8_t OpLuma = 0x80;
+    constexpr uint8_t OpRun = 0xc0;
+    constexpr uint8_t OpRgb = 0xfe;
+    constexpr uint8_t OpRgba = 0xff;
+    constexpr uint8_t OpMask = 0xc0;
+    constexpr int MaxRun = 62;
+    constexpr int IndexSize = 64;
+
+    // Worst case for an opaque pixel: QOI_OP_RGB
+    constexpr size_t MaxBytesPerPixel = 4;
+
+    // Largest image Decode accepts, as the format's reference implementation does
+    constexpr uint64_t MaxPixels = 400000000;
+
+    struct Pixel
+    {
+        uint8_t r;
+        uint8_t g;
+        uint8_t b;
+        uint8_t a;
+    };
+
+    bool operator==(const Pixel& left, const Pixel& right)
+    {
+        return left.r == right.r && left.g == right.g && left.b == right.b && left.a == right.a;
+    }
+
+    int Hash(const Pixel& pixel)
+    {
+        return (pixel.r * 3 + pixel.g * 5 + pixel.b * 7 + pixel.a * 11) % IndexSize;
+    }
+
+    Pixel ReadOpaque(const uint8_t* rgba)
+    {
+        return { rgba[0], rgba[1], rgba[2], 255 };
+    }
+
+    void WriteBigEndian(uint8_t* out, const uint32_t value)
+    {
+        out[0] = static_cast<uint8_t>(value >> 24);
+        out[1] = static_cast<uint8_t>(value >> 16);
+        out[2] = static_cast<uint8_t>(value >> 8);
+        out[3] = static_cast<uint8_t>(value);
+    }
+
+    uint32_t ReadBigEndian(const uint8_t* data)
+    {
+        return (static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16) |
+            (static_cast<uint32_t>(data[2]) << 8) | data[3];
+    }
+
+    // Encodes rows [firstRow, endRow) into out, which must have room for the worst case.
+    // Returns the number of bytes written.
+    size_t EncodeBand(
+        const uint8_t* rgba, const int width, const size_t stride, const int firstRow, const int endRow, uint8_t* out)
+    {
+        Pixel index[IndexSize] = {};
+        bool known[IndexSize];
+
+        // The decoder's state where the band starts: the first band has the format's
+        // initial state; later bands only know that the previous pixel is in the index
+        Pixel previous = { 0, 0, 0, 255 };
+        if (firstRow == 0)
+        {
+            std::fill(known, known + IndexSize, true);
+        }
+        else
+        {
+            std::fill(known, known + IndexSize, false);
+            previous = ReadOpaque(rgba + static_cast<size_t>(firstRow - 1) * stride + static_cast<size_t>(width - 1) * 4);
+            index[Hash(previous)] = previous;
+            known[Hash(previous)] = true;
+        }
+
+        uint8_t* write = out;
+        int run = 0;
+
+        for (int y = firstRow; y < endRow; ++y)
+        {
+            const uint8_t* row = rgba + static_cast<size_t>(y) * stride;
+            for (int x = 0; x < width; ++x)
+            {
+                const Pixel pixel = ReadOpaque(row + static_cast<size_t>(x) * 4);
+                if (pixel == previous)
+                {
+                    if (++run == MaxRun)
+                    {
+                        *write++ = static_cast<uint8_t>(OpRun | (run - 1));
+                        run = 0;
+                    }
+
+                    continue;
+                }
+
+                if (run > 0)
+                {
+                    *write++ = static_cast<uint8_t>(OpRun | (run - 1));
+                    run = 0;
+                }
+
+                const int position = Hash(pixel);
+                if (known[position] && index[position] == pixel)
+                {
+                    *write++ = static_cast<uint8_t>(OpIndex | position);
+                }
+                else
+                {
+                    index[position] = pixel;
+                    known[position] = true;
+
+                    const int dr = static_cast<int8_t>(pixel.r - previous.r);
+                    const int dg = static_cast<int8_t>(pixel.g - previous.g);
+                    const int db = static_cast<int8_t>(pixel.b - previous.b);
+                    const int drg = dr - dg;
+                    const int dbg = db - dg;
+
+                    if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+                    {
+                        *write++ = static_cast<uint8_t>(OpDiff | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2));
+                    }
+                    else if (dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8 && dbg <= 7)
+                    {
+                        *write++ = static_cast<uint8_t>(OpLuma | (dg + 32));
+                        *write++ = static_cast<uint8_t>(((drg + 8) << 4) | (dbg + 8));
+                    }
+                    else
+                    {
+                        *write++ = OpRgb;
+                        *write++ = pixel.r;
+                        *write++ = pixel.g;
+                        *write++ = pixel.b;
+                    }
+                }
+
+                previous = pixel;
+            }
+        }
+
+        // The next band starts its own run
+        if (run > 0)
+        {
+            *write++ = static_cast<uint8_t>(OpRun | (run - 1));
+        }
+
+        return static_cast<size_t>(write - out);
+    }
+
+    // Whole rows per band, and no more bands than threads
+    void GetBands(const int height, const unsigned threads, int& bandCount, int& bandRows)
+    {
+        bandCount = (std::max)(1, (std::min)(static_cast<int>((std::max)(threads, 1u)), height / Qoi::MinBandRows));
+        bandRows = (height + bandCount - 1) / bandCount;
+    }
+}
+
+namespace Qoi
+{
+    size_t GetMaxEncodedSize(const int width, const int height, const unsigned threads)
+    {
+        if (width <= 0 || height <= 0)
+        {
+            return 0;
+        }
+
+        int bandCount;
+        int bandRows;
+        GetBands(height, threads, bandCount, bandRows);
+        return HeaderSize + static_cast<size_t>(width) * bandRows * MaxBytesPerPixel * bandCount + EndMarkerSize;
+    }
+
+    bool Encode(
+        const uint8_t* rgba, const int width, const int height, const size_t stride, const unsigned threads,
+        uint8_t* out, const size_t capacity, size_t& size)
+    {
+        size = 0;
+        if (!rgba || !out || width <= 0 || height <= 0 || stride < static_cast<size_t>(width) * 4 ||
+            capacity < GetMaxEncodedSize(width, height, threads))
+        {
+            return false;
+        }
+
+        int bandCount;
+        int bandRows;
+        GetBands(height, threads, bandCount, bandRows);
+        const size_t bandCapacity = static_cast<size_t>(width) * bandRows * MaxBytesPerPixel;
+
+        // Each band is written to its own part of out, then the parts are closed up
+        std::vector<size_t> bandSizes(bandCount);
+
+        const auto encodeBand = [&](const int band)
+        {
+            const int firstRow = band * bandRows;
+            const int endRow = (std::min)(height, firstRow + bandRows);
+            bandSizes[band] = firstRow < endRow ?
+                EncodeBand(rgba, width, stride, firstRow, endRow, out + HeaderSize + bandCapacity * band) : 0;
+        };
+
+        std::vector<std::thread> workers;
+        workers.reserve(bandCount - 1);
+        for (int band = 1; band < bandCount; ++band)
+        {
+            workers.emplace_back(encodeBand, band);
+        }
+
+        encodeBand(0);
+        for (std::thread& worker : workers)
+        {
+            worker.join();
+        }
+
+        memcpy(out, "qoif", 4);
+        WriteBigEndian(out + 4, static_cast<uint32_t>(width));
+        WriteBigEndian(out + 8, static_cast<uint32_t>(height));
+        out[12] = 3;     // RGB
+        out[13] = 0;     // sRGB
+
+        size = HeaderSize + bandSizes[0];
+        for (int band = 1; band < bandCount; ++band)
+        {
+            memmove(out + size, out + HeaderSize + bandCapacity * band, bandSizes[band]);
+            size += bandSizes[band];
+        }
+
+        static constexpr uint8_t EndMarker[EndMarkerSize] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+        memcpy(out + size, EndMarker, EndMarkerSize);
+        size += EndMarkerSize;
+        return true;
+    }
+
+    bool Encode(
+        const uint8_t* rgba, const int width, const int height, const size_t stride, const unsigned threads,
+        std::vector<uint8_t>& out)
+    {
+        out.resize(GetMaxEncodedSize(width, height, threads));
+
+        size_t size = 0;
+        const bool encoded = Encode(rgba, width, height, stride, threads, out.data(), out.size(), size);
+        out.resize(size);
+        return encoded;
+    }
+
+    bool Decode(const uint8_t* data, const size_t size, int& width, int& height, std::vector<uint8_t>& rgba)
+    {
+        rgba.clear();
+        if (!data || size < HeaderSize + EndMarkerSize || memcmp(data, "qoif", 4) != 0)
+        {
+            return false;
+        }
+
+        const uint32_t imageWidth = ReadBigEndian(data + 4);
+        const uint32_t imageHeight = ReadBigEndian(data + 8);
+        if (imageWidth == 0 || imageHeight == 0 || static_cast<uint64_t>(imageWidth) * imageHeight > MaxPixels ||
+            data[12] < 3 || data[12] > 4)
+        {
+            return false;
+        }
+
+        const size_t pixelCount = static_cast<size_t>(imageWidth) * imageHeight;
+        rgba.resize(pixelCount * 4);
+
+        Pixel index[IndexSize] = {};
+        Pixel pixel = { 0, 0, 0, 255 };
+        const size_t end = size - EndMarkerSize;
+        size_t read = HeaderSize;
+        int run = 0;
+
+        for (size_t n = 0; n < pixelCount; ++n)
+        {
+            if (run > 0)
+            {
+                --run;
+            }
+            else if (read < end)
+            {
+                const uint8_t op = data[read++];
+                if (op == OpRgb)
+                {
+                    if (read + 3 > end)
+                    {
+                        return false;
+                    }
+
+                    pixel.r = data[read];
+                    pixel.g = data[read + 1];
+                    pixel.b = data[read + 2];
+                    read += 3;
+                }
+                else if (op == OpRgba)
+                {
+                    if (read + 4 > end)
+                    {
+                        return false;
+                    }
+
+                    pixel = { data[read], data[read + 1], data[read + 2], data[read + 3] };
+                    read += 4;
+                }
+                else if ((op & OpMask) == OpIndex)
+                {
+                    pixel = index[op];
+                }
+                else if ((op & OpMask) == OpDiff)
+                {
+                    pixel.r = static_cast<uint8_t>(pixel.r + ((op >> 4) & 3) - 2);
+                    pixel.g = static_cast<uint8_t>(pixel.g + ((op >> 2) & 3) - 2);
+                    pixel.b = static_cast<uint8_t>(pixel.b + (op & 3) - 2);
+                }
+                else if ((op & OpMask) == OpLuma)
+                {
+                    if (read >= end)
+                    {
+                        return false;
+                    }
+
+                    const uint8_t second = data[read++];
+                    const int dg = (op & 0x3f) - 32;
+                    pixel.r = static_cast<uint8_t>(pixel.r + dg - 8 + ((second >> 4) & 0x0f));
+                    pixel.g = static_cast<uint8_t>(pixel.g + dg);
+                    pixel.b = static_cast<uint8_t>(pixel.b + dg - 8 + (second & 0x0f));
+                }
+                else
+                {
+                    run = op & 0x3f;
+                }
+
+                index[Hash(pixel)] = pixel;
+            }
+            else
+            {
+                // Ran out of data
+                return false;
+            }
+
+            uint8_t* write = rgba.data() + n * 4;
+            write[0] = pixel.r;
+            write[1] = pixel.g;
+            write[2] = pixel.b;
+            write[3] = pixel.a;
+        }
+
+        width = static_cast<int>(imageWidth);
+        height = static_cast<int>(imageHeight);
+        return true;
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+// Portable encoder and decoder for QOI ("Quite OK Image", qoiformat.org) images, used for
+// snapshots of the mirror. QOI files are about the size of PNGs but take a fraction of the
+// time to encode, and QOI needs no zlib.
+//
+// Encoding can be split across threads. The image is cut into bands of whole rows, and
+// each band is encoded on its own, starting from the last pixel of the band before. A
+// band only refers to colour index entries it has set itself (or that the decoder is sure
+// to have, such as the previous pixel's), and runs are ended at each band's end, so the
+// bands can simply be concatenated into one standard QOI stream.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Qoi
+{
+    // Encodes width * height RGBA pixels, stride bytes apart row to row, as an opaque
+    // 3-channel sRGB image; alpha is ignored. threads is a maximum: small images use fewer.
+    bool Encode(const uint8_t* rgba, int width, int height, size_t stride, unsigned threads, std::vector<uint8_t>& out);
+
+    // As above, into capacity bytes at out, which must be at least GetMaxEncodedSize; size
+    // is set to the length of the image written
+    bool Encode(const uint8_t* rgba, int width, int height, size_t stride, unsigned threads,
+        uint8_t* out, size_t capacity, size_t& size);
+
+    // The space Encode needs for a width x height image split across threads
+    size_t GetMaxEncodedSize(int width, int height, unsigned threads);
+
+    // Decodes any QOI image to tightly packed RGBA
+    bool Decode(const uint8_t* data, size_t size, int& width, int& height, std::vector<uint8_t>& rgba);
+
+    constexpr size_t HeaderSize = 14;
+    constexpr size_t EndMarkerSize = 8;
+
+    // Bands are at least this many rows, so threads aren't started for too little work
+    constexpr int MinBandRows = 32;
+}
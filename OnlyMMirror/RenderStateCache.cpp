@@ -0,0 +1,203 @@
+#include "stdafx.h"
+#include "RenderStateCache.h"
+
+RenderStateCache::RenderStateCache()
+    : context_(nullptr)
+    , renderTargetView_(nullptr)
+    , rasterizerState_(nullptr)
+    , blendState_(nullptr)
+    , inputLayout_(nullptr)
+    , vertexBuffer_(nullptr)
+    , vertexShader_(nullptr)
+    , pixelShader_(nullptr)
+    , sampler_(nullptr)
+    , constantBuffers_()
+    , shaderResource_(nullptr)
+    , viewport_()
+    , scissorRect_()
+    , calls_(0)
+    , valid_(false)
+{
+}
+
+void RenderStateCache::Attach(ID3D11DeviceContext* context)
+{
+    context_ = context;
+    Invalidate();
+}
+
+void RenderStateCache::Detach()
+{
+    context_ = nullptr;
+    Invalidate();
+}
+
+void RenderStateCache::Invalidate()
+{
+    renderTargetView_ = nullptr;
+    rasterizerState_ = nullptr;
+    blendState_ = nullptr;
+    inputLayout_ = nullptr;
+    vertexBuffer_ = nullptr;
+    vertexShader_ = nullptr;
+    pixelShader_ = nullptr;
+    sampler_ = nullptr;
+    for (ID3D11Buffer*& buffer : constantBuffers_)
+    {
+        buffer = nullptr;
+    }
+
+    shaderResource_ = nullptr;
+    viewport_ = D3D11_VIEWPORT();
+    scissorRect_ = D3D11_RECT();
+    valid_ = false;
+}
+
+void RenderStateCache::SetRenderTarget(ID3D11RenderTargetView* renderTargetView)
+{
+    if (!valid_)
+    {
+        // The state nothing else sets: the topology never changes, and the blend state is
+        // put back to the default the cache now assumes
+        context_->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+        context_->OMSetBlendState(nullptr, nullptr, 0xffffffff);
+        calls_ += 2;
+        valid_ = true;
+    }
+
+    if (renderTargetView != renderTargetView_)
+    {
+        context_->OMSetRenderTargets(1, &renderTargetView, nullptr);
+        ++calls_;
+        renderTargetView_ = renderTargetView;
+    }
+}
+
+void RenderStateCache::SetRasterizerState(ID3D11RasterizerState* state)
+{
+    if (state != rasterizerState_)
+    {
+        context_->RSSetState(state);
+        ++calls_;
+        rasterizerState_ = state;
+    }
+}
+
+void RenderStateCache::SetBlendState(ID3D11BlendState* state)
+{
+    if (state != blendState_)
+    {
+        context_->OMSetBlendState(state, nullptr, 0xffffffff);
+        ++calls_;
+        blendState_ = state;
+    }
+}
+
+void RenderStateCache::SetInputLayout(ID3D11InputLayout* layout)
+{
+    if (layout != inputLayout_)
+    {
+        context_->IASetInputLayout(layout);
+        ++calls_;
+        inputLayout_ = layout;
+    }
+}
+
+void RenderStateCache::SetVertexBuffer(ID3D11Buffer* buffer, const UINT stride)
+{
+    if (buffer != vertexBuffer_)
+    {
+        constexpr UINT offset = 0;
+        context_->IASetVertexBuffers(0, 1, &buffer, &stride, &offset);
+        ++calls_;
+        vertexBuffer_ = buffer;
+    }
+}
+
+void RenderStateCache::SetVertexShader(ID3D11VertexShader* shader)
+{
+    if (shader != vertexShader_)
+    {
+        context_->VSSetShader(shader, nullptr, 0);
+        ++calls_;
+        vertexShader_ = shader;
+    }
+}
+
+void RenderStateCache::SetPixelShader(ID3D11PixelShader* shader)
+{
+    if (shader != pixelShader_)
+    {
+        context_->PSSetShader(shader, nullptr, 0);
+        ++calls_;
+        pixelShader_ = shader;
+    }
+}
+
+void RenderStateCache::SetSampler(ID3D11SamplerState* sampler)
+{
+    if (sampler != sampler_)
+    {
+        context_->PSSetSamplers(0, 1, &sampler);
+        ++calls_;
+        sampler_ = sampler;
+    }
+}
+
+void RenderStateCache::SetPixelConstantBuffer(const UINT slot, ID3D11Buffer* buffer)
+{
+    if (slot < ConstantBufferSlots && buffer != constantBuffers_[slot])
+    {
+        context_->PSSetConstantBuffers(slot, 1, &buffer);
+        ++calls_;
+        constantBuffers_[slot] = buffer;
+    }
+}
+
+void RenderStateCache::SetShaderResource(ID3D11ShaderResourceView* view)
+{
+    if (view != shaderResource_)
+    {
+        context_->PSSetShaderResources(0, 1, &view);
+        ++calls_;
+        shaderResource_ = view;
+    }
+}
+
+void RenderStateCache::SetViewport(const D3D11_VIEWPORT& viewport)
+{
+    if (memcmp(&viewport, &viewport_, sizeof(viewport)) != 0)
+    {
+        context_->RSSetViewports(1, &viewport);
+        ++calls_;
+        viewport_ = viewport;
+    }
+}
+
+void RenderStateCache::SetScissorRect(const D3D11_RECT& rect)
+{
+    if (memcmp(&rect, &scissorRect_, sizeof(rect)) != 0)
+    {
+        context_->RSSetScissorRects(1, &rect);
+        ++calls_;
+        scissorRect_ = rect;
+    }
+}
+
+void RenderStateCache::Draw(const UINT vertexCount, const UINT firstVertex)
+{
+    context_->Draw(vertexCount, firstVertex);
+    ++calls_;
+}
+
+void RenderStateCache::CountCalls(const UINT count)
+{
+    calls_ += count;
+}
+
+UINT RenderStateCache::TakeCallCount()
+{
+    const UINT calls = calls_;
+    calls_ = 0;
+    return calls;
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <d3d11.h>
+
+// The mirror's pipeline state as last bound on the immediate context. Each setter only
+// reaches the driver when the value differs from what's bound, so RenderFrame can state
+// what every draw needs without paying for it twice. Anything else that binds state on
+// the context (the text overlays, a swap chain resize) must be followed by Invalidate.
+// Calls that did reach the driver are counted, for the per-frame cost in MirrorStats.
+class RenderStateCache  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+public:
+    RenderStateCache();
+
+    // The context isn't referenced; the owner keeps it alive while it's attached
+    void Attach(ID3D11DeviceContext* context);
+    void Detach();
+    void Invalidate();
+
+    // Call first in each frame: after Invalidate it also binds the state nothing else sets
+    void SetRenderTarget(ID3D11RenderTargetView* renderTargetView);
+    void SetRasterizerState(ID3D11RasterizerState* state);
+    void SetBlendState(ID3D11BlendState* state);
+    void SetInputLayout(ID3D11InputLayout* layout);
+    void SetVertexBuffer(ID3D11Buffer* buffer, UINT stride);
+    void SetVertexShader(ID3D11VertexShader* shader);
+    void SetPixelShader(ID3D11PixelShader* shader);
+    void SetSampler(ID3D11SamplerState* sampler);
+    void SetPixelConstantBuffer(UINT slot, ID3D11Buffer* buffer);
+    void SetShaderResource(ID3D11ShaderResourceView* view);
+    void SetViewport(const D3D11_VIEWPORT& viewport);
+    void SetScissorRect(const D3D11_RECT& rect);
+    void Draw(UINT vertexCount, UINT firstVertex);
+
+    // For calls made on the context directly, e.g. clears, updates and the present
+    void CountCalls(UINT count);
+
+    // Driver calls since the last time this was called
+    UINT TakeCallCount();
+
+    static constexpr UINT ConstantBufferSlots = 3;
+
+private:
+    ID3D11DeviceContext* context_;
+    ID3D11RenderTargetView* renderTargetView_;
+    ID3D11RasterizerState* rasterizerState_;
+    ID3D11BlendState* blendState_;
+    ID3D11InputLayout* inputLayout_;
+    ID3D11Buffer* vertexBuffer_;
+    ID3D11VertexShader* vertexShader_;
+    ID3D11PixelShader* pixelShader_;
+    ID3D11SamplerState* sampler_;
+    ID3D11Buffer* constantBuffers_[ConstantBufferSlots];
+    ID3D11ShaderResourceView* shaderResource_;
+    D3D11_VIEWPORT viewport_;
+    D3D11_RECT scissorRect_;
+    UINT calls_;
+    bool valid_;
+};
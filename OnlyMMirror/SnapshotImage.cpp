@@ -0,0 +1,118 @@
+#include "SnapshotImage.h"
+
+#include <algorithm>
+#include <cstring>
+#include "FrameStatistics.h"
+
+namespace
+{
+    uint8_t ToByte(const float value)
+    {
+        return static_cast<uint8_t>(value <= 0.0f ? 0.0f : value >= 1.0f ? 255.0f : value * 255.0f + 0.5f);
+    }
+
+    void ConvertPixel(
+        const uint8_t* source, const SnapshotFormat format, const ToneMapConstants& toneMap, uint8_t* rgba)
+    {
+        float wide[3];
+        switch (format)
+        {
+            case SnapshotFormat::Rgb10a2:
+            {
+                uint32_t pixel;
+                memcpy(&pixel, source, sizeof(pixel));
+                wide[0] = static_cast<float>(pixel & 0x3ff) / 1023.0f;
+                wide[1] = static_cast<float>((pixel >> 10) & 0x3ff) / 1023.0f;
+                wide[2] = static_cast<float>((pixel >> 20) & 0x3ff) / 1023.0f;
+                break;
+            }
+
+            case SnapshotFormat::Rgba16f:
+            {
+                uint16_t pixel[3];
+                memcpy(pixel, source, sizeof(pixel));
+                wide[0] = FrameAnalysis::HalfToFloat(pixel[0]);
+                wide[1] = FrameAnalysis::HalfToFloat(pixel[1]);
+                wide[2] = FrameAnalysis::HalfToFloat(pixel[2]);
+                break;
+            }
+
+            case SnapshotFormat::Bgra8:
+            default:
+                rgba[0] = source[2];
+                rgba[1] = source[1];
+                rgba[2] = source[0];
+                rgba[3] = 255;
+                return;
+        }
+
+        float displayed[3];
+        ToneMap::Apply(toneMap, wide, displayed);
+        rgba[0] = ToByte(displayed[0]);
+        rgba[1] = ToByte(displayed[1]);
+        rgba[2] = ToByte(displayed[2]);
+        rgba[3] = 255;
+    }
+}
+
+namespace SnapshotImage
+{
+    int GetBytesPerPixel(const SnapshotFormat format)
+    {
+        return format == SnapshotFormat::Rgba16f ? 8 : 4;
+    }
+
+    void GetUprightSize(const int imageWidth, const int imageHeight, const OutputRotation rotation, int& width, int& height)
+    {
+        const bool swapAxes = RotationTransform::SwapsAxes(rotation);
+        width = swapAxes ? imageHeight : imageWidth;
+        height = swapAxes ? imageWidth : imageHeight;
+    }
+
+    void Convert(
+        const uint8_t* pixels, const size_t pitch, const int imageWidth, const int imageHeight, const SnapshotFormat format,
+        const OutputRotation rotation, const ToneMapConstants& toneMap, const int firstRow, const int endRow, uint8_t* rgba)
+    {
+        int width;
+        int height;
+        GetUprightSize(imageWidth, imageHeight, rotation, width, height);
+        const size_t bytesPerPixel = static_cast<size_t>(GetBytesPerPixel(format));
+
+        for (int y = (std::max)(firstRow, 0); y < (std::min)(endRow, height); ++y)
+        {
+            uint8_t* row = rgba + static_cast<size_t>(y) * width * 4;
+            for (int x = 0; x < width; ++x)
+            {
+                // The image pixel shown at desktop (x, y); see RotationTransform::DesktopToImage
+                int imageX;
+                int imageY;
+                switch (rotation)
+                {
+                    case OutputRotation::Rotate90:
+                        imageX = y;
+                        imageY = width - 1 - x;
+                        break;
+
+                    case OutputRotation::Rotate180:
+                        imageX = width - 1 - x;
+                        imageY = height - 1 - y;
+                        break;
+
+                    case OutputRotation::Rotate270:
+                        imageX = height - 1 - y;
+                        imageY = x;
+                        break;
+
+                    default:
+                        imageX = x;
+                        imageY = y;
+                        break;
+                }
+
+                ConvertPixel(
+                    pixels + static_cast<size_t>(imageY) * pitch + static_cast<size_t>(imageX) * bytesPerPixel,
+                    format, toneMap, row + static_cast<size_t>(x) * 4);
+            }
+        }
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+// Portable conversion of a read back capture to an upright 8-bit image for snapshots. The
+// captured texture is in the output's unrotated orientation and may be 10-bit or FP16; the
+// snapshot is what the mirror shows: tone mapped the same way and turned the right way up.
+
+#include <cstddef>
+#include <cstdint>
+#include "OutputRotation.h"
+#include "ToneMap.h"
+
+// The captured texture's formats (DXGI_FORMAT_B8G8R8A8_UNORM, R10G10B10A2_UNORM and
+// R16G16B16A16_FLOAT)
+enum class SnapshotFormat
+{
+    Bgra8,
+    Rgb10a2,
+    Rgba16f
+};
+
+namespace SnapshotImage
+{
+    int GetBytesPerPixel(SnapshotFormat format);
+
+    // The converted image's size, in desktop orientation, for an imageWidth * imageHeight capture
+    void GetUprightSize(int imageWidth, int imageHeight, OutputRotation rotation, int& width, int& height);
+
+    // Converts imageWidth * imageHeight pixels, pitch bytes apart row to row, to opaque RGBA
+    // in desktop orientation. rgba is the whole upright image, tightly packed; only its rows
+    // [firstRow, endRow) are written, so that the work can be split between threads.
+    void Convert(
+        const uint8_t* pixels, size_t pitch, int imageWidth, int imageHeight, SnapshotFormat format,
+        OutputRotation rotation, const ToneMapConstants& toneMap, int firstRow, int endRow, uint8_t* rgba);
+}
@@ -0,0 +1,331 @@
+#include "stdafx.h"
+#include "SnapshotWriter.h"
+#include "Qoi.h"
+#include <ShlObj.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#pragma comment(lib, "shell32.lib")
+#pragma comment(lib, "ole32.lib")
+
+namespace
+{
+    template <class T> void SafeRelease(T*& pointer)
+    {
+        if (pointer)
+        {
+            pointer->Release();
+            pointer = nullptr;
+        }
+    }
+
+    bool GetSnapshotFormat(const DXGI_FORMAT format, SnapshotFormat& snapshotFormat)
+    {
+        switch (format)
+        {
+            case DXGI_FORMAT_B8G8R8A8_UNORM:
+            case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+                snapshotFormat = SnapshotFormat::Bgra8;
+                return true;
+
+            case DXGI_FORMAT_R10G10B10A2_UNORM:
+                snapshotFormat = SnapshotFormat::Rgb10a2;
+                return true;
+
+            case DXGI_FORMAT_R16G16B16A16_FLOAT:
+                snapshotFormat = SnapshotFormat::Rgba16f;
+                return true;
+
+            default:
+                return false;
+        }
+    }
+
+    double GetElapsedMs(const LARGE_INTEGER& start, const LARGE_INTEGER& end)
+    {
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        return static_cast<double>(end.QuadPart - start.QuadPart) * 1000.0 / static_cast<double>(frequency.QuadPart);
+    }
+
+    // <Pictures>\OnlyMMirror <date> <time>.qoi, or the same in the temp folder
+    bool GetSnapshotPath(wchar_t* path, const size_t size)
+    {
+        size_t length = 0;
+        PWSTR pictures = nullptr;
+        if (SUCCEEDED(SHGetKnownFolderPath(FOLDERID_Pictures, 0, nullptr, &pictures)))
+        {
+            length = wcslen(pictures) + 1 < size ? wcslen(pictures) : 0;
+            if (length > 0)
+            {
+                wcscpy_s(path, size, pictures);
+                path[length++] = L'\\';
+            }
+        }
+
+        CoTaskMemFree(pictures);
+
+        if (length == 0)
+        {
+            length = GetTempPathW(static_cast<DWORD>(size), path);
+            if (length == 0 || length >= size)
+            {
+                return false;
+            }
+        }
+
+        SYSTEMTIME time;
+        GetLocalTime(&time);
+        return swprintf_s(
+            path + length, size - length, L"OnlyMMirror %04u-%02u-%02u %02u%02u%02u.%03u.qoi",
+            time.wYear, time.wMonth, time.wDay, time.wHour, time.wMinute, time.wSecond, time.wMilliseconds) > 0;
+    }
+}
+
+constexpr unsigned SnapshotWriter::MaxEncodeThreads;
+
+SnapshotWriter::SnapshotWriter()
+    : pool_(nullptr)
+    , staging_(nullptr)
+    , mapped_(false)
+    , converted_(false)
+    , width_(0)
+    , height_(0)
+    , format_(SnapshotFormat::Bgra8)
+    , rotation_(OutputRotation::Identity)
+    , toneMap_()
+{
+}
+
+SnapshotWriter::~SnapshotWriter()
+{
+    Destroy();
+}
+
+bool SnapshotWriter::Create(TexturePool* pool)
+{
+    Destroy();
+
+    pool_ = pool;
+    return pool_ != nullptr;
+}
+
+void SnapshotWriter::Destroy()
+{
+    // The worker may still be reading the mapped texture
+    if (task_.valid())
+    {
+        task_.wait();
+        task_ = std::future<SnapshotResult>();
+    }
+
+    if (staging_)
+    {
+        ID3D11Device* device = nullptr;
+        ID3D11DeviceContext* context = nullptr;
+        staging_->GetDevice(&device);
+        device->GetImmediateContext(&context);
+        ReleaseStaging(context);
+        SafeRelease(context);
+        SafeRelease(device);
+    }
+
+    pool_ = nullptr;
+}
+
+void SnapshotWriter::ReleaseStaging(ID3D11DeviceContext* context)
+{
+    if (mapped_)
+    {
+        context->Unmap(staging_, 0);
+        mapped_ = false;
+    }
+
+    // Textures only exist while there's a pool
+    if (pool_)
+    {
+        pool_->Recycle(staging_);
+    }
+}
+
+bool SnapshotWriter::IsBusy() const
+{
+    return staging_ != nullptr || task_.valid();
+}
+
+bool SnapshotWriter::Queue(
+    ID3D11DeviceContext* context, ID3D11Texture2D* source, const PixelRect& region,
+    const OutputRotation rotation, const ToneMapConstants& toneMap)
+{
+    if (!pool_ || !context || !source || IsBusy())
+    {
+        return false;
+    }
+
+    D3D11_TEXTURE2D_DESC sourceDesc;
+    source->GetDesc(&sourceDesc);
+
+    PixelRect clipped;
+    const PixelRect whole = { 0, 0, static_cast<int>(sourceDesc.Width), static_cast<int>(sourceDesc.Height) };
+    if (!GetSnapshotFormat(sourceDesc.Format, format_) || !ViewTransform::Intersect(region, whole, clipped))
+    {
+        return false;
+    }
+
+    D3D11_TEXTURE2D_DESC stagingDesc = {};
+    stagingDesc.Width = static_cast<UINT>(clipped.right - clipped.left);
+    stagingDesc.Height = static_cast<UINT>(clipped.bottom - clipped.top);
+    stagingDesc.MipLevels = 1;
+    stagingDesc.ArraySize = 1;
+    stagingDesc.Format = sourceDesc.Format;
+    stagingDesc.SampleDesc.Count = 1;
+    stagingDesc.Usage = D3D11_USAGE_STAGING;
+    stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+
+    if (!pool_->Acquire(stagingDesc, &staging_, nullptr))
+    {
+        return false;
+    }
+
+    const D3D11_BOX box = {
+        static_cast<UINT>(clipped.left), static_cast<UINT>(clipped.top), 0,
+        static_cast<UINT>(clipped.right), static_cast<UINT>(clipped.bottom), 1 };
+    context->CopySubresourceRegion(staging_, 0, 0, 0, 0, source, 0, &box);
+
+    width_ = static_cast<int>(stagingDesc.Width);
+    height_ = static_cast<int>(stagingDesc.Height);
+    rotation_ = rotation;
+    toneMap_ = toneMap;
+    return true;
+}
+
+bool SnapshotWriter::Update(ID3D11DeviceContext* context, SnapshotResult& result)
+{
+    if (staging_ && !mapped_)
+    {
+        D3D11_MAPPED_SUBRESOURCE mapped;
+        if (FAILED(context->Map(staging_, 0, D3D11_MAP_READ, D3D11_MAP_FLAG_DO_NOT_WAIT, &mapped)))
+        {
+            // DXGI_ERROR_WAS_STILL_DRAWING: try again next frame
+            return false;
+        }
+
+        mapped_ = true;
+        converted_ = false;
+
+        FrameBufferPool* buffers = &buffers_;
+        const uint8_t* pixels = static_cast<const uint8_t*>(mapped.pData);
+        const size_t pitch = mapped.RowPitch;
+        const int width = width_;
+        const int height = height_;
+        const SnapshotFormat format = format_;
+        const OutputRotation rotation = rotation_;
+        const ToneMapConstants toneMap = toneMap_;
+        std::atomic<bool>* converted = &converted_;
+
+        task_ = std::async(std::launch::async, [=]
+        {
+            return Write(buffers, pixels, pitch, width, height, format, rotation, toneMap, converted);
+        });
+    }
+
+    if (mapped_ && converted_)
+    {
+        ReleaseStaging(context);
+    }
+
+    if (!task_.valid() || task_.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+        return false;
+    }
+
+    result = task_.get();
+    return true;
+}
+
+SnapshotResult SnapshotWriter::Write(
+    FrameBufferPool* buffers, const uint8_t* pixels, const size_t pitch, const int width, const int height,
+    const SnapshotFormat format, const OutputRotation rotation, const ToneMapConstants& toneMap,
+    std::atomic<bool>* converted)
+{
+    SnapshotResult result = {};
+    SnapshotImage::GetUprightSize(width, height, rotation, result.width, result.height);
+
+    const unsigned threads = (std::max)(1u, (std::min)(MaxEncodeThreads, std::thread::hardware_concurrency()));
+
+    LARGE_INTEGER start;
+    QueryPerformanceCounter(&start);
+
+    const size_t stride = static_cast<size_t>(result.width) * 4;
+    const FrameBuffer upright = buffers->Acquire(stride * result.height);
+    if (upright)
+    {
+        const int bandRows = (result.height + static_cast<int>(threads) - 1) / static_cast<int>(threads);
+        const auto convertBand = [&](const int band)
+        {
+            SnapshotImage::Convert(
+                pixels, pitch, width, height, format, rotation, toneMap,
+                band * bandRows, (band + 1) * bandRows, upright.Data());
+        };
+
+        std::vector<std::thread> workers;
+        for (int band = 1; band < static_cast<int>(threads); ++band)
+        {
+            workers.emplace_back(convertBand, band);
+        }
+
+        convertBand(0);
+        for (std::thread& worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    // The window thread can unmap the staging texture now
+    *converted = true;
+    if (!upright)
+    {
+        return result;
+    }
+
+    LARGE_INTEGER convertEnd;
+    QueryPerformanceCounter(&convertEnd);
+    result.convertMs = GetElapsedMs(start, convertEnd);
+
+    // The worst case is larger than the image, so unlike a vector it isn't cleared first
+    const FrameBuffer encoded = buffers->Acquire(Qoi::GetMaxEncodedSize(result.width, result.height, threads));
+    size_t encodedSize = 0;
+    const bool encodedImage = encoded && Qoi::Encode(
+        upright.Data(), result.width, result.height, stride, threads, encoded.Data(), encoded.Size(), encodedSize);
+
+    LARGE_INTEGER encodeEnd;
+    QueryPerformanceCounter(&encodeEnd);
+    result.encodeMs = GetElapsedMs(convertEnd, encodeEnd);
+    result.bytes = encodedSize;
+
+    wchar_t path[MAX_PATH];
+    if (!encodedImage || !GetSnapshotPath(path, MAX_PATH))
+    {
+        return result;
+    }
+
+    char utf8Path[MAX_PATH * 3];
+    if (WideCharToMultiByte(CP_UTF8, 0, path, -1, utf8Path, sizeof(utf8Path), nullptr, nullptr) > 0)
+    {
+        result.path = utf8Path;
+    }
+
+    const HANDLE file = CreateFileW(path, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)  // NOLINT(performance-no-int-to-ptr)
+    {
+        return result;
+    }
+
+    DWORD bytesWritten = 0;
+    result.saved = WriteFile(file, encoded.Data(), static_cast<DWORD>(encodedSize), &bytesWritten, nullptr) &&
+        bytesWritten == encodedSize;
+    CloseHandle(file);
+
+    return result;
+}
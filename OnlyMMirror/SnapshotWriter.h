@@ -0,0 +1,75 @@
+#pragma once
+#include <d3d11.h>
+#include <atomic>
+#include <future>
+#include <string>
+#include "FrameBufferPool.h"
+#include "OutputRotation.h"
+#include "SnapshotImage.h"
+#include "TexturePool.h"
+#include "ToneMap.h"
+#include "ViewTransform.h"
+
+struct SnapshotResult
+{
+    bool saved;
+    std::string path;               // UTF-8
+    int width;
+    int height;
+    size_t bytes;
+    double convertMs;
+    double encodeMs;
+};
+
+// Saves snapshots of the captured texture without stalling the mirror. The texture is
+// copied to a staging texture on the GPU and mapped on a later frame with DO_NOT_WAIT. A
+// worker thread converts the mapped pixels (see SnapshotImage), after which the window
+// thread unmaps them, then encodes the image as QOI across several threads and writes it
+// to the Pictures folder. One snapshot is in progress at a time.
+class SnapshotWriter  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+public:
+    SnapshotWriter();
+    ~SnapshotWriter();
+
+    // Textures come from pool, which has to outlive this
+    bool Create(TexturePool* pool);
+
+    // Waits for a snapshot that's being written
+    void Destroy();
+
+    // Queues a copy of region of source, in the image's coordinates. Returns false if a
+    // snapshot is already in progress or the format isn't supported.
+    bool Queue(ID3D11DeviceContext* context, ID3D11Texture2D* source, const PixelRect& region,
+        OutputRotation rotation, const ToneMapConstants& toneMap);
+
+    // Call once a frame: hands a finished copy to the worker. Returns true, with the
+    // outcome in result, when the worker has finished.
+    bool Update(ID3D11DeviceContext* context, SnapshotResult& result);
+
+    bool IsBusy() const;
+
+    static constexpr unsigned MaxEncodeThreads = 4;
+
+private:
+    void ReleaseStaging(ID3D11DeviceContext* context);
+
+    // Runs on the worker
+    static SnapshotResult Write(
+        FrameBufferPool* buffers, const uint8_t* pixels, size_t pitch, int width, int height, SnapshotFormat format,
+        OutputRotation rotation, const ToneMapConstants& toneMap, std::atomic<bool>* converted);
+
+    TexturePool* pool_;
+    ID3D11Texture2D* staging_;
+    bool mapped_;
+    std::atomic<bool> converted_;       // set by the worker once it's done with the mapped pixels
+    int width_;
+    int height_;
+    SnapshotFormat format_;
+    OutputRotation rotation_;
+    ToneMapConstants toneMap_;
+
+    // Converted and encoded images; at 33 MB each for a 4K output they're worth reusing
+    FrameBufferPool buffers_;
+    std::future<SnapshotResult> task_;
+};
@@ -0,0 +1,370 @@
+#include "stdafx.h"
+#include "TextOverlay.h"
+#include <d3dcompiler.h>
+
+namespace
+{
+    const char* overlayVertexShaderSource = R"(
+struct VS_INPUT {
+    float2 pos : POSITION;
+    float2 tex : TEXCOORD0;
+    float4 color : COLOR0;
+};
+
+struct VS_OUTPUT {
+    float4 pos : SV_POSITION;
+    float2 tex : TEXCOORD0;
+    float4 color : COLOR0;
+};
+
+VS_OUTPUT main(VS_INPUT input) {
+    VS_OUTPUT output;
+    output.pos = float4(input.pos, 0.0f, 1.0f);
+    output.tex = input.tex;
+    output.color = input.color;
+    return output;
+}
+)";
+
+    // The atlas holds coverage only; colour comes from the vertex
+    const char* overlayPixelShaderSource = R"(
+Texture2D atlasTexture : register(t0);
+SamplerState pointSampler : register(s0);
+
+struct PS_INPUT {
+    float4 pos : SV_POSITION;
+    float2 tex : TEXCOORD0;
+    float4 color : COLOR0;
+};
+
+float4 main(PS_INPUT input) : SV_TARGET {
+    float coverage = atlasTexture.Sample(pointSampler, input.tex).r;
+    return float4(input.color.rgb, input.color.a * coverage);
+}
+)";
+
+    // ReSharper disable CppDeclaratorNeverUsed
+    struct OverlayVertex
+    {
+        float x;
+        float y;
+        float u;
+        float v;
+        float color[4];
+    };
+    // ReSharper enable CppDeclaratorNeverUsed
+
+    bool CompileShader(const char* source, const char* profile, ID3DBlob** blob)
+    {
+        ID3DBlob* errorBlob = nullptr;
+        const HRESULT hr = D3DCompile(
+            source, strlen(source), nullptr, nullptr, nullptr, "main", profile, 0, 0, blob, &errorBlob);
+
+        if (errorBlob)
+        {
+            errorBlob->Release();
+        }
+
+        return SUCCEEDED(hr);
+    }
+
+    template<typename T>
+    void SafeRelease(T*& ptr)
+    {
+        if (ptr) { ptr->Release(); ptr = nullptr; }
+    }
+}
+
+TextOverlay::TextOverlay()
+    : vertexShader_(nullptr)
+    , pixelShader_(nullptr)
+    , inputLayout_(nullptr)
+    , vertexBuffer_(nullptr)
+    , atlasTexture_(nullptr)
+    , atlasSRV_(nullptr)
+    , samplerState_(nullptr)
+    , blendState_(nullptr)
+    , foreground_{ 1.0f, 1.0f, 1.0f, 1.0f }
+    , background_{ 0.0f, 0.0f, 0.0f, 0.6f }
+    , x_(8)
+    , y_(8)
+    , scale_(2)
+    , builtWidth_(0)
+    , builtHeight_(0)
+    , vertexCount_(0)
+    , dirty_(true)
+    , visible_(false)
+{
+}
+
+TextOverlay::~TextOverlay()
+{
+    Destroy();
+}
+
+bool TextOverlay::Create(ID3D11Device* device)
+{
+    Destroy();
+
+    ID3DBlob* vsBlob = nullptr;
+    if (!CompileShader(overlayVertexShaderSource, "vs_4_0", &vsBlob))
+    {
+        return false;
+    }
+
+    HRESULT hr = device->CreateVertexShader(
+        vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), nullptr, &vertexShader_);
+
+    if (SUCCEEDED(hr))
+    {
+        const D3D11_INPUT_ELEMENT_DESC layout[] =
+        {
+            { "POSITION", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+            { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 8, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+            { "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 16, D3D11_INPUT_PER_VERTEX_DATA, 0 }
+        };
+
+        hr = device->CreateInputLayout(
+            layout, 3, vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), &inputLayout_);
+    }
+
+    vsBlob->Release();
+
+    if (FAILED(hr))
+    {
+        return false;
+    }
+
+    ID3DBlob* psBlob = nullptr;
+    if (!CompileShader(overlayPixelShaderSource, "ps_4_0", &psBlob))
+    {
+        return false;
+    }
+
+    hr = device->CreatePixelShader(psBlob->GetBufferPointer(), psBlob->GetBufferSize(), nullptr, &pixelShader_);
+    psBlob->Release();
+
+    if (FAILED(hr))
+    {
+        return false;
+    }
+
+    // Atlas is baked once on the CPU and never changes
+    uint8_t atlasPixels[GlyphAtlas::Width * GlyphAtlas::Height];
+    GlyphAtlas::Build(atlasPixels);
+
+    D3D11_TEXTURE2D_DESC textureDesc = {};
+    textureDesc.Width = GlyphAtlas::Width;
+    textureDesc.Height = GlyphAtlas::Height;
+    textureDesc.MipLevels = 1;
+    textureDesc.ArraySize = 1;
+    textureDesc.Format = DXGI_FORMAT_R8_UNORM;
+    textureDesc.SampleDesc.Count = 1;
+    textureDesc.Usage = D3D11_USAGE_IMMUTABLE;
+    textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+    D3D11_SUBRESOURCE_DATA textureData = {};
+    textureData.pSysMem = atlasPixels;
+    textureData.SysMemPitch = GlyphAtlas::Width;
+
+    hr = device->CreateTexture2D(&textureDesc, &textureData, &atlasTexture_);
+    if (SUCCEEDED(hr))
+    {
+        hr = device->CreateShaderResourceView(atlasTexture_, nullptr, &atlasSRV_);
+    }
+
+    if (FAILED(hr))
+    {
+        return false;
+    }
+
+    D3D11_BUFFER_DESC bufferDesc = {};
+    bufferDesc.ByteWidth = MaxQuads * 6 * sizeof(OverlayVertex);
+    bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+    bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+    hr = device->CreateBuffer(&bufferDesc, nullptr, &vertexBuffer_);
+    if (FAILED(hr))
+    {
+        return false;
+    }
+
+    // Point sampling keeps the integer-scaled glyphs crisp
+    D3D11_SAMPLER_DESC samplerDesc = {};
+    samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_POINT;
+    samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
+    samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
+    samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+    samplerDesc.ComparisonFunc = D3D11_COMPARISON_NEVER;
+    samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
+
+    hr = device->CreateSamplerState(&samplerDesc, &samplerState_);
+    if (FAILED(hr))
+    {
+        return false;
+    }
+
+    D3D11_BLEND_DESC blendDesc = {};
+    blendDesc.RenderTarget[0].BlendEnable = TRUE;
+    blendDesc.RenderTarget[0].SrcBlend = D3D11_BLEND_SRC_ALPHA;
+    blendDesc.RenderTarget[0].DestBlend = D3D11_BLEND_INV_SRC_ALPHA;
+    blendDesc.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
+    blendDesc.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ONE;
+    blendDesc.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_ZERO;
+    blendDesc.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
+    blendDesc.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+
+    hr = device->CreateBlendState(&blendDesc, &blendState_);
+
+    dirty_ = true;
+    return SUCCEEDED(hr);
+}
+
+void TextOverlay::Destroy()
+{
+    SafeRelease(blendState_);
+    SafeRelease(samplerState_);
+    SafeRelease(atlasSRV_);
+    SafeRelease(atlasTexture_);
+    SafeRelease(vertexBuffer_);
+    SafeRelease(inputLayout_);
+    SafeRelease(pixelShader_);
+    SafeRelease(vertexShader_);
+    vertexCount_ = 0;
+}
+
+void TextOverlay::SetText(const char* text)
+{
+    if (text_ != text)
+    {
+        text_ = text;
+        dirty_ = true;
+    }
+}
+
+void TextOverlay::SetPosition(const int x, const int y, const int scale)
+{
+    const int clampedScale = scale < 1 ? 1 : scale;
+    if (x != x_ || y != y_ || clampedScale != scale_)
+    {
+        x_ = x;
+        y_ = y;
+        scale_ = clampedScale;
+        dirty_ = true;
+    }
+}
+
+void TextOverlay::SetColors(const float (&foreground)[4], const float (&background)[4])
+{
+    memcpy(foreground_, foreground, sizeof(foreground_));
+    memcpy(background_, background, sizeof(background_));
+    dirty_ = true;
+}
+
+bool TextOverlay::IsVisible() const
+{
+    return visible_;
+}
+
+void TextOverlay::SetVisible(const bool visible)
+{
+    visible_ = visible;
+}
+
+void TextOverlay::ToggleVisible()
+{
+    visible_ = !visible_;
+}
+
+bool TextOverlay::Rebuild(ID3D11DeviceContext* context, const int targetWidth, const int targetHeight)
+{
+    int textWidth;
+    int textHeight;
+    GlyphAtlas::Measure(text_.c_str(), scale_, textWidth, textHeight);
+
+    quads_.clear();
+    quads_.push_back(GlyphAtlas::SolidQuad(
+        static_cast<float>(x_ - Padding),
+        static_cast<float>(y_ - Padding),
+        static_cast<float>(x_ + textWidth + Padding),
+        static_cast<float>(y_ + textHeight + Padding)));
+
+    GlyphAtlas::Layout(text_.c_str(), static_cast<float>(x_), static_cast<float>(y_), scale_, quads_);
+
+    if (quads_.size() > MaxQuads)
+    {
+        quads_.resize(MaxQuads);
+    }
+
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    if (FAILED(context->Map(vertexBuffer_, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped)))
+    {
+        return false;
+    }
+
+    const float scaleX = 2.0f / static_cast<float>(targetWidth);
+    const float scaleY = 2.0f / static_cast<float>(targetHeight);
+
+    auto* vertex = static_cast<OverlayVertex*>(mapped.pData);
+    for (const GlyphQuad& quad : quads_)
+    {
+        const float* color = quad.solid ? background_ : foreground_;
+
+        const float left = quad.x0 * scaleX - 1.0f;
+        const float right = quad.x1 * scaleX - 1.0f;
+        const float top = 1.0f - quad.y0 * scaleY;
+        const float bottom = 1.0f - quad.y1 * scaleY;
+
+        const OverlayVertex corners[6] =
+        {
+            { left,  top,    quad.u0, quad.v0, { color[0], color[1], color[2], color[3] } },
+            { right, top,    quad.u1, quad.v0, { color[0], color[1], color[2], color[3] } },
+            { left,  bottom, quad.u0, quad.v1, { color[0], color[1], color[2], color[3] } },
+            { left,  bottom, quad.u0, quad.v1, { color[0], color[1], color[2], color[3] } },
+            { right, top,    quad.u1, quad.v0, { color[0], color[1], color[2], color[3] } },
+            { right, bottom, quad.u1, quad.v1, { color[0], color[1], color[2], color[3] } }
+        };
+
+        memcpy(vertex, corners, sizeof(corners));
+        vertex += 6;
+    }
+
+    context->Unmap(vertexBuffer_, 0);
+
+    vertexCount_ = static_cast<UINT>(quads_.size() * 6);
+    builtWidth_ = targetWidth;
+    builtHeight_ = targetHeight;
+    dirty_ = false;
+
+    return true;
+}
+
+void TextOverlay::Render(ID3D11DeviceContext* context, const int targetWidth, const int targetHeight)
+{
+    if (!visible_ || !vertexBuffer_ || text_.empty() || targetWidth <= 0 || targetHeight <= 0)
+    {
+        return;
+    }
+
+    if ((dirty_ || targetWidth != builtWidth_ || targetHeight != builtHeight_) &&
+        !Rebuild(context, targetWidth, targetHeight))
+    {
+        return;
+    }
+
+    constexpr UINT stride = sizeof(OverlayVertex);
+    constexpr UINT offset = 0;
+    context->IASetInputLayout(inputLayout_);
+    context->IASetVertexBuffers(0, 1, &vertexBuffer_, &stride, &offset);
+    context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    context->VSSetShader(vertexShader_, nullptr, 0);
+    context->PSSetShader(pixelShader_, nullptr, 0);
+    context->PSSetShaderResources(0, 1, &atlasSRV_);
+    context->PSSetSamplers(0, 1, &samplerState_);
+    context->OMSetBlendState(blendState_, nullptr, 0xffffffff);
+
+    context->Draw(vertexCount_, 0);
+
+    context->OMSetBlendState(nullptr, nullptr, 0xffffffff);
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <d3d11.h>
+#include <string>
+#include <vector>
+#include "GlyphAtlas.h"
+
+// Text drawn directly into the swap chain from the pre-baked GlyphAtlas. Vertices are only
+// rebuilt when the text or target size changes, so a visible overlay costs one draw per frame.
+class TextOverlay  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+public:
+    TextOverlay();
+    ~TextOverlay();
+
+    bool Create(ID3D11Device* device);
+    void Destroy();
+
+    void SetText(const char* text);
+    void SetPosition(int x, int y, int scale);
+    void SetColors(const float (&foreground)[4], const float (&background)[4]);
+
+    bool IsVisible() const;
+    void SetVisible(bool visible);
+    void ToggleVisible();
+
+    // Draws into the currently bound render target; the caller's viewport must cover it.
+    void Render(ID3D11DeviceContext* context, int targetWidth, int targetHeight);
+
+private:
+    bool Rebuild(ID3D11DeviceContext* context, int targetWidth, int targetHeight);
+
+    static constexpr UINT MaxQuads = 1024;
+    static constexpr int Padding = 4;
+
+    ID3D11VertexShader* vertexShader_;
+    ID3D11PixelShader* pixelShader_;
+    ID3D11InputLayout* inputLayout_;
+    ID3D11Buffer* vertexBuffer_;
+    ID3D11Texture2D* atlasTexture_;
+    ID3D11ShaderResourceView* atlasSRV_;
+    ID3D11SamplerState* samplerState_;
+    ID3D11BlendState* blendState_;
+
+    std::string text_;
+    std::vector<GlyphQuad> quads_;
+    float foreground_[4];
+    float background_[4];
+    int x_;
+    int y_;
+    int scale_;
+    int builtWidth_;
+    int builtHeight_;
+    UINT vertexCount_;
+    bool dirty_;
+    bool visible_;
+};
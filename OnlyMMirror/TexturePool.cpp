@@ -0,0 +1,236 @@
+#include "stdafx.h"
+#include "TexturePool.h"
+
+#include <algorithm>
+
+template<typename T>
+static void SafeRelease(T*& ptr)  // NOLINT(misc-use-anonymous-namespace)
+{
+    if (ptr) { ptr->Release(); ptr = nullptr; }
+}
+
+namespace
+{
+    uint64_t GetBytesPerPixel(const DXGI_FORMAT format)
+    {
+        switch (format)
+        {
+            case DXGI_FORMAT_R32G32B32A32_FLOAT:
+                return 16;
+
+            case DXGI_FORMAT_R16G16B16A16_FLOAT:
+            case DXGI_FORMAT_R16G16B16A16_UNORM:
+                return 8;
+
+            case DXGI_FORMAT_R8_UNORM:
+                return 1;
+
+            default:
+                return 4;
+        }
+    }
+}
+
+constexpr uint64_t TexturePool::DefaultMaxIdleBytes;
+
+TexturePool::TexturePool()
+    : device_(nullptr)
+    , maxIdleBytes_(DefaultMaxIdleBytes)
+    , clock_(0)
+    , stats_()
+{
+}
+
+TexturePool::~TexturePool()
+{
+    Destroy();
+}
+
+bool TexturePool::Create(ID3D11Device* device, const uint64_t maxIdleBytes)
+{
+    Destroy();
+
+    if (!device)
+    {
+        return false;
+    }
+
+    device_ = device;
+    device_->AddRef();
+    maxIdleBytes_ = maxIdleBytes;
+    return true;
+}
+
+void TexturePool::Destroy()
+{
+    // Anything still acquired goes too; its holders must be gone by now
+    for (Entry& entry : entries_)
+    {
+        SafeRelease(entry.srv);
+        SafeRelease(entry.texture);
+    }
+
+    entries_.clear();
+    SafeRelease(device_);
+    stats_ = TexturePoolStats();
+    clock_ = 0;
+}
+
+bool TexturePool::Acquire(const D3D11_TEXTURE2D_DESC& desc, ID3D11Texture2D** texture, ID3D11ShaderResourceView** srv)
+{
+    if (!device_ || !texture)
+    {
+        return false;
+    }
+
+    const bool wantView = srv && (desc.BindFlags & D3D11_BIND_SHADER_RESOURCE) != 0;
+
+    // The most recently used match, which is the likeliest to still be resident
+    Entry* match = nullptr;
+    for (Entry& entry : entries_)
+    {
+        if (!entry.inUse && memcmp(&entry.desc, &desc, sizeof(desc)) == 0 &&
+            (!wantView || entry.srv) && (!match || entry.lastUsed > match->lastUsed))
+        {
+            match = &entry;
+        }
+    }
+
+    if (match)
+    {
+        ++stats_.reused;
+        stats_.bytesIdle -= match->bytes;
+    }
+    else
+    {
+        Entry entry = {};
+        entry.desc = desc;
+        entry.bytes = GetByteSize(desc);
+
+        if (FAILED(device_->CreateTexture2D(&desc, nullptr, &entry.texture)) ||
+            (wantView && FAILED(device_->CreateShaderResourceView(entry.texture, nullptr, &entry.srv))))
+        {
+            SafeRelease(entry.texture);
+            return false;
+        }
+
+        ++stats_.created;
+        entries_.push_back(entry);
+        match = &entries_.back();
+    }
+
+    match->inUse = true;
+    stats_.bytesInUse += match->bytes;
+    if (stats_.bytesInUse + stats_.bytesIdle > stats_.highWaterBytes)
+    {
+        stats_.highWaterBytes = stats_.bytesInUse + stats_.bytesIdle;
+    }
+
+    *texture = match->texture;
+    if (srv)
+    {
+        *srv = wantView ? match->srv : nullptr;
+    }
+
+    return true;
+}
+
+void TexturePool::Recycle(ID3D11Texture2D*& texture, ID3D11ShaderResourceView*& srv)
+{
+    Recycle(texture);
+    srv = nullptr;
+}
+
+void TexturePool::Recycle(ID3D11Texture2D*& texture)
+{
+    if (!texture)
+    {
+        return;
+    }
+
+    for (Entry& entry : entries_)
+    {
+        if (entry.texture == texture && entry.inUse)
+        {
+            entry.inUse = false;
+            entry.lastUsed = ++clock_;
+            stats_.bytesInUse -= entry.bytes;
+            stats_.bytesIdle += entry.bytes;
+            break;
+        }
+    }
+
+    texture = nullptr;
+    Trim();
+}
+
+void TexturePool::Discard(ID3D11Texture2D*& texture, ID3D11ShaderResourceView*& srv)
+{
+    for (auto entry = entries_.begin(); texture && entry != entries_.end(); ++entry)
+    {
+        if (entry->texture == texture && entry->inUse)
+        {
+            stats_.bytesInUse -= entry->bytes;
+            ++stats_.evicted;
+            SafeRelease(entry->srv);
+            SafeRelease(entry->texture);
+            entries_.erase(entry);
+            break;
+        }
+    }
+
+    texture = nullptr;
+    srv = nullptr;
+}
+
+void TexturePool::SetMaxIdleBytes(const uint64_t maxIdleBytes)
+{
+    maxIdleBytes_ = maxIdleBytes;
+    Trim();
+}
+
+TexturePoolStats TexturePool::GetStats() const
+{
+    return stats_;
+}
+
+uint64_t TexturePool::GetByteSize(const D3D11_TEXTURE2D_DESC& desc)
+{
+    const UINT levels = desc.MipLevels == 0 ? 1 : desc.MipLevels;
+
+    uint64_t bytes = 0;
+    for (UINT level = 0; level < levels; ++level)
+    {
+        const uint64_t width = (std::max)(desc.Width >> level, 1u);
+        const uint64_t height = (std::max)(desc.Height >> level, 1u);
+        bytes += width * height;
+    }
+
+    return bytes * GetBytesPerPixel(desc.Format) * (std::max)(desc.ArraySize, 1u) * (std::max)(desc.SampleDesc.Count, 1u);
+}
+
+void TexturePool::Trim()
+{
+    while (stats_.bytesIdle > maxIdleBytes_)
+    {
+        auto oldest = entries_.end();
+        for (auto entry = entries_.begin(); entry != entries_.end(); ++entry)
+        {
+            if (!entry->inUse && (oldest == entries_.end() || entry->lastUsed < oldest->lastUsed))
+            {
+                oldest = entry;
+            }
+        }
+
+        if (oldest == entries_.end())
+        {
+            break;
+        }
+
+        stats_.bytesIdle -= oldest->bytes;
+        ++stats_.evicted;
+        SafeRelease(oldest->srv);
+        SafeRelease(oldest->texture);
+        entries_.erase(oldest);
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <d3d11.h>
+#include <cstdint>
+#include <vector>
+
+struct TexturePoolStats
+{
+    uint64_t bytesInUse;
+    uint64_t bytesIdle;
+    uint64_t highWaterBytes;        // in use + idle
+    uint64_t created;
+    uint64_t reused;
+    uint64_t evicted;
+};
+
+// Textures, with a view of each where they're bound as shader resources, kept for reuse
+// and keyed by their full description. A size, rotation or format change hands the old
+// texture back and takes one that matches the new description, so switching back and
+// forth, e.g. an HDR toggle, doesn't reallocate. Idle textures beyond maxIdleBytes are
+// released, least recently used first. Only used from the window's thread.
+class TexturePool  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+public:
+    TexturePool();
+    ~TexturePool();
+
+    bool Create(ID3D11Device* device, uint64_t maxIdleBytes = DefaultMaxIdleBytes);
+    void Destroy();
+
+    // A texture matching desc, and a view of all of it in srv if that isn't null. The pool
+    // keeps the references: hand both back with Recycle rather than releasing them.
+    bool Acquire(const D3D11_TEXTURE2D_DESC& desc, ID3D11Texture2D** texture, ID3D11ShaderResourceView** srv);
+
+    // Returns a texture from Acquire to the pool and clears the caller's pointers
+    void Recycle(ID3D11Texture2D*& texture, ID3D11ShaderResourceView*& srv);
+    void Recycle(ID3D11Texture2D*& texture);
+
+    // Returns a texture from Acquire and releases it rather than keeping it idle, for one
+    // that's being replaced to save memory
+    void Discard(ID3D11Texture2D*& texture, ID3D11ShaderResourceView*& srv);
+
+    void SetMaxIdleBytes(uint64_t maxIdleBytes);
+    TexturePoolStats GetStats() const;
+
+    // Video memory for a texture, allowing for its mips and array slices
+    static uint64_t GetByteSize(const D3D11_TEXTURE2D_DESC& desc);
+
+    static constexpr uint64_t DefaultMaxIdleBytes = 96ull * 1024 * 1024;
+
+private:
+    struct Entry
+    {
+        D3D11_TEXTURE2D_DESC desc;
+        ID3D11Texture2D* texture;
+        ID3D11ShaderResourceView* srv;
+        uint64_t bytes;
+        uint64_t lastUsed;          // clock_ when it was last recycled
+        bool inUse;
+    };
+
+    void Trim();
+
+    ID3D11Device* device_;
+    std::vector<Entry> entries_;
+    uint64_t maxIdleBytes_;
+    uint64_t clock_;
+    TexturePoolStats stats_;
+};
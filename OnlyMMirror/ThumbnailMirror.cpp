@@ -0,0 +1,84 @@
+#include "stdafx.h"
+#include "ThumbnailMirror.h"
+
+#pragma comment(lib, "dwmapi.lib")
+
+ThumbnailMirror::ThumbnailMirror()
+    : thumbnail_(nullptr)
+    , source_(nullptr)
+    , sourceRect_()
+    , destinationRect_()
+{
+}
+
+ThumbnailMirror::~ThumbnailMirror()
+{
+    Unregister();
+}
+
+bool ThumbnailMirror::Register(const HWND destination, const HWND source)
+{
+    Unregister();
+
+    if (FAILED(DwmRegisterThumbnail(destination, source, &thumbnail_)))
+    {
+        thumbnail_ = nullptr;
+        return false;
+    }
+
+    source_ = source;
+    return true;
+}
+
+void ThumbnailMirror::Unregister()
+{
+    if (thumbnail_)
+    {
+        DwmUnregisterThumbnail(thumbnail_);
+        thumbnail_ = nullptr;
+    }
+
+    source_ = nullptr;
+    SetRectEmpty(&sourceRect_);
+    SetRectEmpty(&destinationRect_);
+}
+
+bool ThumbnailMirror::IsRegistered() const
+{
+    return thumbnail_ != nullptr;
+}
+
+HWND ThumbnailMirror::GetSource() const
+{
+    return source_;
+}
+
+bool ThumbnailMirror::Update(const RECT& sourceRect, const RECT& destinationRect)
+{
+    if (!thumbnail_)
+    {
+        return false;
+    }
+
+    if (EqualRect(&sourceRect, &sourceRect_) && EqualRect(&destinationRect, &destinationRect_))
+    {
+        return true;
+    }
+
+    DWM_THUMBNAIL_PROPERTIES properties = {};
+    properties.dwFlags = DWM_TNP_RECTSOURCE | DWM_TNP_RECTDESTINATION | DWM_TNP_VISIBLE | DWM_TNP_OPACITY | DWM_TNP_SOURCECLIENTAREAONLY;
+    properties.rcSource = sourceRect;
+    properties.rcDestination = destinationRect;
+    properties.fVisible = TRUE;
+    properties.opacity = 255;
+    properties.fSourceClientAreaOnly = FALSE;
+
+    if (FAILED(DwmUpdateThumbnailProperties(thumbnail_, &properties)))
+    {
+        return false;
+    }
+
+    sourceRect_ = sourceRect;
+    destinationRect_ = destinationRect;
+    return true;
+}
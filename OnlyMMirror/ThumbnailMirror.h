@@ -0,0 +1,27 @@
+#pragma once
+#include <windows.h>
+#include <dwmapi.h>
+
+// Mirrors another top-level window with a DWM thumbnail. DWM composes and scales the
+// source directly into the destination window, so no capture, copy or draw is done here.
+class ThumbnailMirror  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+public:
+    ThumbnailMirror();
+    ~ThumbnailMirror();
+
+    bool Register(HWND destination, HWND source);
+    void Unregister();
+    bool IsRegistered() const;
+    HWND GetSource() const;
+
+    // sourceRect is relative to the source window's top-left corner (non-client area
+    // included); destinationRect is in the destination's client coordinates.
+    bool Update(const RECT& sourceRect, const RECT& destinationRect);
+
+private:
+    HTHUMBNAIL thumbnail_;
+    HWND source_;
+    RECT sourceRect_;
+    RECT destinationRect_;
+};
@@ -0,0 +1,57 @@
+#include "TileLayout.h"
+
+#include <algorithm>
+#include <cmath>
+
+void TileLayout::GetRowSize(const std::vector<PixelRect>& sources, int& width, int& height)
+{
+    width = 0;
+    height = 0;
+
+    for (const PixelRect& source : sources)
+    {
+        width += source.right - source.left;
+        height = (std::max)(height, source.bottom - source.top);
+    }
+}
+
+bool TileLayout::Arrange(const std::vector<PixelRect>& sources, const PixelRect& area, std::vector<PixelRect>& tiles)
+{
+    tiles.clear();
+
+    int rowWidth;
+    int rowHeight;
+    GetRowSize(sources, rowWidth, rowHeight);
+
+    const int areaWidth = area.right - area.left;
+    const int areaHeight = area.bottom - area.top;
+    if (rowWidth <= 0 || rowHeight <= 0 || areaWidth <= 0 || areaHeight <= 0)
+    {
+        return false;
+    }
+
+    const double scale = (std::min)(
+        static_cast<double>(areaWidth) / rowWidth, static_cast<double>(areaHeight) / rowHeight);
+
+    const double left = area.left + (areaWidth - rowWidth * scale) / 2.0;
+    const double middle = area.top + areaHeight / 2.0;
+
+    // Edges come from the running offset so neighbouring tiles meet without gaps
+    int offset = 0;
+    for (const PixelRect& source : sources)
+    {
+        const int width = source.right - source.left;
+        const double height = (source.bottom - source.top) * scale;
+
+        PixelRect tile;
+        tile.left = static_cast<int>(std::lround(left + offset * scale));
+        tile.right = static_cast<int>(std::lround(left + (offset + width) * scale));
+        tile.top = static_cast<int>(std::lround(middle - height / 2.0));
+        tile.bottom = static_cast<int>(std::lround(middle + height / 2.0));
+        tiles.push_back(tile);
+
+        offset += width;
+    }
+
+    return true;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+// Portable layout of several monitors side by side in the mirror, all at the same scale.
+
+#include <vector>
+#include "ViewTransform.h"
+
+class TileLayout
+{
+public:
+    // The size of the sources placed side by side: their total width and greatest height
+    static void GetRowSize(const std::vector<PixelRect>& sources, int& width, int& height);
+
+    // Arranges the sources left to right in area, scaled uniformly to fit and centred.
+    // tiles gets one rect per source, in the same order. Returns false if nothing fits.
+    static bool Arrange(const std::vector<PixelRect>& sources, const PixelRect& area, std::vector<PixelRect>& tiles);
+};
@@ -0,0 +1,123 @@
+#include "ToneMap.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // Linear BT.2020 to linear BT.709 primaries
+    constexpr float Bt2020To709[3][3] =
+    {
+        {  1.6605f, -0.5876f, -0.0728f },
+        { -0.1246f,  1.1329f, -0.0083f },
+        { -0.0182f, -0.1006f,  1.1187f }
+    };
+
+    float Clamp01(const float value)
+    {
+        return (std::min)(1.0f, (std::max)(0.0f, value));
+    }
+}
+
+namespace ToneMap
+{
+    ToneMapConstants GetConstants(const ToneMapSettings& settings)
+    {
+        const float sdrWhite = settings.sdrWhiteNits > 0.0f ? settings.sdrWhiteNits : DefaultSdrWhiteNits;
+
+        ToneMapConstants constants;
+        constants.encoding = static_cast<float>(settings.encoding);
+        constants.scale = settings.encoding == ColourEncoding::LinearScRgb ? ScRgbUnitNits / sdrWhite : 1.0f / sdrWhite;
+        constants.peak = settings.peakNits > 0.0f ? settings.peakNits / sdrWhite : 1.0f;
+        constants.knee = Knee;
+        return constants;
+    }
+
+    float Compress(const float x, const float peak, const float knee)
+    {
+        if (peak <= 1.0f || x <= knee)
+        {
+            return (std::min)(x, 1.0f);
+        }
+
+        // Extended Reinhard over the range above the knee
+        const float range = 1.0f - knee;
+        const float a = ((std::min)(x, peak) - knee) / range;
+        const float limit = (peak - knee) / range;
+        return knee + range * a * (1.0f + a / (limit * limit)) / (1.0f + a);
+    }
+
+    void Apply(const ToneMapConstants& constants, const float source[3], float result[3])
+    {
+        if (constants.encoding < 0.5f)
+        {
+            // Already SDR
+            for (int n = 0; n < 3; ++n)
+            {
+                result[n] = Clamp01(source[n]);
+            }
+
+            return;
+        }
+
+        float linear[3];
+        if (constants.encoding < 1.5f)
+        {
+            for (int n = 0; n < 3; ++n)
+            {
+                linear[n] = source[n] * constants.scale;
+            }
+        }
+        else
+        {
+            const float nits[3] = { PqToNits(source[0]), PqToNits(source[1]), PqToNits(source[2]) };
+            for (int n = 0; n < 3; ++n)
+            {
+                linear[n] = (Bt2020To709[n][0] * nits[0] + Bt2020To709[n][1] * nits[1] + Bt2020To709[n][2] * nits[2]) * constants.scale;
+            }
+        }
+
+        for (float& channel : linear)
+        {
+            channel = (std::max)(0.0f, channel);
+        }
+
+        // Compressing the largest channel and scaling the others with it keeps the hue
+        const float largest = (std::max)(linear[0], (std::max)(linear[1], linear[2]));
+        if (largest > constants.knee)
+        {
+            const float ratio = Compress(largest, constants.peak, constants.knee) / largest;
+            for (float& channel : linear)
+            {
+                channel *= ratio;
+            }
+        }
+
+        for (int n = 0; n < 3; ++n)
+        {
+            result[n] = LinearToSrgb(Clamp01(linear[n]));
+        }
+    }
+
+    float SrgbToLinear(const float value)
+    {
+        return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+    }
+
+    float LinearToSrgb(const float value)
+    {
+        return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+    }
+
+    float PqToNits(const float value)
+    {
+        constexpr float m1 = 0.1593017578125f;
+        constexpr float m2 = 78.84375f;
+        constexpr float c1 = 0.8359375f;
+        constexpr float c2 = 18.8515625f;
+        constexpr float c3 = 18.6875f;
+
+        const float p = std::pow(Clamp01(value), 1.0f / m2);
+        return 10000.0f * std::pow((std::max)(p - c1, 0.0f) / (c2 - c3 * p), 1.0f / m1);
+    }
+}
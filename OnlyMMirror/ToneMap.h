@@ -0,0 +1,49 @@
+#pragma once
+
+// Portable reference for the mirror's tone mapping of HDR and wide-format desktops to the
+// 8-bit SDR swap chain. The pixel shader in DuplicationWindow does the same maths per pixel;
+// this version exists so that the curve can be checked on the CPU.
+
+enum class ColourEncoding
+{
+    Srgb,           // 8 or 10-bit SDR: sRGB transfer, BT.709 primaries; shown as is
+    LinearScRgb,    // FP16 scRGB: linear, BT.709 primaries, 1.0 = 80 nits
+    Pq2020          // 10-bit HDR10: SMPTE ST 2084 transfer, BT.2020 primaries
+};
+
+struct ToneMapSettings
+{
+    ColourEncoding encoding;
+    float sdrWhiteNits;     // the brightness Windows gives SDR white on the source monitor
+    float peakNits;         // the source monitor's peak brightness
+};
+
+// Same layout as the shader's ToneMap constant buffer
+struct ToneMapConstants
+{
+    float encoding;         // ColourEncoding as a float
+    float scale;            // source units to multiples of SDR white
+    float peak;             // source peak in multiples of SDR white
+    float knee;             // below this, multiples of SDR white pass through unchanged
+};
+
+namespace ToneMap
+{
+    constexpr float ScRgbUnitNits = 80.0f;
+    constexpr float DefaultSdrWhiteNits = 80.0f;
+    constexpr float Knee = 0.75f;
+
+    ToneMapConstants GetConstants(const ToneMapSettings& settings);
+
+    // Converts one source pixel (as sampled from the captured texture) to an sRGB-encoded
+    // value in 0..1 for the swap chain
+    void Apply(const ToneMapConstants& constants, const float source[3], float result[3]);
+
+    // Rolls off x, in multiples of SDR white, so that peak maps to 1. Values up to the knee
+    // are unchanged and the slope is continuous there.
+    float Compress(float x, float peak, float knee);
+
+    float SrgbToLinear(float value);
+    float LinearToSrgb(float value);
+    float PqToNits(float value);
+}
@@ -0,0 +1,241 @@
+// Checks BorderDetector (see BorderDetector.h) on synthetic reduced luma frames: symmetric
+// letterbox and pillarbox borders adopted after ShrinkSeconds, asymmetric dark content and
+// black frames left alone, a change in a border dropping the borders, and the HoldSeconds
+// wait before they're adopted again. Portable, e.g.
+//
+//     g++ -std=c++17 -O2 -I OnlyMMirror -o BorderDetectorTest OnlyMMirror/Tools/BorderDetectorTest.cpp OnlyMMirror/BorderDetector.cpp OnlyMMirror/ViewTransform.cpp
+//     ./BorderDetectorTest
+
+#include "BorderDetector.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    // A 1080p output, measured as the feed probe does at a tenth of its size
+    constexpr int OutputWidth = 1920;
+    constexpr int OutputHeight = 1080;
+    constexpr int SampleWidth = 192;
+    constexpr int SampleHeight = 108;
+    constexpr PixelRect Output = { 0, 0, OutputWidth, OutputHeight };
+
+    // Updates come with each probe, a couple of times a second
+    constexpr double Step = 0.5;
+
+    int failures = 0;
+
+    void Check(const bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            printf("FAILED: %s\n", what);
+            ++failures;
+        }
+    }
+
+    // Black, with content in the given samples. The content is dark grey with some texture,
+    // just above the border level, as a dark scene would be.
+    std::vector<uint8_t> MakeFrame(const int left, const int top, const int right, const int bottom)
+    {
+        std::vector<uint8_t> luma(static_cast<size_t>(SampleWidth) * SampleHeight, 0);
+        for (int y = top; y < bottom; ++y)
+        {
+            for (int x = left; x < right; ++x)
+            {
+                luma[static_cast<size_t>(y) * SampleWidth + x] =
+                    static_cast<uint8_t>(BorderDetector::BorderLuma + 1 + (x * 7 + y * 13) % 90);
+            }
+        }
+
+        return luma;
+    }
+
+    // A 2.39:1 film in 16:9: 12 samples (120 pixels) top and bottom
+    std::vector<uint8_t> MakeLetterbox()
+    {
+        return MakeFrame(0, 12, SampleWidth, SampleHeight - 12);
+    }
+
+    // 4:3 slides in 16:9: 24 samples (240 pixels) either side
+    std::vector<uint8_t> MakePillarbox()
+    {
+        return MakeFrame(24, 0, SampleWidth - 24, SampleHeight);
+    }
+
+    bool Update(BorderDetector& detector, const std::vector<uint8_t>& luma, const double now)
+    {
+        return detector.Update(luma.data(), SampleWidth, SampleHeight, Output, now);
+    }
+
+    // Feeds the same frame from start until before end; returns when the borders were
+    // adopted, or a negative time if they weren't
+    double Feed(BorderDetector& detector, const std::vector<uint8_t>& luma, const double start, const double end)
+    {
+        for (double now = start; now < end; now += Step)
+        {
+            if (Update(detector, luma, now))
+            {
+                return now;
+            }
+        }
+
+        return -1.0;
+    }
+
+    bool IsOutput(const PixelRect& rect)
+    {
+        return rect.left == 0 && rect.top == 0 && rect.right == OutputWidth && rect.bottom == OutputHeight;
+    }
+
+    bool Near(const int value, const int expected, const int tolerance)
+    {
+        return value >= expected - tolerance && value <= expected + tolerance;
+    }
+
+    void TestLetterbox()
+    {
+        BorderDetector detector;
+        detector.Reset(Output);
+
+        const double adopted = Feed(detector, MakeLetterbox(), 0.0, 10.0);
+        Check(adopted >= BorderDetector::ShrinkSeconds, "letterbox: not adopted before ShrinkSeconds");
+        Check(adopted >= 0.0 && adopted < BorderDetector::ShrinkSeconds + Step, "letterbox: adopted after ShrinkSeconds");
+        Check(detector.HasBorders(), "letterbox: has borders");
+
+        // Within a sample of the edges, and never cutting into the content
+        const PixelRect& content = detector.GetContent();
+        Check(content.left == 0 && content.right == OutputWidth, "letterbox: full width");
+        Check(Near(content.top, 110, 10) && content.top <= 120, "letterbox: top border");
+        Check(Near(content.bottom, 970, 10) && content.bottom >= 960, "letterbox: bottom border");
+
+        // The same frame again changes nothing
+        Check(!Update(detector, MakeLetterbox(), 10.0) && detector.HasBorders(), "letterbox: kept");
+    }
+
+    void TestPillarbox()
+    {
+        BorderDetector detector;
+        detector.Reset(Output);
+
+        const double adopted = Feed(detector, MakePillarbox(), 0.0, 10.0);
+        Check(adopted >= BorderDetector::ShrinkSeconds && adopted < BorderDetector::ShrinkSeconds + Step,
+            "pillarbox: adopted after ShrinkSeconds");
+
+        const PixelRect& content = detector.GetContent();
+        Check(content.top == 0 && content.bottom == OutputHeight, "pillarbox: full height");
+        Check(Near(content.left, 230, 10) && content.left <= 240, "pillarbox: left border");
+        Check(Near(content.right, 1690, 10) && content.right >= 1680, "pillarbox: right border");
+    }
+
+    void TestAsymmetric()
+    {
+        // Text on a black slide, off to the left
+        BorderDetector detector;
+        detector.Reset(Output);
+        Check(Feed(detector, MakeFrame(10, 20, 120, 60), 0.0, 20.0) < 0.0, "asymmetric: off centre text not adopted");
+        Check(!detector.HasBorders() && IsOutput(detector.GetContent()), "asymmetric: no borders");
+
+        // A dark scene lit only at the top
+        detector.Reset(Output);
+        Check(Feed(detector, MakeFrame(0, 0, SampleWidth, 40), 0.0, 20.0) < 0.0, "asymmetric: dark scene not adopted");
+        Check(!detector.HasBorders(), "asymmetric: still no borders");
+
+        // Bars thinner than MinBorderFraction aren't worth cropping
+        detector.Reset(Output);
+        Check(Feed(detector, MakeFrame(1, 0, SampleWidth - 1, SampleHeight), 0.0, 20.0) < 0.0, "thin: not adopted");
+    }
+
+    void TestBlack()
+    {
+        const std::vector<uint8_t> black = MakeFrame(0, 0, 0, 0);
+
+        BorderDetector detector;
+        detector.Reset(Output);
+        Check(Feed(detector, black, 0.0, 20.0) < 0.0 && !detector.HasBorders(), "black: no borders from a black frame");
+
+        // A fade to black between scenes keeps the borders
+        Feed(detector, MakeLetterbox(), 20.0, 30.0);
+        Check(detector.HasBorders(), "black: letterbox adopted");
+        Check(Feed(detector, black, 30.0, 40.0) < 0.0 && detector.HasBorders(), "black: borders kept through black");
+    }
+
+    void TestChangeInBorder()
+    {
+        BorderDetector detector;
+        detector.Reset(Output);
+        Feed(detector, MakeLetterbox(), 0.0, 10.0);
+        Check(detector.HasBorders(), "change: letterbox adopted");
+
+        // Changes in the content leave the borders alone
+        Check(!detector.AddChange({ 400, 300, 800, 600 }), "change: in the content");
+        Check(!detector.AddChange({ 0, 0, 0, 0 }), "change: empty");
+        Check(detector.HasBorders(), "change: borders kept");
+
+        // A subtitle in the bottom border drops them straight away
+        Check(detector.AddChange({ 600, 1000, 1300, 1060 }), "change: in a border drops the borders");
+        Check(!detector.HasBorders() && IsOutput(detector.GetContent()), "change: whole output");
+        Check(!detector.AddChange({ 600, 1000, 1300, 1060 }), "change: nothing left to drop");
+    }
+
+    void TestHold()
+    {
+        BorderDetector detector;
+        detector.Reset(Output);
+        Feed(detector, MakeLetterbox(), 0.0, 10.0);
+
+        // The drop is timed from the next update
+        detector.AddChange({ 0, 0, 100, 50 });
+        const double dropped = 10.0;
+        const double adopted = Feed(detector, MakeLetterbox(), dropped, dropped + 30.0);
+        Check(adopted >= dropped + BorderDetector::HoldSeconds, "hold: not adopted again before HoldSeconds");
+        Check(adopted >= 0.0 && adopted < dropped + BorderDetector::HoldSeconds + Step, "hold: adopted again after HoldSeconds");
+
+        // Each change in a border starts the wait again
+        detector.AddChange({ 0, 0, 100, 50 });
+        const double restart = adopted + Step;
+        Update(detector, MakeLetterbox(), restart);
+        detector.AddChange({ 0, 0, 100, 50 });
+        const double again = Feed(detector, MakeLetterbox(), restart + Step, restart + 30.0);
+        Check(again >= restart + Step + BorderDetector::HoldSeconds, "hold: a second change restarts the wait");
+    }
+
+    void TestCandidate()
+    {
+        BorderDetector detector;
+        detector.Reset(Output);
+
+        // A change in the borders waiting to be adopted means they have to hold for HoldSeconds
+        Feed(detector, MakeLetterbox(), 0.0, 1.5);
+        detector.AddChange({ 0, 0, 100, 50 });
+        Check(!detector.HasBorders(), "candidate: not adopted yet");
+        Check(Feed(detector, MakeLetterbox(), 1.5, 1.5 + BorderDetector::HoldSeconds) < 0.0,
+            "candidate: a change in the borders waits HoldSeconds");
+
+        // Zoomed in, the probe doesn't see all of the content and can't find its edges
+        detector.Reset(Output);
+        const PixelRect zoomed = { 480, 270, 1440, 810 };
+        bool adopted = false;
+        for (double now = 0.0; now < 10.0; now += Step)
+        {
+            adopted = detector.Update(MakeLetterbox().data(), SampleWidth, SampleHeight, zoomed, now) || adopted;
+        }
+
+        Check(!adopted && !detector.HasBorders(), "candidate: not measured while zoomed in");
+        Check(!detector.Update(nullptr, SampleWidth, SampleHeight, Output, 20.0), "candidate: no luma");
+    }
+}
+
+int main()
+{
+    TestLetterbox();
+    TestPillarbox();
+    TestAsymmetric();
+    TestBlack();
+    TestChangeInBorder();
+    TestHold();
+    TestCandidate();
+
+    printf("%s\n", failures == 0 ? "all passed" : "some checks failed");
+    return failures == 0 ? 0 : 1;
+}
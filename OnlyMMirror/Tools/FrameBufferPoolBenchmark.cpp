@@ -0,0 +1,155 @@
+// Compares FrameBufferPool (see FrameBufferPool.h) with fresh allocations for whole frame
+// buffers, as a snapshot uses them: a converted image and an encoded one are taken, each
+// is written in full, and both are given back. Fresh buffers come from malloc, and from a
+// std::vector, which also clears them. Also run with the sizes alternating, as after a
+// change of resolution. Portable, e.g.
+//
+//     g++ -std=c++17 -O2 -I OnlyMMirror -o FrameBufferPoolBenchmark OnlyMMirror/Tools/FrameBufferPoolBenchmark.cpp OnlyMMirror/FrameBufferPool.cpp
+//     ./FrameBufferPoolBenchmark
+
+#include "FrameBufferPool.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    constexpr int Iterations = 100;
+
+    struct FrameSize
+    {
+        const char* name;
+        size_t bytes;
+    };
+
+    // BGRA 1080p and 4K, and 4K FP16 as an HDR desktop's converted copy would be
+    const FrameSize Sizes[] = {
+        { "1080p bgra8", 1920u * 1080u * 4u },
+        { "4K bgra8", 3840u * 2160u * 4u },
+        { "4K rgba16f", 3840u * 2160u * 8u } };
+
+    // Called through a volatile pointer so that the compiler can't drop the writes
+    void* (*volatile fill)(void*, int, size_t) = memset;
+
+    // Stands in for the conversion and encode writing the whole buffer, so the time includes
+    // the writes themselves as well as any first touch of fresh pages
+    unsigned Touch(uint8_t* data, const size_t size)
+    {
+        static uint8_t value = 0;
+        fill(data, ++value, size);
+        return data[size / 2] + data[size - 1];
+    }
+
+    template <typename Function>
+    double MeasureMs(const Function& function)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        const auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    void Print(const char* how, const char* name, const double ms)
+    {
+        const double perFrameMs = ms / Iterations;
+        printf("%-8s %-12s %8.3f ms a frame %8.0f frames/s\n", how, name, perFrameMs, 1000.0 / perFrameMs);
+    }
+
+    unsigned MeasurePooled(const size_t* sizes, const int sizeCount, const char* name, FrameBufferPool& pool)
+    {
+        unsigned sum = 0;
+        const double ms = MeasureMs([&]
+        {
+            for (int n = 0; n < Iterations; ++n)
+            {
+                const size_t size = sizes[n % sizeCount];
+                const FrameBuffer converted = pool.Acquire(size);
+                const FrameBuffer encoded = pool.Acquire(size);
+                if (converted && encoded)
+                {
+                    sum += Touch(converted.Data(), size) + Touch(encoded.Data(), size);
+                }
+            }
+        });
+
+        Print("pooled", name, ms);
+        return sum;
+    }
+
+    unsigned MeasureMalloc(const size_t* sizes, const int sizeCount, const char* name)
+    {
+        unsigned sum = 0;
+        const double ms = MeasureMs([&]
+        {
+            for (int n = 0; n < Iterations; ++n)
+            {
+                const size_t size = sizes[n % sizeCount];
+                auto* converted = static_cast<uint8_t*>(malloc(size));  // NOLINT(cppcoreguidelines-no-malloc)
+                auto* encoded = static_cast<uint8_t*>(malloc(size));  // NOLINT(cppcoreguidelines-no-malloc)
+                if (converted && encoded)
+                {
+                    sum += Touch(converted, size) + Touch(encoded, size);
+                }
+
+                free(encoded);  // NOLINT(cppcoreguidelines-no-malloc)
+                free(converted);  // NOLINT(cppcoreguidelines-no-malloc)
+            }
+        });
+
+        Print("malloc", name, ms);
+        return sum;
+    }
+
+    unsigned MeasureVector(const size_t* sizes, const int sizeCount, const char* name)
+    {
+        unsigned sum = 0;
+        const double ms = MeasureMs([&]
+        {
+            for (int n = 0; n < Iterations; ++n)
+            {
+                const size_t size = sizes[n % sizeCount];
+                std::vector<uint8_t> converted(size);
+                std::vector<uint8_t> encoded(size);
+                sum += Touch(converted.data(), size) + Touch(encoded.data(), size);
+            }
+        });
+
+        Print("vector", name, ms);
+        return sum;
+    }
+}
+
+int main()
+{
+    unsigned sum = 0;
+
+    for (const FrameSize& size : Sizes)
+    {
+        FrameBufferPool pool;
+        sum += MeasurePooled(&size.bytes, 1, size.name, pool);
+        sum += MeasureMalloc(&size.bytes, 1, size.name);
+        sum += MeasureVector(&size.bytes, 1, size.name);
+
+        const FrameBufferPoolStats stats = pool.GetStats();
+        printf("         %-12s %llu fresh and %llu reused, %.0f MB reserved at most\n\n", size.name,
+            static_cast<unsigned long long>(stats.freshAllocations), static_cast<unsigned long long>(stats.reusedAllocations),
+            static_cast<double>(stats.highWaterBytesReserved) / (1024.0 * 1024.0));
+    }
+
+    // The resolution changing back and forth; the pool keeps a buffer of each size
+    const size_t alternating[] = { Sizes[0].bytes, Sizes[1].bytes };
+    FrameBufferPool pool;
+    sum += MeasurePooled(alternating, 2, "alternating", pool);
+    sum += MeasureMalloc(alternating, 2, "alternating");
+    sum += MeasureVector(alternating, 2, "alternating");
+
+    const FrameBufferPoolStats stats = pool.GetStats();
+    printf("         %-12s %llu fresh and %llu reused\n", "alternating",
+        static_cast<unsigned long long>(stats.freshAllocations), static_cast<unsigned long long>(stats.reusedAllocations));
+
+    // Keeps the touched pages from being optimised away
+    return sum == 1 ? 1 : 0;
+}
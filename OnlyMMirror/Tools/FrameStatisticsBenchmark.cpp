@@ -0,0 +1,197 @@
+// Measures the feed statistics kernels (see FrameStatistics.h) on synthetic 4K frames: the
+// luma conversion of each capture format (8-bit SDR, HDR10 and scRGB, the last two tone
+// mapped), the mean, dark fraction and histogram, and the change count against the frame
+// before. The probe runs them on a small reduced copy; full frames show what they cost per
+// pixel and whether the compiler vectorised them. Portable, e.g.
+//
+//     g++ -std=c++17 -O2 -I OnlyMMirror -o FrameStatisticsBenchmark OnlyMMirror/Tools/FrameStatisticsBenchmark.cpp OnlyMMirror/FrameStatistics.cpp OnlyMMirror/ToneMap.cpp
+//     ./FrameStatisticsBenchmark
+
+#include "FrameStatistics.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+    constexpr int Runs = 5;
+    constexpr int Width = 3840;
+    constexpr int Height = 2160;
+    constexpr size_t PixelCount = static_cast<size_t>(Width) * Height;
+
+    // The same desktop in each format: a gradient with noise, and a black letterbox
+    float SceneValue(const int x, const int y, const int channel, std::mt19937& random)
+    {
+        if (y < Height / 8 || y >= Height - Height / 8)
+        {
+            return 0.0f;
+        }
+
+        std::uniform_real_distribution<float> noise(-0.02f, 0.02f);
+        const float value = (static_cast<float>(x) / Width + static_cast<float>(y) / Height) * 0.5f +
+            static_cast<float>(channel) * 0.05f + noise(random);
+        return (std::min)(1.0f, (std::max)(0.0f, value));
+    }
+
+    // Normal and zero values only, which is all the scene has
+    uint16_t FloatToHalf(const float value)
+    {
+        if (value <= 0.0f)
+        {
+            return 0;
+        }
+
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        const int exponent = static_cast<int>((bits >> 23) & 0xff) - 127 + 15;
+        if (exponent <= 0)
+        {
+            return 0;
+        }
+
+        return static_cast<uint16_t>((exponent << 10) | ((bits >> 13) & 0x3ff));
+    }
+
+    std::vector<uint8_t> MakeBgra8(const unsigned seed)
+    {
+        std::mt19937 random(seed);
+        std::vector<uint8_t> pixels(PixelCount * 4);
+        for (int y = 0; y < Height; ++y)
+        {
+            for (int x = 0; x < Width; ++x)
+            {
+                uint8_t* pixel = pixels.data() + (static_cast<size_t>(y) * Width + x) * 4;
+                for (int channel = 0; channel < 3; ++channel)
+                {
+                    pixel[2 - channel] = static_cast<uint8_t>(SceneValue(x, y, channel, random) * 255.0f + 0.5f);
+                }
+
+                pixel[3] = 255;
+            }
+        }
+
+        return pixels;
+    }
+
+    // PQ codes spanning SDR levels and some highlights
+    std::vector<uint32_t> MakeRgb10a2(const unsigned seed)
+    {
+        std::mt19937 random(seed);
+        std::vector<uint32_t> pixels(PixelCount);
+        for (int y = 0; y < Height; ++y)
+        {
+            for (int x = 0; x < Width; ++x)
+            {
+                uint32_t pixel = 3u << 30;
+                for (int channel = 0; channel < 3; ++channel)
+                {
+                    const float code = SceneValue(x, y, channel, random) * 0.8f;
+                    pixel |= static_cast<uint32_t>(code * 1023.0f + 0.5f) << (channel * 10);
+                }
+
+                pixels[static_cast<size_t>(y) * Width + x] = pixel;
+            }
+        }
+
+        return pixels;
+    }
+
+    // scRGB up to 6x SDR white at 80 nits, so that part of it is rolled off
+    std::vector<uint16_t> MakeRgba16f(const unsigned seed)
+    {
+        std::mt19937 random(seed);
+        std::vector<uint16_t> pixels(PixelCount * 4);
+        for (int y = 0; y < Height; ++y)
+        {
+            for (int x = 0; x < Width; ++x)
+            {
+                uint16_t* pixel = pixels.data() + (static_cast<size_t>(y) * Width + x) * 4;
+                for (int channel = 0; channel < 3; ++channel)
+                {
+                    const float value = SceneValue(x, y, channel, random);
+                    pixel[channel] = FloatToHalf(value * value * 6.0f);
+                }
+
+                pixel[3] = FloatToHalf(1.0f);
+            }
+        }
+
+        return pixels;
+    }
+
+    template <typename Function>
+    double MeasureMs(const Function& function)
+    {
+        double bestMs = 1.0e30;
+        for (int run = 0; run < Runs; ++run)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            function();
+            const auto end = std::chrono::steady_clock::now();
+            bestMs = (std::min)(bestMs, std::chrono::duration<double, std::milli>(end - start).count());
+        }
+
+        return bestMs;
+    }
+
+    void Print(const char* kernel, const char* format, const double ms, const size_t bytesPerPixel)
+    {
+        printf("%-9s %-8s %dx%d %8.2f ms %8.0f Mpixel/s %8.0f MB/s\n",
+            kernel, format, Width, Height, ms, static_cast<double>(PixelCount) / (ms * 1000.0),
+            static_cast<double>(PixelCount * bytesPerPixel) / (1024.0 * 1024.0) / ms * 1000.0);
+    }
+
+    // The statistics kernels on luma from one format; the second frame is the first moved
+    // on, as the next probe would see it
+    void MeasureStatistics(const char* format, const std::vector<uint8_t>& luma, const std::vector<uint8_t>& previous)
+    {
+        FrameStatistics statistics;
+        const double meanMs = MeasureMs([&] { FrameAnalysis::Measure(luma.data(), nullptr, luma.size(), statistics); });
+        Print("measure", format, meanMs, 1);
+
+        const double changeMs = MeasureMs([&] { FrameAnalysis::Measure(luma.data(), previous.data(), luma.size(), statistics); });
+        Print("+changes", format, changeMs, 2);
+
+        printf("          %-8s mean %.3f, dark %.1f%%, changed %.1f%%\n\n",
+            format, statistics.meanLuma, statistics.darkFraction * 100.0, statistics.changedFraction * 100.0);
+    }
+}
+
+int main()
+{
+    const ToneMapConstants hdr10 = ToneMap::GetConstants({ ColourEncoding::Pq2020, 203.0f, 1000.0f });
+    const ToneMapConstants scRgb = ToneMap::GetConstants({ ColourEncoding::LinearScRgb, 200.0f, 1000.0f });
+
+    std::vector<uint8_t> luma(PixelCount);
+    std::vector<uint8_t> previous(PixelCount);
+
+    {
+        const std::vector<uint8_t> frame = MakeBgra8(1);
+        const std::vector<uint8_t> next = MakeBgra8(2);
+        FrameAnalysis::LumaFromBgra8(next.data(), PixelCount, previous.data());
+        Print("luma", "bgra8", MeasureMs([&] { FrameAnalysis::LumaFromBgra8(frame.data(), PixelCount, luma.data()); }), 4);
+        MeasureStatistics("bgra8", luma, previous);
+    }
+
+    {
+        const std::vector<uint32_t> frame = MakeRgb10a2(1);
+        const std::vector<uint32_t> next = MakeRgb10a2(2);
+        FrameAnalysis::LumaFromRgb10a2(next.data(), PixelCount, hdr10, previous.data());
+        Print("luma", "hdr10", MeasureMs([&] { FrameAnalysis::LumaFromRgb10a2(frame.data(), PixelCount, hdr10, luma.data()); }), 4);
+        MeasureStatistics("hdr10", luma, previous);
+    }
+
+    {
+        const std::vector<uint16_t> frame = MakeRgba16f(1);
+        const std::vector<uint16_t> next = MakeRgba16f(2);
+        FrameAnalysis::LumaFromRgba16f(next.data(), PixelCount, scRgb, previous.data());
+        Print("luma", "scrgb", MeasureMs([&] { FrameAnalysis::LumaFromRgba16f(frame.data(), PixelCount, scRgb, luma.data()); }), 8);
+        MeasureStatistics("scrgb", luma, previous);
+    }
+
+    return 0;
+}
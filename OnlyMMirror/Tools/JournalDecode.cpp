@@ -0,0 +1,385 @@
+// Prints a frame journal dump (see FrameJournal.h) as a timeline, followed by the frame
+// pacing and jitter it shows. Portable, so a dump can be looked at anywhere, e.g.
+//
+//     g++ -std=c++17 -O2 -I OnlyMMirror -o JournalDecode OnlyMMirror/Tools/JournalDecode.cpp OnlyMMirror/FrameJournal.cpp
+//     ./JournalDecode OnlyMMirror-crash.journal [--summary] [--last <records>]
+
+#include "FrameJournal.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <vector>
+
+namespace
+{
+    constexpr int32_t WaitTimeout = static_cast<int32_t>(0x887A0027);   // DXGI_ERROR_WAIT_TIMEOUT
+    constexpr size_t MaxHitches = 10;
+
+    struct Summary
+    {
+        size_t count;
+        double mean;
+        double deviation;
+        double p50;
+        double p99;
+        double max;
+    };
+
+    Summary Summarise(std::vector<double> values)
+    {
+        Summary summary = {};
+        summary.count = values.size();
+        if (values.empty())
+        {
+            return summary;
+        }
+
+        double sum = 0.0;
+        for (const double value : values)
+        {
+            sum += value;
+        }
+
+        summary.mean = sum / static_cast<double>(values.size());
+
+        double squares = 0.0;
+        for (const double value : values)
+        {
+            squares += (value - summary.mean) * (value - summary.mean);
+        }
+
+        summary.deviation = std::sqrt(squares / static_cast<double>(values.size()));
+
+        std::sort(values.begin(), values.end());
+        const auto at = [&values](const double percentile)
+        {
+            return values[static_cast<size_t>(percentile / 100.0 * static_cast<double>(values.size() - 1) + 0.5)];
+        };
+
+        summary.p50 = at(50.0);
+        summary.p99 = at(99.0);
+        summary.max = values.back();
+        return summary;
+    }
+
+    void PrintSummary(const char* name, const char* unit, const Summary& summary)
+    {
+        if (summary.count == 0)
+        {
+            printf("  %-24s none\n", name);
+            return;
+        }
+
+        printf("  %-24s n %-6zu mean %8.3f  sd %8.3f  p50 %8.3f  p99 %8.3f  max %8.3f %s\n",
+            name, summary.count, summary.mean, summary.deviation, summary.p50, summary.p99, summary.max, unit);
+    }
+
+    const char* GetModeName(const uint32_t mode)
+    {
+        // MirrorMode
+        switch (mode)
+        {
+            case 0:
+                return "duplication";
+
+            case 1:
+                return "window";
+
+            case 2:
+                return "thumbnail";
+
+            default:
+                return "unknown";
+        }
+    }
+
+    const char* GetReasonName(const uint32_t reason)
+    {
+        // JournalDumpReason
+        switch (reason)
+        {
+            case 0:
+                return "exit";
+
+            case 1:
+                return "crash";
+
+            case 2:
+                return "hotkey";
+
+            default:
+                return "unknown";
+        }
+    }
+
+    void PrintRecord(const JournalRecord& record, const double ms)
+    {
+        const auto event = static_cast<JournalEvent>(record.event);
+        printf("%12.3f ms  frame %-7u %-8s", ms, record.frame, FrameJournal::GetEventName(event));
+
+        switch (event)
+        {
+            case JournalEvent::Acquire:
+                printf(" hr 0x%08x  accumulated %u", static_cast<uint32_t>(record.result), record.count);
+                if (record.value >= 0.0f)
+                {
+                    printf("  dirty %.1f%%", record.value);
+                }
+                break;
+
+            case JournalEvent::Render:
+                printf(" cpu %.1f us  %u calls", record.value, record.count);
+                break;
+
+            case JournalEvent::Present:
+                if ((record.flags & JournalUnchanged) != 0)
+                {
+                    printf(" unchanged, not presented");
+                }
+                else
+                {
+                    printf(" hr 0x%08x  area %.1f%%%s", static_cast<uint32_t>(record.result), record.value,
+                        (record.flags & JournalPartial) != 0 ? "  partial" : "");
+                }
+                break;
+
+            case JournalEvent::GpuFrame:
+                printf(" copy %.3f ms  draw %.3f ms", record.value, record.value2);
+                break;
+
+            case JournalEvent::Restart:
+                if (record.result == 0)
+                {
+                    printf(" for a full frame");
+                }
+                else
+                {
+                    printf(" after hr 0x%08x", static_cast<uint32_t>(record.result));
+                }
+                break;
+
+            case JournalEvent::Mode:
+                printf(" %s", GetModeName(record.count));
+                break;
+
+            case JournalEvent::Dump:
+                printf(" %s", GetReasonName(record.count));
+                break;
+
+            case JournalEvent::Count:
+            default:
+                break;
+        }
+
+        printf("\n");
+    }
+
+    void PrintStatistics(const JournalHeader& header, const std::vector<JournalRecord>& records)
+    {
+        const double msPerTick = 1000.0 / static_cast<double>(header.ticksPerSecond);
+
+        std::vector<double> acquireIntervals;
+        std::vector<double> presentIntervals;
+        std::vector<double> latencies;
+        std::vector<double> renderCpu;
+        std::vector<double> renderCalls;
+        std::vector<double> gpuCopy;
+        std::vector<double> gpuDraw;
+        std::vector<std::pair<double, double>> hitches;    // interval, at
+        std::map<uint32_t, int64_t> acquiredAt;            // frame to time of its acquire
+
+        uint64_t accumulated = 0;
+        size_t framesWithSkips = 0;
+        size_t partialPresents = 0;
+        size_t unchanged = 0;
+        size_t failedPresents = 0;
+        size_t restarts = 0;
+
+        int64_t lastAcquire = -1;
+        int64_t lastPresent = -1;
+        const int64_t origin = records.front().time;
+
+        for (const JournalRecord& record : records)
+        {
+            switch (static_cast<JournalEvent>(record.event))
+            {
+                case JournalEvent::Acquire:
+                    if (record.result != 0)
+                    {
+                        break;
+                    }
+
+                    accumulated += record.count;
+                    framesWithSkips += record.count > 1 ? 1 : 0;
+                    if (lastAcquire >= 0)
+                    {
+                        acquireIntervals.push_back(static_cast<double>(record.time - lastAcquire) * msPerTick);
+                    }
+
+                    lastAcquire = record.time;
+                    acquiredAt[record.frame] = record.time;
+                    break;
+
+                case JournalEvent::Present:
+                    if ((record.flags & JournalUnchanged) != 0)
+                    {
+                        ++unchanged;
+                        break;
+                    }
+
+                    if (record.result < 0)
+                    {
+                        ++failedPresents;
+                        break;
+                    }
+
+                    partialPresents += (record.flags & JournalPartial) != 0 ? 1 : 0;
+                    if (lastPresent >= 0)
+                    {
+                        const double interval = static_cast<double>(record.time - lastPresent) * msPerTick;
+                        presentIntervals.push_back(interval);
+                        hitches.emplace_back(interval, static_cast<double>(record.time - origin) * msPerTick);
+                    }
+
+                    lastPresent = record.time;
+                    {
+                        // Only the first present of each frame; the rest are pointer moves
+                        const auto acquire = acquiredAt.find(record.frame);
+                        if (acquire != acquiredAt.end())
+                        {
+                            latencies.push_back(static_cast<double>(record.time - acquire->second) * msPerTick);
+                            acquiredAt.erase(acquire);
+                        }
+                    }
+                    break;
+
+                case JournalEvent::Render:
+                    renderCpu.push_back(record.value);
+                    renderCalls.push_back(record.count);
+                    break;
+
+                case JournalEvent::GpuFrame:
+                    gpuCopy.push_back(record.value);
+                    gpuDraw.push_back(record.value2);
+                    break;
+
+                case JournalEvent::Restart:
+                    ++restarts;
+                    break;
+
+                case JournalEvent::Mode:
+                case JournalEvent::Dump:
+                case JournalEvent::Count:
+                default:
+                    break;
+            }
+        }
+
+        const double span = static_cast<double>(records.back().time - origin) * msPerTick;
+        printf("\n%zu records over %.3f s (%llu written, ring of %u)\n",
+            records.size(), span / 1000.0, static_cast<unsigned long long>(header.written), header.capacity);
+
+        printf("  desktop frames %llu, %zu acquires with frames accumulated between them\n",
+            static_cast<unsigned long long>(accumulated), framesWithSkips);
+        printf("  presents %zu (%zu partial, %zu failed), %zu frames unchanged, %zu duplication restarts\n\n",
+            presentIntervals.size() + (lastPresent >= 0 ? 1 : 0), partialPresents, failedPresents, unchanged, restarts);
+
+        const Summary presents = Summarise(presentIntervals);
+        PrintSummary("acquire interval", "ms", Summarise(acquireIntervals));
+        PrintSummary("present interval", "ms", presents);
+        PrintSummary("acquire to present", "ms", Summarise(latencies));
+        PrintSummary("render cpu", "us", Summarise(renderCpu));
+        PrintSummary("render calls", "", Summarise(renderCalls));
+        PrintSummary("gpu copy", "ms", Summarise(gpuCopy));
+        PrintSummary("gpu draw", "ms", Summarise(gpuDraw));
+
+        // Presents that came more than twice as late as usual
+        std::sort(hitches.begin(), hitches.end(), [](const std::pair<double, double>& a, const std::pair<double, double>& b)
+        {
+            return a.first > b.first;
+        });
+
+        printf("\nhitches (present interval over twice the median):\n");
+        size_t shown = 0;
+        for (const auto& hitch : hitches)
+        {
+            if (shown == MaxHitches || hitch.first <= 2.0 * presents.p50)
+            {
+                break;
+            }
+
+            printf("  %10.3f ms at %12.3f ms\n", hitch.first, hitch.second);
+            ++shown;
+        }
+
+        if (shown == 0)
+        {
+            printf("  none\n");
+        }
+    }
+}
+
+int main(const int argc, char* argv[])
+{
+    const char* path = nullptr;
+    bool summaryOnly = false;
+    size_t last = 0;
+
+    for (int n = 1; n < argc; ++n)
+    {
+        if (strcmp(argv[n], "--summary") == 0)
+        {
+            summaryOnly = true;
+        }
+        else if (strcmp(argv[n], "--last") == 0 && n + 1 < argc)
+        {
+            last = strtoul(argv[++n], nullptr, 10);
+        }
+        else
+        {
+            path = argv[n];
+        }
+    }
+
+    if (!path)
+    {
+        fprintf(stderr, "usage: %s <journal> [--summary] [--last <records>]\n", argv[0]);
+        return 2;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    const std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    JournalHeader header;
+    std::vector<JournalRecord> records;
+    if (!FrameJournal::Parse(data.data(), data.size(), header, records))
+    {
+        fprintf(stderr, "%s isn't a frame journal\n", path);
+        return 1;
+    }
+
+    if (records.empty())
+    {
+        printf("no records\n");
+        return 0;
+    }
+
+    if (!summaryOnly)
+    {
+        const double msPerTick = 1000.0 / static_cast<double>(header.ticksPerSecond);
+        const size_t first = last > 0 && last < records.size() ? records.size() - last : 0;
+        for (size_t n = first; n < records.size(); ++n)
+        {
+            PrintRecord(records[n], static_cast<double>(records[n].time - records.front().time) * msPerTick);
+        }
+    }
+
+    PrintStatistics(header, records);
+    return 0;
+}
@@ -0,0 +1,314 @@
+// Checks the glass-to-glass latency pattern (see LatencyPattern.h) on synthetic frames.
+// The pattern is drawn, then scaled, blurred, offset and reduced in contrast the way a
+// capture of it might be, and each decoded stamp is checked. Misreads are also checked:
+// low contrast, a flipped bit, a pattern caught half way through being redrawn, and
+// strips that don't fit the image must all be rejected. Portable, e.g.
+//
+//     g++ -std=c++17 -O2 -I OnlyMMirror -o LatencyPatternTest OnlyMMirror/Tools/LatencyPatternTest.cpp OnlyMMirror/LatencyPattern.cpp
+//     ./LatencyPatternTest
+
+#include "LatencyPattern.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    constexpr int DrawnCellSize = 12;
+
+    int failures = 0;
+
+    void Check(const bool condition, const char* what, const double detail = 0.0)
+    {
+        if (!condition)
+        {
+            printf("FAILED: %s (%g)\n", what, detail);
+            ++failures;
+        }
+    }
+
+    struct Image
+    {
+        int width;
+        int height;
+        std::vector<uint8_t> luma;
+
+        uint8_t& At(const int x, const int y) { return luma[static_cast<size_t>(y) * width + x]; }
+        uint8_t At(const int x, const int y) const { return luma[static_cast<size_t>(y) * width + x]; }
+    };
+
+    // The pattern as LatencyPatternWindow draws it, on a mid-grey desktop
+    Image Draw(const uint32_t stamp, const PixelRect& rect, const int width, const int height,
+        const uint8_t light = 255, const uint8_t dark = 0)
+    {
+        bool cells[LatencyPattern::CellCount];
+        LatencyPattern::Encode(stamp, cells);
+
+        Image image = { width, height, std::vector<uint8_t>(static_cast<size_t>(width) * height, 128) };
+        const int cellWidth = (rect.right - rect.left) / LatencyPattern::CellCount;
+        for (int y = rect.top; y < rect.bottom; ++y)
+        {
+            for (int x = rect.left; x < rect.right; ++x)
+            {
+                const int cell = (std::min)((x - rect.left) / cellWidth, LatencyPattern::CellCount - 1);
+                image.At(x, y) = cells[cell] ? light : dark;
+            }
+        }
+
+        return image;
+    }
+
+    // Bilinear resample by scale, as the capture or a downscaled mirror would
+    Image Scale(const Image& source, const double scale)
+    {
+        Image image = {
+            static_cast<int>(source.width * scale), static_cast<int>(source.height * scale), std::vector<uint8_t>() };
+        image.luma.resize(static_cast<size_t>(image.width) * image.height);
+
+        for (int y = 0; y < image.height; ++y)
+        {
+            for (int x = 0; x < image.width; ++x)
+            {
+                const double sx = (std::min)((x + 0.5) / scale - 0.5, source.width - 1.0);
+                const double sy = (std::min)((y + 0.5) / scale - 0.5, source.height - 1.0);
+                const int x0 = (std::max)(0, static_cast<int>(std::floor(sx)));
+                const int y0 = (std::max)(0, static_cast<int>(std::floor(sy)));
+                const int x1 = (std::min)(x0 + 1, source.width - 1);
+                const int y1 = (std::min)(y0 + 1, source.height - 1);
+                const double fx = (std::max)(0.0, sx - x0);
+                const double fy = (std::max)(0.0, sy - y0);
+
+                const double top = source.At(x0, y0) * (1.0 - fx) + source.At(x1, y0) * fx;
+                const double bottom = source.At(x0, y1) * (1.0 - fx) + source.At(x1, y1) * fx;
+                image.At(x, y) = static_cast<uint8_t>(top * (1.0 - fy) + bottom * fy + 0.5);
+            }
+        }
+
+        return image;
+    }
+
+    // Box blur of the given radius
+    Image Blur(const Image& source, const int radius)
+    {
+        Image image = source;
+        for (int y = 0; y < source.height; ++y)
+        {
+            for (int x = 0; x < source.width; ++x)
+            {
+                int sum = 0;
+                int count = 0;
+                for (int dy = -radius; dy <= radius; ++dy)
+                {
+                    for (int dx = -radius; dx <= radius; ++dx)
+                    {
+                        const int sx = x + dx;
+                        const int sy = y + dy;
+                        if (sx >= 0 && sy >= 0 && sx < source.width && sy < source.height)
+                        {
+                            sum += source.At(sx, sy);
+                            ++count;
+                        }
+                    }
+                }
+
+                image.At(x, y) = static_cast<uint8_t>(sum / count);
+            }
+        }
+
+        return image;
+    }
+
+    PixelRect ScaleRect(const PixelRect& rect, const double scale)
+    {
+        return {
+            static_cast<int>(std::lround(rect.left * scale)), static_cast<int>(std::lround(rect.top * scale)),
+            static_cast<int>(std::lround(rect.right * scale)), static_cast<int>(std::lround(rect.bottom * scale)) };
+    }
+
+    // The cells left of split from after, the rest from before
+    Image Tear(const Image& before, const Image& after, const PixelRect& rect, const int split)
+    {
+        Image torn = before;
+        for (int y = rect.top; y < rect.bottom; ++y)
+        {
+            for (int x = rect.left; x < rect.left + split * DrawnCellSize; ++x)
+            {
+                torn.At(x, y) = after.At(x, y);
+            }
+        }
+
+        return torn;
+    }
+
+    bool Decode(const Image& image, const PixelRect& rect, uint32_t& stamp)
+    {
+        return LatencyPattern::Decode(image.luma.data(), image.width, image.height, image.width, rect, stamp);
+    }
+
+    void TestStamps()
+    {
+        Check(LatencyPattern::ToStamp(0, 10000000) == 0, "stamp: zero");
+        Check(LatencyPattern::ToStamp(10000000, 10000000) == 10000, "stamp: one second");
+        Check(LatencyPattern::ToStamp(15000, 10000000) == 15, "stamp: 1.5 ms");
+        Check(LatencyPattern::ToStamp(100, 0) == 0, "stamp: no frequency");
+
+        // Four days of a 10 MHz counter doesn't overflow the multiplication
+        const int64_t fourDays = 4LL * 24 * 3600 * 10000000;
+        Check(LatencyPattern::ToStamp(fourDays, 10000000) == 4u * 24 * 3600 * 10000, "stamp: four days");
+
+        Check(std::fabs(LatencyPattern::GetElapsedMs(1000, 1250) - 25.0) < 1e-9, "elapsed: 25 ms");
+        Check(std::fabs(LatencyPattern::GetElapsedMs(0xfffffff0u, 0x10u) - 3.2) < 1e-9, "elapsed: across the wrap");
+        Check(LatencyPattern::GetElapsedMs(1250, 1000) < 0.0, "elapsed: a stamp from the future is negative");
+    }
+
+    void TestScaled()
+    {
+        const uint32_t stamps[] = { 0u, 1u, 0x12345678u, 0xdeadbeefu, 0xffffffffu };
+        const double scales[] = { 1.0, 0.75, 0.5, 1.0 / 3.0, 1.25 };
+        const int blurs[] = { 0, 1, 2 };
+
+        // Cells of DrawnCellSize pixels, at an odd offset from the frame's corner
+        const PixelRect drawn = { 37, 21, 37 + LatencyPattern::CellCount * DrawnCellSize, 21 + DrawnCellSize * 2 };
+
+        for (const uint32_t expected : stamps)
+        {
+            const Image original = Draw(expected, drawn, drawn.right + 50, drawn.bottom + 30);
+            for (const double scale : scales)
+            {
+                const Image scaled = scale == 1.0 ? original : Scale(original, scale);
+                const PixelRect rect = ScaleRect(drawn, scale);
+                for (const int blur : blurs)
+                {
+                    // Blurring more than a quarter of a cell reaches the sampled middles
+                    if (blur * 4 > DrawnCellSize * scale)
+                    {
+                        continue;
+                    }
+
+                    uint32_t stamp = 0;
+                    const bool decoded = Decode(blur > 0 ? Blur(scaled, blur) : scaled, rect, stamp);
+                    Check(decoded, "scaled: decodes", scale);
+                    Check(!decoded || stamp == expected, "scaled: the right stamp", scale);
+                }
+            }
+        }
+    }
+
+    void TestOffset()
+    {
+        // The rect the reader is given is off by a pixel or two from where the pattern landed
+        const uint32_t expected = 0x0badf00du;
+        const PixelRect drawn = { 40, 10, 40 + LatencyPattern::CellCount * DrawnCellSize, 10 + DrawnCellSize * 2 };
+        const Image image = Draw(expected, drawn, drawn.right + 40, drawn.bottom + 20);
+
+        for (int dx = -2; dx <= 2; ++dx)
+        {
+            for (int dy = -2; dy <= 2; ++dy)
+            {
+                const PixelRect rect = { drawn.left + dx, drawn.top + dy, drawn.right + dx, drawn.bottom + dy };
+                uint32_t stamp = 0;
+                Check(Decode(image, rect, stamp) && stamp == expected, "offset: decodes the right stamp", dx * 10 + dy);
+            }
+        }
+    }
+
+    void TestToneMapped()
+    {
+        // SDR white tone mapped down and black lifted, but still above MinContrast
+        const uint32_t expected = 0x600dcafeu;
+        const PixelRect drawn = { 0, 0, LatencyPattern::CellCount * DrawnCellSize, DrawnCellSize };
+        const Image image = Draw(expected, drawn, drawn.right, drawn.bottom, 190, 100);
+
+        uint32_t stamp = 0;
+        Check(Decode(image, drawn, stamp) && stamp == expected, "tone mapped: decodes the right stamp");
+    }
+
+    void TestMisreads()
+    {
+        const uint32_t expected = 0x13572468u;
+        const PixelRect drawn = { 8, 8, 8 + LatencyPattern::CellCount * DrawnCellSize, 8 + DrawnCellSize * 2 };
+        const int width = drawn.right + 8;
+        const int height = drawn.bottom + 8;
+        uint32_t stamp = 0;
+
+        // Too little contrast between the reference cells
+        const Image faint = Draw(expected, drawn, width, height, 140, 100);
+        Check(!Decode(faint, drawn, stamp), "misread: low contrast rejected");
+
+        // No pattern at all
+        const Image grey = { width, height, std::vector<uint8_t>(static_cast<size_t>(width) * height, 128) };
+        Check(!Decode(grey, drawn, stamp), "misread: no pattern rejected");
+
+        // One bit of the stamp flipped: the CRC no longer matches
+        for (int bit = 0; bit < LatencyPattern::StampBits; bit += 5)
+        {
+            const Image flipped = Draw(expected ^ (1u << bit), drawn, width, height);
+            Image corrupt = Draw(expected, drawn, width, height);
+
+            // Only the stamp's cells, leaving the original CRC
+            const int firstCell = 2 + (LatencyPattern::StampBits - 1 - bit) * 2;
+            for (int y = drawn.top; y < drawn.bottom; ++y)
+            {
+                for (int x = drawn.left + firstCell * DrawnCellSize; x < drawn.left + (firstCell + 2) * DrawnCellSize; ++x)
+                {
+                    corrupt.At(x, y) = flipped.At(x, y);
+                }
+            }
+
+            Check(!Decode(corrupt, drawn, stamp), "misread: flipped bit rejected", bit);
+        }
+
+        // Caught half way through being redrawn, the left of the strip new and the right old.
+        // A frame later only the low bits have changed, so a tear can read as either stamp,
+        // but never as anything else
+        const Image before = Draw(expected, drawn, width, height);
+        const Image nextFrame = Draw(expected + 167u, drawn, width, height);
+        for (int split = 2; split < LatencyPattern::CellCount; ++split)
+        {
+            const bool decoded = Decode(Tear(before, nextFrame, drawn, split), drawn, stamp);
+            Check(!decoded || stamp == expected || stamp == expected + 167u, "misread: torn read is one of the stamps", split);
+        }
+
+        // Where every bit has changed the CRC no longer matches either half
+        const Image inverted = Draw(~expected, drawn, width, height);
+        for (const int split : { 10, 20, 41, 62, 74 })
+        {
+            Check(!Decode(Tear(before, inverted, drawn, split), drawn, stamp), "misread: torn horizontally rejected", split);
+        }
+
+        // The top half new and the bottom half old: the changed pairs average out
+        Image torn = before;
+        for (int y = drawn.top; y < (drawn.top + drawn.bottom) / 2; ++y)
+        {
+            for (int x = drawn.left; x < drawn.right; ++x)
+            {
+                torn.At(x, y) = inverted.At(x, y);
+            }
+        }
+
+        Check(!Decode(torn, drawn, stamp), "misread: torn vertically rejected");
+
+        // Strips that don't fit the image, or are too small to have two pixels a cell
+        const Image good = Draw(expected, drawn, width, height);
+        Check(!Decode(good, { -1, drawn.top, drawn.right - 1, drawn.bottom }, stamp), "misread: off the left rejected");
+        Check(!Decode(good, { drawn.left, drawn.top, width + 1, drawn.bottom }, stamp), "misread: off the right rejected");
+        Check(!Decode(good, { drawn.left, drawn.top, drawn.left + LatencyPattern::CellCount * 2 - 1, drawn.bottom }, stamp),
+            "misread: too narrow rejected");
+        Check(!Decode(good, { drawn.left, drawn.top, drawn.right, drawn.top + 1 }, stamp), "misread: too short rejected");
+        Check(!LatencyPattern::Decode(nullptr, width, height, width, drawn, stamp), "misread: no image rejected");
+    }
+}
+
+int main()
+{
+    TestStamps();
+    TestScaled();
+    TestOffset();
+    TestToneMapped();
+    TestMisreads();
+
+    printf("%s\n", failures == 0 ? "all passed" : "some checks failed");
+    return failures == 0 ? 0 : 1;
+}
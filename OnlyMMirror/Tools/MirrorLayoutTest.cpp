@@ -0,0 +1,157 @@
+// Property test of MirrorLayout::Fit (see MirrorLayout.h) over random monitor and window
+// sizes, rotations and client origins. For each it checks that the fitted rect is never
+// empty, stays inside the client area, is centred, keeps the source's aspect ratio to
+// within a pixel, and fills the area along one axis unless it was snapped to an exact
+// integer downscale. The random sequence is seeded, so failures reproduce. Portable, e.g.
+//
+//     g++ -std=c++17 -O2 -I OnlyMMirror -o MirrorLayoutTest OnlyMMirror/Tools/MirrorLayoutTest.cpp OnlyMMirror/MirrorLayout.cpp OnlyMMirror/OutputRotation.cpp OnlyMMirror/ViewTransform.cpp
+//     ./MirrorLayoutTest [iterations]
+
+#include "MirrorLayout.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+namespace
+{
+    int failures = 0;
+
+    // Only the first few failures of each property are printed
+    void Check(const bool condition, const char* what, const int width, const int height, const PixelRect& area)
+    {
+        if (!condition)
+        {
+            if (++failures <= 20)
+            {
+                printf("FAILED: %s: %dx%d in (%d, %d, %d, %d)\n",
+                    what, width, height, area.left, area.top, area.right, area.bottom);
+            }
+        }
+    }
+
+    void CheckFit(const int width, const int height, const PixelRect& area)
+    {
+        const PixelRect fitted = MirrorLayout::Fit(width, height, area);
+        const int areaWidth = area.right - area.left;
+        const int areaHeight = area.bottom - area.top;
+        const int fittedWidth = fitted.right - fitted.left;
+        const int fittedHeight = fitted.bottom - fitted.top;
+
+        Check(fittedWidth >= 1 && fittedHeight >= 1, "empty or negative", width, height, area);
+        Check(ViewTransform::Contains(area, fitted), "outside the client area", width, height, area);
+
+        Check(std::abs((fitted.left - area.left) - (area.right - fitted.right)) <= 1 &&
+            std::abs((fitted.top - area.top) - (area.bottom - fitted.bottom)) <= 1,
+            "not centred", width, height, area);
+
+        // The dependent side is rounded, and may move another pixel to snap; a side that
+        // would round to nothing is kept at a pixel
+        const double heightError = std::fabs(static_cast<double>(fittedWidth) * height / width - fittedHeight);
+        const double widthError = std::fabs(static_cast<double>(fittedHeight) * width / height - fittedWidth);
+        const bool clamped = fittedWidth == 1 || fittedHeight == 1;
+        Check(clamped || (std::fmin)(heightError, widthError) <= 1.5, "aspect ratio not kept", width, height, area);
+
+        const bool snapped = MirrorLayout::GetBoxFilterFactor(width, height, fittedWidth, fittedHeight) > 1;
+        Check(snapped || fittedWidth == areaWidth || fittedHeight == areaHeight, "doesn't fill the area", width, height, area);
+
+        // Never larger than the fit scale allows, give or take the rounding
+        const double scale = MirrorLayout::GetFitScale(width, height, areaWidth, areaHeight);
+        Check(fittedWidth <= width * scale + 1.0 && fittedHeight <= height * scale + 1.0, "larger than the fit scale",
+            width, height, area);
+    }
+
+    void TestRandom(const int iterations)
+    {
+        std::mt19937 random(20240611);
+        std::uniform_int_distribution<int> monitorSize(1, 7680);
+        std::uniform_int_distribution<int> windowSize(1, 3840);
+        std::uniform_int_distribution<int> origin(-3840, 3840);
+        std::uniform_int_distribution<int> rotation(static_cast<int>(OutputRotation::Identity), static_cast<int>(OutputRotation::Rotate270));
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            // The window's client area may be anywhere on the virtual desktop
+            int width;
+            int height;
+            MirrorLayout::GetDisplayedSize(monitorSize(random), monitorSize(random),
+                static_cast<OutputRotation>(rotation(random)), width, height);
+
+            PixelRect area;
+            area.left = origin(random);
+            area.top = origin(random);
+            area.right = area.left + windowSize(random);
+            area.bottom = area.top + windowSize(random);
+
+            CheckFit(width, height, area);
+        }
+    }
+
+    void TestCommon()
+    {
+        // Real monitors in small, odd and exactly divisible windows
+        const int monitors[][2] = {
+            { 1920, 1080 }, { 1080, 1920 }, { 3840, 2160 }, { 2560, 1440 }, { 1280, 1024 },
+            { 1366, 768 }, { 3440, 1440 }, { 1024, 768 }, { 7680, 4320 }, { 2160, 3840 } };
+        const int windows[][2] = {
+            { 1, 1 }, { 1, 1000 }, { 1000, 1 }, { 2, 3 }, { 640, 360 }, { 961, 541 }, { 960, 540 },
+            { 1279, 719 }, { 800, 600 }, { 1920, 1080 }, { 1919, 1081 }, { 3840, 1080 } };
+
+        for (const auto& monitor : monitors)
+        {
+            for (const auto& window : windows)
+            {
+                CheckFit(monitor[0], monitor[1], { 0, 0, window[0], window[1] });
+                CheckFit(monitor[0], monitor[1], { -7, 13, window[0] - 7, window[1] + 13 });
+            }
+        }
+
+        // Extreme aspect ratios
+        CheckFit(7680, 1, { 0, 0, 100, 100 });
+        CheckFit(1, 7680, { 0, 0, 100, 100 });
+        CheckFit(1, 1, { 0, 0, 3840, 2160 });
+    }
+
+    void TestSnapped()
+    {
+        // Within a pixel of half size snaps to exactly half, so the box filter applies
+        const PixelRect half = MirrorLayout::Fit(1920, 1080, { 0, 0, 961, 541 });
+        Check(half.right - half.left == 960 && half.bottom - half.top == 540, "snapped to half", 1920, 1080, half);
+
+        const PixelRect third = MirrorLayout::Fit(3840, 2160, { 0, 0, 1281, 721 });
+        Check(third.right - third.left == 1280 && third.bottom - third.top == 720, "snapped to a third", 3840, 2160, third);
+
+        // Two pixels off is a plain fit
+        const PixelRect plain = MirrorLayout::Fit(1920, 1080, { 0, 0, 962, 1000 });
+        Check(plain.right - plain.left == 962, "not snapped", 1920, 1080, plain);
+    }
+
+    void TestEmpty()
+    {
+        // Nothing fits: a minimised window, or a source that hasn't arrived yet
+        const PixelRect cases[] = { { 0, 0, 0, 100 }, { 0, 0, 100, 0 }, { 10, 10, 5, 20 }, { 10, 10, 20, 5 } };
+        for (const PixelRect& area : cases)
+        {
+            Check(ViewTransform::IsEmpty(MirrorLayout::Fit(1920, 1080, area)), "empty area gives an empty rect", 1920, 1080, area);
+        }
+
+        const PixelRect area = { 0, 0, 800, 600 };
+        Check(ViewTransform::IsEmpty(MirrorLayout::Fit(0, 1080, area)), "no source width", 0, 1080, area);
+        Check(ViewTransform::IsEmpty(MirrorLayout::Fit(1920, -1, area)), "negative source height", 1920, -1, area);
+        Check(MirrorLayout::GetFitScale(1920, 1080, 0, 600) == 0.0, "no fit scale for an empty area", 1920, 1080, area);
+    }
+}
+
+int main(const int argc, char* argv[])
+{
+    const int iterations = argc > 1 ? atoi(argv[1]) : 1000000;
+
+    TestRandom(iterations);
+    TestCommon();
+    TestSnapped();
+    TestEmpty();
+
+    printf("%s\n", failures == 0 ? "all passed" : "some checks failed");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,240 @@
+// Checks RotationTransform (see OutputRotation.h) for each DXGI_MODE_ROTATION: dirty and
+// move rects round-trip between desktop and image coordinates, including odd output sizes
+// and rects on the edges; each pixel maps to the pixel the texture coordinates sample; and
+// a move's source and destination stay the same size and offset. Portable, e.g.
+//
+//     g++ -std=c++17 -O2 -I OnlyMMirror -o OutputRotationTest OnlyMMirror/Tools/OutputRotationTest.cpp OnlyMMirror/OutputRotation.cpp OnlyMMirror/ViewTransform.cpp
+//     ./OutputRotationTest
+
+#include "OutputRotation.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+    const OutputRotation Rotations[] = {
+        OutputRotation::Unspecified, OutputRotation::Identity, OutputRotation::Rotate90,
+        OutputRotation::Rotate180, OutputRotation::Rotate270 };
+
+    // Desktop sizes, including odd ones and a single pixel
+    const int Sizes[][2] = { { 1920, 1080 }, { 1080, 1920 }, { 1366, 768 }, { 17, 5 }, { 5, 17 }, { 7, 7 }, { 1, 1 } };
+
+    int failures = 0;
+
+    void Check(const bool condition, const char* what, const OutputRotation rotation, const int width, const int height)
+    {
+        if (!condition)
+        {
+            if (++failures <= 20)
+            {
+                printf("FAILED: %s, rotation %d, %dx%d\n", what, static_cast<int>(rotation), width, height);
+            }
+        }
+    }
+
+    bool SameRect(const PixelRect& a, const PixelRect& b)
+    {
+        return a.left == b.left && a.top == b.top && a.right == b.right && a.bottom == b.bottom;
+    }
+
+    int64_t Area(const PixelRect& rect)
+    {
+        return static_cast<int64_t>(rect.right - rect.left) * (rect.bottom - rect.top);
+    }
+
+    void GetImageSize(const int width, const int height, const OutputRotation rotation, int& imageWidth, int& imageHeight)
+    {
+        const bool swapAxes = RotationTransform::SwapsAxes(rotation);
+        imageWidth = swapAxes ? height : width;
+        imageHeight = swapAxes ? width : height;
+    }
+
+    // A rect in image coordinates, as the duplication reports it, checked both ways round
+    void CheckRect(const PixelRect& imageRect, const int width, const int height, const OutputRotation rotation)
+    {
+        int imageWidth;
+        int imageHeight;
+        GetImageSize(width, height, rotation, imageWidth, imageHeight);
+
+        const PixelRect desktopRect = RotationTransform::ImageToDesktop(imageRect, width, height, rotation);
+        const PixelRect image = { 0, 0, imageWidth, imageHeight };
+        const PixelRect desktop = { 0, 0, width, height };
+
+        Check(SameRect(RotationTransform::DesktopToImage(desktopRect, width, height, rotation), imageRect),
+            "image to desktop and back", rotation, width, height);
+        Check(SameRect(RotationTransform::ImageToDesktop(
+            RotationTransform::DesktopToImage(desktopRect, width, height, rotation), width, height, rotation), desktopRect),
+            "desktop to image and back", rotation, width, height);
+        Check(!ViewTransform::IsEmpty(desktopRect) && Area(desktopRect) == Area(imageRect), "same area", rotation, width, height);
+        Check(ViewTransform::Contains(desktop, desktopRect) == ViewTransform::Contains(image, imageRect),
+            "stays on the output", rotation, width, height);
+
+        if (RotationTransform::SwapsAxes(rotation))
+        {
+            Check(desktopRect.right - desktopRect.left == imageRect.bottom - imageRect.top &&
+                desktopRect.bottom - desktopRect.top == imageRect.right - imageRect.left, "sides swapped", rotation, width, height);
+        }
+    }
+
+    void TestRoundTrip()
+    {
+        for (const OutputRotation rotation : Rotations)
+        {
+            for (const auto& size : Sizes)
+            {
+                const int width = size[0];
+                const int height = size[1];
+                int imageWidth;
+                int imageHeight;
+                GetImageSize(width, height, rotation, imageWidth, imageHeight);
+
+                // The whole output, its corners and its edges
+                CheckRect({ 0, 0, imageWidth, imageHeight }, width, height, rotation);
+                CheckRect({ 0, 0, 1, 1 }, width, height, rotation);
+                CheckRect({ imageWidth - 1, 0, imageWidth, 1 }, width, height, rotation);
+                CheckRect({ 0, imageHeight - 1, 1, imageHeight }, width, height, rotation);
+                CheckRect({ imageWidth - 1, imageHeight - 1, imageWidth, imageHeight }, width, height, rotation);
+                CheckRect({ 0, 0, imageWidth, 1 }, width, height, rotation);
+                CheckRect({ 0, imageHeight - 1, imageWidth, imageHeight }, width, height, rotation);
+                CheckRect({ 0, 0, 1, imageHeight }, width, height, rotation);
+                CheckRect({ imageWidth - 1, 0, imageWidth, imageHeight }, width, height, rotation);
+
+                // Every rect of a small output, and a spread of them on larger ones
+                const int step = (std::max)(1, (std::max)(imageWidth, imageHeight) / 12);
+                for (int left = 0; left < imageWidth; left += step)
+                {
+                    for (int top = 0; top < imageHeight; top += step)
+                    {
+                        for (int right = left + 1; right <= imageWidth; right += step)
+                        {
+                            for (int bottom = top + 1; bottom <= imageHeight; bottom += step)
+                            {
+                                CheckRect({ left, top, right, bottom }, width, height, rotation);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void TestPixels()
+    {
+        // Each desktop pixel's rect maps to the image pixel the texture coordinates sample at
+        // its centre, so copies of dirty rects and the drawn quad agree
+        for (const OutputRotation rotation : Rotations)
+        {
+            for (const auto& size : Sizes)
+            {
+                const int width = size[0] > 64 ? 33 : size[0];
+                const int height = size[1] > 64 ? 21 : size[1];
+                int imageWidth;
+                int imageHeight;
+                GetImageSize(width, height, rotation, imageWidth, imageHeight);
+
+                for (int y = 0; y < height; ++y)
+                {
+                    for (int x = 0; x < width; ++x)
+                    {
+                        const PixelRect pixel = RotationTransform::DesktopToImage({ x, y, x + 1, y + 1 }, width, height, rotation);
+
+                        float u;
+                        float v;
+                        RotationTransform::DesktopToImage(
+                            (x + 0.5f) / static_cast<float>(width), (y + 0.5f) / static_cast<float>(height), rotation, u, v);
+                        const int sampledX = static_cast<int>(std::floor(u * static_cast<float>(imageWidth)));
+                        const int sampledY = static_cast<int>(std::floor(v * static_cast<float>(imageHeight)));
+
+                        Check(pixel.left == sampledX && pixel.top == sampledY, "pixel matches the texture coordinates",
+                            rotation, width, height);
+                    }
+                }
+            }
+        }
+    }
+
+    void TestCorners()
+    {
+        // The whole output: the desktop's top left vertex samples the image's corner that is
+        // shown there
+        const QuadMapping whole = { -1.0f, 1.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f };
+        const int width = 17;
+        const int height = 5;
+
+        for (const OutputRotation rotation : Rotations)
+        {
+            int imageWidth;
+            int imageHeight;
+            GetImageSize(width, height, rotation, imageWidth, imageHeight);
+
+            float texCoords[4][2];
+            RotationTransform::GetCornerTexCoords(whole, rotation, texCoords);
+
+            const PixelRect topLeft = RotationTransform::DesktopToImage({ 0, 0, 1, 1 }, width, height, rotation);
+            const float cornerU = texCoords[1][0] * static_cast<float>(imageWidth);
+            const float cornerV = texCoords[1][1] * static_cast<float>(imageHeight);
+            Check(std::fabs(cornerU - static_cast<float>(topLeft.left == 0 ? 0 : imageWidth)) < 1e-4f &&
+                std::fabs(cornerV - static_cast<float>(topLeft.top == 0 ? 0 : imageHeight)) < 1e-4f,
+                "top left vertex", rotation, width, height);
+
+            // The four corners are distinct corners of the texture
+            for (int n = 0; n < 4; ++n)
+            {
+                for (int m = n + 1; m < 4; ++m)
+                {
+                    Check(texCoords[n][0] != texCoords[m][0] || texCoords[n][1] != texCoords[m][1],
+                        "distinct corners", rotation, width, height);
+                }
+            }
+        }
+    }
+
+    void TestMoves()
+    {
+        // A move rect: the destination in image coordinates, and the source point it came from
+        const int width = 1366;
+        const int height = 767;
+        const PixelRect destination = { 101, 33, 301, 83 };
+        const int sourceX = 121;
+        const int sourceY = 0;
+
+        for (const OutputRotation rotation : Rotations)
+        {
+            const PixelRect source = {
+                sourceX, sourceY, sourceX + destination.right - destination.left, sourceY + destination.bottom - destination.top };
+
+            const PixelRect desktopSource = RotationTransform::ImageToDesktop(source, width, height, rotation);
+            const PixelRect desktopDestination = RotationTransform::ImageToDesktop(destination, width, height, rotation);
+
+            Check(desktopSource.right - desktopSource.left == desktopDestination.right - desktopDestination.left &&
+                desktopSource.bottom - desktopSource.top == desktopDestination.bottom - desktopDestination.top,
+                "move keeps its size", rotation, width, height);
+
+            // The offset is the image's offset rotated: its length along each axis is kept
+            const int imageDx = destination.left - source.left;
+            const int imageDy = destination.top - source.top;
+            const int desktopDx = desktopDestination.left - desktopSource.left;
+            const int desktopDy = desktopDestination.top - desktopSource.top;
+            const bool swapAxes = RotationTransform::SwapsAxes(rotation);
+            Check(std::abs(desktopDx) == std::abs(swapAxes ? imageDy : imageDx) &&
+                std::abs(desktopDy) == std::abs(swapAxes ? imageDx : imageDy), "move offset rotated", rotation, width, height);
+
+            Check(SameRect(RotationTransform::DesktopToImage(desktopSource, width, height, rotation), source) &&
+                SameRect(RotationTransform::DesktopToImage(desktopDestination, width, height, rotation), destination),
+                "move round trip", rotation, width, height);
+        }
+    }
+}
+
+int main()
+{
+    TestRoundTrip();
+    TestPixels();
+    TestCorners();
+    TestMoves();
+
+    printf("%s\n", failures == 0 ? "all passed" : "some checks failed");
+    return failures == 0 ? 0 : 1;
+}
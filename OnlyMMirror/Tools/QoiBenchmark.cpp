@@ -0,0 +1,225 @@
+// Measures snapshot encoding (see Qoi.h and SnapshotImage.h) on synthetic frames: encode
+// throughput and size with 1 to 8 threads, checked by decoding each result, and the cost
+// of converting the capture formats. Portable, e.g.
+//
+//     g++ -std=c++17 -O2 -pthread -I OnlyMMirror -o QoiBenchmark OnlyMMirror/Tools/QoiBenchmark.cpp OnlyMMirror/Qoi.cpp OnlyMMirror/SnapshotImage.cpp OnlyMMirror/ToneMap.cpp OnlyMMirror/FrameStatistics.cpp OnlyMMirror/OutputRotation.cpp OnlyMMirror/ViewTransform.cpp
+//     ./QoiBenchmark [--write <file.qoi>]
+
+#include "Qoi.h"
+#include "SnapshotImage.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <vector>
+
+namespace
+{
+    constexpr int Runs = 5;
+    constexpr unsigned ThreadCounts[] = { 1, 2, 4, 8 };
+
+    struct Frame
+    {
+        const char* name;
+        int width;
+        int height;
+        std::vector<uint8_t> rgba;
+    };
+
+    void Fill(Frame& frame, const int left, const int top, const int right, const int bottom, const uint8_t r, const uint8_t g, const uint8_t b)
+    {
+        for (int y = (std::max)(top, 0); y < (std::min)(bottom, frame.height); ++y)
+        {
+            for (int x = (std::max)(left, 0); x < (std::min)(right, frame.width); ++x)
+            {
+                uint8_t* pixel = frame.rgba.data() + (static_cast<size_t>(y) * frame.width + x) * 4;
+                pixel[0] = r;
+                pixel[1] = g;
+                pixel[2] = b;
+                pixel[3] = 255;
+            }
+        }
+    }
+
+    // Flat backgrounds, windows and lines of small glyph-like marks
+    Frame MakeDesktop(const int width, const int height)
+    {
+        Frame frame = { "desktop", width, height, std::vector<uint8_t>(static_cast<size_t>(width) * height * 4) };
+        std::mt19937 random(1);
+
+        Fill(frame, 0, 0, width, height, 0, 90, 160);
+        for (int window = 0; window < 6; ++window)
+        {
+            const int left = static_cast<int>(random() % (width / 2));
+            const int top = static_cast<int>(random() % (height / 2));
+            const int right = left + width / 3;
+            const int bottom = top + height / 3;
+            Fill(frame, left, top, right, bottom, 245, 245, 245);
+            Fill(frame, left, top, right, top + 30, 40, 40, 48);
+
+            for (int line = top + 40; line + 12 < bottom; line += 18)
+            {
+                for (int x = left + 8; x + 6 < right - 8; x += 7)
+                {
+                    if (random() % 5 != 0)
+                    {
+                        const int glyphHeight = 6 + static_cast<int>(random() % 6);
+                        Fill(frame, x, line + 12 - glyphHeight, x + 1 + static_cast<int>(random() % 4), line + 12, 20, 20, 20);
+                    }
+                }
+            }
+        }
+
+        return frame;
+    }
+
+    // Smooth gradients with sensor-like noise, the worst case for QOI
+    Frame MakePhoto(const int width, const int height)
+    {
+        Frame frame = { "photo", width, height, std::vector<uint8_t>(static_cast<size_t>(width) * height * 4) };
+        std::mt19937 random(2);
+
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                uint8_t* pixel = frame.rgba.data() + (static_cast<size_t>(y) * width + x) * 4;
+                const int noise = static_cast<int>(random() % 9) - 4;
+                pixel[0] = static_cast<uint8_t>((std::min)(255, (std::max)(0, x * 255 / width + noise)));
+                pixel[1] = static_cast<uint8_t>((std::min)(255, (std::max)(0, y * 255 / height + noise)));
+                pixel[2] = static_cast<uint8_t>((std::min)(255, (std::max)(0, 128 + (x - y) * 64 / width + noise)));
+                pixel[3] = 255;
+            }
+        }
+
+        return frame;
+    }
+
+    // A 4:3 slide pillarboxed on a 16:9 output
+    Frame MakeSlide(const int width, const int height)
+    {
+        Frame frame = MakePhoto(width, height);
+        frame.name = "slide";
+
+        const int border = (width - height * 4 / 3) / 2;
+        Fill(frame, 0, 0, border, height, 0, 0, 0);
+        Fill(frame, width - border, 0, width, height, 0, 0, 0);
+        Fill(frame, border + 60, 80, width - border - 60, 200, 255, 255, 255);
+        return frame;
+    }
+
+    double MeasureEncode(const Frame& frame, const unsigned threads, std::vector<uint8_t>& encoded)
+    {
+        double bestMs = 1.0e30;
+        for (int run = 0; run < Runs; ++run)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            Qoi::Encode(frame.rgba.data(), frame.width, frame.height, static_cast<size_t>(frame.width) * 4, threads, encoded);
+            const auto end = std::chrono::steady_clock::now();
+            bestMs = (std::min)(bestMs, std::chrono::duration<double, std::milli>(end - start).count());
+        }
+
+        return bestMs;
+    }
+
+    bool Verify(const Frame& frame, const std::vector<uint8_t>& encoded)
+    {
+        int width;
+        int height;
+        std::vector<uint8_t> decoded;
+        return Qoi::Decode(encoded.data(), encoded.size(), width, height, decoded) &&
+            width == frame.width && height == frame.height && decoded == frame.rgba;
+    }
+
+    void MeasureConvert(const int width, const int height)
+    {
+        const SnapshotFormat formats[] = { SnapshotFormat::Bgra8, SnapshotFormat::Rgb10a2, SnapshotFormat::Rgba16f };
+        const char* names[] = { "bgra8", "rgb10a2", "rgba16f" };
+        const ToneMapConstants toneMap = ToneMap::GetConstants({ ColourEncoding::LinearScRgb, 200.0f, 1000.0f });
+
+        std::vector<uint8_t> rgba(static_cast<size_t>(width) * height * 4);
+        for (int n = 0; n < 3; ++n)
+        {
+            const size_t pitch = static_cast<size_t>(width) * SnapshotImage::GetBytesPerPixel(formats[n]);
+            std::vector<uint8_t> pixels(pitch * height);
+            std::mt19937 random(3);
+            for (uint8_t& byte : pixels)
+            {
+                byte = static_cast<uint8_t>(random() % 64);
+            }
+
+            for (const OutputRotation rotation : { OutputRotation::Identity, OutputRotation::Rotate90 })
+            {
+                double bestMs = 1.0e30;
+                for (int run = 0; run < Runs; ++run)
+                {
+                    const auto start = std::chrono::steady_clock::now();
+                    SnapshotImage::Convert(
+                        pixels.data(), pitch, width, height, formats[n], rotation, toneMap, 0, height, rgba.data());
+                    const auto end = std::chrono::steady_clock::now();
+                    bestMs = (std::min)(bestMs, std::chrono::duration<double, std::milli>(end - start).count());
+                }
+
+                printf("convert %-8s %dx%d %-9s %8.2f ms (1 thread)\n", names[n], width, height,
+                    rotation == OutputRotation::Identity ? "upright" : "rotated", bestMs);
+            }
+        }
+    }
+}
+
+int main(const int argc, char* argv[])
+{
+    const char* writePath = nullptr;
+    for (int n = 1; n < argc; ++n)
+    {
+        if (strcmp(argv[n], "--write") == 0 && n + 1 < argc)
+        {
+            writePath = argv[++n];
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--write <file.qoi>]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    bool verified = true;
+    std::vector<uint8_t> encoded;
+
+    const int sizes[][2] = { { 1920, 1080 }, { 3840, 2160 } };
+    for (const auto& size : sizes)
+    {
+        const Frame frames[] = {
+            MakeDesktop(size[0], size[1]), MakePhoto(size[0], size[1]), MakeSlide(size[0], size[1]) };
+
+        for (const Frame& frame : frames)
+        {
+            const double megabytes = static_cast<double>(frame.rgba.size()) / (1024.0 * 1024.0);
+            for (const unsigned threads : ThreadCounts)
+            {
+                const double ms = MeasureEncode(frame, threads, encoded);
+                const bool valid = Verify(frame, encoded);
+                verified = verified && valid;
+
+                printf("encode  %-8s %dx%d %u thread%s %8.2f ms %8.0f MB/s  %5.1f%% of raw%s\n",
+                    frame.name, frame.width, frame.height, threads, threads == 1 ? " " : "s", ms, megabytes * 1000.0 / ms,
+                    100.0 * static_cast<double>(encoded.size()) / static_cast<double>(frame.width * frame.height * 3),
+                    valid ? "" : "  DECODE MISMATCH");
+            }
+        }
+
+        if (writePath && size[0] == 1920)
+        {
+            Qoi::Encode(frames[0].rgba.data(), frames[0].width, frames[0].height,
+                static_cast<size_t>(frames[0].width) * 4, 4, encoded);
+            std::ofstream(writePath, std::ios::binary).write(
+                reinterpret_cast<const char*>(encoded.data()), static_cast<std::streamsize>(encoded.size()));
+        }
+    }
+
+    MeasureConvert(3840, 2160);
+    return verified ? 0 : 1;
+}
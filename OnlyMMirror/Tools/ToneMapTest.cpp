@@ -0,0 +1,234 @@
+// Checks the CPU reference of the mirror's tone mapping (see ToneMap.h) against known
+// values: the sRGB and PQ transfer functions, scRGB and HDR10 pixels at and around SDR
+// white, SDR content passing through unchanged, the roll-off up to the monitor's peak and
+// clipping beyond it. Portable, e.g.
+//
+//     g++ -std=c++17 -O2 -I OnlyMMirror -o ToneMapTest OnlyMMirror/Tools/ToneMapTest.cpp OnlyMMirror/ToneMap.cpp
+//     ./ToneMapTest
+
+#include "ToneMap.h"
+
+#include <cmath>
+#include <cstdio>
+#include <initializer_list>
+
+namespace
+{
+    int failures = 0;
+
+    void Check(const bool condition, const char* what, const double value = 0.0)
+    {
+        if (!condition)
+        {
+            printf("FAILED: %s (%g)\n", what, value);
+            ++failures;
+        }
+    }
+
+    bool Near(const double value, const double expected, const double tolerance)
+    {
+        return std::fabs(value - expected) <= tolerance;
+    }
+
+    // The SMPTE ST 2084 encoding, the inverse of ToneMap::PqToNits, in double precision
+    double NitsToPq(const double nits)
+    {
+        const double m1 = 2610.0 / 16384.0;
+        const double m2 = 2523.0 / 4096.0 * 128.0;
+        const double c1 = 3424.0 / 4096.0;
+        const double c2 = 2413.0 / 4096.0 * 32.0;
+        const double c3 = 2392.0 / 4096.0 * 32.0;
+
+        const double y = std::pow(nits / 10000.0, m1);
+        return std::pow((c1 + c2 * y) / (1.0 + c3 * y), m2);
+    }
+
+    // As the swap chain stores it
+    int To8Bit(const float value)
+    {
+        return static_cast<int>(std::lround(value * 255.0f));
+    }
+
+    void ApplyGrey(const ToneMapConstants& constants, const float value, float result[3])
+    {
+        const float source[3] = { value, value, value };
+        ToneMap::Apply(constants, source, result);
+    }
+
+    bool IsGrey(const float result[3])
+    {
+        return Near(result[0], result[1], 2e-3) && Near(result[1], result[2], 2e-3);
+    }
+
+    void TestTransfers()
+    {
+        // sRGB anchors: mid grey, black and white, and the linear toe
+        Check(Near(ToneMap::SrgbToLinear(0.5f), 0.21404, 1e-4), "sRGB 0.5 decodes to 0.214");
+        Check(Near(ToneMap::LinearToSrgb(0.21404f), 0.5, 1e-4), "0.214 encodes to sRGB 0.5");
+        Check(ToneMap::LinearToSrgb(0.0f) == 0.0f && Near(ToneMap::LinearToSrgb(1.0f), 1.0, 1e-6), "sRGB black and white");
+        Check(Near(ToneMap::LinearToSrgb(0.002f), 0.002 * 12.92, 1e-7), "sRGB toe is linear");
+
+        for (int n = 0; n <= 255; ++n)
+        {
+            const float value = static_cast<float>(n) / 255.0f;
+            Check(To8Bit(ToneMap::LinearToSrgb(ToneMap::SrgbToLinear(value))) == n, "sRGB round trip", n);
+        }
+
+        // PQ anchors: the published code values for 100, 203 and 1000 nits, and the ends
+        Check(ToneMap::PqToNits(0.0f) < 1e-3f, "PQ 0 is black", ToneMap::PqToNits(0.0f));
+        Check(Near(ToneMap::PqToNits(1.0f), 10000.0, 1.0), "PQ 1 is 10000 nits", ToneMap::PqToNits(1.0f));
+        Check(Near(ToneMap::PqToNits(0.50808f), 100.0, 0.2), "PQ 0.508 is 100 nits", ToneMap::PqToNits(0.50808f));
+        Check(Near(ToneMap::PqToNits(0.58069f), 203.0, 0.3), "PQ 0.581 is 203 nits", ToneMap::PqToNits(0.58069f));
+        Check(Near(ToneMap::PqToNits(0.75183f), 1000.0, 1.0), "PQ 0.752 is 1000 nits", ToneMap::PqToNits(0.75183f));
+
+        // Everywhere in between, to a tenth of a percent
+        for (double nits = 0.1; nits <= 10000.0; nits *= 1.25)
+        {
+            const double decoded = ToneMap::PqToNits(static_cast<float>(NitsToPq(nits)));
+            Check(Near(decoded, nits, nits * 1e-3), "PQ round trip", nits);
+        }
+
+        // Out of range codes clip
+        Check(ToneMap::PqToNits(1.5f) == ToneMap::PqToNits(1.0f), "PQ above 1 clips");
+        Check(ToneMap::PqToNits(-0.5f) == ToneMap::PqToNits(0.0f), "PQ below 0 clips");
+    }
+
+    void TestCompress()
+    {
+        const float peak = 5.0f;
+        const float knee = ToneMap::Knee;
+
+        // Unchanged up to the knee, the peak lands on white, and beyond it stays there
+        Check(ToneMap::Compress(0.5f, peak, knee) == 0.5f, "compress: below the knee unchanged");
+        Check(ToneMap::Compress(knee, peak, knee) == knee, "compress: the knee unchanged");
+        Check(Near(ToneMap::Compress(peak, peak, knee), 1.0, 1e-6), "compress: peak is white");
+        Check(Near(ToneMap::Compress(peak * 4.0f, peak, knee), 1.0, 1e-6), "compress: above the peak clips");
+
+        // Monotonic, and the slope is continuous at the knee
+        float previous = 0.0f;
+        for (float x = 0.0f; x <= peak; x += 0.01f)
+        {
+            const float y = ToneMap::Compress(x, peak, knee);
+            Check(y >= previous && y <= 1.0f, "compress: monotonic", x);
+            previous = y;
+        }
+
+        const float slope = (ToneMap::Compress(knee + 1e-3f, peak, knee) - knee) / 1e-3f;
+        Check(Near(slope, 1.0, 0.01), "compress: slope 1 at the knee", slope);
+
+        // Without headroom there's nothing to compress, only clipping
+        Check(ToneMap::Compress(0.9f, 1.0f, knee) == 0.9f && ToneMap::Compress(1.5f, 1.0f, knee) == 1.0f,
+            "compress: no headroom clips");
+    }
+
+    void TestSdr()
+    {
+        // SDR desktops are shown as they are, only clipped
+        const ToneMapConstants constants = ToneMap::GetConstants({ ColourEncoding::Srgb, 0.0f, 0.0f });
+        const float source[3] = { 0.25f, 0.5f, 1.0f };
+        float result[3];
+        ToneMap::Apply(constants, source, result);
+        Check(result[0] == 0.25f && result[1] == 0.5f && result[2] == 1.0f, "SDR: passed through");
+
+        const float outside[3] = { -0.2f, 1.2f, 0.0f };
+        ToneMap::Apply(constants, outside, result);
+        Check(result[0] == 0.0f && result[1] == 1.0f && result[2] == 0.0f, "SDR: clipped");
+    }
+
+    void TestScRgb()
+    {
+        // SDR white at 200 nits on a 1000 nit monitor: 2.5 in scRGB's 80 nit units
+        const ToneMapConstants constants = ToneMap::GetConstants({ ColourEncoding::LinearScRgb, 200.0f, 1000.0f });
+        Check(Near(constants.scale, 0.4, 1e-6) && Near(constants.peak, 5.0, 1e-6), "scRGB: constants");
+
+        // SDR content, e.g. the desktop's mid grey, comes out as the same sRGB value
+        float result[3];
+        for (const float srgb : { 0.1f, 0.25f, 0.5f, 0.75f, 0.85f })
+        {
+            ApplyGrey(constants, ToneMap::SrgbToLinear(srgb) * 2.5f, result);
+            Check(To8Bit(result[0]) == To8Bit(srgb) && IsGrey(result), "scRGB: SDR content passed through", srgb);
+        }
+
+        // SDR white is rolled off a little to leave room for highlights up to the peak
+        ApplyGrey(constants, 2.5f, result);
+        const float white = ToneMap::LinearToSrgb(ToneMap::Compress(1.0f, 5.0f, ToneMap::Knee));
+        Check(Near(result[0], white, 1e-5) && result[0] < 1.0f && result[0] > 0.9f, "scRGB: SDR white", result[0]);
+
+        // The monitor's peak is white, and anything brighter clips
+        ApplyGrey(constants, 12.5f, result);
+        Check(To8Bit(result[0]) == 255 && IsGrey(result), "scRGB: peak is white", result[0]);
+        ApplyGrey(constants, 50.0f, result);
+        Check(To8Bit(result[0]) == 255 && IsGrey(result), "scRGB: above the peak clips", result[0]);
+
+        // A bright red keeps its hue: the other channels are scaled with it
+        const float red[3] = { 10.0f, 1.0f, 1.0f };
+        ToneMap::Apply(constants, red, result);
+        const float ratio = ToneMap::Compress(4.0f, 5.0f, ToneMap::Knee) / 4.0f;
+        Check(Near(result[1], ToneMap::LinearToSrgb(0.4f * ratio), 1e-5) && result[1] == result[2], "scRGB: hue kept", result[1]);
+
+        // Negative (out of gamut) values clip to black
+        const float negative[3] = { -1.0f, 0.5f, -0.01f };
+        ToneMap::Apply(constants, negative, result);
+        Check(result[0] == 0.0f && result[2] == 0.0f, "scRGB: negative clips");
+
+        // Without a known peak, or SDR white at 80 nits on an 80 nit monitor, 1.0 is white
+        const ToneMapConstants unknown = ToneMap::GetConstants({ ColourEncoding::LinearScRgb, 0.0f, 0.0f });
+        Check(Near(unknown.scale, 1.0, 1e-6) && unknown.peak == 1.0f, "scRGB: default constants");
+        ApplyGrey(unknown, 1.0f, result);
+        Check(To8Bit(result[0]) == 255, "scRGB: 1.0 is white without headroom", result[0]);
+        ApplyGrey(unknown, 0.21404f, result);
+        Check(Near(result[0], 0.5, 1e-4), "scRGB: mid grey without headroom", result[0]);
+    }
+
+    void TestHdr10()
+    {
+        // SDR white at 203 nits, the BT.2408 reference, on a 1000 nit monitor
+        const ToneMapConstants constants = ToneMap::GetConstants({ ColourEncoding::Pq2020, 203.0f, 1000.0f });
+        float result[3];
+
+        // Greys below the knee pass through: 100 nits is about half of SDR white
+        ApplyGrey(constants, static_cast<float>(NitsToPq(100.0)), result);
+        Check(Near(result[0], ToneMap::LinearToSrgb(100.0f / 203.0f), 2e-3) && IsGrey(result), "HDR10: 100 nits", result[0]);
+
+        ApplyGrey(constants, static_cast<float>(NitsToPq(203.0 * 0.5)), result);
+        Check(To8Bit(result[0]) == To8Bit(ToneMap::LinearToSrgb(0.5f)), "HDR10: half SDR white", result[0]);
+
+        // SDR white as with scRGB, the peak is white and beyond it clips
+        ApplyGrey(constants, static_cast<float>(NitsToPq(203.0)), result);
+        const float white = ToneMap::LinearToSrgb(ToneMap::Compress(1.0f, 1000.0f / 203.0f, ToneMap::Knee));
+        Check(Near(result[0], white, 2e-3) && IsGrey(result), "HDR10: SDR white", result[0]);
+        ApplyGrey(constants, static_cast<float>(NitsToPq(1000.0)), result);
+        Check(To8Bit(result[0]) == 255, "HDR10: peak is white", result[0]);
+        ApplyGrey(constants, 1.0f, result);
+        Check(To8Bit(result[0]) == 255 && IsGrey(result), "HDR10: 10000 nits clips", result[0]);
+        ApplyGrey(constants, 0.0f, result);
+        Check(To8Bit(result[0]) == 0, "HDR10: black", result[0]);
+
+        // BT.2020's red is outside BT.709: the other channels clip to 0
+        const float red[3] = { static_cast<float>(NitsToPq(100.0)), 0.0f, 0.0f };
+        ToneMap::Apply(constants, red, result);
+        Check(result[0] > 0.5f && result[1] == 0.0f && result[2] == 0.0f, "HDR10: BT.2020 red clips to BT.709");
+
+        // BT.709's green survives the round trip through BT.2020 primaries
+        const double green709[3] = { 0.3293, 0.9195, 0.0880 };  // 709 green (0, 1, 0) in 2020 primaries
+        const float green[3] = {
+            static_cast<float>(NitsToPq(green709[0] * 100.0)),
+            static_cast<float>(NitsToPq(green709[1] * 100.0)),
+            static_cast<float>(NitsToPq(green709[2] * 100.0)) };
+        ToneMap::Apply(constants, green, result);
+        Check(To8Bit(result[0]) <= 2 && To8Bit(result[2]) <= 2 &&
+            Near(result[1], ToneMap::LinearToSrgb(100.0f / 203.0f), 5e-3), "HDR10: BT.709 green kept", result[1]);
+    }
+}
+
+int main()
+{
+    TestTransfers();
+    TestCompress();
+    TestSdr();
+    TestScRgb();
+    TestHdr10();
+
+    printf("%s\n", failures == 0 ? "all passed" : "some checks failed");
+    return failures == 0 ? 0 : 1;
+}
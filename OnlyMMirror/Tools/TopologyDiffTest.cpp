@@ -0,0 +1,158 @@
+// Checks TopologyDiff (see TopologyDiff.h) against the display changes the mirror has to
+// follow: monitors added, removed, renumbered, moved and changed in resolution, and
+// lookups by id and by GDI device name. Portable, e.g.
+//
+//     g++ -std=c++17 -O2 -I OnlyMMirror -o TopologyDiffTest OnlyMMirror/Tools/TopologyDiffTest.cpp OnlyMMirror/TopologyDiff.cpp
+//     ./TopologyDiffTest
+
+#include "TopologyDiff.h"
+
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    int failures = 0;
+
+    void Check(const bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            printf("FAILED: %s\n", what);
+            ++failures;
+        }
+    }
+
+    bool Equals(const std::vector<std::string>& ids, const std::vector<std::string>& expected)
+    {
+        return ids == expected;
+    }
+
+    // Three monitors side by side: 1080p, 4K and 1080p, the first with a taskbar
+    std::vector<DisplayMonitor> MakeTopology()
+    {
+        return {
+            { "path-a", "\\\\.\\DISPLAY1", { 0, 0, 1920, 1080 }, { 0, 0, 1920, 1040 } },
+            { "path-b", "\\\\.\\DISPLAY2", { 1920, 0, 5760, 2160 }, { 1920, 0, 5760, 2160 } },
+            { "path-c", "\\\\.\\DISPLAY3", { 5760, 0, 7680, 1080 }, { 5760, 0, 7680, 1080 } } };
+    }
+
+    void TestUnchanged()
+    {
+        const TopologyChanges changes = TopologyDiff::Compare(MakeTopology(), MakeTopology());
+        Check(changes.IsEmpty(), "unchanged: no changes");
+        Check(!changes.Affects("path-a"), "unchanged: nothing affected");
+    }
+
+    void TestAdded()
+    {
+        std::vector<DisplayMonitor> after = MakeTopology();
+        after.push_back({ "path-d", "\\\\.\\DISPLAY4", { 7680, 0, 9600, 1080 }, { 7680, 0, 9600, 1080 } });
+
+        const TopologyChanges changes = TopologyDiff::Compare(MakeTopology(), after);
+        Check(Equals(changes.added, { "path-d" }), "added: the new monitor");
+        Check(changes.removed.empty() && changes.renamed.empty() && changes.moved.empty(), "added: nothing else");
+        Check(changes.Affects("path-d") && !changes.Affects("path-b"), "added: only the new monitor affected");
+    }
+
+    void TestRemoved()
+    {
+        std::vector<DisplayMonitor> after = MakeTopology();
+        after.erase(after.begin() + 1);
+
+        const TopologyChanges changes = TopologyDiff::Compare(MakeTopology(), after);
+        Check(Equals(changes.removed, { "path-b" }), "removed: the disconnected monitor");
+        Check(changes.added.empty() && changes.renamed.empty() && changes.moved.empty(), "removed: nothing else");
+        Check(changes.Affects("path-b") && !changes.Affects("path-c"), "removed: only that monitor affected");
+    }
+
+    void TestRenumbered()
+    {
+        // Reconnecting a monitor can swap the GDI names without anything moving
+        std::vector<DisplayMonitor> after = MakeTopology();
+        std::swap(after[1].deviceName, after[2].deviceName);
+
+        const TopologyChanges changes = TopologyDiff::Compare(MakeTopology(), after);
+        Check(Equals(changes.renamed, { "path-b", "path-c" }), "renumbered: both monitors renamed");
+        Check(changes.added.empty() && changes.removed.empty() && changes.moved.empty(), "renumbered: nothing else");
+
+        const DisplayMonitor* byName = TopologyDiff::FindByDeviceName(after, "\\\\.\\DISPLAY2");
+        Check(byName && byName->id == "path-c", "renumbered: the old name now finds the other monitor");
+
+        const DisplayMonitor* byId = TopologyDiff::FindById(after, "path-b");
+        Check(byId && byId->deviceName == "\\\\.\\DISPLAY3", "renumbered: the id still finds the same monitor");
+    }
+
+    void TestMoved()
+    {
+        std::vector<DisplayMonitor> after = MakeTopology();
+        after[2].bounds = { 5760, 1080, 7680, 2160 };
+        after[2].workArea = after[2].bounds;
+
+        const TopologyChanges changes = TopologyDiff::Compare(MakeTopology(), after);
+        Check(Equals(changes.moved, { "path-c" }), "moved: the rearranged monitor");
+        Check(changes.added.empty() && changes.removed.empty() && changes.renamed.empty(), "moved: nothing else");
+    }
+
+    void TestResolution()
+    {
+        // 4K to 1440p, and the 4K monitor rotated to portrait
+        std::vector<DisplayMonitor> after = MakeTopology();
+        after[1].bounds = { 1920, 0, 4480, 1440 };
+        after[1].workArea = after[1].bounds;
+
+        TopologyChanges changes = TopologyDiff::Compare(MakeTopology(), after);
+        Check(Equals(changes.moved, { "path-b" }), "resolution: the monitor counts as moved");
+
+        after = MakeTopology();
+        after[1].bounds = { 1920, 0, 4080, 3840 };
+        after[1].workArea = after[1].bounds;
+
+        changes = TopologyDiff::Compare(MakeTopology(), after);
+        Check(Equals(changes.moved, { "path-b" }), "rotation: the monitor counts as moved");
+    }
+
+    void TestWorkArea()
+    {
+        // The taskbar moving to another monitor changes work areas but not bounds
+        std::vector<DisplayMonitor> after = MakeTopology();
+        after[0].workArea = after[0].bounds;
+        after[2].workArea = { 5760, 0, 7680, 1040 };
+
+        const TopologyChanges changes = TopologyDiff::Compare(MakeTopology(), after);
+        Check(Equals(changes.moved, { "path-a", "path-c" }), "work area: both monitors count as moved");
+    }
+
+    void TestFind()
+    {
+        const std::vector<DisplayMonitor> monitors = MakeTopology();
+
+        const DisplayMonitor* byId = TopologyDiff::FindById(monitors, "path-c");
+        Check(byId == &monitors[2], "find: by id");
+        Check(!TopologyDiff::FindById(monitors, "path-x"), "find: unknown id");
+        Check(!TopologyDiff::FindById(monitors, ""), "find: empty id");
+
+        const DisplayMonitor* byName = TopologyDiff::FindByDeviceName(monitors, "\\\\.\\DISPLAY2");
+        Check(byName == &monitors[1], "find: by device name");
+        Check(!TopologyDiff::FindByDeviceName(monitors, "\\\\.\\DISPLAY9"), "find: unknown device name");
+        Check(!TopologyDiff::FindByDeviceName(monitors, "\\\\.\\display2"), "find: device names are matched exactly");
+        Check(!TopologyDiff::FindById(std::vector<DisplayMonitor>(), "path-a"), "find: no monitors");
+    }
+}
+
+int main()
+{
+    TestUnchanged();
+    TestAdded();
+    TestRemoved();
+    TestRenumbered();
+    TestMoved();
+    TestResolution();
+    TestWorkArea();
+    TestFind();
+
+    printf("%s\n", failures == 0 ? "all passed" : "some checks failed");
+    return failures == 0 ? 0 : 1;
+}
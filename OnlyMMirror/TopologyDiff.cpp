@@ -0,0 +1,80 @@
+#include "TopologyDiff.h"
+
+#include <algorithm>
+
+namespace
+{
+    bool IsSameRect(const PixelRect& a, const PixelRect& b)
+    {
+        return a.left == b.left && a.top == b.top && a.right == b.right && a.bottom == b.bottom;
+    }
+
+    bool Contains(const std::vector<std::string>& ids, const std::string& id)
+    {
+        return std::find(ids.begin(), ids.end(), id) != ids.end();
+    }
+}
+
+bool TopologyChanges::IsEmpty() const
+{
+    return added.empty() && removed.empty() && renamed.empty() && moved.empty();
+}
+
+bool TopologyChanges::Affects(const std::string& id) const
+{
+    return Contains(added, id) || Contains(removed, id) || Contains(renamed, id) || Contains(moved, id);
+}
+
+namespace TopologyDiff
+{
+    const DisplayMonitor* FindById(const std::vector<DisplayMonitor>& monitors, const std::string& id)
+    {
+        const auto found = std::find_if(monitors.begin(), monitors.end(),
+            [&id](const DisplayMonitor& monitor) { return monitor.id == id; });
+
+        return found == monitors.end() ? nullptr : &*found;
+    }
+
+    const DisplayMonitor* FindByDeviceName(const std::vector<DisplayMonitor>& monitors, const std::string& deviceName)
+    {
+        const auto found = std::find_if(monitors.begin(), monitors.end(),
+            [&deviceName](const DisplayMonitor& monitor) { return monitor.deviceName == deviceName; });
+
+        return found == monitors.end() ? nullptr : &*found;
+    }
+
+    TopologyChanges Compare(const std::vector<DisplayMonitor>& before, const std::vector<DisplayMonitor>& after)
+    {
+        TopologyChanges changes;
+
+        for (const DisplayMonitor& monitor : after)
+        {
+            const DisplayMonitor* previous = FindById(before, monitor.id);
+            if (!previous)
+            {
+                changes.added.push_back(monitor.id);
+                continue;
+            }
+
+            if (previous->deviceName != monitor.deviceName)
+            {
+                changes.renamed.push_back(monitor.id);
+            }
+
+            if (!IsSameRect(previous->bounds, monitor.bounds) || !IsSameRect(previous->workArea, monitor.workArea))
+            {
+                changes.moved.push_back(monitor.id);
+            }
+        }
+
+        for (const DisplayMonitor& monitor : before)
+        {
+            if (!FindById(after, monitor.id))
+            {
+                changes.removed.push_back(monitor.id);
+            }
+        }
+
+        return changes;
+    }
+}
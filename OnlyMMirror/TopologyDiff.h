@@ -0,0 +1,38 @@
+#pragma once
+
+// Portable comparison of two snapshots of the display topology. Monitors are matched by a
+// stable id (the monitor's device path), not by GDI device name: names like "\\.\DISPLAY2"
+// are handed out again when monitors are connected, disconnected or re-enumerated.
+
+#include <string>
+#include <vector>
+#include "ViewTransform.h"
+
+struct DisplayMonitor
+{
+    std::string id;             // stable across renumbering and reconnection
+    std::string deviceName;     // GDI device name, which can change
+    PixelRect bounds;           // in desktop coordinates
+    PixelRect workArea;         // bounds less the taskbar and docked toolbars
+};
+
+struct TopologyChanges
+{
+    std::vector<std::string> added;     // ids, in each case
+    std::vector<std::string> removed;
+    std::vector<std::string> renamed;   // same monitor, different device name
+    std::vector<std::string> moved;     // bounds or work area changed, e.g. resolution or rotation
+
+    bool IsEmpty() const;
+
+    // Whether the monitor with this id was added, removed, renamed or moved
+    bool Affects(const std::string& id) const;
+};
+
+namespace TopologyDiff
+{
+    const DisplayMonitor* FindById(const std::vector<DisplayMonitor>& monitors, const std::string& id);
+    const DisplayMonitor* FindByDeviceName(const std::vector<DisplayMonitor>& monitors, const std::string& deviceName);
+
+    TopologyChanges Compare(const std::vector<DisplayMonitor>& before, const std::vector<DisplayMonitor>& after);
+}
@@ -0,0 +1,158 @@
+#include "stdafx.h"
+#include "TopologyWatcher.h"
+#include <string>
+
+namespace
+{
+    PixelRect ToPixelRect(const RECT& rect)
+    {
+        return { rect.left, rect.top, rect.right, rect.bottom };
+    }
+
+    std::string ToUtf8(const WCHAR* text)
+    {
+        const int length = WideCharToMultiByte(CP_UTF8, 0, text, -1, nullptr, 0, nullptr, nullptr);
+        if (length <= 1)
+        {
+            return std::string();
+        }
+
+        std::string result(static_cast<size_t>(length - 1), '\0');
+        WideCharToMultiByte(CP_UTF8, 0, text, -1, &result[0], length, nullptr, nullptr);
+        return result;
+    }
+
+    BOOL CALLBACK AddMonitor(const HMONITOR monitor, HDC /*monitorDeviceContext*/, LPRECT /*monitorRect*/, const LPARAM data)
+    {
+        auto* monitors = reinterpret_cast<std::vector<DisplayMonitor>*>(data);  // NOLINT(performance-no-int-to-ptr)
+
+        MONITORINFOEX info{};
+        info.cbSize = sizeof(MONITORINFOEX);
+        if (GetMonitorInfo(monitor, &info))
+        {
+            DisplayMonitor displayMonitor;
+            displayMonitor.deviceName = info.szDevice;
+            displayMonitor.bounds = ToPixelRect(info.rcMonitor);
+            displayMonitor.workArea = ToPixelRect(info.rcWork);
+            monitors->push_back(displayMonitor);
+        }
+
+        return TRUE;
+    }
+
+    // The device path of the monitor shown by each GDI source, e.g. "\\.\DISPLAY2"
+    void AssignIds(std::vector<DisplayMonitor>& monitors)
+    {
+        UINT32 pathCount = 0;
+        UINT32 modeCount = 0;
+        if (GetDisplayConfigBufferSizes(QDC_ONLY_ACTIVE_PATHS, &pathCount, &modeCount) != ERROR_SUCCESS)
+        {
+            return;
+        }
+
+        std::vector<DISPLAYCONFIG_PATH_INFO> paths(pathCount);
+        std::vector<DISPLAYCONFIG_MODE_INFO> modes(modeCount);
+        if (QueryDisplayConfig(QDC_ONLY_ACTIVE_PATHS, &pathCount, paths.data(), &modeCount, modes.data(), nullptr) != ERROR_SUCCESS)
+        {
+            return;
+        }
+
+        for (UINT32 n = 0; n < pathCount; ++n)
+        {
+            DISPLAYCONFIG_SOURCE_DEVICE_NAME sourceName = {};
+            sourceName.header.type = DISPLAYCONFIG_DEVICE_INFO_GET_SOURCE_NAME;
+            sourceName.header.size = sizeof(sourceName);
+            sourceName.header.adapterId = paths[n].sourceInfo.adapterId;
+            sourceName.header.id = paths[n].sourceInfo.id;
+
+            DISPLAYCONFIG_TARGET_DEVICE_NAME targetName = {};
+            targetName.header.type = DISPLAYCONFIG_DEVICE_INFO_GET_TARGET_NAME;
+            targetName.header.size = sizeof(targetName);
+            targetName.header.adapterId = paths[n].targetInfo.adapterId;
+            targetName.header.id = paths[n].targetInfo.id;
+
+            if (DisplayConfigGetDeviceInfo(&sourceName.header) != ERROR_SUCCESS ||
+                DisplayConfigGetDeviceInfo(&targetName.header) != ERROR_SUCCESS)
+            {
+                continue;
+            }
+
+            const std::string deviceName = ToUtf8(sourceName.viewGdiDeviceName);
+            for (DisplayMonitor& monitor : monitors)
+            {
+                // A cloned source drives several monitors; the first one identifies it
+                if (monitor.id.empty() && monitor.deviceName == deviceName)
+                {
+                    monitor.id = ToUtf8(targetName.monitorDevicePath);
+                }
+            }
+        }
+    }
+}
+
+constexpr ULONGLONG TopologyWatcher::SettleMs;
+
+TopologyWatcher::TopologyWatcher()
+    : changeTime_(0)
+    , changePending_(false)
+{
+}
+
+bool TopologyWatcher::Start()
+{
+    changePending_ = false;
+    return Enumerate(monitors_);
+}
+
+void TopologyWatcher::OnDisplayChange()
+{
+    changeTime_ = GetTickCount64();
+    changePending_ = true;
+}
+
+bool TopologyWatcher::Poll(TopologyChanges& changes)
+{
+    if (!changePending_ || GetTickCount64() - changeTime_ < SettleMs)
+    {
+        return false;
+    }
+
+    changePending_ = false;
+
+    std::vector<DisplayMonitor> monitors;
+    if (!Enumerate(monitors))
+    {
+        return false;
+    }
+
+    changes = TopologyDiff::Compare(monitors_, monitors);
+    monitors_.swap(monitors);
+    return true;
+}
+
+const std::vector<DisplayMonitor>& TopologyWatcher::GetMonitors() const
+{
+    return monitors_;
+}
+
+bool TopologyWatcher::Enumerate(std::vector<DisplayMonitor>& monitors)
+{
+    monitors.clear();
+    if (!EnumDisplayMonitors(nullptr, nullptr, AddMonitor, reinterpret_cast<LPARAM>(&monitors)))
+    {
+        return false;
+    }
+
+    AssignIds(monitors);
+
+    // Without a device path (e.g. a remote session) the device name is all there is
+    for (DisplayMonitor& monitor : monitors)
+    {
+        if (monitor.id.empty())
+        {
+            monitor.id = monitor.deviceName;
+        }
+    }
+
+    return !monitors.empty();
+}
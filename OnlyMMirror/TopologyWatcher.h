@@ -0,0 +1,35 @@
+#pragma once
+#include <windows.h>
+#include <vector>
+#include "TopologyDiff.h"
+
+// Keeps a snapshot of the connected monitors, identified by their device paths from
+// QueryDisplayConfig, and reports what changed after a display change. WM_DISPLAYCHANGE
+// comes in bursts while Windows reconfigures, so a change is only reported once the
+// topology has been quiet for SettleMs.
+class TopologyWatcher  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+public:
+    TopologyWatcher();
+
+    // Takes the first snapshot
+    bool Start();
+
+    // Call on WM_DISPLAYCHANGE
+    void OnDisplayChange();
+
+    // Once a display change has settled, takes a new snapshot and returns true with what
+    // changed since the last one
+    bool Poll(TopologyChanges& changes);
+
+    const std::vector<DisplayMonitor>& GetMonitors() const;
+
+    static bool Enumerate(std::vector<DisplayMonitor>& monitors);
+
+    static constexpr ULONGLONG SettleMs = 500;
+
+private:
+    std::vector<DisplayMonitor> monitors_;
+    ULONGLONG changeTime_;
+    bool changePending_;
+};
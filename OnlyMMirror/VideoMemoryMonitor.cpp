@@ -0,0 +1,87 @@
+#include "stdafx.h"
+#include "VideoMemoryMonitor.h"
+
+VideoMemoryMonitor::VideoMemoryMonitor()
+    : adapter_(nullptr)
+    , budgetEvent_(nullptr)
+    , budgetCookie_(0)
+{
+}
+
+VideoMemoryMonitor::~VideoMemoryMonitor()
+{
+    Destroy();
+}
+
+bool VideoMemoryMonitor::Create(ID3D11Device* device)
+{
+    Destroy();
+
+    if (!device)
+    {
+        return false;
+    }
+
+    IDXGIDevice* dxgiDevice = nullptr;
+    if (FAILED(device->QueryInterface(__uuidof(IDXGIDevice), reinterpret_cast<void**>(&dxgiDevice))))  // NOLINT(clang-diagnostic-language-extension-token)
+    {
+        return false;
+    }
+
+    IDXGIAdapter* dxgiAdapter = nullptr;
+    HRESULT hr = dxgiDevice->GetAdapter(&dxgiAdapter);
+    dxgiDevice->Release();
+    if (FAILED(hr))
+    {
+        return false;
+    }
+
+    hr = dxgiAdapter->QueryInterface(__uuidof(IDXGIAdapter3), reinterpret_cast<void**>(&adapter_));  // NOLINT(clang-diagnostic-language-extension-token)
+    dxgiAdapter->Release();
+    if (FAILED(hr))
+    {
+        adapter_ = nullptr;
+        return false;
+    }
+
+    // Without the notification the budget is still picked up by the regular queries
+    budgetEvent_ = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (budgetEvent_ && FAILED(adapter_->RegisterVideoMemoryBudgetChangeNotificationEvent(budgetEvent_, &budgetCookie_)))
+    {
+        CloseHandle(budgetEvent_);
+        budgetEvent_ = nullptr;
+    }
+
+    return true;
+}
+
+void VideoMemoryMonitor::Destroy()
+{
+    if (adapter_ && budgetEvent_)
+    {
+        adapter_->UnregisterVideoMemoryBudgetChangeNotification(budgetCookie_);
+    }
+
+    if (budgetEvent_) { CloseHandle(budgetEvent_); budgetEvent_ = nullptr; }
+    if (adapter_) { adapter_->Release(); adapter_ = nullptr; }
+    budgetCookie_ = 0;
+}
+
+bool VideoMemoryMonitor::TakeBudgetChange()
+{
+    // Auto-reset, so a signal is only taken once
+    return budgetEvent_ && WaitForSingleObject(budgetEvent_, 0) == WAIT_OBJECT_0;
+}
+
+bool VideoMemoryMonitor::Query(uint64_t& usage, uint64_t& budget) const
+{
+    DXGI_QUERY_VIDEO_MEMORY_INFO info;
+    if (!adapter_ || FAILED(adapter_->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &info)))
+    {
+        return false;
+    }
+
+    usage = info.CurrentUsage;
+    budget = info.Budget;
+    return true;
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <d3d11.h>
+#include <dxgi1_4.h>
+#include <cstdint>
+
+// The render adapter's local video memory: what the process is using and the budget the
+// OS currently allows it, which shrinks when other applications need the memory. The OS
+// signals a change of budget; usage only changes with our own allocations, so between
+// changes it's enough to look about once a second. Needs IDXGIAdapter3 (Windows 10).
+class VideoMemoryMonitor  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+public:
+    VideoMemoryMonitor();
+    ~VideoMemoryMonitor();
+
+    // Returns false if the adapter can't report its budget; Query then always fails
+    bool Create(ID3D11Device* device);
+    void Destroy();
+
+    // Whether the OS has changed the budget since the last call
+    bool TakeBudgetChange();
+
+    // In bytes
+    bool Query(uint64_t& usage, uint64_t& budget) const;
+
+private:
+    IDXGIAdapter3* adapter_;
+    HANDLE budgetEvent_;
+    DWORD budgetCookie_;
+};
@@ -0,0 +1,206 @@
+#include "ViewTransform.h"
+
+#include <algorithm>
+#include <cmath>
+
+constexpr double ViewTransform::MaxZoom;
+
+ViewTransform::ViewTransform()
+    : source_()
+    , zoom_(1.0)
+    , centreX_(0.0)
+    , centreY_(0.0)
+{
+}
+
+void ViewTransform::SetSource(const PixelRect& source)
+{
+    if (source.left == source_.left && source.top == source_.top &&
+        source.right == source_.right && source.bottom == source_.bottom)
+    {
+        return;
+    }
+
+    source_ = source;
+    Reset();
+}
+
+const PixelRect& ViewTransform::GetSource() const
+{
+    return source_;
+}
+
+void ViewTransform::Reset()
+{
+    zoom_ = 1.0;
+    centreX_ = (source_.left + source_.right) / 2.0;
+    centreY_ = (source_.top + source_.bottom) / 2.0;
+}
+
+bool ViewTransform::Zoom(const double factor, const double fx, const double fy)
+{
+    if (factor <= 0.0)
+    {
+        return false;
+    }
+
+    const double newZoom = (std::min)(MaxZoom, (std::max)(1.0, zoom_ * factor));
+    if (newZoom == zoom_)
+    {
+        return false;
+    }
+
+    // The source point under (fx, fy) stays under it
+    const double pointX = centreX_ + (fx - 0.5) * ViewWidth();
+    const double pointY = centreY_ + (fy - 0.5) * ViewHeight();
+
+    zoom_ = newZoom;
+    centreX_ = pointX - (fx - 0.5) * ViewWidth();
+    centreY_ = pointY - (fy - 0.5) * ViewHeight();
+
+    Clamp();
+    return true;
+}
+
+bool ViewTransform::SetZoom(const double zoom)
+{
+    return Zoom(zoom / zoom_);
+}
+
+bool ViewTransform::Pan(const double dx, const double dy)
+{
+    const double oldX = centreX_;
+    const double oldY = centreY_;
+
+    centreX_ += dx * ViewWidth();
+    centreY_ += dy * ViewHeight();
+    Clamp();
+
+    return centreX_ != oldX || centreY_ != oldY;
+}
+
+double ViewTransform::GetZoom() const
+{
+    return zoom_;
+}
+
+PixelRect ViewTransform::GetRegion() const
+{
+    const double halfWidth = ViewWidth() / 2.0;
+    const double halfHeight = ViewHeight() / 2.0;
+
+    PixelRect region;
+    region.left = static_cast<int>(std::floor(centreX_ - halfWidth));
+    region.top = static_cast<int>(std::floor(centreY_ - halfHeight));
+    region.right = static_cast<int>(std::ceil(centreX_ + halfWidth));
+    region.bottom = static_cast<int>(std::ceil(centreY_ + halfHeight));
+
+    PixelRect clipped;
+    return Intersect(region, source_, clipped) ? clipped : region;
+}
+
+bool ViewTransform::Map(const PixelRect& content, QuadMapping& mapping) const
+{
+    const double viewWidth = ViewWidth();
+    const double viewHeight = ViewHeight();
+    const double contentWidth = content.right - content.left;
+    const double contentHeight = content.bottom - content.top;
+    if (viewWidth <= 0.0 || viewHeight <= 0.0 || contentWidth <= 0.0 || contentHeight <= 0.0)
+    {
+        return false;
+    }
+
+    const double viewLeft = centreX_ - viewWidth / 2.0;
+    const double viewTop = centreY_ - viewHeight / 2.0;
+
+    // The visible part of the content, in source coordinates
+    const double left = (std::max)(viewLeft, static_cast<double>(content.left));
+    const double top = (std::max)(viewTop, static_cast<double>(content.top));
+    const double right = (std::min)(viewLeft + viewWidth, static_cast<double>(content.right));
+    const double bottom = (std::min)(viewTop + viewHeight, static_cast<double>(content.bottom));
+    if (left >= right || top >= bottom)
+    {
+        return false;
+    }
+
+    mapping.left = static_cast<float>((left - viewLeft) / viewWidth * 2.0 - 1.0);
+    mapping.right = static_cast<float>((right - viewLeft) / viewWidth * 2.0 - 1.0);
+    mapping.top = static_cast<float>(1.0 - (top - viewTop) / viewHeight * 2.0);
+    mapping.bottom = static_cast<float>(1.0 - (bottom - viewTop) / viewHeight * 2.0);
+
+    mapping.u0 = static_cast<float>((left - content.left) / contentWidth);
+    mapping.u1 = static_cast<float>((right - content.left) / contentWidth);
+    mapping.v0 = static_cast<float>((top - content.top) / contentHeight);
+    mapping.v1 = static_cast<float>((bottom - content.top) / contentHeight);
+
+    return true;
+}
+
+bool ViewTransform::MapPoint(const double sourceX, const double sourceY, float& x, float& y) const
+{
+    const double viewWidth = ViewWidth();
+    const double viewHeight = ViewHeight();
+    if (viewWidth <= 0.0 || viewHeight <= 0.0)
+    {
+        return false;
+    }
+
+    const double fx = (sourceX - (centreX_ - viewWidth / 2.0)) / viewWidth;
+    const double fy = (sourceY - (centreY_ - viewHeight / 2.0)) / viewHeight;
+    if (fx < 0.0 || fx > 1.0 || fy < 0.0 || fy > 1.0)
+    {
+        return false;
+    }
+
+    x = static_cast<float>(fx * 2.0 - 1.0);
+    y = static_cast<float>(1.0 - fy * 2.0);
+    return true;
+}
+
+bool ViewTransform::Intersect(const PixelRect& a, const PixelRect& b, PixelRect& result)
+{
+    result.left = (std::max)(a.left, b.left);
+    result.top = (std::max)(a.top, b.top);
+    result.right = (std::min)(a.right, b.right);
+    result.bottom = (std::min)(a.bottom, b.bottom);
+
+    if (IsEmpty(result))
+    {
+        result = PixelRect();
+        return false;
+    }
+
+    return true;
+}
+
+bool ViewTransform::Contains(const PixelRect& outer, const PixelRect& inner)
+{
+    return !IsEmpty(inner) &&
+        inner.left >= outer.left && inner.top >= outer.top &&
+        inner.right <= outer.right && inner.bottom <= outer.bottom;
+}
+
+bool ViewTransform::IsEmpty(const PixelRect& rect)
+{
+    return rect.left >= rect.right || rect.top >= rect.bottom;
+}
+
+void ViewTransform::Clamp()
+{
+    // Keep the whole view inside the source
+    const double halfWidth = ViewWidth() / 2.0;
+    const double halfHeight = ViewHeight() / 2.0;
+
+    centreX_ = (std::min)(source_.right - halfWidth, (std::max)(source_.left + halfWidth, centreX_));
+    centreY_ = (std::min)(source_.bottom - halfHeight, (std::max)(source_.top + halfHeight, centreY_));
+}
+
+double ViewTransform::ViewWidth() const
+{
+    return (source_.right - source_.left) / zoom_;
+}
+
+double ViewTransform::ViewHeight() const
+{
+    return (source_.bottom - source_.top) / zoom_;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+// Portable region-of-interest maths for the mirror: which part of the source is in view
+// (zoom and pan), and how a captured area maps onto the mirror's quad.
+
+// Same layout as a Win32 RECT
+struct PixelRect
+{
+    int left;
+    int top;
+    int right;
+    int bottom;
+};
+
+// Normalised device coordinates of a quad and the texture coordinates at its corners
+struct QuadMapping
+{
+    float left;
+    float top;
+    float right;
+    float bottom;
+    float u0;
+    float v0;
+    float u1;
+    float v1;
+};
+
+class ViewTransform
+{
+public:
+    ViewTransform();
+
+    // The area that can be viewed, e.g. the target monitor in desktop coordinates.
+    // The view is reset if it changes.
+    void SetSource(const PixelRect& source);
+    const PixelRect& GetSource() const;
+
+    void Reset();
+
+    // Multiplies the zoom by factor, keeping the point at (fx, fy) - fractions of the
+    // view's width and height - where it is. Returns false if the view didn't change.
+    bool Zoom(double factor, double fx = 0.5, double fy = 0.5);
+
+    // Sets the zoom about the centre of the view
+    bool SetZoom(double zoom);
+
+    // Pans by fractions of the view's width and height
+    bool Pan(double dx, double dy);
+
+    double GetZoom() const;
+
+    // The part of the source in view, rounded outwards to whole pixels
+    PixelRect GetRegion() const;
+
+    // Maps content (the part of the source a texture covers) into the view, clipping it
+    // to the view. Returns false if none of it is visible.
+    bool Map(const PixelRect& content, QuadMapping& mapping) const;
+
+    // Maps a source point to normalised device coordinates. Returns false if it's out of view.
+    bool MapPoint(double sourceX, double sourceY, float& x, float& y) const;
+
+    static bool Intersect(const PixelRect& a, const PixelRect& b, PixelRect& result);
+    static bool Contains(const PixelRect& outer, const PixelRect& inner);
+    static bool IsEmpty(const PixelRect& rect);
+
+    static constexpr double MaxZoom = 16.0;
+
+private:
+    void Clamp();
+    double ViewWidth() const;
+    double ViewHeight() const;
+
+    PixelRect source_;
+    double zoom_;
+    double centreX_;
+    double centreY_;
+};
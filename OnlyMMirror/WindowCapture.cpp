@@ -0,0 +1,275 @@
+#include "stdafx.h"
+#include "WindowCapture.h"
+
+#include <mutex>
+#include <windows.graphics.capture.interop.h>
+#include <windows.graphics.directx.direct3d11.interop.h>
+#include <winrt/Windows.Foundation.h>
+#include <winrt/Windows.Foundation.Metadata.h>
+#include <winrt/Windows.Graphics.Capture.h>
+#include <winrt/Windows.Graphics.DirectX.Direct3D11.h>
+
+#pragma comment(lib, "windowsapp.lib")
+
+namespace
+{
+    namespace WinCapture = winrt::Windows::Graphics::Capture;
+    namespace WinDirectX = winrt::Windows::Graphics::DirectX;
+    using winrt::Windows::Foundation::Metadata::ApiInformation;
+
+    // One buffer can be held by the render thread while the next frame is composed into the other
+    constexpr int BufferCount = 2;
+    constexpr auto PixelFormat = WinDirectX::DirectXPixelFormat::B8G8R8A8UIntNormalized;
+}
+
+struct WindowCapture::Impl
+{
+    WinDirectX::Direct3D11::IDirect3DDevice device{ nullptr };
+    WinCapture::GraphicsCaptureItem item{ nullptr };
+    WinCapture::Direct3D11CaptureFramePool framePool{ nullptr };
+    WinCapture::GraphicsCaptureSession session{ nullptr };
+    winrt::Windows::Graphics::SizeInt32 poolSize{};
+
+    // Written by the frame pool's thread, read by the render thread
+    std::mutex lock;
+    WinCapture::Direct3D11CaptureFrame latestFrame{ nullptr };
+    UINT replacedFrames = 0;
+    bool stopped = false;
+
+    // Render thread only
+    WinCapture::Direct3D11CaptureFrame acquiredFrame{ nullptr };
+    ID3D11Texture2D* acquiredTexture = nullptr;
+
+    void OnFrameArrived(const WinCapture::Direct3D11CaptureFramePool& sender)
+    {
+        const std::lock_guard<std::mutex> guard(lock);
+        if (stopped)
+        {
+            return;
+        }
+
+        WinCapture::Direct3D11CaptureFrame frame = sender.TryGetNextFrame();
+        if (!frame)
+        {
+            return;
+        }
+
+        const winrt::Windows::Graphics::SizeInt32 contentSize = frame.ContentSize();
+        if (contentSize.Width != poolSize.Width || contentSize.Height != poolSize.Height)
+        {
+            // The window was resized; size the buffers for subsequent frames to match
+            poolSize = contentSize;
+            sender.Recreate(device, PixelFormat, BufferCount, poolSize);
+        }
+
+        if (latestFrame)
+        {
+            latestFrame.Close();
+            ++replacedFrames;
+        }
+
+        latestFrame = std::move(frame);
+    }
+};
+
+WindowCapture::WindowCapture()
+    : window_(nullptr)
+{
+}
+
+WindowCapture::~WindowCapture()
+{
+    Stop();
+}
+
+bool WindowCapture::IsSupported()
+{
+    try
+    {
+        return WinCapture::GraphicsCaptureSession::IsSupported();
+    }
+    catch (const winrt::hresult_error&)
+    {
+        return false;
+    }
+}
+
+bool WindowCapture::Start(ID3D11Device* device, const HWND window)
+{
+    Stop();
+
+    if (!device || !window)
+    {
+        return false;
+    }
+
+    // Nothing here initialises the apartment; C++/WinRT falls back to the implicit MTA
+    try
+    {
+        auto impl = std::make_shared<Impl>();
+
+        winrt::com_ptr<IDXGIDevice> dxgiDevice;
+        winrt::check_hresult(device->QueryInterface(__uuidof(IDXGIDevice), dxgiDevice.put_void()));  // NOLINT(clang-diagnostic-language-extension-token)
+
+        winrt::com_ptr<IInspectable> inspectable;
+        winrt::check_hresult(CreateDirect3D11DeviceFromDXGIDevice(dxgiDevice.get(), inspectable.put()));
+        impl->device = inspectable.as<WinDirectX::Direct3D11::IDirect3DDevice>();
+
+        const auto interop = winrt::get_activation_factory<WinCapture::GraphicsCaptureItem, IGraphicsCaptureItemInterop>();
+        winrt::check_hresult(interop->CreateForWindow(
+            window, winrt::guid_of<WinCapture::GraphicsCaptureItem>(), winrt::put_abi(impl->item)));
+
+        impl->poolSize = impl->item.Size();
+        impl->framePool = WinCapture::Direct3D11CaptureFramePool::CreateFreeThreaded(
+            impl->device, PixelFormat, BufferCount, impl->poolSize);
+
+        // A frame can still be arriving while Stop runs, so the handler holds a weak reference
+        const std::weak_ptr<Impl> weakImpl = impl;
+        impl->framePool.FrameArrived([weakImpl](const WinCapture::Direct3D11CaptureFramePool& sender, const winrt::Windows::Foundation::IInspectable&)
+        {
+            if (const std::shared_ptr<Impl> strongImpl = weakImpl.lock())
+            {
+                try
+                {
+                    strongImpl->OnFrameArrived(sender);
+                }
+                catch (const winrt::hresult_error&)
+                {
+                    // e.g. device removed; the render thread just stops getting frames
+                }
+            }
+        });
+
+        impl->session = impl->framePool.CreateCaptureSession(impl->item);
+
+        if (ApiInformation::IsPropertyPresent(L"Windows.Graphics.Capture.GraphicsCaptureSession", L"IsCursorCaptureEnabled"))
+        {
+            // The pointer is only drawn into the frame when it is over the window
+            impl->session.IsCursorCaptureEnabled(true);
+        }
+
+        if (ApiInformation::IsPropertyPresent(L"Windows.Graphics.Capture.GraphicsCaptureSession", L"IsBorderRequired"))
+        {
+            impl->session.IsBorderRequired(false);
+        }
+
+        impl->session.StartCapture();
+
+        impl_ = std::move(impl);
+        window_ = window;
+        return true;
+    }
+    catch (const winrt::hresult_error&)
+    {
+        return false;
+    }
+}
+
+void WindowCapture::Stop()
+{
+    if (!impl_)
+    {
+        return;
+    }
+
+    ReleaseFrame();
+
+    try
+    {
+        {
+            const std::lock_guard<std::mutex> guard(impl_->lock);
+            impl_->stopped = true;
+            if (impl_->latestFrame)
+            {
+                impl_->latestFrame.Close();
+                impl_->latestFrame = nullptr;
+            }
+        }
+
+        impl_->session.Close();
+        impl_->framePool.Close();
+    }
+    catch (const winrt::hresult_error&)
+    {
+        // The device may already be gone; there's nothing more to release
+    }
+
+    impl_.reset();
+    window_ = nullptr;
+}
+
+HWND WindowCapture::GetWindow() const
+{
+    return window_;
+}
+
+bool WindowCapture::AcquireFrame(WindowCaptureFrame* frame)
+{
+    if (!impl_ || !frame)
+    {
+        return false;
+    }
+
+    ReleaseFrame();
+
+    UINT replacedFrames;
+    {
+        const std::lock_guard<std::mutex> guard(impl_->lock);
+        impl_->acquiredFrame = std::move(impl_->latestFrame);
+        impl_->latestFrame = nullptr;
+        replacedFrames = impl_->replacedFrames;
+        impl_->replacedFrames = 0;
+    }
+
+    if (!impl_->acquiredFrame)
+    {
+        return false;
+    }
+
+    try
+    {
+        const auto access = impl_->acquiredFrame.Surface().as<::Windows::Graphics::DirectX::Direct3D11::IDirect3DDxgiInterfaceAccess>();
+        winrt::check_hresult(access->GetInterface(__uuidof(ID3D11Texture2D), reinterpret_cast<void**>(&impl_->acquiredTexture)));  // NOLINT(clang-diagnostic-language-extension-token)
+
+        const winrt::Windows::Graphics::SizeInt32 contentSize = impl_->acquiredFrame.ContentSize();
+
+        // SystemRelativeTime is the QPC timeline in 100ns units
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        const LONGLONG hundredNanoseconds = impl_->acquiredFrame.SystemRelativeTime().count();
+
+        frame->texture = impl_->acquiredTexture;
+        frame->contentSize.cx = contentSize.Width;
+        frame->contentSize.cy = contentSize.Height;
+        frame->presentTime = static_cast<LONGLONG>(
+            static_cast<double>(hundredNanoseconds) * static_cast<double>(frequency.QuadPart) / 1.0e7);
+        frame->skippedFrames = replacedFrames;
+        return true;
+    }
+    catch (const winrt::hresult_error&)
+    {
+        ReleaseFrame();
+        return false;
+    }
+}
+
+void WindowCapture::ReleaseFrame()
+{
+    if (!impl_)
+    {
+        return;
+    }
+
+    if (impl_->acquiredTexture)
+    {
+        impl_->acquiredTexture->Release();
+        impl_->acquiredTexture = nullptr;
+    }
+
+    if (impl_->acquiredFrame)
+    {
+        // Returns the buffer to the pool
+        impl_->acquiredFrame.Close();
+        impl_->acquiredFrame = nullptr;
+    }
+}
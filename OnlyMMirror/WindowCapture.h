@@ -0,0 +1,39 @@
+#pragma once
+#include <windows.h>
+#include <d3d11.h>
+#include <memory>
+
+struct WindowCaptureFrame
+{
+    ID3D11Texture2D* texture;   // owned by the capture; valid until ReleaseFrame
+    SIZE contentSize;           // the window's size; the texture can be larger
+    LONGLONG presentTime;       // QPC ticks when the frame was composed
+    UINT skippedFrames;         // frames that arrived since the last acquire but were replaced
+};
+
+// Captures a single window with Windows.Graphics.Capture, so only that window's pixels are
+// copied rather than the whole output. The frame pool is free-threaded: frames arrive on a
+// thread-pool thread and the latest one is held, under a lock, until the render thread
+// acquires it. The WinRT types are kept out of this header.
+class WindowCapture  // NOLINT(cppcoreguidelines-special-member-functions)
+{
+public:
+    WindowCapture();
+    ~WindowCapture();
+
+    static bool IsSupported();
+
+    bool Start(ID3D11Device* device, HWND window);
+    void Stop();
+    HWND GetWindow() const;
+
+    // Mirrors IDXGIOutputDuplication: returns false if no new frame has arrived since the
+    // last call, otherwise the frame must be released (after copying it) with ReleaseFrame.
+    bool AcquireFrame(WindowCaptureFrame* frame);
+    void ReleaseFrame();
+
+private:
+    struct Impl;
+    std::shared_ptr<Impl> impl_;
+    HWND window_;
+};